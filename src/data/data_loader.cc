@@ -0,0 +1,131 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/data/data_loader.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include "glog/logging.h"
+
+namespace intellgraph {
+
+template <typename T>
+DataLoader<T>::DataLoader(const Dataset<T> *dataset,
+                          const DataLoaderOptions &options)
+    : dataset_(dataset), options_(options), generator_(options.seed) {
+  DCHECK(dataset_);
+  DCHECK_GT(options_.batch_size, 0);
+
+  int64_t num_examples = dataset_->num_examples();
+  num_batches_ = options_.drop_remainder
+                     ? num_examples / options_.batch_size
+                     : (num_examples + options_.batch_size - 1) /
+                           options_.batch_size;
+
+  order_.resize(num_examples);
+  std::iota(order_.begin(), order_.end(), 0);
+  // Read-ahead only helps sequential epochs
+  dataset_->file().Advise(options_.shuffle ? MADV_RANDOM : MADV_SEQUENTIAL);
+
+  for (Batch<T> &batch : batches_) {
+    batch.feature_.resize(dataset_->feature_rows(), options_.batch_size);
+    batch.labels_.resize(dataset_->label_rows(), options_.batch_size);
+  }
+  // Epochs without mini-batches end right away, see Next
+  if (num_batches_ > 0) {
+    producer_ = std::thread(&DataLoader<T>::ProduceLoop, this);
+  }
+}
+
+template <typename T> DataLoader<T>::~DataLoader() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  if (producer_.joinable()) {
+    producer_.join();
+  }
+}
+
+template <typename T> const Batch<T> *DataLoader<T>::Next() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (consuming_) {
+    // Releases the mini-batch returned by the last call
+    full_[consumed_] = false;
+    consumed_ ^= 1;
+    consuming_ = false;
+    cv_.notify_all();
+  }
+  if (batch_index_ == num_batches_) {
+    batch_index_ = 0;
+    return nullptr;
+  }
+  cv_.wait(lock, [this] { return full_[consumed_]; });
+  consuming_ = true;
+  ++batch_index_;
+  return &batches_[consumed_];
+}
+
+template <typename T> void DataLoader<T>::ProduceLoop() {
+  int produced = 0;
+  for (int64_t index = 0;; index = (index + 1) % num_batches_) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this, produced] { return stopped_ || !full_[produced]; });
+      if (stopped_) {
+        return;
+      }
+    }
+    // The caller never reads a buffer that is not full
+    Gather(index, &batches_[produced]);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      full_[produced] = true;
+    }
+    cv_.notify_all();
+    produced ^= 1;
+  }
+}
+
+template <typename T>
+void DataLoader<T>::Gather(int64_t index, Batch<T> *batch) {
+  if (index == 0 && options_.shuffle) {
+    std::shuffle(order_.begin(), order_.end(), generator_);
+  }
+  int feature_rows = dataset_->feature_rows();
+  int label_rows = dataset_->label_rows();
+  int64_t begin = index * options_.batch_size;
+  int length = std::min<int64_t>(options_.batch_size, order_.size() - begin);
+  for (int i = 0; i < length; ++i) {
+    int64_t example = order_[begin + i];
+    std::memcpy(batch->feature_.col(i).data(), dataset_->feature(example),
+                feature_rows * sizeof(T));
+    std::memcpy(batch->labels_.col(i).data(), dataset_->labels(example),
+                label_rows * sizeof(int));
+  }
+  batch->length_ = length;
+}
+
+// Explicit instantiation
+template class Batch<float>;
+template class Batch<double>;
+template class DataLoader<float>;
+template class DataLoader<double>;
+
+} // namespace intellgraph
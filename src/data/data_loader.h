@@ -0,0 +1,127 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_DATA_DATA_LOADER_H_
+#define INTELLGRAPH_SRC_DATA_DATA_LOADER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "src/data/dataset.h"
+#include "src/eigen.h"
+
+namespace intellgraph {
+
+struct DataLoaderOptions {
+  // Number of examples of a mini-batch
+  int batch_size = 32;
+  // Visits examples in a new random order every epoch
+  bool shuffle = true;
+  // Seed of the random orders
+  uint64_t seed = 0;
+  // Skips the last mini-batch of an epoch if it is not full
+  bool drop_remainder = false;
+};
+
+// Batch is a mini-batch assembled by DataLoader. Its buffers are allocated
+// once and reused, the maps point at them.
+template <typename T> class Batch {
+public:
+  Eigen::Map<const MatrixX<T>> feature() const {
+    return Eigen::Map<const MatrixX<T>>(feature_.data(), feature_.rows(),
+                                        length_);
+  }
+  Eigen::Map<const MatrixX<int>> labels() const {
+    return Eigen::Map<const MatrixX<int>>(labels_.data(), labels_.rows(),
+                                          length_);
+  }
+  int length() const { return length_; }
+
+private:
+  template <typename> friend class DataLoader;
+
+  MatrixX<T> feature_;
+  MatrixX<int> labels_;
+  int length_ = 0;
+};
+
+// DataLoader streams mini-batches of a dataset for training, e.g.
+//   while (const Batch<float> *batch = loader.Next()) {
+//     classifier.Train(batch->feature(), batch->labels());
+//   }
+// A producer thread gathers the examples of the next mini-batch into one of
+// two buffers while the caller trains on the other one, so that reading the
+// mapped dataset overlaps with training. The producer runs ahead into the
+// next epoch, whose order is drawn as soon as its first mini-batch is
+// assembled. The dataset must outlive the loader. Datasets without a
+// mini-batch, e.g. empty ones or ones smaller than a dropped remainder, start
+// no producer and every epoch ends right away.
+template <typename T> class DataLoader {
+public:
+  DataLoader(const Dataset<T> *dataset, const DataLoaderOptions &options);
+  // Stops the producer
+  ~DataLoader();
+
+  DataLoader(const DataLoader &) = delete;
+  DataLoader &operator=(const DataLoader &) = delete;
+
+  // Returns the next mini-batch of the epoch, or nullptr once the epoch is
+  // over, in which case the following call starts the next epoch. The batch
+  // is valid until the next call.
+  const Batch<T> *Next();
+
+  // Returns the number of mini-batches of an epoch
+  int64_t num_batches() const { return num_batches_; }
+
+private:
+  void ProduceLoop();
+  // Gathers mini-batch |index| of an epoch into |batch|
+  void Gather(int64_t index, Batch<T> *batch);
+
+  const Dataset<T> *dataset_ = nullptr;
+  const DataLoaderOptions options_;
+  int64_t num_batches_ = 0;
+
+  // Only accessed by the producer
+  std::vector<int64_t> order_;
+  std::mt19937_64 generator_;
+
+  // Double buffers, |full_| tells whether a buffer holds a mini-batch that
+  // the caller has not released yet
+  Batch<T> batches_[2];
+  bool full_[2] = {false, false};
+  int consumed_ = 0;
+  bool consuming_ = false;
+  int64_t batch_index_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopped_ = false;
+  std::thread producer_;
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class Batch<float>;
+extern template class Batch<double>;
+extern template class DataLoader<float>;
+extern template class DataLoader<double>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_DATA_DATA_LOADER_H_
@@ -0,0 +1,169 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/data/data_loader.h"
+
+#include <cstdio>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/text_format.h"
+#include "src/data/dataset.h"
+#include "src/eigen.h"
+#include "src/graph/classifier_impl.h"
+#include "src/proto/graph_parameter.pb.h"
+#include "src/registry.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+constexpr char kGraphParameter[] = R"(
+  solver_config { type: "SGD" eta: 0.5 lambda: 0.0 }
+  length: 4
+  input_vertex_param { id: 0 type: INPUT operation: "DummyTransformer" dims: 2 }
+  output_vertex_param { id: 2 type: OUTPUT operation: "CrossEntropy" dims: 1 }
+  intermediate_vertex_params { id: 1 type: HIDDEN operation: "Tanh" dims: 4 }
+  edge_params { id: 0 type: "Dense" vertex_in_id: 0 vertex_out_id: 1 }
+  edge_params { id: 1 type: "Dense" vertex_in_id: 1 vertex_out_id: 2 }
+)";
+
+class DataLoaderTest : public ::testing::Test {
+protected:
+  // Writes |num_examples| examples whose first feature and label are their
+  // index
+  void WriteDataset(int num_examples) {
+    path_ = ::testing::TempDir() + "data_loader_test.igdata";
+    MatrixX<double> feature(2, num_examples);
+    MatrixX<int> labels(1, num_examples);
+    for (int i = 0; i < num_examples; ++i) {
+      feature.col(i) << i, -i;
+      labels(0, i) = i;
+    }
+    DatasetWriter<double> writer(path_, 2, 1);
+    writer.Append(feature, labels);
+    ASSERT_TRUE(writer.Close());
+    dataset_ = Dataset<double>::Open(path_);
+    ASSERT_TRUE(dataset_);
+  }
+
+  // Returns the examples of an epoch in the order they are visited
+  std::vector<int> RunEpoch(DataLoader<double> *loader,
+                            std::vector<int> *lengths) {
+    std::vector<int> examples;
+    while (const Batch<double> *batch = loader->Next()) {
+      lengths->push_back(batch->length());
+      for (int i = 0; i < batch->length(); ++i) {
+        EXPECT_EQ(batch->feature()(0, i), batch->labels()(0, i));
+        EXPECT_EQ(batch->feature()(1, i), -batch->labels()(0, i));
+        examples.push_back(batch->labels()(0, i));
+      }
+    }
+    return examples;
+  }
+
+  void TearDown() override { std::remove(path_.c_str()); }
+
+  std::string path_;
+  std::unique_ptr<Dataset<double>> dataset_;
+};
+
+TEST_F(DataLoaderTest, SequentialSuccess) {
+  WriteDataset(10);
+  DataLoaderOptions options;
+  options.batch_size = 4;
+  options.shuffle = false;
+  DataLoader<double> loader(dataset_.get(), options);
+  EXPECT_EQ(loader.num_batches(), 3);
+
+  for (int epoch = 0; epoch < 3; ++epoch) {
+    std::vector<int> lengths;
+    std::vector<int> examples = RunEpoch(&loader, &lengths);
+    EXPECT_EQ(lengths, std::vector<int>({4, 4, 2}));
+    EXPECT_EQ(examples, std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+  }
+}
+
+TEST_F(DataLoaderTest, ShuffleSuccess) {
+  WriteDataset(100);
+  DataLoaderOptions options;
+  options.batch_size = 8;
+  options.drop_remainder = true;
+  DataLoader<double> loader(dataset_.get(), options);
+  EXPECT_EQ(loader.num_batches(), 12);
+
+  std::vector<int> lengths;
+  std::vector<int> first_epoch = RunEpoch(&loader, &lengths);
+  std::vector<int> second_epoch = RunEpoch(&loader, &lengths);
+  EXPECT_EQ(lengths, std::vector<int>(24, 8));
+  // Examples are visited at most once per epoch in a new order
+  EXPECT_EQ(std::set<int>(first_epoch.begin(), first_epoch.end()).size(), 96);
+  EXPECT_EQ(std::set<int>(second_epoch.begin(), second_epoch.end()).size(),
+            96);
+  EXPECT_NE(first_epoch, second_epoch);
+
+  // The order only depends on the seed
+  DataLoader<double> other_loader(dataset_.get(), options);
+  EXPECT_EQ(RunEpoch(&other_loader, &lengths), first_epoch);
+}
+
+TEST_F(DataLoaderTest, NoBatchSuccess) {
+  // The only mini-batch is not full and dropped
+  WriteDataset(3);
+  DataLoaderOptions options;
+  options.batch_size = 4;
+  options.drop_remainder = true;
+  DataLoader<double> loader(dataset_.get(), options);
+  EXPECT_EQ(loader.num_batches(), 0);
+  EXPECT_EQ(loader.Next(), nullptr);
+  EXPECT_EQ(loader.Next(), nullptr);
+}
+
+TEST_F(DataLoaderTest, TrainSuccess) {
+  Registry::LoadRegistry();
+  GraphParameter graph_parameter;
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(kGraphParameter,
+                                                            &graph_parameter));
+  ClassifierImpl<double> classifier(graph_parameter);
+
+  // XOR
+  path_ = ::testing::TempDir() + "data_loader_test.igdata";
+  MatrixX<double> feature(2, 4);
+  feature << 0.0, 0.0, 1.0, 1.0, 0.0, 1.0, 0.0, 1.0;
+  MatrixX<int> labels(1, 4);
+  labels << 0, 1, 1, 0;
+  DatasetWriter<double> writer(path_, 2, 1);
+  for (int i = 0; i < 16; ++i) {
+    writer.Append(feature, labels);
+  }
+  ASSERT_TRUE(writer.Close());
+  dataset_ = Dataset<double>::Open(path_);
+  ASSERT_TRUE(dataset_);
+
+  DataLoaderOptions options;
+  options.batch_size = 16;
+  DataLoader<double> loader(dataset_.get(), options);
+  double loss = classifier.CalculateLoss(feature, labels);
+  for (int epoch = 0; epoch < 50; ++epoch) {
+    while (const Batch<double> *batch = loader.Next()) {
+      classifier.Train(batch->feature(), batch->labels());
+    }
+  }
+  EXPECT_LT(classifier.CalculateLoss(feature, labels), loss);
+}
+
+} // namespace
+} // namespace intellgraph
@@ -0,0 +1,190 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/data/dataset.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "glog/logging.h"
+
+namespace intellgraph {
+namespace {
+
+constexpr char kMagic[8] = "IGDATA";
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t scalar_size;
+  uint32_t feature_rows;
+  uint32_t label_rows;
+  uint64_t num_examples;
+  uint64_t label_offset;
+};
+
+uint64_t Align(uint64_t offset) {
+  return (offset + kDatasetAlignment - 1) / kDatasetAlignment *
+         kDatasetAlignment;
+}
+
+// Features follow the header
+const uint64_t kFeatureOffset = Align(sizeof(Header));
+
+static_assert(sizeof(int) == sizeof(int32_t), "Labels are 32-bit integers.");
+
+} // namespace
+
+template <typename T>
+DatasetWriter<T>::DatasetWriter(const std::string &path, int feature_rows,
+                                int label_rows)
+    : path_(path), label_path_(path + ".labels"), feature_rows_(feature_rows),
+      label_rows_(label_rows),
+      file_(path, std::ios::binary | std::ios::trunc),
+      label_file_(label_path_, std::ios::binary | std::ios::trunc) {
+  DCHECK_GT(feature_rows_, 0);
+  DCHECK_GT(label_rows_, 0);
+  // The header is written by Close
+  const char padding[kDatasetAlignment] = {};
+  file_.write(padding, kFeatureOffset);
+}
+
+template <typename T> DatasetWriter<T>::~DatasetWriter() {
+  if (label_file_.is_open()) {
+    label_file_.close();
+    std::remove(label_path_.c_str());
+  }
+}
+
+template <typename T>
+void DatasetWriter<T>::Append(const Eigen::Ref<const MatrixX<T>> &feature,
+                              const Eigen::Ref<const MatrixX<int>> &labels) {
+  DCHECK_EQ(feature.rows(), feature_rows_);
+  DCHECK_EQ(labels.rows(), label_rows_);
+  DCHECK_EQ(feature.cols(), labels.cols());
+  // Columns are contiguous even if the matrices are blocks
+  for (int i = 0; i < feature.cols(); ++i) {
+    Append(feature.col(i).data(), labels.col(i).data(), 1);
+  }
+}
+
+template <typename T>
+void DatasetWriter<T>::Append(const T *feature, const int *labels,
+                              int64_t num_examples) {
+  DCHECK(label_file_.is_open());
+  file_.write(reinterpret_cast<const char *>(feature),
+              num_examples * feature_rows_ * sizeof(T));
+  label_file_.write(reinterpret_cast<const char *>(labels),
+                    num_examples * label_rows_ * sizeof(int));
+  num_examples_ += num_examples;
+}
+
+template <typename T> bool DatasetWriter<T>::Close() {
+  DCHECK(label_file_.is_open());
+  label_file_.close();
+  bool labels_written = static_cast<bool>(label_file_);
+
+  Header header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kDatasetVersion;
+  header.scalar_size = sizeof(T);
+  header.feature_rows = feature_rows_;
+  header.label_rows = label_rows_;
+  header.num_examples = num_examples_;
+  uint64_t position =
+      kFeatureOffset + num_examples_ * feature_rows_ * sizeof(T);
+  header.label_offset = Align(position);
+
+  const char padding[kDatasetAlignment] = {};
+  file_.write(padding, header.label_offset - position);
+  if (num_examples_ > 0) {
+    std::ifstream label_file(label_path_, std::ios::binary);
+    file_ << label_file.rdbuf();
+  }
+  std::remove(label_path_.c_str());
+  file_.seekp(0);
+  file_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file_.close();
+  if (!file_ || !labels_written) {
+    LOG(ERROR) << "Failed to write the dataset " << path_ << ".";
+    return false;
+  }
+  return true;
+}
+
+template <typename T>
+std::unique_ptr<Dataset<T>> Dataset<T>::Open(const std::string &path) {
+  std::unique_ptr<MappedFile> file = MappedFile::Open(path, false);
+  if (!file) {
+    return nullptr;
+  }
+  std::unique_ptr<Dataset<T>> dataset(new Dataset<T>(std::move(file)));
+  if (!dataset->Parse()) {
+    LOG(ERROR) << path << " is not a valid dataset.";
+    return nullptr;
+  }
+  return dataset;
+}
+
+template <typename T>
+Dataset<T>::Dataset(std::unique_ptr<MappedFile> file)
+    : file_(std::move(file)) {}
+
+template <typename T> Dataset<T>::~Dataset() = default;
+
+template <typename T> bool Dataset<T>::Parse() {
+  const char *data = file_->data();
+  uint64_t size = file_->size();
+
+  Header header;
+  if (size < kFeatureOffset) {
+    return false;
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kDatasetVersion || header.scalar_size != sizeof(T)) {
+    LOG(ERROR) << "Unsupported dataset version " << header.version
+               << " or scalar size " << header.scalar_size << ".";
+    return false;
+  }
+  if (header.feature_rows == 0 || header.label_rows == 0 ||
+      header.feature_rows > INT32_MAX || header.label_rows > INT32_MAX ||
+      header.num_examples >
+          (size - kFeatureOffset) / header.feature_rows / sizeof(T)) {
+    return false;
+  }
+  uint64_t label_offset =
+      Align(kFeatureOffset +
+            header.num_examples * header.feature_rows * sizeof(T));
+  if (header.label_offset != label_offset || label_offset > size ||
+      header.num_examples >
+          (size - label_offset) / header.label_rows / sizeof(int)) {
+    return false;
+  }
+
+  feature_rows_ = header.feature_rows;
+  label_rows_ = header.label_rows;
+  num_examples_ = header.num_examples;
+  features_ = reinterpret_cast<const T *>(data + kFeatureOffset);
+  labels_ = reinterpret_cast<const int *>(data + label_offset);
+  return true;
+}
+
+// Explicit instantiation
+template class DatasetWriter<float>;
+template class DatasetWriter<double>;
+template class Dataset<float>;
+template class Dataset<double>;
+
+} // namespace intellgraph
@@ -0,0 +1,132 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_DATA_DATASET_H_
+#define INTELLGRAPH_SRC_DATA_DATASET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "src/eigen.h"
+#include "src/utility/mapped_file.h"
+
+namespace intellgraph {
+
+// A dataset file holds labelled examples in native byte order:
+//   - a header with a magic string, the format version, the size of a scalar,
+//     the numbers of feature and label rows and the number of examples
+//   - the features, a column-major matrix with an example per column
+//   - the labels, a column-major matrix of 32-bit integers with an example
+//     per column
+// Both matrices start at a multiple of kDatasetAlignment bytes, so that the
+// columns of a mapped dataset can be fed to a graph in place.
+constexpr uint32_t kDatasetVersion = 1;
+constexpr size_t kDatasetAlignment = 64;
+
+// DatasetWriter appends examples to a dataset file. Features are streamed to
+// the file and labels to a temporary file next to it, so that the examples
+// never have to fit in memory at once.
+template <typename T> class DatasetWriter {
+public:
+  explicit DatasetWriter(const std::string &path, int feature_rows,
+                         int label_rows);
+  ~DatasetWriter();
+
+  DatasetWriter(const DatasetWriter &) = delete;
+  DatasetWriter &operator=(const DatasetWriter &) = delete;
+
+  // Appends the columns of |feature| and |labels| as examples
+  void Append(const Eigen::Ref<const MatrixX<T>> &feature,
+              const Eigen::Ref<const MatrixX<int>> &labels);
+  // Appends |num_examples| column-major examples
+  void Append(const T *feature, const int *labels, int64_t num_examples);
+
+  // Moves the labels behind the features and writes the header. Returns
+  // false if the file cannot be written.
+  bool Close();
+
+  int64_t num_examples() const { return num_examples_; }
+
+private:
+  std::string path_;
+  std::string label_path_;
+  int feature_rows_;
+  int label_rows_;
+  int64_t num_examples_ = 0;
+  std::ofstream file_;
+  std::ofstream label_file_;
+};
+
+// Dataset maps a dataset file into memory and validates it. The mapping is
+// read-only, pages are read from the file when they are first accessed and
+// may be evicted under memory pressure, so a dataset can be larger than
+// memory.
+template <typename T> class Dataset {
+public:
+  // Returns nullptr if the file cannot be mapped or is not a valid dataset of
+  // |T| scalars
+  static std::unique_ptr<Dataset<T>> Open(const std::string &path);
+  ~Dataset();
+
+  Dataset(const Dataset &) = delete;
+  Dataset &operator=(const Dataset &) = delete;
+
+  int feature_rows() const { return feature_rows_; }
+  int label_rows() const { return label_rows_; }
+  int64_t num_examples() const { return num_examples_; }
+
+  // Returns the column of example |index|
+  const T *feature(int64_t index) const {
+    return features_ + index * feature_rows_;
+  }
+  const int *labels(int64_t index) const {
+    return labels_ + index * label_rows_;
+  }
+
+  // Maps all examples
+  Eigen::Map<const MatrixX<T>> features() const {
+    return Eigen::Map<const MatrixX<T>>(features_, feature_rows_,
+                                        num_examples_);
+  }
+  Eigen::Map<const MatrixX<int>> labels() const {
+    return Eigen::Map<const MatrixX<int>>(labels_, label_rows_, num_examples_);
+  }
+
+  const MappedFile &file() const { return *file_; }
+
+private:
+  explicit Dataset(std::unique_ptr<MappedFile> file);
+  bool Parse();
+
+  std::unique_ptr<MappedFile> file_;
+  int feature_rows_ = 0;
+  int label_rows_ = 0;
+  int64_t num_examples_ = 0;
+  const T *features_ = nullptr;
+  const int *labels_ = nullptr;
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class DatasetWriter<float>;
+extern template class DatasetWriter<double>;
+extern template class Dataset<float>;
+extern template class Dataset<double>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_DATA_DATASET_H_
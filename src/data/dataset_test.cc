@@ -0,0 +1,77 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/data/dataset.h"
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "src/eigen.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+TEST(DatasetTest, WriteAndOpenSuccess) {
+  std::string path = ::testing::TempDir() + "dataset_test.igdata";
+  MatrixX<float> feature = MatrixX<float>::Random(3, 5);
+  MatrixX<int> labels(2, 5);
+  labels << 0, 1, 0, 1, 1, 1, 0, 1, 0, 0;
+
+  DatasetWriter<float> writer(path, 3, 2);
+  writer.Append(feature.leftCols(2), labels.leftCols(2));
+  writer.Append(feature.rightCols(3).data(), labels.rightCols(3).data(), 3);
+  EXPECT_EQ(writer.num_examples(), 5);
+  ASSERT_TRUE(writer.Close());
+
+  std::unique_ptr<Dataset<float>> dataset = Dataset<float>::Open(path);
+  ASSERT_TRUE(dataset);
+  EXPECT_EQ(dataset->feature_rows(), 3);
+  EXPECT_EQ(dataset->label_rows(), 2);
+  EXPECT_EQ(dataset->num_examples(), 5);
+  EXPECT_EQ(dataset->features(), feature);
+  EXPECT_EQ(dataset->labels(), labels);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(dataset->feature(0)) %
+                kDatasetAlignment,
+            0);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(dataset->labels(0)) %
+                kDatasetAlignment,
+            0);
+  EXPECT_EQ(dataset->feature(3)[1], feature(1, 3));
+  EXPECT_EQ(dataset->labels(4)[0], labels(0, 4));
+
+  // Scalars are floats
+  EXPECT_FALSE(Dataset<double>::Open(path));
+  std::remove(path.c_str());
+}
+
+TEST(DatasetTest, OpenFailure) {
+  std::string path = ::testing::TempDir() + "dataset_test.igdata";
+  EXPECT_FALSE(Dataset<float>::Open(path));
+
+  DatasetWriter<float> writer(path, 4, 1);
+  writer.Append(MatrixX<float>::Ones(4, 16), MatrixX<int>::Zero(1, 16));
+  ASSERT_TRUE(writer.Close());
+  // Truncates the labels
+  ASSERT_EQ(truncate(path.c_str(), 64 + 4 * 16 * sizeof(float) + 8), 0);
+  EXPECT_FALSE(Dataset<float>::Open(path));
+  std::remove(path.c_str());
+}
+
+} // namespace
+} // namespace intellgraph
@@ -0,0 +1,87 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include <sys/stat.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "glog/logging.h"
+#include "src/data/text_ingest.h"
+
+// Converts a CSV or libsvm text file into a dataset that DataLoader maps
+// directly, see src/data/dataset.h, and reports the parsing throughput:
+//   intellgraph_ingest <csv|libsvm> <input> <output> <dims> [num_classes]
+//       [num_threads] [float|double]
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  if (argc < 5) {
+    LOG(ERROR) << "Usage: " << argv[0]
+               << " <csv|libsvm> <input> <output> <dims> [num_classes]"
+                  " [num_threads] [float|double]";
+    return 1;
+  }
+
+  intellgraph::IngestOptions options;
+  std::string format = argv[1];
+  if (format == "csv") {
+    options.format = intellgraph::InputFormat::kCsv;
+  } else if (format == "libsvm") {
+    options.format = intellgraph::InputFormat::kLibsvm;
+  } else {
+    LOG(ERROR) << "Unknown format " << format;
+    return 1;
+  }
+  options.feature_rows = std::atoi(argv[4]);
+  options.num_classes = argc > 5 ? std::atoi(argv[5]) : 2;
+  options.num_threads = argc > 6 ? std::atoi(argv[6])
+                                 : std::thread::hardware_concurrency();
+  bool use_double = argc > 7 && std::string(argv[7]) == "double";
+  if (options.feature_rows <= 0 || options.num_threads <= 0) {
+    LOG(ERROR) << "Dimensions and the number of threads must be positive";
+    return 1;
+  }
+
+  struct stat input_stat;
+  if (stat(argv[2], &input_stat) != 0) {
+    LOG(ERROR) << "Failed to stat " << argv[2];
+    return 1;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  int64_t num_examples = 0;
+  bool ingested =
+      use_double
+          ? intellgraph::IngestText<double>(argv[2], argv[3], options,
+                                            &num_examples)
+          : intellgraph::IngestText<float>(argv[2], argv[3], options,
+                                           &num_examples);
+  if (!ingested) {
+    return 1;
+  }
+  double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+
+  std::printf("examples: %lld\n", static_cast<long long>(num_examples));
+  std::printf("input:    %.3f GB in %.3f s\n", input_stat.st_size / 1e9,
+              seconds);
+  std::printf("speed:    %.3f GB/s with %d threads\n",
+              input_stat.st_size / 1e9 / seconds, options.num_threads);
+  return 0;
+}
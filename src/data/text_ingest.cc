@@ -0,0 +1,320 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/data/text_ingest.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+
+#include "glog/logging.h"
+#include "src/data/dataset.h"
+#include "src/utility/mapped_file.h"
+#include "src/utility/thread_pool.h"
+
+namespace intellgraph {
+namespace {
+
+const char *SkipBlanks(const char *p, const char *end) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+    ++p;
+  }
+  return p;
+}
+
+// Powers of ten that are exact in a double, and in a float up to 1e10
+constexpr double kPowersOfTen[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                   1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                   1e18, 1e19, 1e20, 1e21, 1e22};
+
+bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Parses a number like -12.375e2 at |p|. Returns the end of the number or
+// nullptr if there is none. The decimal digits are gathered into an integer,
+// if both the integer and the power of ten are exact in |T|, the correctly
+// rounded result is their product or quotient. This covers numbers written
+// with a few significant digits, others, e.g. with many digits or inf, fall
+// back to std::from_chars.
+template <typename T>
+const char *ParseNumber(const char *p, const char *end, T *value) {
+  p = SkipBlanks(p, end);
+  if (p < end && *p == '+') {
+    ++p;
+  }
+  const char *begin = p;
+  bool negative = p < end && *p == '-';
+  p += negative;
+
+  uint64_t mantissa = 0;
+  int num_digits = 0;
+  int exponent = 0;
+  for (; p < end && IsDigit(*p); ++p, ++num_digits) {
+    mantissa = mantissa * 10 + (*p - '0');
+  }
+  if (p < end && *p == '.') {
+    for (++p; p < end && IsDigit(*p); ++p, ++num_digits, --exponent) {
+      mantissa = mantissa * 10 + (*p - '0');
+    }
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char *q = p + 1;
+    bool negative_exponent = q < end && *q == '-';
+    q += q < end && (*q == '-' || *q == '+');
+    int written_exponent = 0;
+    const char *digits = q;
+    for (; q < end && IsDigit(*q) && written_exponent < 10000; ++q) {
+      written_exponent = written_exponent * 10 + (*q - '0');
+    }
+    if (q == digits) {
+      num_digits = 0;
+    }
+    exponent += negative_exponent ? -written_exponent : written_exponent;
+    p = q;
+  }
+
+  constexpr int kMaxPower = sizeof(T) == sizeof(float) ? 10 : 22;
+  constexpr uint64_t kMaxMantissa = uint64_t(1)
+                                    << std::numeric_limits<T>::digits;
+  // At most 19 digits cannot overflow |mantissa|
+  if (num_digits == 0 || num_digits > 19 || mantissa > kMaxMantissa ||
+      exponent < -kMaxPower || exponent > kMaxPower) {
+    auto [number_end, error] = std::from_chars(begin, end, *value);
+    return error == std::errc() ? number_end : nullptr;
+  }
+  T result = static_cast<T>(mantissa);
+  T power = static_cast<T>(kPowersOfTen[exponent < 0 ? -exponent : exponent]);
+  result = exponent < 0 ? result / power : result * power;
+  *value = negative ? -result : result;
+  return p;
+}
+
+// Stores the class of |label| into a column of |label_rows| labels
+template <typename T>
+bool StoreLabel(T label, int num_classes, int label_rows, int *labels) {
+  if (num_classes <= 2) {
+    labels[0] = label > 0 ? 1 : 0;
+    return true;
+  }
+  int label_class = static_cast<int>(label);
+  if (label_class != label || label_class < 0 || label_class >= num_classes) {
+    return false;
+  }
+  std::fill(labels, labels + label_rows, 0);
+  labels[label_class] = 1;
+  return true;
+}
+
+// Parses |feature_rows| comma-separated features at |p| into |features|
+template <typename T>
+const char *ParseCsvFeatures(const char *p, const char *end,
+                             int feature_rows, T *features) {
+  for (int i = 0; i < feature_rows; ++i) {
+    p = SkipBlanks(p, end);
+    if (p == end || *p != ',') {
+      return nullptr;
+    }
+    p = ParseNumber(p + 1, end, &features[i]);
+    if (!p) {
+      return nullptr;
+    }
+  }
+  return p;
+}
+
+// Parses index:value pairs at |p| into |features|, which are zero
+template <typename T>
+const char *ParseLibsvmFeatures(const char *p, const char *end,
+                                int feature_rows, T *features) {
+  for (p = SkipBlanks(p, end); p < end; p = SkipBlanks(p, end)) {
+    int index;
+    auto [index_end, error] = std::from_chars(p, end, index);
+    if (error != std::errc() || index < 1 || index > feature_rows ||
+        index_end == end || *index_end != ':') {
+      return nullptr;
+    }
+    p = ParseNumber(index_end + 1, end, &features[index - 1]);
+    if (!p) {
+      return nullptr;
+    }
+  }
+  return p;
+}
+
+} // namespace
+
+int LabelRows(const IngestOptions &options) {
+  return options.num_classes <= 2 ? 1 : options.num_classes;
+}
+
+std::vector<const char *> SplitLines(const char *begin, const char *end,
+                                     int num_chunks) {
+  DCHECK_GT(num_chunks, 0);
+  std::vector<const char *> bounds = {begin};
+  size_t size = end - begin;
+  for (int i = 1; i < num_chunks; ++i) {
+    const char *target = begin + size * i / num_chunks;
+    if (target <= bounds.back()) {
+      continue;
+    }
+    // Chunks end after a newline
+    const char *newline = static_cast<const char *>(
+        std::memchr(target - 1, '\n', end - target + 1));
+    if (!newline || newline + 1 == end) {
+      break;
+    }
+    if (newline + 1 > bounds.back()) {
+      bounds.push_back(newline + 1);
+    }
+  }
+  bounds.push_back(end);
+  return bounds;
+}
+
+template <typename T>
+bool ParseText(const char *begin, const char *end,
+               const IngestOptions &options, ParsedChunk<T> *chunk) {
+  DCHECK(chunk);
+  DCHECK_GT(options.feature_rows, 0);
+
+  int feature_rows = options.feature_rows;
+  int label_rows = LabelRows(options);
+  for (const char *line = begin; line < end;) {
+    const char *line_end =
+        static_cast<const char *>(std::memchr(line, '\n', end - line));
+    if (!line_end) {
+      line_end = end;
+    }
+    if (SkipBlanks(line, line_end) == line_end) {
+      line = line_end + 1;
+      continue;
+    }
+
+    // Columns are appended in place
+    chunk->features.resize(chunk->features.size() + feature_rows);
+    chunk->labels.resize(chunk->labels.size() + label_rows);
+    T *features = chunk->features.data() + chunk->features.size() -
+                  feature_rows;
+    int *labels = chunk->labels.data() + chunk->labels.size() - label_rows;
+
+    T label;
+    const char *p = ParseNumber(line, line_end, &label);
+    if (p && options.format == InputFormat::kCsv) {
+      p = ParseCsvFeatures(p, line_end, feature_rows, features);
+    } else if (p) {
+      std::fill(features, features + feature_rows, T(0));
+      p = ParseLibsvmFeatures(p, line_end, feature_rows, features);
+    }
+    if (!p || SkipBlanks(p, line_end) != line_end ||
+        !StoreLabel(label, options.num_classes, label_rows, labels)) {
+      LOG(ERROR) << "Malformed line: " << std::string(line, line_end);
+      return false;
+    }
+    ++chunk->num_examples;
+    line = line_end + 1;
+  }
+  return true;
+}
+
+template <typename T>
+bool IngestText(const std::string &input_path, const std::string &output_path,
+                const IngestOptions &options, int64_t *num_examples) {
+  DCHECK(num_examples);
+  DCHECK_GT(options.num_threads, 0);
+  DCHECK_GT(options.chunk_bytes, 0);
+
+  std::unique_ptr<MappedFile> file = MappedFile::Open(input_path, false);
+  if (!file) {
+    return false;
+  }
+  file->Advise(MADV_SEQUENTIAL);
+  const char *begin = file->data();
+  const char *end = begin + file->size();
+  if (options.skip_header) {
+    const char *newline =
+        static_cast<const char *>(std::memchr(begin, '\n', end - begin));
+    begin = newline ? newline + 1 : end;
+  }
+
+  int num_threads = options.num_threads;
+  std::unique_ptr<ThreadPool> thread_pool;
+  if (num_threads > 1) {
+    thread_pool = std::make_unique<ThreadPool>(num_threads - 1);
+  }
+  std::vector<ParsedChunk<T>> chunks(num_threads);
+  DatasetWriter<T> writer(output_path, options.feature_rows,
+                          LabelRows(options));
+  bool parsed = true;
+  while (parsed && begin < end) {
+    // A window holds a chunk per thread and ends at a line boundary
+    const char *window_end = end;
+    size_t window = options.chunk_bytes * num_threads;
+    if (static_cast<size_t>(end - begin) > window) {
+      const char *newline = static_cast<const char *>(
+          std::memchr(begin + window, '\n', end - begin - window));
+      window_end = newline ? newline + 1 : end;
+    }
+    std::vector<const char *> bounds =
+        SplitLines(begin, window_end, num_threads);
+    int num_chunks = bounds.size() - 1;
+
+    std::atomic<bool> chunks_parsed{true};
+    auto parse = [&](int i) {
+      chunks[i].features.clear();
+      chunks[i].labels.clear();
+      chunks[i].num_examples = 0;
+      if (!ParseText(bounds[i], bounds[i + 1], options, &chunks[i])) {
+        chunks_parsed = false;
+      }
+    };
+    if (thread_pool) {
+      thread_pool->ParallelFor(num_chunks, parse);
+    } else {
+      parse(0);
+    }
+    parsed = chunks_parsed;
+
+    // Chunks are written in the order of the input
+    for (int i = 0; parsed && i < num_chunks; ++i) {
+      writer.Append(chunks[i].features.data(), chunks[i].labels.data(),
+                    chunks[i].num_examples);
+    }
+    begin = window_end;
+  }
+
+  *num_examples = writer.num_examples();
+  if (!writer.Close() || !parsed) {
+    std::remove(output_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+// Explicit instantiation
+template bool ParseText<float>(const char *, const char *,
+                               const IngestOptions &, ParsedChunk<float> *);
+template bool ParseText<double>(const char *, const char *,
+                                const IngestOptions &, ParsedChunk<double> *);
+template bool IngestText<float>(const std::string &, const std::string &,
+                                const IngestOptions &, int64_t *);
+template bool IngestText<double>(const std::string &, const std::string &,
+                                 const IngestOptions &, int64_t *);
+
+} // namespace intellgraph
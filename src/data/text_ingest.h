@@ -0,0 +1,84 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_DATA_TEXT_INGEST_H_
+#define INTELLGRAPH_SRC_DATA_TEXT_INGEST_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace intellgraph {
+
+enum class InputFormat {
+  // A line holds the label followed by every feature, separated by commas
+  kCsv = 0,
+  // A line holds the label followed by space-separated index:value pairs of
+  // nonzero features, indices starting from 1
+  kLibsvm = 1,
+};
+
+struct IngestOptions {
+  InputFormat format = InputFormat::kCsv;
+  // Number of features of an example
+  int feature_rows = 0;
+  // Labels are class indices starting from 0. Two classes are stored as a
+  // single row where positive labels are 1 and others are 0, so that -1/+1
+  // labels work as well. More classes are one-hot encoded.
+  int num_classes = 2;
+  // Skips the first line, e.g. the column names of a CSV file
+  bool skip_header = false;
+  // Number of threads that parse chunks of the input concurrently
+  int num_threads = 1;
+  // Size of the text each thread parses at once, the memory used is bounded
+  // by a few times |num_threads| * |chunk_bytes|
+  size_t chunk_bytes = 16 << 20;
+};
+
+// Examples parsed from a chunk of text, as column-major matrices
+template <typename T> struct ParsedChunk {
+  std::vector<T> features;
+  std::vector<int> labels;
+  int64_t num_examples = 0;
+};
+
+// Returns the number of label rows of a dataset ingested with |options|
+int LabelRows(const IngestOptions &options);
+
+// Splits [|begin|, |end|) into at most |num_chunks| chunks of similar size
+// that end at line boundaries. Returns the chunk boundaries, starting with
+// |begin| and ending with |end|.
+std::vector<const char *> SplitLines(const char *begin, const char *end,
+                                     int num_chunks);
+
+// Parses the lines of [|begin|, |end|) and appends their examples to
+// |chunk|. Blank lines are skipped. Returns false and logs the line if a
+// line is malformed.
+template <typename T>
+bool ParseText(const char *begin, const char *end,
+               const IngestOptions &options, ParsedChunk<T> *chunk);
+
+// Converts the text file at |input_path| into a dataset at |output_path|,
+// see src/data/dataset.h. The input is mapped into memory and parsed a
+// window at a time, each window split across threads, so that inputs larger
+// than memory can be converted. Returns false if a file cannot be read or
+// written or a line is malformed.
+template <typename T>
+bool IngestText(const std::string &input_path, const std::string &output_path,
+                const IngestOptions &options, int64_t *num_examples);
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_DATA_TEXT_INGEST_H_
@@ -0,0 +1,132 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/data/text_ingest.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/data/dataset.h"
+#include "src/eigen.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+TEST(TextIngestTest, ParseCsvSuccess) {
+  std::string text = "1,0.5,-2\r\n\n0, 3e-1 ,+4\n-1,1,2";
+  IngestOptions options;
+  options.feature_rows = 2;
+  ParsedChunk<float> chunk;
+  ASSERT_TRUE(
+      ParseText(text.data(), text.data() + text.size(), options, &chunk));
+  EXPECT_EQ(chunk.num_examples, 3);
+  EXPECT_EQ(chunk.features,
+            std::vector<float>({0.5f, -2.0f, 0.3f, 4.0f, 1.0f, 2.0f}));
+  EXPECT_EQ(chunk.labels, std::vector<int>({1, 0, 0}));
+}
+
+TEST(TextIngestTest, ParseLibsvmSuccess) {
+  std::string text = "2 1:0.5 4:-1\n0\n1 3:2.5\n";
+  IngestOptions options;
+  options.format = InputFormat::kLibsvm;
+  options.feature_rows = 4;
+  options.num_classes = 3;
+  ParsedChunk<double> chunk;
+  ASSERT_TRUE(
+      ParseText(text.data(), text.data() + text.size(), options, &chunk));
+  EXPECT_EQ(chunk.num_examples, 3);
+  EXPECT_EQ(chunk.features, std::vector<double>({0.5, 0, 0, -1, 0, 0, 0, 0,
+                                                 0, 0, 2.5, 0}));
+  // One-hot encoded
+  EXPECT_EQ(chunk.labels, std::vector<int>({0, 0, 1, 1, 0, 0, 0, 1, 0}));
+}
+
+TEST(TextIngestTest, ParseFailure) {
+  IngestOptions options;
+  options.feature_rows = 2;
+  ParsedChunk<float> chunk;
+  for (std::string text : {"1,2", "1,2,3,4", "1,a,3", "label,x,y"}) {
+    EXPECT_FALSE(
+        ParseText(text.data(), text.data() + text.size(), options, &chunk));
+  }
+
+  options.format = InputFormat::kLibsvm;
+  options.num_classes = 3;
+  for (std::string text : {"1 0:1", "1 3:1", "1 1", "3 1:1", "0.5 1:1"}) {
+    EXPECT_FALSE(
+        ParseText(text.data(), text.data() + text.size(), options, &chunk));
+  }
+}
+
+TEST(TextIngestTest, SplitLinesSuccess) {
+  std::string text = "1,2\n3,4\n5,6\n7,8\n";
+  const char *begin = text.data();
+  const char *end = begin + text.size();
+  EXPECT_EQ(SplitLines(begin, end, 2),
+            std::vector<const char *>({begin, begin + 8, end}));
+  EXPECT_EQ(SplitLines(begin, end, 4),
+            std::vector<const char *>(
+                {begin, begin + 4, begin + 8, begin + 12, end}));
+  // Chunks never split a line
+  EXPECT_EQ(SplitLines(begin, begin + 4, 3),
+            std::vector<const char *>({begin, begin + 4}));
+}
+
+TEST(TextIngestTest, IngestTextSuccess) {
+  std::string input_path = ::testing::TempDir() + "text_ingest_test.csv";
+  std::string output_path = ::testing::TempDir() + "text_ingest_test.igdata";
+  MatrixX<float> feature(3, 1000);
+  MatrixX<int> labels(1, 1000);
+  {
+    std::ofstream input(input_path);
+    input << "label,a,b,c\n";
+    for (int i = 0; i < feature.cols(); ++i) {
+      feature.col(i) << i, i * 0.5f, -i;
+      labels(0, i) = i % 2;
+      input << labels(0, i) << "," << feature(0, i) << "," << feature(1, i)
+            << "," << feature(2, i) << "\n";
+    }
+  }
+
+  // Small chunks make several windows of several chunks
+  IngestOptions options;
+  options.feature_rows = 3;
+  options.skip_header = true;
+  options.num_threads = 3;
+  options.chunk_bytes = 1000;
+  int64_t num_examples = 0;
+  ASSERT_TRUE(
+      IngestText<float>(input_path, output_path, options, &num_examples));
+  EXPECT_EQ(num_examples, 1000);
+
+  std::unique_ptr<Dataset<float>> dataset = Dataset<float>::Open(output_path);
+  ASSERT_TRUE(dataset);
+  EXPECT_EQ(dataset->features(), feature);
+  EXPECT_EQ(dataset->labels(), labels);
+
+  // The header is not a valid example
+  options.skip_header = false;
+  EXPECT_FALSE(
+      IngestText<float>(input_path, output_path, options, &num_examples));
+  std::remove(input_path.c_str());
+  std::remove(output_path.c_str());
+}
+
+} // namespace
+} // namespace intellgraph
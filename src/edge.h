@@ -15,6 +15,8 @@ Contributor(s):
 #ifndef INTELLGRAPH_SRC_EDGE_EDGE_H_
 #define INTELLGRAPH_SRC_EDGE_EDGE_H_
 
+#include <vector>
+
 #include "src/eigen.h"
 #include "src/solver.h"
 #include "src/visitor.h"
@@ -38,12 +40,52 @@ public:
   virtual int col() const = 0;
   virtual const Eigen::Map<const MatrixX<T>> &weight() = 0;
   virtual Eigen::Map<MatrixX<T>> mutable_weight() = 0;
+  // Binds the weight matrix to external storage of row() * col() elements,
+  // e.g. to share weights between graph replicas
+  virtual void BindWeight(T *weight) = 0;
   virtual Eigen::Map<MatrixX<T>> mutable_bias() = 0;
   virtual Eigen::Map<MatrixX<T>> mutable_weight_stores(int index) = 0;
   virtual Eigen::Map<MatrixX<T>> mutable_bias_stores(int index) = 0;
+  // Binds weight store |index| and its bias store to external storage of the
+  // size of the weight matrix and of the bias, e.g. to keep solver stores of
+  // a graph in one arena. |index| is at most num_weight_stores(), and a null
+  // |bias_store| leaves the bias store as it is, e.g. unallocated for edges
+  // that do not own the bias.
+  virtual void BindStores(int index, T *weight_store, T *bias_store) = 0;
+  // Number of stores allocated so far by solvers, e.g. the moments of Adam
+  virtual int num_weight_stores() const = 0;
+  virtual int num_bias_stores() const = 0;
+
+  // Nabla weight and nabla bias are kept in persistent buffers that are
+  // allocated once and filled in place by CalcNablaWeight and CalcNablaBias
+  virtual Eigen::Map<MatrixX<T>> mutable_nabla_weight() = 0;
+  virtual Eigen::Map<MatrixX<T>> mutable_nabla_bias() = 0;
+  // Binds the nabla weight and the nabla bias to external storage of the size
+  // of the weight matrix and of the bias, e.g. to keep nablas of a graph in
+  // one arena. A null |nabla_bias| keeps the nabla bias in its own buffer.
+  // Only dense nabla weights, see nabla_weight_cols, can be bound.
+  virtual void BindNablas(T *nabla_weight, T *nabla_bias) = 0;
+
+  virtual void CalcNablaWeight() = 0;
+  virtual void CalcNablaBias() = 0;
+  // Returns the columns of the weight matrix that the nabla weight of the
+  // last batch is confined to, in ascending order, or nullptr if the nabla
+  // weight is dense. A sparse nabla weight only holds these columns, in the
+  // same order, and solvers only update these columns of the weight matrix
+  // and of its stores. Edges whose nabla weight may be sparse return a
+  // non-null pointer from construction on.
+  virtual const std::vector<int> *nabla_weight_cols() const { return nullptr; }
+
+  // Returns whether the edge holds the bias of its outbound vertex. A vertex
+  // with several inbound edges adds its bias in the forward pass of the first
+  // one only, see Graph::CompileSchedule, so only that edge calculates the
+  // nabla bias, and solvers only update the bias and keep its stores through
+  // that edge.
+  bool owns_bias() const { return owns_bias_; }
+  void set_owns_bias(bool owns_bias) { owns_bias_ = owns_bias; }
 
-  virtual const MatrixX<T> CalcNablaWeight() = 0;
-  virtual const MatrixX<T> CalcNablaBias() = 0;
+private:
+  bool owns_bias_ = true;
 };
 
 } // namespace intellgraph
@@ -36,6 +36,8 @@ DenseEdgeImpl<T, VertexIn, VertexOut>::DenseEdgeImpl(int id, VertexIn *vtx_in,
   DCHECK_EQ(vtx_in_->col(), vtx_out_->col());
 
   weight_ = DynMatrix<T>(row_, col_);
+  nabla_weight_ = DynMatrix<T>(row_, col_);
+  nabla_bias_ = DynMatrix<T>(col_, 1);
   // Initialization
   weight_.mutable_map().array() = weight_.mutable_map().array().unaryExpr(
       std::function<T(T)>(NormalFunctor<T>(0.0, std::sqrt(2.0 / col_))));
@@ -70,6 +72,11 @@ Eigen::Map<MatrixX<T>> DenseEdgeImpl<T, VertexIn, VertexOut>::mutable_weight() {
   return weight_.mutable_map();
 };
 
+template <typename T, class VertexIn, class VertexOut>
+void DenseEdgeImpl<T, VertexIn, VertexOut>::BindWeight(T *weight) {
+  weight_.Bind(weight, row_ * col_, row_, col_);
+}
+
 template <typename T, class VertexIn, class VertexOut>
 Eigen::Map<MatrixX<T>> DenseEdgeImpl<T, VertexIn, VertexOut>::mutable_bias() {
   return vtx_out_->mutable_bias();
@@ -102,6 +109,21 @@ DenseEdgeImpl<T, VertexIn, VertexOut>::mutable_bias_stores(int index) {
   return bias_stores_[index].mutable_map();
 }
 
+template <typename T, class VertexIn, class VertexOut>
+void DenseEdgeImpl<T, VertexIn, VertexOut>::BindStores(int index,
+                                                       T *weight_store,
+                                                       T *bias_store) {
+  DCHECK(weight_store);
+
+  mutable_weight_stores(index);
+  weight_stores_[index].Bind(weight_store, row_ * col_, row_, col_);
+  // Edges that do not own the bias of their outbound vertex keep no store
+  if (bias_store) {
+    mutable_bias_stores(index);
+    bias_stores_[index].Bind(bias_store, col_, col_, 1);
+  }
+}
+
 template <typename T, class VertexIn, class VertexOut>
 VertexIn *const DenseEdgeImpl<T, VertexIn, VertexOut>::vertex_in() {
   return vtx_in_;
@@ -113,16 +135,50 @@ VertexOut *const DenseEdgeImpl<T, VertexIn, VertexOut>::vertex_out() {
 }
 
 template <typename T, class VertexIn, class VertexOut>
-const MatrixX<T> DenseEdgeImpl<T, VertexIn, VertexOut>::CalcNablaWeight() {
+int DenseEdgeImpl<T, VertexIn, VertexOut>::num_weight_stores() const {
+  return weight_stores_.size();
+}
+
+template <typename T, class VertexIn, class VertexOut>
+int DenseEdgeImpl<T, VertexIn, VertexOut>::num_bias_stores() const {
+  return bias_stores_.size();
+}
+
+template <typename T, class VertexIn, class VertexOut>
+Eigen::Map<MatrixX<T>>
+DenseEdgeImpl<T, VertexIn, VertexOut>::mutable_nabla_weight() {
+  return nabla_weight_.mutable_map();
+}
+
+template <typename T, class VertexIn, class VertexOut>
+Eigen::Map<MatrixX<T>>
+DenseEdgeImpl<T, VertexIn, VertexOut>::mutable_nabla_bias() {
+  return nabla_bias_.mutable_map();
+}
+
+template <typename T, class VertexIn, class VertexOut>
+void DenseEdgeImpl<T, VertexIn, VertexOut>::BindNablas(T *nabla_weight,
+                                                       T *nabla_bias) {
+  DCHECK(nabla_weight);
+
+  nabla_weight_.Bind(nabla_weight, row_ * col_, row_, col_);
+  if (nabla_bias) {
+    nabla_bias_.Bind(nabla_bias, col_, col_, 1);
+  }
+}
+
+template <typename T, class VertexIn, class VertexOut>
+void DenseEdgeImpl<T, VertexIn, VertexOut>::CalcNablaWeight() {
   // Calculates |nabla_weight|:
   // $\frac{\partial loss}{\partial W^l}=a^{l-1}(\delta^{l})^T$
-  int batch_size = vtx_in_->col();
-  return (vtx_in_->act() * vtx_out_->mutable_delta().transpose()) / batch_size;
+  T scale = 1.0 / vtx_in_->col();
+  nabla_weight_.mutable_map().noalias() =
+      scale * vtx_in_->act() * vtx_out_->mutable_delta().transpose();
 }
 
 template <typename T, class VertexIn, class VertexOut>
-const MatrixX<T> DenseEdgeImpl<T, VertexIn, VertexOut>::CalcNablaBias() {
-  return vtx_out_->CalcNablaBias();
+void DenseEdgeImpl<T, VertexIn, VertexOut>::CalcNablaBias() {
+  vtx_out_->CalcNablaBias(nabla_bias_.mutable_map());
 }
 
 // Explicitly instantiation
@@ -42,12 +42,20 @@ public:
 
   const Eigen::Map<const MatrixX<T>> &weight() override;
   Eigen::Map<MatrixX<T>> mutable_weight() override;
+  void BindWeight(T *weight) override;
   Eigen::Map<MatrixX<T>> mutable_bias() override;
   Eigen::Map<MatrixX<T>> mutable_weight_stores(int index) override;
   Eigen::Map<MatrixX<T>> mutable_bias_stores(int index) override;
+  void BindStores(int index, T *weight_store, T *bias_store) override;
+  int num_weight_stores() const override;
+  int num_bias_stores() const override;
 
-  const MatrixX<T> CalcNablaWeight() override;
-  const MatrixX<T> CalcNablaBias() override;
+  Eigen::Map<MatrixX<T>> mutable_nabla_weight() override;
+  Eigen::Map<MatrixX<T>> mutable_nabla_bias() override;
+  void BindNablas(T *nabla_weight, T *nabla_bias) override;
+
+  void CalcNablaWeight() override;
+  void CalcNablaBias() override;
 
   VertexIn *const vertex_in();
   VertexOut *const vertex_out();
@@ -61,6 +69,8 @@ private:
   VertexOut *const vtx_out_;
 
   DynMatrix<T> weight_;
+  DynMatrix<T> nabla_weight_;
+  DynMatrix<T> nabla_bias_;
   std::vector<DynMatrix<T>> weight_stores_;
   std::vector<DynMatrix<T>> bias_stores_;
 };
@@ -19,6 +19,9 @@ Contributor(s):
 
 namespace intellgraph {
 
+// Forward declaration
+template <typename T> class Edge;
+
 // OpVertex is an abstract class that represents a vertex in the IntellGraph.
 // The class is used to store activation and bias matrices in the Neural
 // Network.
@@ -29,11 +32,26 @@ public:
   OpVertex() = default;
   virtual ~OpVertex() = default;
 
+  // Applies the activation function to the activation matrix in place
   virtual void Activate() = 0;
+  // Applies the activation function to the external |act| in place, the
+  // vertex itself is left untouched so that this can be called concurrently
+  virtual void Activate(Eigen::Ref<MatrixX<T>> act) const = 0;
+  // Multiplies the delta matrix element-wise by the derivative of the
+  // activation function, which is evaluated from the activation matrix. The
+  // activation matrix itself is left untouched since it is still needed for
+  // calculating nabla weights.
   virtual void Derive() = 0;
 
   // Resizes activation and delta matrices
   virtual void ResizeVertex(int length) = 0;
+  // Binds activation and delta matrices of |length| columns to external
+  // storage that holds at least row() * length elements each. A null |delta|
+  // releases the delta matrix, e.g. when the graph only runs inference.
+  virtual void BindBuffers(T *act, T *delta, int length) = 0;
+  // Binds the bias vector to external storage of row() elements, e.g. to
+  // share biases between graph replicas
+  virtual void BindBias(T *bias) = 0;
 
   virtual int id() const = 0;
   virtual int row() const = 0;
@@ -43,7 +61,18 @@ public:
   virtual Eigen::Map<MatrixX<T>> mutable_act() = 0;
   virtual Eigen::Map<MatrixX<T>> mutable_delta() = 0;
   virtual Eigen::Map<MatrixX<T>> mutable_bias() = 0;
-  virtual const MatrixX<T> CalcNablaBias() = 0;
+  // Calculates nabla bias of the current batch into |nabla_bias|
+  virtual void CalcNablaBias(Eigen::Ref<MatrixX<T>> nabla_bias) = 0;
+  // Returns the parameters the vertex owns besides its bias, e.g. the gate
+  // weights of a recurrent vertex, or nullptr. Graphs traverse them along
+  // with edges, so that solvers update them.
+  virtual Edge<T> *parameters() { return nullptr; }
+  // Returns the activation matrix if the vertex keeps it sparse, e.g. the
+  // feature fed to a sparse input vertex, or nullptr. act() of such a vertex
+  // is not valid.
+  virtual const Eigen::Map<const SparseMatrix<T>> *sparse_act() const {
+    return nullptr;
+  }
 };
 
 } // namespace intellgraph
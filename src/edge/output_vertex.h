@@ -15,6 +15,11 @@ Contributor(s):
 #ifndef INTELLGRAPH_SRC_EDGE_OUTPUT_VERTEX_H_
 #define INTELLGRAPH_SRC_EDGE_OUTPUT_VERTEX_H_
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "glog/logging.h"
 #include "src/edge/op_vertex.h"
 #include "src/eigen.h"
 
@@ -30,6 +35,37 @@ public:
 
   virtual T CalcLoss(const Eigen::Ref<const MatrixX<T>> &labels) = 0;
   virtual void CalcDelta(const Eigen::Ref<const MatrixX<T>> &labels) = 0;
+  // Whether CalcLoss follows the next Activate. Vertices whose exact loss
+  // needs more than the activations, e.g. the logits of SoftmaxCrossEntropy,
+  // only keep it on the loss path, so that training passes copy nothing.
+  bool loss_path() const { return loss_path_; }
+  void set_loss_path(bool loss_path) { loss_path_ = loss_path; }
+  // Writes the |k| most probable classes of each column into |classes| and
+  // their probabilities into |probabilities|, both k x col() and in order of
+  // decreasing probability. By default they are selected from the activation
+  // matrix, which holds the probability distribution of each column.
+  virtual void TopK(int k, MatrixX<int> *classes,
+                    MatrixX<T> *probabilities) const {
+    const Eigen::Map<const MatrixX<T>> &act = this->act();
+    DCHECK(k > 0 && k <= act.rows());
+
+    classes->resize(k, act.cols());
+    probabilities->resize(k, act.cols());
+    std::vector<int> order(act.rows());
+    for (int col = 0; col < act.cols(); ++col) {
+      std::iota(order.begin(), order.end(), 0);
+      std::partial_sort(
+          order.begin(), order.begin() + k, order.end(),
+          [&](int a, int b) { return act(a, col) > act(b, col); });
+      for (int i = 0; i < k; ++i) {
+        (*classes)(i, col) = order[i];
+        (*probabilities)(i, col) = act(order[i], col);
+      }
+    }
+  }
+
+private:
+  bool loss_path_ = false;
 };
 
 } // namespace intellgraph
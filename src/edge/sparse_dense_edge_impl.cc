@@ -0,0 +1,231 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/edge/sparse_dense_edge_impl.h"
+
+#include <algorithm>
+#include <functional>
+#include <math.h>
+
+#include "glog/logging.h"
+#include "src/logging.h"
+#include "src/tensor/dyn_matrix.h"
+#include "src/utility/random.h"
+
+namespace intellgraph {
+
+template <typename T, class VertexIn, class VertexOut>
+SparseDenseEdgeImpl<T, VertexIn, VertexOut>::SparseDenseEdgeImpl(
+    int id, VertexIn *vtx_in, VertexOut *vtx_out)
+    : id_(id), row_(vtx_out->row()), col_(vtx_in->row()), vtx_in_(vtx_in),
+      vtx_out_(vtx_out) {
+  DCHECK_GE(id_, 0);
+  DCHECK_GT(row_, 0);
+  DCHECK_GT(col_, 0);
+  DCHECK(vtx_in_);
+  DCHECK(vtx_out_);
+  DCHECK_EQ(vtx_in_->col(), vtx_out_->col());
+
+  weight_ = DynMatrix<T>(row_, col_);
+  nabla_weight_ = DynMatrix<T>(row_, 1);
+  nabla_bias_ = DynMatrix<T>(row_, 1);
+  nabla_weight_pos_.assign(col_, -1);
+  // Initialization
+  weight_.mutable_map().array() = weight_.mutable_map().array().unaryExpr(
+      std::function<T(T)>(NormalFunctor<T>(0.0, std::sqrt(2.0 / row_))));
+}
+
+template <typename T, class VertexIn, class VertexOut>
+SparseDenseEdgeImpl<T, VertexIn, VertexOut>::~SparseDenseEdgeImpl() = default;
+
+template <typename T, class VertexIn, class VertexOut>
+int SparseDenseEdgeImpl<T, VertexIn, VertexOut>::id() const {
+  return id_;
+}
+
+template <typename T, class VertexIn, class VertexOut>
+int SparseDenseEdgeImpl<T, VertexIn, VertexOut>::row() const {
+  return row_;
+}
+
+template <typename T, class VertexIn, class VertexOut>
+int SparseDenseEdgeImpl<T, VertexIn, VertexOut>::col() const {
+  return col_;
+}
+
+template <typename T, class VertexIn, class VertexOut>
+const Eigen::Map<const MatrixX<T>> &
+SparseDenseEdgeImpl<T, VertexIn, VertexOut>::weight() {
+  return weight_.map();
+}
+
+template <typename T, class VertexIn, class VertexOut>
+Eigen::Map<MatrixX<T>>
+SparseDenseEdgeImpl<T, VertexIn, VertexOut>::mutable_weight() {
+  return weight_.mutable_map();
+}
+
+template <typename T, class VertexIn, class VertexOut>
+void SparseDenseEdgeImpl<T, VertexIn, VertexOut>::BindWeight(T *weight) {
+  weight_.Bind(weight, row_ * col_, row_, col_);
+}
+
+template <typename T, class VertexIn, class VertexOut>
+Eigen::Map<MatrixX<T>>
+SparseDenseEdgeImpl<T, VertexIn, VertexOut>::mutable_bias() {
+  return vtx_out_->mutable_bias();
+}
+
+template <typename T, class VertexIn, class VertexOut>
+Eigen::Map<MatrixX<T>>
+SparseDenseEdgeImpl<T, VertexIn, VertexOut>::mutable_weight_stores(int index) {
+  DCHECK_GE(index, 0);
+  DCHECK_LE(index, weight_stores_.size());
+
+  if (index == weight_stores_.size()) {
+    // Lazy initialization
+    weight_stores_.emplace_back(row_, col_);
+  }
+  return weight_stores_[index].mutable_map();
+}
+
+template <typename T, class VertexIn, class VertexOut>
+Eigen::Map<MatrixX<T>>
+SparseDenseEdgeImpl<T, VertexIn, VertexOut>::mutable_bias_stores(int index) {
+  DCHECK_GE(index, 0);
+  DCHECK_LE(index, bias_stores_.size());
+
+  if (index == bias_stores_.size()) {
+    // Lazy initialization
+    bias_stores_.emplace_back(row_, 1);
+  }
+  return bias_stores_[index].mutable_map();
+}
+
+template <typename T, class VertexIn, class VertexOut>
+void SparseDenseEdgeImpl<T, VertexIn, VertexOut>::BindStores(int index,
+                                                             T *weight_store,
+                                                             T *bias_store) {
+  DCHECK(weight_store);
+
+  mutable_weight_stores(index);
+  weight_stores_[index].Bind(weight_store, row_ * col_, row_, col_);
+  // Edges that do not own the bias of their outbound vertex keep no store
+  if (bias_store) {
+    mutable_bias_stores(index);
+    bias_stores_[index].Bind(bias_store, row_, row_, 1);
+  }
+}
+
+template <typename T, class VertexIn, class VertexOut>
+int SparseDenseEdgeImpl<T, VertexIn, VertexOut>::num_weight_stores() const {
+  return weight_stores_.size();
+}
+
+template <typename T, class VertexIn, class VertexOut>
+int SparseDenseEdgeImpl<T, VertexIn, VertexOut>::num_bias_stores() const {
+  return bias_stores_.size();
+}
+
+template <typename T, class VertexIn, class VertexOut>
+Eigen::Map<MatrixX<T>>
+SparseDenseEdgeImpl<T, VertexIn, VertexOut>::mutable_nabla_weight() {
+  return nabla_weight_.mutable_map();
+}
+
+template <typename T, class VertexIn, class VertexOut>
+Eigen::Map<MatrixX<T>>
+SparseDenseEdgeImpl<T, VertexIn, VertexOut>::mutable_nabla_bias() {
+  return nabla_bias_.mutable_map();
+}
+
+template <typename T, class VertexIn, class VertexOut>
+void SparseDenseEdgeImpl<T, VertexIn, VertexOut>::BindNablas(T *nabla_weight,
+                                                             T *nabla_bias) {
+  // The nabla weight only holds the columns of the features in a batch
+  NOTREACHED();
+}
+
+template <typename T, class VertexIn, class VertexOut>
+void SparseDenseEdgeImpl<T, VertexIn, VertexOut>::CalcNablaWeight() {
+  const Eigen::Map<const SparseMatrix<T>> *act_in = vtx_in_->sparse_act();
+  DCHECK(act_in);
+  Eigen::Map<MatrixX<T>> delta_out = vtx_out_->mutable_delta();
+
+  // Collects the features present in the batch, which are the only weight
+  // columns with a nonzero nabla
+  const int *outer_index = act_in->outerIndexPtr();
+  const int *inner_index = act_in->innerIndexPtr();
+  nabla_weight_cols_.clear();
+  for (int i = outer_index[0]; i < outer_index[act_in->cols()]; ++i) {
+    int feature = inner_index[i];
+    if (nabla_weight_pos_[feature] < 0) {
+      nabla_weight_pos_[feature] = 0;
+      nabla_weight_cols_.push_back(feature);
+    }
+  }
+  // Columns are updated in memory order by solvers
+  std::sort(nabla_weight_cols_.begin(), nabla_weight_cols_.end());
+  for (int pos = 0; pos < nabla_weight_cols_.size(); ++pos) {
+    nabla_weight_pos_[nabla_weight_cols_[pos]] = pos;
+  }
+
+  // Calculates the columns of |nabla_weight|:
+  // $\frac{\partial loss}{\partial W^l}=\delta^{l}(a^{l-1})^T$
+  // A batch without any feature keeps a single zero column, which is not
+  // listed in |nabla_weight_cols_|
+  nabla_weight_.Resize(row_, std::max<int>(nabla_weight_cols_.size(), 1));
+  Eigen::Map<MatrixX<T>> nabla_weight = nabla_weight_.mutable_map();
+  nabla_weight.setZero();
+  T scale = 1.0 / act_in->cols();
+  for (int col = 0; col < act_in->cols(); ++col) {
+    for (typename Eigen::Map<const SparseMatrix<T>>::InnerIterator it(*act_in,
+                                                                      col);
+         it; ++it) {
+      nabla_weight.col(nabla_weight_pos_[it.index()]) +=
+          (scale * it.value()) * delta_out.col(col);
+    }
+  }
+
+  for (int feature : nabla_weight_cols_) {
+    nabla_weight_pos_[feature] = -1;
+  }
+}
+
+template <typename T, class VertexIn, class VertexOut>
+void SparseDenseEdgeImpl<T, VertexIn, VertexOut>::CalcNablaBias() {
+  vtx_out_->CalcNablaBias(nabla_bias_.mutable_map());
+}
+
+template <typename T, class VertexIn, class VertexOut>
+const std::vector<int> *
+SparseDenseEdgeImpl<T, VertexIn, VertexOut>::nabla_weight_cols() const {
+  return &nabla_weight_cols_;
+}
+
+template <typename T, class VertexIn, class VertexOut>
+VertexIn *const SparseDenseEdgeImpl<T, VertexIn, VertexOut>::vertex_in() {
+  return vtx_in_;
+}
+
+template <typename T, class VertexIn, class VertexOut>
+VertexOut *const SparseDenseEdgeImpl<T, VertexIn, VertexOut>::vertex_out() {
+  return vtx_out_;
+}
+
+// Explicitly instantiation
+template class SparseDenseEdgeImpl<float, OpVertex<float>>;
+template class SparseDenseEdgeImpl<double, OpVertex<double>>;
+
+} // namespace intellgraph
@@ -0,0 +1,99 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_EDGE_SPARSE_DENSE_EDGE_IMPL_H_
+#define INTELLGRAPH_SRC_EDGE_SPARSE_DENSE_EDGE_IMPL_H_
+
+#include <vector>
+
+#include "src/edge.h"
+#include "src/edge/op_vertex.h"
+#include "src/eigen.h"
+#include "src/solver.h"
+#include "src/tensor/dyn_matrix.h"
+#include "src/visitor.h"
+
+namespace intellgraph {
+
+// SparseDenseEdgeImpl connects a vertex with a sparse activation, i.e. a
+// sparse input vertex, to a dense vertex. Unlike DenseEdgeImpl, the weight
+// matrix is stored transposed, with one column per feature of the inbound
+// vertex, so that the forward pass only reads the columns of the features
+// present in a batch, and the nabla weight only holds those columns, see
+// Edge::nabla_weight_cols. The inbound vertex has no delta.
+template <typename T, class VertexIn, class VertexOut = VertexIn>
+class SparseDenseEdgeImpl : public Edge<T> {
+public:
+  explicit SparseDenseEdgeImpl(int id, VertexIn *vtx_in, VertexOut *vtx_out);
+  ~SparseDenseEdgeImpl();
+
+  void Accept(Visitor<T> &visitor) override { visitor.Visit(*this); }
+  void Accept(Solver<T> &solver) override { solver.Visit(*this); }
+
+  int id() const override;
+  // Dimensions of the outbound vertex
+  int row() const override;
+  // Dimensions of the inbound vertex
+  int col() const override;
+
+  const Eigen::Map<const MatrixX<T>> &weight() override;
+  Eigen::Map<MatrixX<T>> mutable_weight() override;
+  void BindWeight(T *weight) override;
+  Eigen::Map<MatrixX<T>> mutable_bias() override;
+  Eigen::Map<MatrixX<T>> mutable_weight_stores(int index) override;
+  Eigen::Map<MatrixX<T>> mutable_bias_stores(int index) override;
+  void BindStores(int index, T *weight_store, T *bias_store) override;
+  int num_weight_stores() const override;
+  int num_bias_stores() const override;
+
+  Eigen::Map<MatrixX<T>> mutable_nabla_weight() override;
+  Eigen::Map<MatrixX<T>> mutable_nabla_bias() override;
+  void BindNablas(T *nabla_weight, T *nabla_bias) override;
+
+  void CalcNablaWeight() override;
+  void CalcNablaBias() override;
+  const std::vector<int> *nabla_weight_cols() const override;
+
+  VertexIn *const vertex_in();
+  VertexOut *const vertex_out();
+
+private:
+  int id_ = -1;
+  int row_ = 0;
+  int col_ = 0;
+
+  VertexIn *const vtx_in_;
+  VertexOut *const vtx_out_;
+
+  DynMatrix<T> weight_;
+  DynMatrix<T> nabla_weight_;
+  DynMatrix<T> nabla_bias_;
+  std::vector<DynMatrix<T>> weight_stores_;
+  std::vector<DynMatrix<T>> bias_stores_;
+
+  // Weight columns of the features present in the last batch
+  std::vector<int> nabla_weight_cols_;
+  // Position of each weight column in the nabla weight, or -1 if it is not
+  // in |nabla_weight_cols_|
+  std::vector<int> nabla_weight_pos_;
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class SparseDenseEdgeImpl<float, OpVertex<float>>;
+extern template class SparseDenseEdgeImpl<double, OpVertex<double>>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_EDGE_SPARSE_DENSE_EDGE_IMPL_H_
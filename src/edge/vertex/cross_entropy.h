@@ -35,6 +35,10 @@ public:
     Sigmoid::Activate(vertex);
   }
 
+  template <typename T> static void Activate(Eigen::Ref<MatrixX<T>> act) {
+    Sigmoid::Activate<T>(act);
+  }
+
   template <typename T>
   static void Derive(OutputVertexImpl<T, CrossEntropy> &vertex) {
     // Derivative equation:
@@ -48,13 +52,18 @@ public:
     DCHECK_EQ(vertex.row(), labels.rows());
     DCHECK_EQ(vertex.col(), labels.cols());
 
-    const Eigen::Map<const MatrixX<T>> &act = vertex.act();
+    return CalcLoss<T>(vertex.act(), labels);
+  }
+
+  template <typename T>
+  static T CalcLoss(const Eigen::Ref<const MatrixX<T>> &act,
+                    const Eigen::Ref<const MatrixX<T>> &labels) {
     // Type epsilon is added inside the log function to avoid overflow
     T epsilon = std::numeric_limits<T>::epsilon();
     T loss = (labels.array() * (epsilon + act.array()).log() +
               (1.0 - labels.array()) * (1.0 - act.array() + epsilon).log())
                  .sum();
-    int batch_size = vertex.col();
+    int batch_size = act.cols();
     return -loss / batch_size;
   }
 
@@ -64,9 +73,14 @@ public:
     DCHECK_EQ(vertex.row(), labels.rows());
     DCHECK_EQ(vertex.col(), labels.cols());
 
-    Eigen::Map<MatrixX<T>> delta = vertex.mutable_delta();
-    const Eigen::Map<const MatrixX<T>> &act = vertex.act();
+    CalcDelta<T>(vertex.act(), labels, vertex.mutable_delta());
+  }
 
+  template <typename T>
+  static void CalcDelta(const Eigen::Ref<const MatrixX<T>> &act,
+                        const Eigen::Ref<const MatrixX<T>> &labels,
+                        Eigen::Ref<MatrixX<T>> delta) {
+    // The derivative of the sigmoid cancels out with the one of the loss
     delta = act - labels;
   }
 
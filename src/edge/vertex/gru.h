@@ -0,0 +1,114 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_EDGE_VERTEX_GRU_H_
+#define INTELLGRAPH_SRC_EDGE_VERTEX_GRU_H_
+
+#include "glog/logging.h"
+#include "src/eigen.h"
+#include "src/kernel/activation.h"
+
+namespace intellgraph {
+
+// Gated recurrent unit cell of RecurrentVertexImpl. Gates of a column are
+// laid out as [reset; update; candidate], so that the two sigmoid gates are
+// squashed in one contiguous run. The reset gate applies to the recurrent
+// projection of the candidate, which the cache of a time step holds.
+class Gru {
+public:
+  Gru() = default;
+
+  static constexpr int kNumGates = 3;
+  // The recurrent projection of the candidate is scaled by the reset gate,
+  // so its nablas differ from the ones of the input projection
+  static constexpr bool kGatedRecurrence = true;
+
+  // Adds |recurrent| to the input projection of a time step in |gates|,
+  // activates the gates in place, and calculates the hidden state |h| from
+  // the previous hidden state |h_prev|
+  template <typename T>
+  static void ForwardStep(Eigen::Ref<MatrixX<T>> gates,
+                          const Eigen::Ref<const MatrixX<T>> &recurrent,
+                          const Eigen::Ref<const MatrixX<T>> &h_prev,
+                          const Eigen::Ref<const MatrixX<T>> &cache_prev,
+                          Eigen::Ref<MatrixX<T>> cache,
+                          Eigen::Ref<MatrixX<T>> h) {
+    DCHECK_EQ(gates.rows(), kNumGates * h.rows());
+    const int hidden = h.rows();
+    for (int col = 0; col < gates.cols(); ++col) {
+      T *gate = gates.col(col).data();
+      Eigen::Map<VectorX<T>>(gate, 2 * hidden) +=
+          recurrent.col(col).head(2 * hidden);
+      SigmoidForward(gate, 2 * hidden);
+
+      Eigen::Map<const ArrayX<T>> reset(gate, hidden);
+      Eigen::Map<const ArrayX<T>> update(gate + hidden, hidden);
+      Eigen::Map<ArrayX<T>> candidate(gate + 2 * hidden, hidden);
+      Eigen::Map<ArrayX<T>> recurrent_candidate(cache.col(col).data(),
+                                                hidden);
+
+      // $n=\tanh(W_nx+r\odot U_nh_{t-1})$, $h_t=(1-z)\odot n+z\odot h_{t-1}$
+      recurrent_candidate = recurrent.col(col).tail(hidden).array();
+      candidate += reset * recurrent_candidate;
+      TanhForward(candidate.data(), hidden);
+      h.col(col).array() =
+          candidate + update * (h_prev.col(col).array() - candidate);
+    }
+  }
+
+  // Calculates the deltas of the input projection |dgates| and of the
+  // recurrent projection |drecurrent| from the delta of the hidden state
+  // |dh|, and the delta |dh_prev| that flows directly into the previous
+  // hidden state. |dcache| is unused since the cache is no state.
+  template <typename T>
+  static void BackwardStep(const Eigen::Ref<const MatrixX<T>> &gates,
+                           const Eigen::Ref<const MatrixX<T>> &h_prev,
+                           const Eigen::Ref<const MatrixX<T>> &cache_prev,
+                           const Eigen::Ref<const MatrixX<T>> &cache,
+                           const Eigen::Ref<const MatrixX<T>> &dh,
+                           Eigen::Ref<MatrixX<T>> dcache,
+                           Eigen::Ref<MatrixX<T>> dgates,
+                           Eigen::Ref<MatrixX<T>> drecurrent,
+                           Eigen::Ref<MatrixX<T>> dh_prev) {
+    const int hidden = dh.rows();
+    for (int col = 0; col < gates.cols(); ++col) {
+      const T *gate = gates.col(col).data();
+      T *dgate = dgates.col(col).data();
+      Eigen::Map<const ArrayX<T>> reset(gate, hidden);
+      Eigen::Map<const ArrayX<T>> update(gate + hidden, hidden);
+      Eigen::Map<const ArrayX<T>> candidate(gate + 2 * hidden, hidden);
+      Eigen::Map<ArrayX<T>> dcandidate(dgate + 2 * hidden, hidden);
+      auto dhidden_state = dh.col(col).array();
+
+      dcandidate = dhidden_state * (1 - update);
+      Eigen::Map<ArrayX<T>>(dgate + hidden, hidden) =
+          dhidden_state * (h_prev.col(col).array() - candidate);
+      dh_prev.col(col).array() = dhidden_state * update;
+      TanhBackward(gate + 2 * hidden, dgate + 2 * hidden, hidden);
+      Eigen::Map<ArrayX<T>>(dgate, hidden) =
+          dcandidate * cache.col(col).array();
+      SigmoidBackward(gate, dgate, 2 * hidden);
+
+      drecurrent.col(col).head(2 * hidden) = dgates.col(col).head(2 * hidden);
+      drecurrent.col(col).tail(hidden).array() = dcandidate * reset;
+    }
+  }
+
+protected:
+  ~Gru() = default;
+};
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_EDGE_VERTEX_GRU_H_
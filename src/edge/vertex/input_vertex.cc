@@ -26,10 +26,20 @@ InputVertex<T>::~InputVertex() = default;
 
 template <typename T> void InputVertex<T>::Activate() {}
 
+template <typename T>
+void InputVertex<T>::Activate(Eigen::Ref<MatrixX<T>> act) const {}
+
 template <typename T> void InputVertex<T>::Derive() {}
 
 template <typename T> void InputVertex<T>::ResizeVertex(int length) {}
 
+template <typename T>
+void InputVertex<T>::BindBuffers(T *act, T *delta, int length) {}
+
+template <typename T> void InputVertex<T>::BindBias(T *bias) {
+  NOTREACHED();
+}
+
 template <typename T> Eigen::Map<MatrixX<T>> InputVertex<T>::mutable_act() {
   NOTREACHED();
   return Eigen::Map<MatrixX<T>>(nullptr, -1, -1);
@@ -44,9 +54,15 @@ template <typename T> Eigen::Map<MatrixX<T>> InputVertex<T>::mutable_bias() {
   return Eigen::Map<MatrixX<T>>(nullptr, -1, -1);
 }
 
-template <typename T> const MatrixX<T> InputVertex<T>::CalcNablaBias() {
+template <typename T>
+void InputVertex<T>::CalcNablaBias(Eigen::Ref<MatrixX<T>> nabla_bias) {
+  NOTREACHED();
+}
+
+template <typename T>
+void InputVertex<T>::set_feature(const SparseMatrix<T> *feature, int offset,
+                                 int length) {
   NOTREACHED();
-  return MatrixX<T>(-1, -1);
 }
 
 // Explicit instantiation
@@ -21,6 +21,7 @@ Contributor(s):
 namespace intellgraph {
 
 struct DummyTransformer {};
+struct SparseTransformer {};
 
 template <typename T>
 class InputVertex : public OpVertex<T> {
@@ -32,14 +33,28 @@ public:
 
   // Dummy implementations:
   void Activate() override;
+  void Activate(Eigen::Ref<MatrixX<T>> act) const override;
   void Derive() override;
   void ResizeVertex(int length) override;
+  void BindBuffers(T *act, T *delta, int length) override;
+  void BindBias(T *bias) override;
   Eigen::Map<MatrixX<T>> mutable_act() override;
   Eigen::Map<MatrixX<T>> mutable_delta() override;
   Eigen::Map<MatrixX<T>> mutable_bias() override;
-  const MatrixX<T> CalcNablaBias() override;
+  void CalcNablaBias(Eigen::Ref<MatrixX<T>> nabla_bias) override;
 
   virtual void set_feature(const MatrixX<T> *feature) = 0;
+  // Feeds |length| columns of |feature| starting from column |offset|
+  virtual void set_feature(const MatrixX<T> *feature, int offset,
+                           int length) = 0;
+  // Feeds the columns mapped by |feature| without copying them, the mapped
+  // memory must outlive the passes that read the activation
+  virtual void set_feature(const Eigen::Map<const MatrixX<T>> &feature) = 0;
+  // Feeds |length| columns of the compressed sparse |feature| starting from
+  // column |offset| without copying them. Only sparse input vertices accept
+  // sparse features.
+  virtual void set_feature(const SparseMatrix<T> *feature, int offset,
+                           int length);
 };
 
 // Tells compiler not to instantiate the template in translation units that
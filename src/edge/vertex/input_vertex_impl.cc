@@ -52,22 +52,40 @@ int InputVertexImpl<T, Transformer>::col() const {
 template <typename T, class Transformer>
 const Eigen::Map<const MatrixX<T>> &
 InputVertexImpl<T, Transformer>::act() const {
-  DCHECK(feature_);
+  DCHECK(feature_map_.data());
   return feature_map_;
 }
 
 template <typename T, class Transformer>
 void InputVertexImpl<T, Transformer>::set_feature(const MatrixX<T> *feature) {
   DCHECK(feature);
+  set_feature(feature, 0, feature->cols());
+}
+
+template <typename T, class Transformer>
+void InputVertexImpl<T, Transformer>::set_feature(const MatrixX<T> *feature,
+                                                  int offset, int length) {
+  DCHECK(feature);
   DCHECK_EQ(row_, feature->rows());
+  DCHECK_GE(offset, 0);
+  DCHECK_GT(length, 0);
+  DCHECK_LE(offset + length, feature->cols());
+
+  // Columns are contiguous in the column-major feature matrix
+  set_feature(Eigen::Map<const MatrixX<T>>(
+      feature->data() + static_cast<size_t>(offset) * row_, row_, length));
+}
+
+template <typename T, class Transformer>
+void InputVertexImpl<T, Transformer>::set_feature(
+    const Eigen::Map<const MatrixX<T>> &feature) {
+  DCHECK(feature.data());
+  DCHECK_EQ(row_, feature.rows());
+  DCHECK_GT(feature.cols(), 0);
 
-  LOG(INFO) << "InputVertexImpl feeds a feature value.";
-  if (col_ != feature->cols()) {
-    col_ = feature->cols();
-  }
-  feature_ = feature;
-  new (&feature_map_)
-      Eigen::Map<const MatrixX<T>>(feature_->data(), row_, col_);
+  IG_TRACE(2) << "InputVertexImpl feeds a feature value.";
+  col_ = feature.cols();
+  new (&feature_map_) Eigen::Map<const MatrixX<T>>(feature.data(), row_, col_);
 }
 
 // Explicitly instantiation
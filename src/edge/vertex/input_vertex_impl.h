@@ -38,13 +38,14 @@ public:
 
   const Eigen::Map<const MatrixX<T>> &act() const override;
   void set_feature(const MatrixX<T> *feature) override;
+  void set_feature(const MatrixX<T> *feature, int offset, int length) override;
+  void set_feature(const Eigen::Map<const MatrixX<T>> &feature) override;
 
 private:
   int id_;
   int row_;
   int col_;
 
-  const MatrixX<T> *feature_ = nullptr;
   Eigen::Map<const MatrixX<T>> feature_map_ =
       Eigen::Map<const MatrixX<T>>(nullptr, -1, -1);
 };
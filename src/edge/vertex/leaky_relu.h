@@ -0,0 +1,68 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_EDGE_VERTEX_LEAKY_RELU_H_
+#define INTELLGRAPH_SRC_EDGE_VERTEX_LEAKY_RELU_H_
+
+#include "glog/logging.h"
+#include "src/edge/vertex/op_vertex_impl.h"
+#include "src/eigen.h"
+#include "src/kernel/activation.h"
+
+namespace intellgraph {
+
+class LeakyRelu {
+public:
+  LeakyRelu() = default;
+
+  // Slope of the activation function for negative inputs
+  static constexpr double kAlpha = 0.01;
+
+  template <typename T>
+  static void Activate(OpVertexImpl<T, LeakyRelu> &vertex) {
+    Activate<T>(vertex.mutable_act());
+  }
+
+  template <typename T> static void Activate(Eigen::Ref<MatrixX<T>> act) {
+    // Leaky ReLU activation function:
+    // $f(z)=z$ if $z>0$, and $f(z)=\alpha z$ otherwise
+    ForEachContiguous<T>(act, [](T *data, size_t size) {
+      LeakyReluForward(data, size, static_cast<T>(kAlpha));
+    });
+  }
+
+  template <typename T>
+  static void Derive(OpVertexImpl<T, LeakyRelu> &vertex) {
+    Derive<T>(vertex.act(), vertex.mutable_delta());
+  }
+
+  template <typename T>
+  static void Derive(const Eigen::Ref<const MatrixX<T>> &act,
+                     Eigen::Ref<MatrixX<T>> delta) {
+    // Derivative equation:
+    // $df/dz=1$ if $z>0$, and $df/dz=\alpha$ otherwise. The sign of $f(z)$
+    // is the one of $z$, so the derivative is evaluated from the activation
+    ForEachContiguous<T>(act, delta, [](const T *act_data, T *delta_data,
+                                        size_t size) {
+      LeakyReluBackward(act_data, delta_data, size, static_cast<T>(kAlpha));
+    });
+  }
+
+protected:
+  ~LeakyRelu() = default;
+};
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_EDGE_VERTEX_LEAKY_RELU_H_
@@ -0,0 +1,119 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_EDGE_VERTEX_LSTM_H_
+#define INTELLGRAPH_SRC_EDGE_VERTEX_LSTM_H_
+
+#include "glog/logging.h"
+#include "src/eigen.h"
+#include "src/kernel/activation.h"
+
+namespace intellgraph {
+
+// Long short-term memory cell of RecurrentVertexImpl. Gates of a column are
+// laid out as [input; forget; output; candidate], so that the three sigmoid
+// gates are squashed in one contiguous run. The cache of a time step holds
+// the cell state.
+class Lstm {
+public:
+  Lstm() = default;
+
+  static constexpr int kNumGates = 4;
+  // The recurrent projection enters the gates unchanged, so its nablas are
+  // the ones of the input projection
+  static constexpr bool kGatedRecurrence = false;
+
+  // Adds |recurrent| to the input projection of a time step in |gates|,
+  // activates the gates in place, and calculates the cell state |cache| and
+  // the hidden state |h| from the previous cell state |cache_prev|
+  template <typename T>
+  static void ForwardStep(Eigen::Ref<MatrixX<T>> gates,
+                          const Eigen::Ref<const MatrixX<T>> &recurrent,
+                          const Eigen::Ref<const MatrixX<T>> &h_prev,
+                          const Eigen::Ref<const MatrixX<T>> &cache_prev,
+                          Eigen::Ref<MatrixX<T>> cache,
+                          Eigen::Ref<MatrixX<T>> h) {
+    DCHECK_EQ(gates.rows(), kNumGates * h.rows());
+    const int hidden = h.rows();
+    for (int col = 0; col < gates.cols(); ++col) {
+      T *gate = gates.col(col).data();
+      Eigen::Map<VectorX<T>>(gate, kNumGates * hidden) += recurrent.col(col);
+      SigmoidForward(gate, 3 * hidden);
+      TanhForward(gate + 3 * hidden, hidden);
+
+      Eigen::Map<const ArrayX<T>> input(gate, hidden);
+      Eigen::Map<const ArrayX<T>> forget(gate + hidden, hidden);
+      Eigen::Map<const ArrayX<T>> output(gate + 2 * hidden, hidden);
+      Eigen::Map<const ArrayX<T>> candidate(gate + 3 * hidden, hidden);
+      Eigen::Map<ArrayX<T>> cell(cache.col(col).data(), hidden);
+      Eigen::Map<ArrayX<T>> hidden_state(h.col(col).data(), hidden);
+
+      // $c_t=f\odot c_{t-1}+i\odot g$, $h_t=o\odot\tanh(c_t)$
+      cell = forget * cache_prev.col(col).array() + input * candidate;
+      hidden_state = cell;
+      TanhForward(hidden_state.data(), hidden);
+      hidden_state *= output;
+    }
+  }
+
+  // Calculates the delta of the gates |dgates| from the delta of the hidden
+  // state |dh|, and updates the delta of the cell state |dcache| from the
+  // next time step to this one. The hidden state only reaches the previous
+  // time step through the recurrent projection, so |dh_prev| is zeroed.
+  template <typename T>
+  static void BackwardStep(const Eigen::Ref<const MatrixX<T>> &gates,
+                           const Eigen::Ref<const MatrixX<T>> &h_prev,
+                           const Eigen::Ref<const MatrixX<T>> &cache_prev,
+                           const Eigen::Ref<const MatrixX<T>> &cache,
+                           const Eigen::Ref<const MatrixX<T>> &dh,
+                           Eigen::Ref<MatrixX<T>> dcache,
+                           Eigen::Ref<MatrixX<T>> dgates,
+                           Eigen::Ref<MatrixX<T>> drecurrent,
+                           Eigen::Ref<MatrixX<T>> dh_prev) {
+    const int hidden = dh.rows();
+    ArrayX<T> tanh_cell(hidden);
+    for (int col = 0; col < gates.cols(); ++col) {
+      const T *gate = gates.col(col).data();
+      T *dgate = dgates.col(col).data();
+      Eigen::Map<const ArrayX<T>> input(gate, hidden);
+      Eigen::Map<const ArrayX<T>> forget(gate + hidden, hidden);
+      Eigen::Map<const ArrayX<T>> output(gate + 2 * hidden, hidden);
+      Eigen::Map<const ArrayX<T>> candidate(gate + 3 * hidden, hidden);
+      Eigen::Map<ArrayX<T>> dcell(dcache.col(col).data(), hidden);
+      auto dhidden_state = dh.col(col).array();
+
+      tanh_cell = cache.col(col).array();
+      TanhForward(tanh_cell.data(), hidden);
+      dcell += dhidden_state * output * (1 - tanh_cell.square());
+      Eigen::Map<ArrayX<T>>(dgate, hidden) = dcell * candidate;
+      Eigen::Map<ArrayX<T>>(dgate + hidden, hidden) =
+          dcell * cache_prev.col(col).array();
+      Eigen::Map<ArrayX<T>>(dgate + 2 * hidden, hidden) =
+          dhidden_state * tanh_cell;
+      Eigen::Map<ArrayX<T>>(dgate + 3 * hidden, hidden) = dcell * input;
+      dcell *= forget;
+
+      SigmoidBackward(gate, dgate, 3 * hidden);
+      TanhBackward(gate + 3 * hidden, dgate + 3 * hidden, hidden);
+    }
+    dh_prev.setZero();
+  }
+
+protected:
+  ~Lstm() = default;
+};
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_EDGE_VERTEX_LSTM_H_
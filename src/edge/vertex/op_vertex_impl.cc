@@ -14,9 +14,11 @@ Contributor(s):
 ==============================================================================*/
 #include "src/edge/vertex/op_vertex_impl.h"
 
-#include "glog/logging.h"
+#include "src/edge/vertex/leaky_relu.h"
 #include "src/edge/vertex/relu.h"
 #include "src/edge/vertex/sigmoid.h"
+#include "src/edge/vertex/tanh.h"
+#include "src/logging.h"
 
 namespace intellgraph {
 
@@ -42,13 +44,18 @@ OpVertexImpl<T, Algorithm>::~OpVertexImpl() = default;
 
 template <typename T, class Algorithm>
 void OpVertexImpl<T, Algorithm>::Activate() {
-  LOG(INFO) << "OpVertexImpl " << id_ << " is activated.";
+  IG_TRACE(2) << "OpVertexImpl " << id_ << " is activated.";
   Algorithm::Activate(*this);
 }
 
+template <typename T, class Algorithm>
+void OpVertexImpl<T, Algorithm>::Activate(Eigen::Ref<MatrixX<T>> act) const {
+  Algorithm::template Activate<T>(act);
+}
+
 template <typename T, class Algorithm>
 void OpVertexImpl<T, Algorithm>::Derive() {
-  LOG(INFO) << "OpVertexImpl " << id_ << " is derived.";
+  IG_TRACE(2) << "OpVertexImpl " << id_ << " is derived.";
   Algorithm::Derive(*this);
 }
 
@@ -61,6 +68,24 @@ void OpVertexImpl<T, Algorithm>::ResizeVertex(int length) {
   delta_.Resize(row_, col_);
 }
 
+template <typename T, class Algorithm>
+void OpVertexImpl<T, Algorithm>::BindBuffers(T *act, T *delta, int length) {
+  DCHECK_GT(length, 0);
+
+  col_ = length;
+  act_.Bind(act, row_ * col_, row_, col_);
+  if (delta) {
+    delta_.Bind(delta, row_ * col_, row_, col_);
+  } else {
+    delta_.Release();
+  }
+}
+
+template <typename T, class Algorithm>
+void OpVertexImpl<T, Algorithm>::BindBias(T *bias) {
+  bias_.Bind(bias, row_, row_, 1);
+}
+
 template <typename T, class Algorithm>
 int OpVertexImpl<T, Algorithm>::id() const {
   return id_;
@@ -97,14 +122,19 @@ Eigen::Map<MatrixX<T>> OpVertexImpl<T, Algorithm>::mutable_bias() {
 }
 
 template <typename T, class Algorithm>
-const MatrixX<T> OpVertexImpl<T, Algorithm>::CalcNablaBias() {
-  return delta_.mutable_map().rowwise().sum() / col_;
+void OpVertexImpl<T, Algorithm>::CalcNablaBias(
+    Eigen::Ref<MatrixX<T>> nabla_bias) {
+  nabla_bias.noalias() = delta_.map().rowwise().sum() / col_;
 }
 
 // Explicit instantiation
 template class OpVertexImpl<float, Relu>;
 template class OpVertexImpl<double, Relu>;
+template class OpVertexImpl<float, LeakyRelu>;
+template class OpVertexImpl<double, LeakyRelu>;
 template class OpVertexImpl<float, Sigmoid>;
 template class OpVertexImpl<double, Sigmoid>;
+template class OpVertexImpl<float, Tanh>;
+template class OpVertexImpl<double, Tanh>;
 
 } // namespace intellgraph
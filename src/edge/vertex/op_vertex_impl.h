@@ -36,8 +36,11 @@ public:
   ~OpVertexImpl() override;
 
   void Activate() override;
+  void Activate(Eigen::Ref<MatrixX<T>> act) const override;
   void Derive() override;
   void ResizeVertex(int length) override;
+  void BindBuffers(T *act, T *delta, int length) override;
+  void BindBias(T *bias) override;
 
   int id() const override;
   int row() const override;
@@ -47,7 +50,7 @@ public:
   Eigen::Map<MatrixX<T>> mutable_act() override;
   Eigen::Map<MatrixX<T>> mutable_delta() override;
   Eigen::Map<MatrixX<T>> mutable_bias() override;
-  const MatrixX<T> CalcNablaBias() override;
+  void CalcNablaBias(Eigen::Ref<MatrixX<T>> nabla_bias) override;
 
 private:
   int id_;
@@ -36,6 +36,24 @@ TEST(OpVertexImplTest, ResizeVertexSuccess) {
   EXPECT_DOUBLE_EQ(op_vertex_double.act().cols(), 2);
 }
 
+TEST(OpVertexImplTest, BindBuffersSuccess) {
+  OpVertexImpl<float, Sigmoid> op_vertex(0, 2, 1);
+  float act[6] = {0.0f};
+  float delta[6] = {0.0f};
+
+  op_vertex.BindBuffers(act, delta, 3);
+  EXPECT_EQ(op_vertex.col(), 3);
+  EXPECT_EQ(op_vertex.act().data(), act);
+  EXPECT_EQ(op_vertex.mutable_delta().data(), delta);
+
+  op_vertex.mutable_act().setConstant(1.0f);
+  EXPECT_FLOAT_EQ(act[5], 1.0f);
+
+  // Inference bindings release the delta matrix
+  op_vertex.BindBuffers(act, nullptr, 3);
+  EXPECT_EQ(op_vertex.mutable_delta().data(), nullptr);
+}
+
 TEST(OpVertexImplTest, GetIdSuccess) {
   OpVertexImpl<float, Sigmoid> op_vertex_float(1, 1, 1);
   OpVertexImpl<double, Sigmoid> op_vertex_double(1, 1, 1);
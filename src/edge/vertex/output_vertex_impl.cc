@@ -14,9 +14,10 @@ Contributor(s):
 ==============================================================================*/
 #include "src/edge/vertex/output_vertex_impl.h"
 
-#include "glog/logging.h"
 #include "src/edge/vertex/cross_entropy.h"
 #include "src/edge/vertex/sigmoid_l2.h"
+#include "src/edge/vertex/softmax_cross_entropy.h"
+#include "src/logging.h"
 
 namespace intellgraph {
 
@@ -42,13 +43,18 @@ OutputVertexImpl<T, Algorithm>::~OutputVertexImpl() = default;
 
 template <typename T, class Algorithm>
 void OutputVertexImpl<T, Algorithm>::Activate() {
-  LOG(INFO) << "OutputVertexImpl " << id_ << " is activated.";
+  IG_TRACE(2) << "OutputVertexImpl " << id_ << " is activated.";
   Algorithm::Activate(*this);
 }
 
+template <typename T, class Algorithm>
+void OutputVertexImpl<T, Algorithm>::Activate(Eigen::Ref<MatrixX<T>> act) const {
+  Algorithm::template Activate<T>(act);
+}
+
 template <typename T, class Algorithm>
 void OutputVertexImpl<T, Algorithm>::Derive() {
-  LOG(INFO) << "OutputVertexImpl " << id_ << " is derived.";
+  IG_TRACE(2) << "OutputVertexImpl " << id_ << " is derived.";
   Algorithm::Derive(*this);
 }
 
@@ -61,6 +67,24 @@ void OutputVertexImpl<T, Algorithm>::ResizeVertex(int length) {
   delta_.Resize(row_, col_);
 }
 
+template <typename T, class Algorithm>
+void OutputVertexImpl<T, Algorithm>::BindBuffers(T *act, T *delta, int length) {
+  DCHECK_GT(length, 0);
+
+  col_ = length;
+  act_.Bind(act, row_ * col_, row_, col_);
+  if (delta) {
+    delta_.Bind(delta, row_ * col_, row_, col_);
+  } else {
+    delta_.Release();
+  }
+}
+
+template <typename T, class Algorithm>
+void OutputVertexImpl<T, Algorithm>::BindBias(T *bias) {
+  bias_.Bind(bias, row_, row_, 1);
+}
+
 template <typename T, class Algorithm>
 int OutputVertexImpl<T, Algorithm>::id() const {
   return id_;
@@ -98,8 +122,9 @@ Eigen::Map<MatrixX<T>> OutputVertexImpl<T, Algorithm>::mutable_bias() {
 }
 
 template <typename T, class Algorithm>
-const MatrixX<T> OutputVertexImpl<T, Algorithm>::CalcNablaBias() {
-  return delta_.mutable_map().rowwise().sum() / col_;
+void OutputVertexImpl<T, Algorithm>::CalcNablaBias(
+    Eigen::Ref<MatrixX<T>> nabla_bias) {
+  nabla_bias.noalias() = delta_.map().rowwise().sum() / col_;
 }
 
 template <typename T, class Algorithm>
@@ -119,5 +144,7 @@ template class OutputVertexImpl<float, SigmoidL2>;
 template class OutputVertexImpl<double, SigmoidL2>;
 template class OutputVertexImpl<float, CrossEntropy>;
 template class OutputVertexImpl<double, CrossEntropy>;
+template class OutputVertexImpl<float, SoftmaxCrossEntropy>;
+template class OutputVertexImpl<double, SoftmaxCrossEntropy>;
 
 } // namespace intellgraph
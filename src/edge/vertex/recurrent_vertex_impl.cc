@@ -0,0 +1,355 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/edge/vertex/recurrent_vertex_impl.h"
+
+#include <cmath>
+#include <functional>
+
+#include "src/edge/vertex/gru.h"
+#include "src/edge/vertex/lstm.h"
+#include "src/logging.h"
+#include "src/utility/random.h"
+
+namespace intellgraph {
+
+template <typename T>
+GateParameters<T>::GateParameters(int id, int hidden, int num_gates)
+    : id_(id), hidden_(hidden), num_gates_(num_gates) {
+  DCHECK_GE(id_, 0);
+  DCHECK_GT(hidden_, 0);
+  DCHECK_GT(num_gates_, 0);
+
+  weight_ = DynMatrix<T>(row(), col());
+  bias_ = DynMatrix<T>(col(), 1);
+  nabla_weight_ = DynMatrix<T>(row(), col());
+  nabla_bias_ = DynMatrix<T>(col(), 1);
+  // Initialization
+  weight_.mutable_map().array() = weight_.mutable_map().array().unaryExpr(
+      std::function<T(T)>(NormalFunctor<T>(0.0, std::sqrt(1.0 / hidden_))));
+}
+
+template <typename T> GateParameters<T>::~GateParameters() = default;
+
+template <typename T> int GateParameters<T>::id() const { return id_; }
+
+template <typename T> int GateParameters<T>::row() const {
+  return 2 * hidden_;
+}
+
+template <typename T> int GateParameters<T>::col() const {
+  return num_gates_ * hidden_;
+}
+
+template <typename T>
+const Eigen::Map<const MatrixX<T>> &GateParameters<T>::weight() {
+  return weight_.map();
+}
+
+template <typename T>
+Eigen::Map<MatrixX<T>> GateParameters<T>::mutable_weight() {
+  return weight_.mutable_map();
+}
+
+template <typename T> void GateParameters<T>::BindWeight(T *weight) {
+  weight_.Bind(weight, row() * col(), row(), col());
+}
+
+template <typename T> Eigen::Map<MatrixX<T>> GateParameters<T>::mutable_bias() {
+  return bias_.mutable_map();
+}
+
+template <typename T>
+Eigen::Map<MatrixX<T>> GateParameters<T>::mutable_weight_stores(int index) {
+  DCHECK_GE(index, 0);
+  DCHECK_LE(index, weight_stores_.size());
+
+  if (index == weight_stores_.size()) {
+    // Lazy initialization
+    weight_stores_.emplace_back(row(), col());
+  }
+  return weight_stores_[index].mutable_map();
+}
+
+template <typename T>
+Eigen::Map<MatrixX<T>> GateParameters<T>::mutable_bias_stores(int index) {
+  DCHECK_GE(index, 0);
+  DCHECK_LE(index, bias_stores_.size());
+
+  if (index == bias_stores_.size()) {
+    // Lazy initialization
+    bias_stores_.emplace_back(col(), 1);
+  }
+  return bias_stores_[index].mutable_map();
+}
+
+template <typename T>
+void GateParameters<T>::BindStores(int index, T *weight_store,
+                                   T *bias_store) {
+  DCHECK(weight_store);
+
+  mutable_weight_stores(index);
+  mutable_bias_stores(index);
+  weight_stores_[index].Bind(weight_store, row() * col(), row(), col());
+  if (bias_store) {
+    bias_stores_[index].Bind(bias_store, col(), col(), 1);
+  }
+}
+
+template <typename T> int GateParameters<T>::num_weight_stores() const {
+  return weight_stores_.size();
+}
+
+template <typename T> int GateParameters<T>::num_bias_stores() const {
+  return bias_stores_.size();
+}
+
+template <typename T>
+Eigen::Map<MatrixX<T>> GateParameters<T>::mutable_nabla_weight() {
+  return nabla_weight_.mutable_map();
+}
+
+template <typename T>
+Eigen::Map<MatrixX<T>> GateParameters<T>::mutable_nabla_bias() {
+  return nabla_bias_.mutable_map();
+}
+
+template <typename T>
+void GateParameters<T>::BindNablas(T *nabla_weight, T *nabla_bias) {
+  DCHECK(nabla_weight);
+
+  nabla_weight_.Bind(nabla_weight, row() * col(), row(), col());
+  if (nabla_bias) {
+    nabla_bias_.Bind(nabla_bias, col(), col(), 1);
+  }
+}
+
+template <typename T, class Cell>
+RecurrentVertexImpl<T, Cell>::RecurrentVertexImpl(int id, int row,
+                                                  int sequence_length)
+    : id_(id), row_(row), col_(sequence_length),
+      sequence_length_(sequence_length),
+      parameters_(id, row, Cell::kNumGates) {
+  DCHECK_GE(id_, 0);
+  DCHECK_GT(row_, 0);
+  DCHECK_GT(sequence_length_, 0);
+
+  act_ = DynMatrix<T>(row_, col_);
+  delta_ = DynMatrix<T>(row_, col_);
+  bias_ = DynMatrix<T>(row_, 1);
+}
+
+template <typename T, class Cell>
+RecurrentVertexImpl<T, Cell>::RecurrentVertexImpl(
+    const VertexParameter &vtx_param, int sequence_length)
+    : RecurrentVertexImpl(vtx_param.id(), vtx_param.dims(), sequence_length) {}
+
+template <typename T, class Cell>
+RecurrentVertexImpl<T, Cell>::~RecurrentVertexImpl() = default;
+
+template <typename T, class Cell>
+void RecurrentVertexImpl<T, Cell>::Activate() {
+  IG_TRACE(2) << "RecurrentVertexImpl " << id_ << " is activated.";
+
+  input_ = act_.map();
+  gates_.resize(Cell::kNumGates * row_, col_);
+  cache_.resize(row_, col_);
+  Forward(input_, act_.mutable_map(), gates_, cache_);
+}
+
+template <typename T, class Cell>
+void RecurrentVertexImpl<T, Cell>::Activate(Eigen::Ref<MatrixX<T>> act) const {
+  MatrixX<T> gates(Cell::kNumGates * row_, act.cols());
+  MatrixX<T> cache(row_, act.cols());
+  Forward(act, act, gates, cache);
+}
+
+template <typename T, class Cell>
+void RecurrentVertexImpl<T, Cell>::Forward(
+    const Eigen::Ref<const MatrixX<T>> &input, Eigen::Ref<MatrixX<T>> h,
+    Eigen::Ref<MatrixX<T>> gates, Eigen::Ref<MatrixX<T>> cache) const {
+  DCHECK_EQ(input.cols() % sequence_length_, 0);
+
+  const int batch_size = input.cols() / sequence_length_;
+  const auto &weight = parameters_.weight();
+  auto input_weight = weight.topRows(row_);
+  auto recurrent_weight = weight.bottomRows(row_);
+
+  // Input projection of all time steps at once
+  gates.noalias() = input_weight.transpose() * input;
+  gates.colwise() += parameters_.bias().col(0);
+
+  MatrixX<T> recurrent = MatrixX<T>::Zero(gates.rows(), batch_size);
+  MatrixX<T> zero = MatrixX<T>::Zero(row_, batch_size);
+  for (int step = 0; step < sequence_length_; ++step) {
+    int begin = step * batch_size;
+    auto forward_step = [&](const Eigen::Ref<const MatrixX<T>> &h_prev,
+                            const Eigen::Ref<const MatrixX<T>> &cache_prev) {
+      Cell::template ForwardStep<T>(gates.middleCols(begin, batch_size),
+                                    recurrent, h_prev, cache_prev,
+                                    cache.middleCols(begin, batch_size),
+                                    h.middleCols(begin, batch_size));
+    };
+    if (step == 0) {
+      forward_step(zero, zero);
+      continue;
+    }
+    // Recurrent projection of all gates at once
+    recurrent.noalias() = recurrent_weight.transpose() *
+                          h.middleCols(begin - batch_size, batch_size);
+    forward_step(h.middleCols(begin - batch_size, batch_size),
+                 cache.middleCols(begin - batch_size, batch_size));
+  }
+}
+
+template <typename T, class Cell> void RecurrentVertexImpl<T, Cell>::Derive() {
+  IG_TRACE(2) << "RecurrentVertexImpl " << id_ << " is derived.";
+  DCHECK_EQ(col_ % sequence_length_, 0);
+
+  const int batch_size = col_ / sequence_length_;
+  const auto &weight = parameters_.weight();
+  auto input_weight = weight.topRows(row_);
+  auto recurrent_weight = weight.bottomRows(row_);
+  const Eigen::Map<const MatrixX<T>> &act = act_.map();
+  Eigen::Map<MatrixX<T>> delta = delta_.mutable_map();
+
+  dgates_.resize(Cell::kNumGates * row_, col_);
+  if (Cell::kGatedRecurrence) {
+    drecurrent_.resize(Cell::kNumGates * row_, col_);
+  }
+  MatrixX<T> &drecurrent = Cell::kGatedRecurrence ? drecurrent_ : dgates_;
+
+  // Backpropagation through time, |dh_prev| and |dcache| flow from each time
+  // step into the previous one
+  MatrixX<T> dh(row_, batch_size);
+  MatrixX<T> dh_prev = MatrixX<T>::Zero(row_, batch_size);
+  MatrixX<T> dcache = MatrixX<T>::Zero(row_, batch_size);
+  MatrixX<T> zero = MatrixX<T>::Zero(row_, batch_size);
+  for (int step = sequence_length_ - 1; step >= 0; --step) {
+    int begin = step * batch_size;
+    dh = delta.middleCols(begin, batch_size) + dh_prev;
+    auto backward_step = [&](const Eigen::Ref<const MatrixX<T>> &h_prev,
+                             const Eigen::Ref<const MatrixX<T>> &cache_prev) {
+      Cell::template BackwardStep<T>(
+          gates_.middleCols(begin, batch_size), h_prev, cache_prev,
+          cache_.middleCols(begin, batch_size), dh, dcache,
+          dgates_.middleCols(begin, batch_size),
+          drecurrent.middleCols(begin, batch_size), dh_prev);
+    };
+    if (step == 0) {
+      backward_step(zero, zero);
+      continue;
+    }
+    backward_step(act.middleCols(begin - batch_size, batch_size),
+                  cache_.middleCols(begin - batch_size, batch_size));
+    dh_prev.noalias() +=
+        recurrent_weight * drecurrent.middleCols(begin, batch_size);
+  }
+
+  // Nablas of all time steps at once
+  T scale = 1.0 / col_;
+  Eigen::Map<MatrixX<T>> nabla_weight = parameters_.mutable_nabla_weight();
+  nabla_weight.topRows(row_).noalias() =
+      scale * input_ * dgates_.transpose();
+  int length = col_ - batch_size;
+  nabla_weight.bottomRows(row_).noalias() =
+      scale * act.leftCols(length) * drecurrent.rightCols(length).transpose();
+  parameters_.mutable_nabla_bias().noalias() =
+      scale * dgates_.rowwise().sum();
+
+  delta.noalias() = input_weight * dgates_;
+}
+
+template <typename T, class Cell>
+void RecurrentVertexImpl<T, Cell>::ResizeVertex(int length) {
+  DCHECK(length != col_);
+
+  col_ = length;
+  act_.Resize(row_, col_);
+  delta_.Resize(row_, col_);
+}
+
+template <typename T, class Cell>
+void RecurrentVertexImpl<T, Cell>::BindBuffers(T *act, T *delta, int length) {
+  DCHECK_GT(length, 0);
+
+  col_ = length;
+  act_.Bind(act, row_ * col_, row_, col_);
+  if (delta) {
+    delta_.Bind(delta, row_ * col_, row_, col_);
+  } else {
+    delta_.Release();
+  }
+}
+
+template <typename T, class Cell>
+void RecurrentVertexImpl<T, Cell>::BindBias(T *bias) {
+  bias_.Bind(bias, row_, row_, 1);
+}
+
+template <typename T, class Cell> int RecurrentVertexImpl<T, Cell>::id() const {
+  return id_;
+}
+
+template <typename T, class Cell>
+int RecurrentVertexImpl<T, Cell>::row() const {
+  return row_;
+}
+
+template <typename T, class Cell>
+int RecurrentVertexImpl<T, Cell>::col() const {
+  return col_;
+}
+
+template <typename T, class Cell>
+const Eigen::Map<const MatrixX<T>> &
+RecurrentVertexImpl<T, Cell>::act() const {
+  return act_.map();
+}
+
+template <typename T, class Cell>
+Eigen::Map<MatrixX<T>> RecurrentVertexImpl<T, Cell>::mutable_act() {
+  return act_.mutable_map();
+}
+
+template <typename T, class Cell>
+Eigen::Map<MatrixX<T>> RecurrentVertexImpl<T, Cell>::mutable_delta() {
+  return delta_.mutable_map();
+}
+
+template <typename T, class Cell>
+Eigen::Map<MatrixX<T>> RecurrentVertexImpl<T, Cell>::mutable_bias() {
+  return bias_.mutable_map();
+}
+
+template <typename T, class Cell>
+void RecurrentVertexImpl<T, Cell>::CalcNablaBias(
+    Eigen::Ref<MatrixX<T>> nabla_bias) {
+  nabla_bias.noalias() = delta_.map().rowwise().sum() / col_;
+}
+
+template <typename T, class Cell>
+Edge<T> *RecurrentVertexImpl<T, Cell>::parameters() {
+  return &parameters_;
+}
+
+// Explicit instantiation
+template class GateParameters<float>;
+template class GateParameters<double>;
+template class RecurrentVertexImpl<float, Lstm>;
+template class RecurrentVertexImpl<double, Lstm>;
+template class RecurrentVertexImpl<float, Gru>;
+template class RecurrentVertexImpl<double, Gru>;
+
+} // namespace intellgraph
@@ -0,0 +1,176 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_EDGE_VERTEX_RECURRENT_VERTEX_IMPL_H_
+#define INTELLGRAPH_SRC_EDGE_VERTEX_RECURRENT_VERTEX_IMPL_H_
+
+#include <vector>
+
+#include "src/edge.h"
+#include "src/edge/seq_vertex.h"
+#include "src/eigen.h"
+#include "src/proto/vertex_parameter.pb.h"
+#include "src/solver.h"
+#include "src/tensor/dyn_matrix.h"
+#include "src/visitor.h"
+
+namespace intellgraph {
+
+// GateParameters holds the gate weights and biases of a recurrent vertex
+// behind the Edge interface, so that solvers update them like the
+// parameters of any edge. The weight matrix stacks the input weights on top
+// of the recurrent weights, each |hidden| by |num_gates| * |hidden|, i.e.
+// the weights of all gates are concatenated. Nablas are calculated by the
+// vertex, and visitors only see the parameters through VisitParameters.
+template <typename T> class GateParameters : public Edge<T> {
+public:
+  explicit GateParameters(int id, int hidden, int num_gates);
+  ~GateParameters() override;
+
+  void Accept(Visitor<T> &visitor) override {
+    visitor.VisitParameters(*this);
+  }
+  void Accept(Solver<T> &solver) override { solver.Visit(*this); }
+
+  int id() const override;
+  int row() const override;
+  int col() const override;
+
+  const Eigen::Map<const MatrixX<T>> &weight() override;
+  Eigen::Map<MatrixX<T>> mutable_weight() override;
+  void BindWeight(T *weight) override;
+  Eigen::Map<MatrixX<T>> mutable_bias() override;
+  // Read-only views for vertices that are activated concurrently
+  const Eigen::Map<const MatrixX<T>> &weight() const { return weight_.map(); }
+  const Eigen::Map<const MatrixX<T>> &bias() const { return bias_.map(); }
+  Eigen::Map<MatrixX<T>> mutable_weight_stores(int index) override;
+  Eigen::Map<MatrixX<T>> mutable_bias_stores(int index) override;
+  void BindStores(int index, T *weight_store, T *bias_store) override;
+  int num_weight_stores() const override;
+  int num_bias_stores() const override;
+
+  Eigen::Map<MatrixX<T>> mutable_nabla_weight() override;
+  Eigen::Map<MatrixX<T>> mutable_nabla_bias() override;
+  void BindNablas(T *nabla_weight, T *nabla_bias) override;
+
+  void CalcNablaWeight() override {}
+  void CalcNablaBias() override {}
+
+private:
+  int id_;
+  int hidden_;
+  int num_gates_;
+
+  DynMatrix<T> weight_;
+  DynMatrix<T> bias_;
+  DynMatrix<T> nabla_weight_;
+  DynMatrix<T> nabla_bias_;
+  std::vector<DynMatrix<T>> weight_stores_;
+  std::vector<DynMatrix<T>> bias_stores_;
+};
+
+// RecurrentVertexImpl runs a recurrent |Cell|, e.g. Lstm or Gru, over whole
+// sequences. Columns are time-major like in RnnImpl: column t * batch_size +
+// b is time step t of sequence b, and the number of columns is a multiple of
+// the sequence length the vertex is constructed with, which is the length
+// of the graph. Graphs must therefore not split the columns of a batch, e.g.
+// across data-parallel replicas.
+//
+// Inbound edges write the inputs of the cell into the activation matrix,
+// which Activate overwrites with the hidden states; Derive turns the deltas
+// of the hidden states into the deltas of the inputs, calculating the nablas
+// of the gate parameters on the way. Sequences start from a zero state.
+//
+// The gate input weights are applied on top of the projection of inbound
+// Dense edges on purpose. The activation matrix holds both the inputs and
+// the hidden states, so an edge can only project into |row| rows, while the
+// gates need |num_gates| * |row| of them. The extra |row| by |num_gates| *
+// |row| GEMM keeps the vertex interchangeable with other vertices of the
+// same dims, and the composition of both projections is still linear, i.e.
+// it only factorizes the input weights of a textbook cell through |row|
+// dimensions.
+//
+// The input projection of all time steps is one GEMM up front, each time
+// step adds the recurrent projection of all gates with one more GEMM, and
+// the cell fuses the gate nonlinearities and state updates into one pass
+// over each column.
+template <typename T, class Cell>
+class RecurrentVertexImpl : public Cell, public SeqVertex<T> {
+public:
+  typedef T value_type;
+
+  explicit RecurrentVertexImpl(int id, int row, int sequence_length);
+  explicit RecurrentVertexImpl(const VertexParameter &vtx_param,
+                               int sequence_length);
+  ~RecurrentVertexImpl() override;
+
+  void Activate() override;
+  void Activate(Eigen::Ref<MatrixX<T>> act) const override;
+  void Derive() override;
+  void ResizeVertex(int length) override;
+  void BindBuffers(T *act, T *delta, int length) override;
+  void BindBias(T *bias) override;
+
+  int id() const override;
+  int row() const override;
+  int col() const override;
+
+  const Eigen::Map<const MatrixX<T>> &act() const override;
+  Eigen::Map<MatrixX<T>> mutable_act() override;
+  Eigen::Map<MatrixX<T>> mutable_delta() override;
+  Eigen::Map<MatrixX<T>> mutable_bias() override;
+  void CalcNablaBias(Eigen::Ref<MatrixX<T>> nabla_bias) override;
+  Edge<T> *parameters() override;
+
+  // The whole sequence is processed by a single Activate
+  void ForwardByOneTimeStep() override {}
+  int GetCurrentTimeStep() const override { return 0; }
+
+  int sequence_length() const { return sequence_length_; }
+
+private:
+  // Runs the cell over the sequences of |input| into the hidden states |h|,
+  // keeping activated gates in |gates| and cell caches in |cache|. |input|
+  // may alias |h| since it is only read by the input projection.
+  void Forward(const Eigen::Ref<const MatrixX<T>> &input,
+               Eigen::Ref<MatrixX<T>> h, Eigen::Ref<MatrixX<T>> gates,
+               Eigen::Ref<MatrixX<T>> cache) const;
+
+  int id_;
+  int row_;
+  int col_;
+  int sequence_length_;
+
+  DynMatrix<T> act_;
+  DynMatrix<T> delta_;
+  DynMatrix<T> bias_;
+  GateParameters<T> parameters_;
+
+  // Kept from Activate for Derive
+  MatrixX<T> input_;
+  MatrixX<T> gates_;
+  MatrixX<T> cache_;
+  // Deltas of the input and the recurrent projections
+  MatrixX<T> dgates_;
+  MatrixX<T> drecurrent_;
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class GateParameters<float>;
+extern template class GateParameters<double>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_EDGE_VERTEX_RECURRENT_VERTEX_IMPL_H_
@@ -0,0 +1,162 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/edge/vertex/recurrent_vertex_impl.h"
+
+#include <cmath>
+
+#include "src/edge/vertex/gru.h"
+#include "src/edge/vertex/lstm.h"
+#include "src/eigen.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+constexpr int kHidden = 3;
+constexpr int kSequenceLength = 4;
+constexpr int kBatchSize = 2;
+constexpr int kLength = kSequenceLength * kBatchSize;
+
+MatrixX<double> Sigmoid(const MatrixX<double> &z) {
+  return (1.0 + (-z.array()).exp()).inverse().matrix();
+}
+
+MatrixX<double> Tanh(const MatrixX<double> &z) {
+  return z.array().tanh().matrix();
+}
+
+// Runs the LSTM equations gate by gate
+MatrixX<double> ReferenceLstm(const MatrixX<double> &weight,
+                              const VectorX<double> &bias,
+                              const MatrixX<double> &input) {
+  MatrixX<double> h(kHidden, kLength);
+  MatrixX<double> h_prev = MatrixX<double>::Zero(kHidden, kBatchSize);
+  MatrixX<double> c = MatrixX<double>::Zero(kHidden, kBatchSize);
+  for (int step = 0; step < kSequenceLength; ++step) {
+    MatrixX<double> x = input.middleCols(step * kBatchSize, kBatchSize);
+    auto gate = [&](int index) -> MatrixX<double> {
+      MatrixX<double> z =
+          weight.block(0, index * kHidden, kHidden, kHidden).transpose() * x +
+          weight.block(kHidden, index * kHidden, kHidden, kHidden)
+                  .transpose() *
+              h_prev;
+      return z.colwise() + bias.segment(index * kHidden, kHidden);
+    };
+    MatrixX<double> i = Sigmoid(gate(0)), f = Sigmoid(gate(1)),
+                    o = Sigmoid(gate(2)), g = Tanh(gate(3));
+    c = f.cwiseProduct(c) + i.cwiseProduct(g);
+    h_prev = o.cwiseProduct(Tanh(c));
+    h.middleCols(step * kBatchSize, kBatchSize) = h_prev;
+  }
+  return h;
+}
+
+TEST(RecurrentVertexImplTest, LstmActivateSuccess) {
+  RecurrentVertexImpl<double, Lstm> vertex(0, kHidden, kSequenceLength);
+  ASSERT_EQ(vertex.parameters()->row(), 2 * kHidden);
+  ASSERT_EQ(vertex.parameters()->col(), 4 * kHidden);
+  vertex.parameters()->mutable_bias().setRandom();
+  vertex.ResizeVertex(kLength);
+
+  MatrixX<double> input = MatrixX<double>::Random(kHidden, kLength);
+  vertex.mutable_act() = input;
+  vertex.Activate();
+  MatrixX<double> expected =
+      ReferenceLstm(vertex.parameters()->mutable_weight(),
+                    vertex.parameters()->mutable_bias().col(0), input);
+  EXPECT_TRUE(vertex.act().isApprox(expected, 1e-12));
+
+  // The const version leaves the vertex untouched
+  MatrixX<double> act = input;
+  vertex.Activate(act);
+  EXPECT_TRUE(act.isApprox(expected, 1e-12));
+}
+
+// Checks nablas and input deltas against central differences of the loss
+// sum(h .* weights) of a random |loss_weight|
+template <class Cell> void CheckGradient() {
+  RecurrentVertexImpl<double, Cell> vertex(0, kHidden, kSequenceLength);
+  Edge<double> *parameters = vertex.parameters();
+  parameters->mutable_bias().setRandom();
+  vertex.ResizeVertex(kLength);
+  const MatrixX<double> input = MatrixX<double>::Random(kHidden, kLength);
+  const MatrixX<double> loss_weight = MatrixX<double>::Random(kHidden, kLength);
+
+  auto loss = [&](const MatrixX<double> &x) {
+    MatrixX<double> act = x;
+    vertex.Activate(act);
+    return act.cwiseProduct(loss_weight).sum();
+  };
+
+  vertex.mutable_act() = input;
+  vertex.Activate();
+  vertex.mutable_delta() = loss_weight;
+  vertex.Derive();
+  // Nablas are averaged over columns
+  MatrixX<double> nabla_weight = kLength * parameters->mutable_nabla_weight();
+  MatrixX<double> nabla_bias = kLength * parameters->mutable_nabla_bias();
+
+  constexpr double kEpsilon = 1e-6;
+  Eigen::Map<MatrixX<double>> weight = parameters->mutable_weight();
+  for (int i = 0; i < weight.size(); ++i) {
+    double value = weight(i);
+    weight(i) = value + kEpsilon;
+    double loss_plus = loss(input);
+    weight(i) = value - kEpsilon;
+    double loss_minus = loss(input);
+    weight(i) = value;
+    EXPECT_NEAR(nabla_weight(i), (loss_plus - loss_minus) / (2 * kEpsilon),
+                1e-6);
+  }
+  Eigen::Map<MatrixX<double>> bias = parameters->mutable_bias();
+  for (int i = 0; i < bias.size(); ++i) {
+    double value = bias(i);
+    bias(i) = value + kEpsilon;
+    double loss_plus = loss(input);
+    bias(i) = value - kEpsilon;
+    double loss_minus = loss(input);
+    bias(i) = value;
+    EXPECT_NEAR(nabla_bias(i), (loss_plus - loss_minus) / (2 * kEpsilon),
+                1e-6);
+  }
+  for (int i = 0; i < input.size(); ++i) {
+    MatrixX<double> x = input;
+    x(i) += kEpsilon;
+    double loss_plus = loss(x);
+    x(i) -= 2 * kEpsilon;
+    double loss_minus = loss(x);
+    EXPECT_NEAR(vertex.mutable_delta()(i),
+                (loss_plus - loss_minus) / (2 * kEpsilon), 1e-6);
+  }
+}
+
+TEST(RecurrentVertexImplTest, LstmGradientSuccess) { CheckGradient<Lstm>(); }
+
+TEST(RecurrentVertexImplTest, GruGradientSuccess) { CheckGradient<Gru>(); }
+
+TEST(RecurrentVertexImplTest, BindBuffersSuccess) {
+  RecurrentVertexImpl<float, Gru> vertex(0, 2, 3);
+  float act[12] = {0.0f};
+  float delta[12] = {0.0f};
+
+  vertex.BindBuffers(act, delta, 6);
+  EXPECT_EQ(vertex.col(), 6);
+  EXPECT_EQ(vertex.act().data(), act);
+  EXPECT_EQ(vertex.mutable_delta().data(), delta);
+  EXPECT_EQ(vertex.parameters()->col(), 6);
+}
+
+} // namespace
+} // namespace intellgraph
@@ -18,6 +18,7 @@ Contributor(s):
 #include "glog/logging.h"
 #include "src/edge/vertex/op_vertex_impl.h"
 #include "src/eigen.h"
+#include "src/kernel/activation.h"
 
 namespace intellgraph {
 
@@ -26,26 +27,27 @@ public:
   Relu() = default;
 
   template <typename T> static void Activate(OpVertexImpl<T, Relu> &vertex) {
-    Eigen::Map<MatrixX<T>> act = vertex.mutable_act();
-    for (size_t i = 0; i < act.rows(); ++i) {
-      for (size_t j = 0; j < act.cols(); ++j) {
-        if (act(i, j) < 0) {
-          act(i, j) = 0;
-        }
-      }
-    }
+    Activate<T>(vertex.mutable_act());
+  }
+
+  template <typename T> static void Activate(Eigen::Ref<MatrixX<T>> act) {
+    ForEachContiguous<T>(act, [](T *data, size_t size) {
+      ReluForward(data, size);
+    });
   }
 
   template <typename T> static void Derive(OpVertexImpl<T, Relu> &vertex) {
-    Eigen::Map<MatrixX<T>> act = vertex.mutable_act();
-    for (size_t i = 0; i < act.rows(); ++i) {
-      for (size_t j = 0; j < act.cols(); ++j) {
-        DCHECK_GE(act(i, j), 0);
-        if (act(i, j) > 0) {
-          act(i, j) = 1;
-        }
-      }
-    }
+    Derive<T>(vertex.act(), vertex.mutable_delta());
+  }
+
+  template <typename T>
+  static void Derive(const Eigen::Ref<const MatrixX<T>> &act,
+                     Eigen::Ref<MatrixX<T>> delta) {
+    DCHECK_GE(act.minCoeff(), 0);
+    ForEachContiguous<T>(act, delta, [](const T *act_data, T *delta_data,
+                                        size_t size) {
+      ReluBackward(act_data, delta_data, size);
+    });
   }
 
 protected:
@@ -55,22 +55,28 @@ TEST(ReluTest, DeriveSuccess) {
   // Activation element value EQ zero
   OpVertexImpl<float, Relu> op_vertex_float(0, 1, 1);
   op_vertex_float.mutable_act().setConstant(0.0f);
+  op_vertex_float.mutable_delta().setConstant(3.0f);
   op_vertex_float.Derive();
-  EXPECT_FLOAT_EQ(op_vertex_float.act()(0, 0), 0.0f);
+  EXPECT_FLOAT_EQ(op_vertex_float.mutable_delta()(0, 0), 0.0f);
 
   OpVertexImpl<double, Relu> op_vertex_double(1, 1, 1);
-  op_vertex_float.mutable_act().setConstant(0.0);
+  op_vertex_double.mutable_act().setConstant(0.0);
+  op_vertex_double.mutable_delta().setConstant(3.0);
   op_vertex_double.Derive();
-  EXPECT_DOUBLE_EQ(op_vertex_double.act()(0, 0), 0.0);
+  EXPECT_DOUBLE_EQ(op_vertex_double.mutable_delta()(0, 0), 0.0);
 
   // Activation element value GT zero
   op_vertex_float.mutable_act().setConstant(2.0f);
+  op_vertex_float.mutable_delta().setConstant(3.0f);
   op_vertex_float.Derive();
-  EXPECT_FLOAT_EQ(op_vertex_float.act()(0, 0), 1.0f);
+  EXPECT_FLOAT_EQ(op_vertex_float.mutable_delta()(0, 0), 3.0f);
+  EXPECT_FLOAT_EQ(op_vertex_float.act()(0, 0), 2.0f);
 
   op_vertex_double.mutable_act().setConstant(2.0);
+  op_vertex_double.mutable_delta().setConstant(3.0);
   op_vertex_double.Derive();
-  EXPECT_DOUBLE_EQ(op_vertex_double.act()(0, 0), 1.0);
+  EXPECT_DOUBLE_EQ(op_vertex_double.mutable_delta()(0, 0), 3.0);
+  EXPECT_DOUBLE_EQ(op_vertex_double.act()(0, 0), 2.0);
 }
 
 } // namespace
@@ -0,0 +1,63 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_EDGE_VERTEX_SAMPLED_SOFTMAX_H_
+#define INTELLGRAPH_SRC_EDGE_VERTEX_SAMPLED_SOFTMAX_H_
+
+#include <algorithm>
+#include <cmath>
+
+namespace intellgraph {
+
+// Proposal distributions of SampledSoftmaxImpl, which draws the negative
+// classes of each batch from them. Probability returns the probability of
+// class |label| out of |num_classes|, and Sample maps a uniform random
+// number |u| in [0, 1) to a class.
+
+// Draws all classes equally likely
+class UniformSampledSoftmax {
+public:
+  UniformSampledSoftmax() = default;
+
+  template <typename T> static T Probability(int label, int num_classes) {
+    return static_cast<T>(1) / num_classes;
+  }
+
+  static int Sample(double u, int num_classes) {
+    return std::min(static_cast<int>(u * num_classes), num_classes - 1);
+  }
+};
+
+// Draws classes from the log-uniform (Zipfian) distribution
+// $P(c)=\log((c+2)/(c+1))/\log(C+1)$, which suits classes sorted by
+// decreasing frequency, e.g. the words of a vocabulary
+class LogUniformSampledSoftmax {
+public:
+  LogUniformSampledSoftmax() = default;
+
+  template <typename T> static T Probability(int label, int num_classes) {
+    return std::log1p(static_cast<T>(1) / (label + 1)) /
+           std::log1p(static_cast<T>(num_classes));
+  }
+
+  // Inverts the cumulative distribution $\log(c+1)/\log(C+1)$
+  static int Sample(double u, int num_classes) {
+    int label = static_cast<int>(std::exp(u * std::log1p(num_classes))) - 1;
+    return std::clamp(label, 0, num_classes - 1);
+  }
+};
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_EDGE_VERTEX_SAMPLED_SOFTMAX_H_
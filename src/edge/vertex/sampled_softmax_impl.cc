@@ -0,0 +1,445 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/edge/vertex/sampled_softmax_impl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <utility>
+
+#include "src/edge/vertex/sampled_softmax.h"
+#include "src/kernel/activation.h"
+#include "src/logging.h"
+#include "src/utility/random.h"
+
+namespace intellgraph {
+
+template <typename T>
+ClassParameters<T>::ClassParameters(int id, int dims, int num_classes)
+    : id_(id), dims_(dims), num_classes_(num_classes) {
+  DCHECK_GE(id_, 0);
+  DCHECK_GT(dims_, 0);
+  DCHECK_GT(num_classes_, 0);
+
+  weight_ = DynMatrix<T>(row(), col());
+  // Initialization, biases start at zero
+  Eigen::Map<MatrixX<T>> weight = weight_.mutable_map();
+  weight.topRows(dims_).array() = weight.topRows(dims_).array().unaryExpr(
+      std::function<T(T)>(NormalFunctor<T>(0.0, std::sqrt(1.0 / dims_))));
+  weight.row(dims_).setZero();
+}
+
+template <typename T> ClassParameters<T>::~ClassParameters() = default;
+
+template <typename T> int ClassParameters<T>::id() const { return id_; }
+
+template <typename T> int ClassParameters<T>::row() const { return dims_ + 1; }
+
+template <typename T> int ClassParameters<T>::col() const {
+  return num_classes_;
+}
+
+template <typename T>
+const Eigen::Map<const MatrixX<T>> &ClassParameters<T>::weight() {
+  return weight_.map();
+}
+
+template <typename T>
+Eigen::Map<MatrixX<T>> ClassParameters<T>::mutable_weight() {
+  return weight_.mutable_map();
+}
+
+template <typename T> void ClassParameters<T>::BindWeight(T *weight) {
+  weight_.Bind(weight, row() * col(), row(), col());
+}
+
+template <typename T>
+Eigen::Map<MatrixX<T>> ClassParameters<T>::mutable_bias() {
+  return Eigen::Map<MatrixX<T>>(nullptr, 0, 1);
+}
+
+template <typename T>
+Eigen::Map<MatrixX<T>> ClassParameters<T>::mutable_weight_stores(int index) {
+  DCHECK_GE(index, 0);
+  DCHECK_LE(index, weight_stores_.size());
+
+  if (index == weight_stores_.size()) {
+    // Lazy initialization
+    weight_stores_.emplace_back(row(), col());
+  }
+  return weight_stores_[index].mutable_map();
+}
+
+template <typename T>
+Eigen::Map<MatrixX<T>> ClassParameters<T>::mutable_bias_stores(int index) {
+  return Eigen::Map<MatrixX<T>>(nullptr, 0, 1);
+}
+
+template <typename T>
+void ClassParameters<T>::BindStores(int index, T *weight_store,
+                                    T *bias_store) {
+  DCHECK(weight_store);
+
+  // Biases of the classes are the last row of the weight matrix
+  mutable_weight_stores(index);
+  weight_stores_[index].Bind(weight_store, row() * col(), row(), col());
+}
+
+template <typename T> int ClassParameters<T>::num_weight_stores() const {
+  return weight_stores_.size();
+}
+
+template <typename T> int ClassParameters<T>::num_bias_stores() const {
+  return 0;
+}
+
+template <typename T>
+Eigen::Map<MatrixX<T>> ClassParameters<T>::mutable_nabla_weight() {
+  return Eigen::Map<MatrixX<T>>(nabla_weight_.data(), nabla_weight_.rows(),
+                                nabla_weight_.cols());
+}
+
+template <typename T>
+Eigen::Map<MatrixX<T>> ClassParameters<T>::mutable_nabla_bias() {
+  return Eigen::Map<MatrixX<T>>(nullptr, 0, 1);
+}
+
+template <typename T>
+void ClassParameters<T>::BindNablas(T *nabla_weight, T *nabla_bias) {
+  // The nabla weight only holds the columns of the classes in a batch
+  NOTREACHED();
+}
+
+template <typename T>
+const std::vector<int> *ClassParameters<T>::nabla_weight_cols() const {
+  return &nabla_weight_cols_;
+}
+
+template <typename T>
+void ClassParameters<T>::ConfineNablaWeight(std::vector<int> cols) {
+  nabla_weight_cols_ = std::move(cols);
+  nabla_weight_.setZero(row(), nabla_weight_cols_.size());
+}
+
+template <typename T, class Proposal>
+SampledSoftmaxImpl<T, Proposal>::SampledSoftmaxImpl(int id, int row, int col,
+                                                    int num_classes,
+                                                    int num_sampled)
+    : id_(id), row_(row), col_(col), num_classes_(num_classes),
+      num_sampled_(num_sampled), parameters_(id, row, num_classes),
+      position_(num_classes, -1) {
+  DCHECK_GE(id_, 0);
+  DCHECK_GT(row_, 0);
+  DCHECK_GT(col_, 0);
+  DCHECK_GT(num_sampled_, 0);
+
+  act_ = DynMatrix<T>(row_, col_);
+  delta_ = DynMatrix<T>(row_, col_);
+  bias_ = DynMatrix<T>(row_, 1);
+}
+
+template <typename T, class Proposal>
+SampledSoftmaxImpl<T, Proposal>::SampledSoftmaxImpl(
+    const VertexParameter &vtx_param, int batch_size)
+    : SampledSoftmaxImpl(vtx_param.id(), vtx_param.dims(), batch_size,
+                         vtx_param.sampled_softmax_param().num_classes(),
+                         vtx_param.sampled_softmax_param().num_sampled()) {}
+
+template <typename T, class Proposal>
+SampledSoftmaxImpl<T, Proposal>::~SampledSoftmaxImpl() = default;
+
+template <typename T, class Proposal>
+void SampledSoftmaxImpl<T, Proposal>::Activate() {
+  IG_TRACE(2) << "SampledSoftmaxImpl " << id_ << " is activated.";
+}
+
+template <typename T, class Proposal>
+void SampledSoftmaxImpl<T, Proposal>::Derive() {
+  IG_TRACE(2) << "SampledSoftmaxImpl " << id_ << " is derived.";
+}
+
+template <typename T, class Proposal>
+void SampledSoftmaxImpl<T, Proposal>::ResizeVertex(int length) {
+  DCHECK(length != col_);
+
+  col_ = length;
+  act_.Resize(row_, col_);
+  delta_.Resize(row_, col_);
+}
+
+template <typename T, class Proposal>
+void SampledSoftmaxImpl<T, Proposal>::BindBuffers(T *act, T *delta,
+                                                  int length) {
+  DCHECK_GT(length, 0);
+
+  col_ = length;
+  act_.Bind(act, row_ * col_, row_, col_);
+  if (delta) {
+    delta_.Bind(delta, row_ * col_, row_, col_);
+  } else {
+    delta_.Release();
+  }
+}
+
+template <typename T, class Proposal>
+void SampledSoftmaxImpl<T, Proposal>::BindBias(T *bias) {
+  bias_.Bind(bias, row_, row_, 1);
+}
+
+template <typename T, class Proposal>
+int SampledSoftmaxImpl<T, Proposal>::id() const {
+  return id_;
+}
+
+template <typename T, class Proposal>
+int SampledSoftmaxImpl<T, Proposal>::row() const {
+  return row_;
+}
+
+template <typename T, class Proposal>
+int SampledSoftmaxImpl<T, Proposal>::col() const {
+  return col_;
+}
+
+template <typename T, class Proposal>
+const Eigen::Map<const MatrixX<T>> &
+SampledSoftmaxImpl<T, Proposal>::act() const {
+  return act_.map();
+}
+
+template <typename T, class Proposal>
+Eigen::Map<MatrixX<T>> SampledSoftmaxImpl<T, Proposal>::mutable_act() {
+  return act_.mutable_map();
+}
+
+template <typename T, class Proposal>
+Eigen::Map<MatrixX<T>> SampledSoftmaxImpl<T, Proposal>::mutable_delta() {
+  return delta_.mutable_map();
+}
+
+template <typename T, class Proposal>
+Eigen::Map<MatrixX<T>> SampledSoftmaxImpl<T, Proposal>::mutable_bias() {
+  return bias_.mutable_map();
+}
+
+template <typename T, class Proposal>
+void SampledSoftmaxImpl<T, Proposal>::CalcNablaBias(
+    Eigen::Ref<MatrixX<T>> nabla_bias) {
+  nabla_bias.noalias() = delta_.map().rowwise().sum() / col_;
+}
+
+template <typename T, class Proposal>
+Edge<T> *SampledSoftmaxImpl<T, Proposal>::parameters() {
+  return &parameters_;
+}
+
+template <typename T, class Proposal>
+T SampledSoftmaxImpl<T, Proposal>::Logit(int label, int col) const {
+  DCHECK(label >= 0 && label < num_classes_);
+
+  const Eigen::Map<const MatrixX<T>> &weight = parameters_.weight();
+  return weight.col(label).head(row_).dot(act_.map().col(col)) +
+         weight(row_, label);
+}
+
+template <typename T, class Proposal>
+T SampledSoftmaxImpl<T, Proposal>::LogExpectedCount(int label) const {
+  return std::log(num_sampled_ *
+                  Proposal::template Probability<T>(label, num_classes_));
+}
+
+template <typename T, class Proposal>
+template <class Consume>
+ArrayX<T>
+SampledSoftmaxImpl<T, Proposal>::ScoreBlocks(Consume consume) const {
+  const Eigen::Map<const MatrixX<T>> &weight = parameters_.weight();
+  const Eigen::Map<const MatrixX<T>> &act = act_.map();
+
+  // Sums of exponentials are rescaled whenever a block raises the maximum
+  // logit of a column
+  ArrayX<T> max =
+      ArrayX<T>::Constant(col_, -std::numeric_limits<T>::infinity());
+  ArrayX<T> sum = ArrayX<T>::Zero(col_);
+  MatrixX<T> logits(std::min(kBlockSize, num_classes_), col_);
+  for (int begin = 0; begin < num_classes_; begin += kBlockSize) {
+    int size = std::min(kBlockSize, num_classes_ - begin);
+    auto block = logits.topRows(size);
+    block.noalias() = weight.block(0, begin, row_, size).transpose() * act;
+    block.colwise() += weight.row(row_).segment(begin, size).transpose();
+    consume(begin, block);
+    for (int col = 0; col < col_; ++col) {
+      T block_max = std::max(max(col), block.col(col).maxCoeff());
+      sum(col) = sum(col) * std::exp(max(col) - block_max) +
+                 (block.col(col).array() - block_max).exp().sum();
+      max(col) = block_max;
+    }
+  }
+  return max + sum.log();
+}
+
+template <typename T, class Proposal>
+T SampledSoftmaxImpl<T, Proposal>::CalcLoss(
+    const Eigen::Ref<const MatrixX<T>> &labels) {
+  DCHECK_EQ(labels.rows(), 1);
+  DCHECK_EQ(labels.cols(), col_);
+
+  ArrayX<T> log_sum_exp = ScoreBlocks([](int, const auto &) {});
+
+  T loss = 0;
+  for (int col = 0; col < col_; ++col) {
+    loss += log_sum_exp(col) - Logit(static_cast<int>(labels(0, col)), col);
+  }
+  return loss / col_;
+}
+
+template <typename T, class Proposal>
+void SampledSoftmaxImpl<T, Proposal>::CalcDelta(
+    const Eigen::Ref<const MatrixX<T>> &labels) {
+  DCHECK_EQ(labels.rows(), 1);
+  DCHECK_EQ(labels.cols(), col_);
+
+  const Eigen::Map<const MatrixX<T>> &weight = parameters_.weight();
+  const Eigen::Map<const MatrixX<T>> &act = act_.map();
+  Eigen::Map<MatrixX<T>> delta = delta_.mutable_map();
+
+  // Negatives are shared by the batch, so that their logits are one GEMM
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  sampled_.resize(num_sampled_);
+  sampled_weight_.resize(row_ + 1, num_sampled_);
+  for (int i = 0; i < num_sampled_; ++i) {
+    sampled_[i] = Proposal::Sample(uniform(generator_), num_classes_);
+    sampled_weight_.col(i) = weight.col(sampled_[i]);
+  }
+  logits_.resize(num_sampled_ + 1, col_);
+  auto sampled_logits = logits_.bottomRows(num_sampled_);
+  sampled_logits.noalias() = sampled_weight_.topRows(row_).transpose() * act;
+  for (int i = 0; i < num_sampled_; ++i) {
+    sampled_logits.row(i).array() +=
+        sampled_weight_(row_, i) - LogExpectedCount(sampled_[i]);
+  }
+
+  // Softmax over the true class and the negatives of each column, whose
+  // delta is the distribution minus the one-hot true class. Negatives that
+  // hit the true class are masked out.
+  for (int col = 0; col < col_; ++col) {
+    int label = static_cast<int>(labels(0, col));
+    logits_(0, col) = Logit(label, col) - LogExpectedCount(label);
+    for (int i = 0; i < num_sampled_; ++i) {
+      if (sampled_[i] == label) {
+        sampled_logits(i, col) = std::numeric_limits<T>::lowest();
+      }
+    }
+    SoftmaxForward(logits_.col(col).data(), num_sampled_ + 1);
+    logits_(0, col) -= 1;
+  }
+
+  delta.noalias() = sampled_weight_.topRows(row_) * sampled_logits;
+  for (int col = 0; col < col_; ++col) {
+    int label = static_cast<int>(labels(0, col));
+    delta.col(col) += logits_(0, col) * weight.col(label).head(row_);
+  }
+
+  // Nablas are confined to the classes of the batch in ascending order
+  std::vector<int> cols;
+  auto add_col = [&](int label) {
+    if (position_[label] < 0) {
+      position_[label] = 0;
+      cols.push_back(label);
+    }
+  };
+  for (int col = 0; col < col_; ++col) {
+    add_col(static_cast<int>(labels(0, col)));
+  }
+  for (int label : sampled_) {
+    add_col(label);
+  }
+  std::sort(cols.begin(), cols.end());
+  for (int i = 0; i < cols.size(); ++i) {
+    position_[cols[i]] = i;
+  }
+  parameters_.ConfineNablaWeight(cols);
+  Eigen::Map<MatrixX<T>> nabla_weight = parameters_.mutable_nabla_weight();
+
+  // Nablas of the negatives with one GEMM, scattered into their columns
+  T scale = 1.0 / col_;
+  sampled_nabla_.resize(row_ + 1, num_sampled_);
+  sampled_nabla_.topRows(row_).noalias() =
+      scale * act * sampled_logits.transpose();
+  sampled_nabla_.row(row_).noalias() =
+      scale * sampled_logits.rowwise().sum().transpose();
+  for (int i = 0; i < num_sampled_; ++i) {
+    nabla_weight.col(position_[sampled_[i]]) += sampled_nabla_.col(i);
+  }
+  for (int col = 0; col < col_; ++col) {
+    int position = position_[static_cast<int>(labels(0, col))];
+    nabla_weight.col(position).head(row_) +=
+        scale * logits_(0, col) * act.col(col);
+    nabla_weight(row_, position) += scale * logits_(0, col);
+  }
+
+  for (int label : cols) {
+    position_[label] = -1;
+  }
+}
+
+template <typename T, class Proposal>
+void SampledSoftmaxImpl<T, Proposal>::TopK(int k, MatrixX<int> *classes,
+                                           MatrixX<T> *probabilities) const {
+  DCHECK(k > 0 && k <= num_classes_);
+
+  // Min-heaps of the k largest logits of each column so far
+  using Entry = std::pair<T, int>;
+  std::vector<std::vector<Entry>> heaps(col_);
+  auto keep_top_k = [&](int begin, const Eigen::Ref<const MatrixX<T>> &logits) {
+    for (int col = 0; col < col_; ++col) {
+      std::vector<Entry> &heap = heaps[col];
+      for (int i = 0; i < logits.rows(); ++i) {
+        Entry entry(logits(i, col), begin + i);
+        if (heap.size() < k) {
+          heap.push_back(entry);
+          std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        } else if (entry.first > heap.front().first) {
+          std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+          heap.back() = entry;
+          std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        }
+      }
+    }
+  };
+  ArrayX<T> log_sum_exp = ScoreBlocks(keep_top_k);
+
+  classes->resize(k, col_);
+  probabilities->resize(k, col_);
+  for (int col = 0; col < col_; ++col) {
+    std::vector<Entry> &heap = heaps[col];
+    // Sorts by decreasing logit
+    std::sort_heap(heap.begin(), heap.end(), std::greater<Entry>());
+    for (int i = 0; i < k; ++i) {
+      (*classes)(i, col) = heap[i].second;
+      (*probabilities)(i, col) = std::exp(heap[i].first - log_sum_exp(col));
+    }
+  }
+}
+
+// Explicit instantiation
+template class ClassParameters<float>;
+template class ClassParameters<double>;
+template class SampledSoftmaxImpl<float, UniformSampledSoftmax>;
+template class SampledSoftmaxImpl<double, UniformSampledSoftmax>;
+template class SampledSoftmaxImpl<float, LogUniformSampledSoftmax>;
+template class SampledSoftmaxImpl<double, LogUniformSampledSoftmax>;
+
+} // namespace intellgraph
@@ -0,0 +1,193 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_EDGE_VERTEX_SAMPLED_SOFTMAX_IMPL_H_
+#define INTELLGRAPH_SRC_EDGE_VERTEX_SAMPLED_SOFTMAX_IMPL_H_
+
+#include <random>
+#include <vector>
+
+#include "src/edge.h"
+#include "src/edge/output_vertex.h"
+#include "src/eigen.h"
+#include "src/proto/vertex_parameter.pb.h"
+#include "src/solver.h"
+#include "src/tensor/dyn_matrix.h"
+#include "src/visitor.h"
+
+namespace intellgraph {
+
+// ClassParameters holds the class weights of a sampled softmax vertex behind
+// the Edge interface, so that solvers update them like the parameters of any
+// edge. Column c of the weight matrix is the |dims| embedding of class c
+// followed by its bias, so that the nabla weight, which only holds the
+// classes of the last batch, covers their biases as well. The bias of the
+// edge itself is empty. Nablas are calculated by the vertex, and visitors
+// only see the parameters through VisitParameters.
+template <typename T> class ClassParameters : public Edge<T> {
+public:
+  explicit ClassParameters(int id, int dims, int num_classes);
+  ~ClassParameters() override;
+
+  void Accept(Visitor<T> &visitor) override {
+    visitor.VisitParameters(*this);
+  }
+  void Accept(Solver<T> &solver) override { solver.Visit(*this); }
+
+  int id() const override;
+  int row() const override;
+  int col() const override;
+
+  const Eigen::Map<const MatrixX<T>> &weight() override;
+  Eigen::Map<MatrixX<T>> mutable_weight() override;
+  void BindWeight(T *weight) override;
+  Eigen::Map<MatrixX<T>> mutable_bias() override;
+  // Read-only view for vertices that score classes concurrently
+  const Eigen::Map<const MatrixX<T>> &weight() const { return weight_.map(); }
+  Eigen::Map<MatrixX<T>> mutable_weight_stores(int index) override;
+  Eigen::Map<MatrixX<T>> mutable_bias_stores(int index) override;
+  void BindStores(int index, T *weight_store, T *bias_store) override;
+  int num_weight_stores() const override;
+  int num_bias_stores() const override;
+
+  Eigen::Map<MatrixX<T>> mutable_nabla_weight() override;
+  Eigen::Map<MatrixX<T>> mutable_nabla_bias() override;
+  void BindNablas(T *nabla_weight, T *nabla_bias) override;
+
+  void CalcNablaWeight() override {}
+  void CalcNablaBias() override {}
+  const std::vector<int> *nabla_weight_cols() const override;
+  // Confines the nabla weight to the ascending classes |cols| and zeroes it
+  void ConfineNablaWeight(std::vector<int> cols);
+
+private:
+  int id_;
+  int dims_;
+  int num_classes_;
+
+  DynMatrix<T> weight_;
+  MatrixX<T> nabla_weight_;
+  std::vector<int> nabla_weight_cols_;
+  std::vector<DynMatrix<T>> weight_stores_;
+};
+
+// SampledSoftmaxImpl is a softmax cross entropy output vertex for very large
+// numbers of classes. The activation matrix holds |dims| embeddings rather
+// than a probability distribution, which is what keeps the activation and
+// delta buffers of the graph small, and the vertex owns the class weights
+// that score them, see ClassParameters. Labels are class indices, one row of
+// labels per batch.
+//
+// Training draws |num_sampled| negative classes per batch from the
+// |Proposal| distribution, e.g. LogUniformSampledSoftmax, and CalcDelta
+// approximates the softmax over all classes by the softmax over the true
+// class and the negatives of each column, with logits corrected by the log
+// of their expected counts. Only the columns of the class weights of these
+// classes get nablas, so solvers leave the others untouched. Like the ones
+// of SparseDense edges, such nablas cannot be reduced across data-parallel
+// replicas, and graphs with this vertex train on a single thread.
+//
+// CalcLoss and TopK are exact. They score the classes block by block and
+// fold each block into a running log-sum-exp, so that no more than
+// kBlockSize logits per column are kept at once. act() is not a probability
+// distribution, so classifiers predict with TopK rather than with
+// GetProbabilityDist or CalcConfusionMatrix.
+template <typename T, class Proposal>
+class SampledSoftmaxImpl : public Proposal, public OutputVertex<T> {
+public:
+  typedef T value_type;
+
+  // Number of classes scored at once by CalcLoss and TopK
+  static constexpr int kBlockSize = 256;
+
+  explicit SampledSoftmaxImpl(int id, int row, int col, int num_classes,
+                              int num_sampled);
+  explicit SampledSoftmaxImpl(const VertexParameter &vtx_param,
+                              int batch_size);
+  ~SampledSoftmaxImpl() override;
+
+  // Embeddings are linear, so activation and derivation leave them as they
+  // are
+  void Activate() override;
+  void Activate(Eigen::Ref<MatrixX<T>> act) const override {}
+  void Derive() override;
+  void ResizeVertex(int length) override;
+  void BindBuffers(T *act, T *delta, int length) override;
+  void BindBias(T *bias) override;
+
+  int id() const override;
+  int row() const override;
+  int col() const override;
+
+  const Eigen::Map<const MatrixX<T>> &act() const override;
+  Eigen::Map<MatrixX<T>> mutable_act() override;
+  Eigen::Map<MatrixX<T>> mutable_delta() override;
+  Eigen::Map<MatrixX<T>> mutable_bias() override;
+  void CalcNablaBias(Eigen::Ref<MatrixX<T>> nabla_bias) override;
+  Edge<T> *parameters() override;
+
+  T CalcLoss(const Eigen::Ref<const MatrixX<T>> &labels) override;
+  void CalcDelta(const Eigen::Ref<const MatrixX<T>> &labels) override;
+  void TopK(int k, MatrixX<int> *classes,
+            MatrixX<T> *probabilities) const override;
+
+  int num_classes() const { return num_classes_; }
+  int num_sampled() const { return num_sampled_; }
+  // Negative classes drawn for the last batch
+  const std::vector<int> &sampled() const { return sampled_; }
+  // Reseeds the generator negative classes are drawn with
+  void Seed(unsigned int seed) { generator_.seed(seed); }
+
+private:
+  // Scores all classes against the embeddings in the activation matrix,
+  // calling |consume| with the first class of each block and the logits of
+  // the block, one column per embedding. Returns the log-sum-exp of the
+  // logits of each column.
+  template <class Consume> ArrayX<T> ScoreBlocks(Consume consume) const;
+  // Returns the logit of class |label| for column |col| of the activation
+  T Logit(int label, int col) const;
+  // Logit correction of |label| among the negatives of a batch
+  T LogExpectedCount(int label) const;
+
+  int id_;
+  int row_;
+  int col_;
+  int num_classes_;
+  int num_sampled_;
+
+  DynMatrix<T> act_;
+  DynMatrix<T> delta_;
+  DynMatrix<T> bias_;
+  ClassParameters<T> parameters_;
+
+  std::mt19937 generator_;
+  // Negative classes of the last batch, and their weight columns
+  std::vector<int> sampled_;
+  MatrixX<T> sampled_weight_;
+  // Logits of the true class in the first row and of the negatives below,
+  // turned into their deltas in place
+  MatrixX<T> logits_;
+  MatrixX<T> sampled_nabla_;
+  // Column of each class in the nabla weight, or -1
+  std::vector<int> position_;
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class ClassParameters<float>;
+extern template class ClassParameters<double>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_EDGE_VERTEX_SAMPLED_SOFTMAX_IMPL_H_
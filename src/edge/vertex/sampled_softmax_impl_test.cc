@@ -0,0 +1,186 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/edge/vertex/sampled_softmax_impl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "src/edge/vertex/sampled_softmax.h"
+#include "src/eigen.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+constexpr int kDims = 4;
+constexpr int kBatchSize = 3;
+
+// Fills the embeddings and class biases of |vertex| with random values
+void Randomize(OpVertex<double> &vertex) {
+  vertex.mutable_act().setRandom();
+  vertex.parameters()->mutable_weight().row(kDims).setRandom();
+}
+
+// Returns the probability distribution over all classes
+MatrixX<double> FullSoftmax(Edge<double> *parameters,
+                            const Eigen::Ref<const MatrixX<double>> &act) {
+  const auto &weight = parameters->weight();
+  MatrixX<double> logits = weight.topRows(kDims).transpose() * act;
+  logits.colwise() += weight.row(kDims).transpose();
+  MatrixX<double> dist = logits.array().exp();
+  return dist.array().rowwise() / dist.colwise().sum().array();
+}
+
+TEST(SampledSoftmaxImplTest, CalcLossSuccess) {
+  // Classes span several blocks, the last of which is partial
+  SampledSoftmaxImpl<double, UniformSampledSoftmax> vertex(0, kDims,
+                                                          kBatchSize, 600, 8);
+  Randomize(vertex);
+  MatrixX<double> labels(1, kBatchSize);
+  labels << 3, 299, 599;
+
+  MatrixX<double> dist = FullSoftmax(vertex.parameters(), vertex.act());
+  double loss = 0.0;
+  for (int col = 0; col < kBatchSize; ++col) {
+    loss -= std::log(dist(static_cast<int>(labels(0, col)), col));
+  }
+  EXPECT_NEAR(vertex.CalcLoss(labels), loss / kBatchSize, 1e-9);
+}
+
+TEST(SampledSoftmaxImplTest, TopKSuccess) {
+  SampledSoftmaxImpl<double, UniformSampledSoftmax> vertex(0, kDims,
+                                                          kBatchSize, 600, 8);
+  Randomize(vertex);
+  MatrixX<int> classes;
+  MatrixX<double> probabilities;
+  vertex.TopK(5, &classes, &probabilities);
+  ASSERT_EQ(classes.rows(), 5);
+  ASSERT_EQ(classes.cols(), kBatchSize);
+
+  // Matches the brute-force selection from the whole distribution
+  MatrixX<double> dist = FullSoftmax(vertex.parameters(), vertex.act());
+  for (int col = 0; col < kBatchSize; ++col) {
+    std::vector<int> order(dist.rows());
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(
+        order.begin(), order.begin() + 5, order.end(),
+        [&](int a, int b) { return dist(a, col) > dist(b, col); });
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_EQ(classes(i, col), order[i]);
+      EXPECT_NEAR(probabilities(i, col), dist(order[i], col), 1e-12);
+    }
+  }
+}
+
+TEST(SampledSoftmaxImplTest, CalcDeltaSuccess) {
+  constexpr int kNumClasses = 20;
+  constexpr int kNumSampled = 8;
+  SampledSoftmaxImpl<double, UniformSampledSoftmax> vertex(
+      0, kDims, kBatchSize, kNumClasses, kNumSampled);
+  Randomize(vertex);
+  vertex.Seed(1);
+  MatrixX<double> labels(1, kBatchSize);
+  labels << 0, 7, 19;
+  vertex.CalcDelta(labels);
+
+  // Softmax of each column over its true class and the negatives, whose
+  // logits are corrected by log(num_sampled / num_classes)
+  Edge<double> *parameters = vertex.parameters();
+  const auto &weight = parameters->weight();
+  const std::vector<int> &sampled = vertex.sampled();
+  ASSERT_EQ(sampled.size(), kNumSampled);
+  double correction = std::log(static_cast<double>(kNumSampled) / kNumClasses);
+  MatrixX<double> delta = MatrixX<double>::Zero(kDims, kBatchSize);
+  MatrixX<double> nabla_weight = MatrixX<double>::Zero(kDims + 1, kNumClasses);
+  for (int col = 0; col < kBatchSize; ++col) {
+    std::vector<int> candidates = {static_cast<int>(labels(0, col))};
+    candidates.insert(candidates.end(), sampled.begin(), sampled.end());
+    VectorX<double> dlogits(candidates.size());
+    for (int i = 0; i < candidates.size(); ++i) {
+      dlogits(i) = std::exp(
+          weight.col(candidates[i]).head(kDims).dot(vertex.act().col(col)) +
+          weight(kDims, candidates[i]) - correction);
+      // Accidental hits of the true class
+      if (i > 0 && candidates[i] == candidates[0]) {
+        dlogits(i) = 0.0;
+      }
+    }
+    dlogits /= dlogits.sum();
+    dlogits(0) -= 1.0;
+    for (int i = 0; i < candidates.size(); ++i) {
+      delta.col(col) += dlogits(i) * weight.col(candidates[i]).head(kDims);
+      nabla_weight.col(candidates[i]).head(kDims) +=
+          dlogits(i) * vertex.act().col(col) / kBatchSize;
+      nabla_weight(kDims, candidates[i]) += dlogits(i) / kBatchSize;
+    }
+  }
+  EXPECT_TRUE(vertex.mutable_delta().isApprox(delta, 1e-6));
+
+  // Nablas are only kept for the columns of these classes
+  const std::vector<int> &cols = *parameters->nabla_weight_cols();
+  for (int i = 0; i < cols.size(); ++i) {
+    EXPECT_TRUE(parameters->mutable_nabla_weight().col(i).isApprox(
+        nabla_weight.col(cols[i]), 1e-6));
+    nabla_weight.col(cols[i]).setZero();
+  }
+  EXPECT_TRUE(nabla_weight.isZero());
+}
+
+TEST(SampledSoftmaxImplTest, CalcDeltaConfinesNablas) {
+  SampledSoftmaxImpl<double, LogUniformSampledSoftmax> vertex(
+      0, kDims, kBatchSize, 100000, 16);
+  Randomize(vertex);
+  MatrixX<double> labels(1, kBatchSize);
+  labels << 50000, 20, 99999;
+  vertex.CalcDelta(labels);
+
+  // Nablas only hold the true classes and the negatives
+  const std::vector<int> &cols = *vertex.parameters()->nabla_weight_cols();
+  ASSERT_LE(cols.size(), kBatchSize + 16);
+  EXPECT_TRUE(std::is_sorted(cols.begin(), cols.end()));
+  for (int col = 0; col < kBatchSize; ++col) {
+    EXPECT_TRUE(std::binary_search(cols.begin(), cols.end(),
+                                   static_cast<int>(labels(0, col))));
+  }
+  EXPECT_EQ(vertex.parameters()->mutable_nabla_weight().cols(), cols.size());
+}
+
+TEST(SampledSoftmaxImplTest, LogUniformSampleSuccess) {
+  constexpr int kNumClasses = 10;
+  constexpr int kNumSamples = 100000;
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::vector<int> counts(kNumClasses);
+  for (int i = 0; i < kNumSamples; ++i) {
+    ++counts[LogUniformSampledSoftmax::Sample(uniform(generator),
+                                              kNumClasses)];
+  }
+
+  double total = 0.0;
+  for (int label = 0; label < kNumClasses; ++label) {
+    double probability =
+        LogUniformSampledSoftmax::Probability<double>(label, kNumClasses);
+    total += probability;
+    EXPECT_NEAR(counts[label] / static_cast<double>(kNumSamples),
+                probability, 0.01);
+  }
+  EXPECT_NEAR(total, 1.0, 1e-12);
+}
+
+} // namespace
+} // namespace intellgraph
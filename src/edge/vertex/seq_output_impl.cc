@@ -16,6 +16,7 @@ Contributor(s):
 
 #include "src/edge/vertex/cross_entropy.h"
 #include "src/edge/vertex/sigmoid_l2.h"
+#include "src/edge/vertex/softmax_cross_entropy.h"
 
 namespace intellgraph {
 
@@ -36,6 +37,11 @@ void SeqOutputImpl<T, Algorithm>::Activate() {
   output_vertex_.Activate();
 }
 
+template <typename T, class Algorithm>
+void SeqOutputImpl<T, Algorithm>::Activate(Eigen::Ref<MatrixX<T>> act) const {
+  output_vertex_.Activate(act);
+}
+
 template <typename T, class Algorithm>
 void SeqOutputImpl<T, Algorithm>::Derive() {
   output_vertex_.Derive();
@@ -46,6 +52,16 @@ void SeqOutputImpl<T, Algorithm>::ResizeVertex(int length) {
   output_vertex_.ResizeVertex(length);
 }
 
+template <typename T, class Algorithm>
+void SeqOutputImpl<T, Algorithm>::BindBuffers(T *act, T *delta, int length) {
+  output_vertex_.BindBuffers(act, delta, length);
+}
+
+template <typename T, class Algorithm>
+void SeqOutputImpl<T, Algorithm>::BindBias(T *bias) {
+  output_vertex_.BindBias(bias);
+}
+
 template <typename T, class Algorithm>
 int SeqOutputImpl<T, Algorithm>::id() const {
   return output_vertex_.id();
@@ -82,9 +98,10 @@ Eigen::Map<MatrixX<T>> SeqOutputImpl<T, Algorithm>::mutable_bias() {
 }
 
 template <typename T, class Algorithm>
-const MatrixX<T> SeqOutputImpl<T, Algorithm>::CalcNablaBias() {
+void SeqOutputImpl<T, Algorithm>::CalcNablaBias(
+    Eigen::Ref<MatrixX<T>> nabla_bias) {
   Eigen::Map<MatrixX<T>> delta = output_vertex_.mutable_delta();
-  return delta.col(timestamp_);
+  nabla_bias = delta.col(timestamp_);
 }
 
 template <typename T, class Algorithm>
@@ -114,5 +131,7 @@ template class SeqOutputImpl<float, SigmoidL2>;
 template class SeqOutputImpl<double, SigmoidL2>;
 template class SeqOutputImpl<float, CrossEntropy>;
 template class SeqOutputImpl<double, CrossEntropy>;
+template class SeqOutputImpl<float, SoftmaxCrossEntropy>;
+template class SeqOutputImpl<double, SoftmaxCrossEntropy>;
 
 } // namespace intellgraph
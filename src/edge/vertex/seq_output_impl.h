@@ -32,8 +32,11 @@ public:
   ~SeqOutputImpl() override;
 
   void Activate() override;
+  void Activate(Eigen::Ref<MatrixX<T>> act) const override;
   void Derive() override;
   void ResizeVertex(int length) override;
+  void BindBuffers(T *act, T *delta, int length) override;
+  void BindBias(T *bias) override;
 
   int id() const override;
   int row() const override;
@@ -43,7 +46,7 @@ public:
   Eigen::Map<MatrixX<T>> mutable_act() override;
   Eigen::Map<MatrixX<T>> mutable_delta() override;
   Eigen::Map<MatrixX<T>> mutable_bias() override;
-  const MatrixX<T> CalcNablaBias() override;
+  void CalcNablaBias(Eigen::Ref<MatrixX<T>> nabla_bias) override;
 
   T CalcLoss(const Eigen::Ref<const MatrixX<T>> &labels) override;
   void CalcDelta(const Eigen::Ref<const MatrixX<T>> &labels) override;
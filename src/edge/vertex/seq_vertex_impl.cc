@@ -14,8 +14,10 @@ Contributor(s):
 ==============================================================================*/
 #include "src/edge/vertex/seq_vertex_impl.h"
 
+#include "src/edge/vertex/leaky_relu.h"
 #include "src/edge/vertex/relu.h"
 #include "src/edge/vertex/sigmoid.h"
+#include "src/edge/vertex/tanh.h"
 
 namespace intellgraph {
 
@@ -36,6 +38,11 @@ void SeqVertexImpl<T, Algorithm>::Activate() {
   op_vertex_.Activate();
 }
 
+template <typename T, class Algorithm>
+void SeqVertexImpl<T, Algorithm>::Activate(Eigen::Ref<MatrixX<T>> act) const {
+  op_vertex_.Activate(act);
+}
+
 template <typename T, class Algorithm>
 void SeqVertexImpl<T, Algorithm>::Derive() {
   op_vertex_.Derive();
@@ -46,6 +53,16 @@ void SeqVertexImpl<T, Algorithm>::ResizeVertex(int length) {
   op_vertex_.ResizeVertex(length);
 }
 
+template <typename T, class Algorithm>
+void SeqVertexImpl<T, Algorithm>::BindBuffers(T *act, T *delta, int length) {
+  op_vertex_.BindBuffers(act, delta, length);
+}
+
+template <typename T, class Algorithm>
+void SeqVertexImpl<T, Algorithm>::BindBias(T *bias) {
+  op_vertex_.BindBias(bias);
+}
+
 template <typename T, class Algorithm>
 int SeqVertexImpl<T, Algorithm>::id() const {
   return op_vertex_.id();
@@ -82,9 +99,10 @@ Eigen::Map<MatrixX<T>> SeqVertexImpl<T, Algorithm>::mutable_bias() {
 }
 
 template <typename T, class Algorithm>
-const MatrixX<T> SeqVertexImpl<T, Algorithm>::CalcNablaBias() {
+void SeqVertexImpl<T, Algorithm>::CalcNablaBias(
+    Eigen::Ref<MatrixX<T>> nabla_bias) {
   Eigen::Map<MatrixX<T>> delta = op_vertex_.mutable_delta();
-  return delta.col(timestamp_);
+  nabla_bias = delta.col(timestamp_);
 }
 
 template <typename T, class Algorithm>
@@ -99,7 +117,11 @@ int SeqVertexImpl<T, Algorithm>::GetCurrentTimeStep() const {
 
 template class SeqVertexImpl<float, Relu>;
 template class SeqVertexImpl<double, Relu>;
+template class SeqVertexImpl<float, LeakyRelu>;
+template class SeqVertexImpl<double, LeakyRelu>;
 template class SeqVertexImpl<float, Sigmoid>;
 template class SeqVertexImpl<double, Sigmoid>;
+template class SeqVertexImpl<float, Tanh>;
+template class SeqVertexImpl<double, Tanh>;
 
 } // namespace intellgraph
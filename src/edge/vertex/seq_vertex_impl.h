@@ -29,8 +29,11 @@ public:
   ~SeqVertexImpl() override;
 
   void Activate() override;
+  void Activate(Eigen::Ref<MatrixX<T>> act) const override;
   void Derive() override;
   void ResizeVertex(int length) override;
+  void BindBuffers(T *act, T *delta, int length) override;
+  void BindBias(T *bias) override;
 
   int id() const override;
   int row() const override;
@@ -40,7 +43,7 @@ public:
   Eigen::Map<MatrixX<T>> mutable_act() override;
   Eigen::Map<MatrixX<T>> mutable_delta() override;
   Eigen::Map<MatrixX<T>> mutable_bias() override;
-  const MatrixX<T> CalcNablaBias() override;
+  void CalcNablaBias(Eigen::Ref<MatrixX<T>> nabla_bias) override;
 
   void ForwardByOneTimeStep() override;
   int GetCurrentTimeStep() const override;
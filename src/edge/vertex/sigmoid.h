@@ -18,6 +18,7 @@ Contributor(s):
 #include "glog/logging.h"
 #include "src/edge/vertex/op_vertex_impl.h"
 #include "src/eigen.h"
+#include "src/kernel/activation.h"
 
 namespace intellgraph {
 
@@ -26,17 +27,30 @@ public:
   Sigmoid() = default;
 
   template <typename T> static void Activate(OpVertex<T> &vertex) {
+    Activate<T>(vertex.mutable_act());
+  }
+
+  template <typename T> static void Activate(Eigen::Ref<MatrixX<T>> act) {
     // Sigmoid activation function:
     // $\sigma(z)=1.0/(1.0+e^{-z})$
-    Eigen::Map<MatrixX<T>> act = vertex.mutable_act();
-    act.array() = 0.5 * (1.0 + (0.5 * act.array()).tanh());
+    ForEachContiguous<T>(act, [](T *data, size_t size) {
+      SigmoidForward(data, size);
+    });
   }
 
   template <typename T> static void Derive(OpVertex<T> &vertex) {
+    Derive<T>(vertex.act(), vertex.mutable_delta());
+  }
+
+  template <typename T>
+  static void Derive(const Eigen::Ref<const MatrixX<T>> &act,
+                     Eigen::Ref<MatrixX<T>> delta) {
     // Derivative equation:
     // $d\sigma/dz=\sigma(z)(1-\sigma(z))$
-    Eigen::Map<MatrixX<T>> act = vertex.mutable_act();
-    act.array() *= (1.0 - act.array());
+    ForEachContiguous<T>(act, delta, [](const T *act_data, T *delta_data,
+                                        size_t size) {
+      SigmoidBackward(act_data, delta_data, size);
+    });
   }
 
 protected:
@@ -33,6 +33,10 @@ public:
     Sigmoid::Activate(vertex);
   }
 
+  template <typename T> static void Activate(Eigen::Ref<MatrixX<T>> act) {
+    Sigmoid::Activate<T>(act);
+  }
+
   template <typename T>
   static void Derive(OutputVertexImpl<T, SigmoidL2> &vertex) {
     // Derivative equation:
@@ -46,7 +50,12 @@ public:
     DCHECK_EQ(vertex.row(), labels.rows());
     DCHECK_EQ(vertex.col(), labels.cols());
 
-    const Eigen::Map<const MatrixX<T>> &act = vertex.act();
+    return CalcLoss<T>(vertex.act(), labels);
+  }
+
+  template <typename T>
+  static T CalcLoss(const Eigen::Ref<const MatrixX<T>> &act,
+                    const Eigen::Ref<const MatrixX<T>> &labels) {
     T loss = (act - labels).squaredNorm();
     return loss / 2.0 / act.cols();
   }
@@ -57,12 +66,15 @@ public:
     DCHECK_EQ(vertex.row(), labels.rows());
     DCHECK_EQ(vertex.col(), labels.cols());
 
-    Eigen::Map<MatrixX<T>> delta = vertex.mutable_delta();
-    const Eigen::Map<const MatrixX<T>> &act = vertex.act();
+    CalcDelta<T>(vertex.act(), labels, vertex.mutable_delta());
+  }
 
+  template <typename T>
+  static void CalcDelta(const Eigen::Ref<const MatrixX<T>> &act,
+                        const Eigen::Ref<const MatrixX<T>> &labels,
+                        Eigen::Ref<MatrixX<T>> delta) {
     delta.noalias() = act - labels;
-    Sigmoid::Derive(vertex);
-    delta.array() *= act.array();
+    Sigmoid::Derive<T>(act, delta);
   }
 
 protected:
@@ -66,11 +66,14 @@ TEST(SigmoidL2Test, DeriveSuccess) {
   output_vertex_float.Activate();
   output_vertex_double.Activate();
 
+  output_vertex_float.mutable_delta().setConstant(1.0f);
+  output_vertex_double.mutable_delta().setConstant(1.0);
+
   output_vertex_float.Derive();
   output_vertex_double.Derive();
 
-  EXPECT_FLOAT_EQ(output_vertex_float.act()(0, 0), 0.25f);
-  EXPECT_DOUBLE_EQ(output_vertex_double.act()(0, 0), 0.25);
+  EXPECT_FLOAT_EQ(output_vertex_float.mutable_delta()(0, 0), 0.25f);
+  EXPECT_DOUBLE_EQ(output_vertex_double.mutable_delta()(0, 0), 0.25);
 }
 
 TEST(SigmoidL2Test, CalcLossSuccess) {
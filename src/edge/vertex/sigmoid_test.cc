@@ -54,13 +54,17 @@ TEST(SigmoidTest, ActivateSuccess) {
 TEST(SigmoidTest, DeriveSuccess) {
   OpVertexImpl<float, Sigmoid> op_vertex_float(0, 1, 1);
   op_vertex_float.Activate();
+  op_vertex_float.mutable_delta().setConstant(2.0f);
   op_vertex_float.Derive();
-  EXPECT_FLOAT_EQ(op_vertex_float.act()(0, 0), 0.25f);
+  EXPECT_FLOAT_EQ(op_vertex_float.mutable_delta()(0, 0), 0.5f);
+  EXPECT_FLOAT_EQ(op_vertex_float.act()(0, 0), 0.5f);
 
   OpVertexImpl<double, Sigmoid> op_vertex_double(1, 1, 1);
   op_vertex_double.Activate();
+  op_vertex_double.mutable_delta().setConstant(2.0);
   op_vertex_double.Derive();
-  EXPECT_DOUBLE_EQ(op_vertex_double.act()(0, 0), 0.25);
+  EXPECT_DOUBLE_EQ(op_vertex_double.mutable_delta()(0, 0), 0.5);
+  EXPECT_DOUBLE_EQ(op_vertex_double.act()(0, 0), 0.5);
 }
 
 } // namespace
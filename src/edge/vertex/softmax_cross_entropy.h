@@ -0,0 +1,185 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_EDGE_VERTEX_SOFTMAX_CROSS_ENTROPY_H_
+#define INTELLGRAPH_SRC_EDGE_VERTEX_SOFTMAX_CROSS_ENTROPY_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "glog/logging.h"
+#include "src/edge/op_vertex.h"
+#include "src/edge/vertex/output_vertex_impl.h"
+#include "src/eigen.h"
+#include "src/kernel/activation.h"
+
+namespace intellgraph {
+
+// SoftmaxCrossEntropy is the output operation of multi-class classifiers,
+// whose columns are distributions over the classes. Labels are either one-hot
+// columns, or a single row that holds the class index of each column, so that
+// one-hot labels of a large number of classes are never built.
+class SoftmaxCrossEntropy {
+public:
+  SoftmaxCrossEntropy() = default;
+
+  // On the loss path, see OutputVertex::loss_path, keeps the logits and the
+  // log-normalizer of each column, so that CalcLoss of the vertex takes
+  // $-\log a_y=\log\sum_j e^{z_j}-z_y$ rather than the log of a probability
+  // that may have underflowed. Other passes keep nothing.
+  template <typename T>
+  void Activate(OutputVertexImpl<T, SoftmaxCrossEntropy> &vertex) {
+    Eigen::Map<MatrixX<T>> act = vertex.mutable_act();
+    if (!vertex.loss_path()) {
+      logits_.resize(0, 0);
+      Activate<T>(act);
+      return;
+    }
+    logits_ = act.template cast<double>();
+    Activate<T>(act);
+    log_normalizers_.resize(act.cols());
+    for (int col = 0; col < act.cols(); ++col) {
+      // The most probable class holds at least 1 / rows, so its log is exact
+      int max_row;
+      double max_logit = logits_.col(col).maxCoeff(&max_row);
+      log_normalizers_(col) =
+          max_logit - std::log(static_cast<double>(act(max_row, col)));
+    }
+  }
+
+  template <typename T> static void Activate(Eigen::Ref<MatrixX<T>> act) {
+    // Softmax activation function, column by column:
+    // $a_i=e^{z_i-\max z}/\sum_j e^{z_j-\max z}$
+    for (int col = 0; col < act.cols(); ++col) {
+      SoftmaxForward(act.col(col).data(), static_cast<size_t>(act.rows()));
+    }
+  }
+
+  template <typename T> static void Derive(OpVertex<T> &vertex) {
+    Derive<T>(vertex.act(), vertex.mutable_delta());
+  }
+
+  template <typename T>
+  static void Derive(const Eigen::Ref<const MatrixX<T>> &act,
+                     Eigen::Ref<MatrixX<T>> delta) {
+    // Derivative equation:
+    // $\partial a_i/\partial z_j=a_i(\delta_{ij}-a_j)$
+    for (int col = 0; col < act.cols(); ++col) {
+      SoftmaxBackward(act.col(col).data(), delta.col(col).data(),
+                      static_cast<size_t>(act.rows()));
+    }
+  }
+
+  // Returns the loss of the last Activate of |vertex| from its logits if it
+  // was on the loss path, or from its probabilities otherwise
+  template <typename T>
+  T CalcLoss(OutputVertexImpl<T, SoftmaxCrossEntropy> &vertex,
+             const Eigen::Ref<const MatrixX<T>> &labels) const {
+    DCHECK_EQ(vertex.col(), labels.cols());
+    if (logits_.cols() != vertex.col()) {
+      return CalcLoss<T>(vertex.act(), labels);
+    }
+    DCHECK_EQ(logits_.rows(), vertex.row());
+
+    double loss = 0;
+    if (IsClassIndex<T>(vertex.act(), labels)) {
+      for (int col = 0; col < logits_.cols(); ++col) {
+        int label = static_cast<int>(labels(0, col));
+        DCHECK(label >= 0 && label < logits_.rows());
+        loss += log_normalizers_(col) - logits_(label, col);
+      }
+    } else {
+      DCHECK_EQ(logits_.rows(), labels.rows());
+      for (int col = 0; col < logits_.cols(); ++col) {
+        loss += (labels.col(col).template cast<double>().array() *
+                 (log_normalizers_(col) - logits_.col(col).array()))
+                    .sum();
+      }
+    }
+    int batch_size = logits_.cols();
+    return static_cast<T>(loss / batch_size);
+  }
+
+  // Returns the loss of the probabilities |act| when their logits are not
+  // kept, e.g. off the loss path or by graphs of src/graph/static_graph.h
+  template <typename T>
+  static T CalcLoss(const Eigen::Ref<const MatrixX<T>> &act,
+                    const Eigen::Ref<const MatrixX<T>> &labels) {
+    // Probabilities are clamped to the smallest normal number inside the log,
+    // which bounds the loss of a class whose probability underflowed
+    T min = std::numeric_limits<T>::min();
+    T loss = 0;
+    if (IsClassIndex(act, labels)) {
+      for (int col = 0; col < act.cols(); ++col) {
+        int label = static_cast<int>(labels(0, col));
+        DCHECK(label >= 0 && label < act.rows());
+        loss -= std::log(std::max(act(label, col), min));
+      }
+    } else {
+      DCHECK_EQ(act.rows(), labels.rows());
+      loss = -(labels.array() * act.array().max(min).log()).sum();
+    }
+    int batch_size = act.cols();
+    return loss / batch_size;
+  }
+
+  template <typename T>
+  static void CalcDelta(OutputVertexImpl<T, SoftmaxCrossEntropy> &vertex,
+                        const Eigen::Ref<const MatrixX<T>> &labels) {
+    DCHECK_EQ(vertex.col(), labels.cols());
+
+    CalcDelta<T>(vertex.act(), labels, vertex.mutable_delta());
+  }
+
+  template <typename T>
+  static void CalcDelta(const Eigen::Ref<const MatrixX<T>> &act,
+                        const Eigen::Ref<const MatrixX<T>> &labels,
+                        Eigen::Ref<MatrixX<T>> delta) {
+    // The Jacobian of the softmax cancels out with the derivative of the
+    // loss, so that $\delta=a-y$
+    if (IsClassIndex(act, labels)) {
+      delta = act;
+      for (int col = 0; col < act.cols(); ++col) {
+        int label = static_cast<int>(labels(0, col));
+        DCHECK(label >= 0 && label < act.rows());
+        delta(label, col) -= 1;
+      }
+    } else {
+      DCHECK_EQ(act.rows(), labels.rows());
+      delta.noalias() = act - labels;
+    }
+  }
+
+protected:
+  ~SoftmaxCrossEntropy() = default;
+
+private:
+  // Returns true if |labels| hold a class index per column rather than
+  // one-hot columns
+  template <typename T>
+  static bool IsClassIndex(const Eigen::Ref<const MatrixX<T>> &act,
+                           const Eigen::Ref<const MatrixX<T>> &labels) {
+    return labels.rows() == 1 && act.rows() > 1;
+  }
+
+  // Logits and log-normalizers of the last Activate of the vertex on the
+  // loss path, kept in double precision for vertices of either scalar type
+  MatrixX<double> logits_;
+  VectorX<double> log_normalizers_;
+};
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_EDGE_VERTEX_SOFTMAX_CROSS_ENTROPY_H_
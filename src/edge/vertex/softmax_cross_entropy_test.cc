@@ -0,0 +1,142 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/edge/vertex/softmax_cross_entropy.h"
+
+#include <cmath>
+
+#include "src/edge/vertex/output_vertex_impl.h"
+#include "src/eigen.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+TEST(SoftmaxCrossEntropyTest, ActivateSuccess) {
+  OutputVertexImpl<double, SoftmaxCrossEntropy> output_vertex(0, 3, 2);
+  // Logits of the second column overflow the exponential unless their
+  // maximum is subtracted first
+  output_vertex.mutable_act() << 1.0, 1000.0, 2.0, 1001.0, 3.0, 1002.0;
+
+  output_vertex.Activate();
+
+  double sum = 1.0 + std::exp(1.0) + std::exp(2.0);
+  for (int col = 0; col < 2; ++col) {
+    EXPECT_DOUBLE_EQ(output_vertex.act()(0, col), 1.0 / sum);
+    EXPECT_DOUBLE_EQ(output_vertex.act()(1, col), std::exp(1.0) / sum);
+    EXPECT_DOUBLE_EQ(output_vertex.act()(2, col), std::exp(2.0) / sum);
+  }
+}
+
+TEST(SoftmaxCrossEntropyTest, CalcLossSuccess) {
+  OutputVertexImpl<float, SoftmaxCrossEntropy> output_vertex(0, 3, 2);
+  // The probability of class 0 in the second column underflows
+  output_vertex.mutable_act() << 0.0f, 0.0f, 1.0f, 200.0f, 2.0f, 0.0f;
+  output_vertex.set_loss_path(true);
+  output_vertex.Activate();
+
+  MatrixX<float> one_hot(3, 2);
+  one_hot << 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f;
+  MatrixX<float> class_index(1, 2);
+  class_index << 1.0f, 0.0f;
+
+  // $\log\sum_j e^{z_j}-z_y$ of each column
+  double expected_loss =
+      (std::log(1.0 + std::exp(1.0) + std::exp(2.0)) - 1.0 +
+       200.0 + std::log1p(2.0 * std::exp(-200.0))) /
+      2.0;
+  EXPECT_FLOAT_EQ(output_vertex.CalcLoss(one_hot), expected_loss);
+  EXPECT_FLOAT_EQ(output_vertex.CalcLoss(class_index), expected_loss);
+
+  // Probabilities without logits are clamped inside the log
+  EXPECT_TRUE(std::isfinite(SoftmaxCrossEntropy::CalcLoss<float>(
+      output_vertex.act(), class_index)));
+}
+
+TEST(SoftmaxCrossEntropyTest, CalcLossOffLossPathSuccess) {
+  OutputVertexImpl<double, SoftmaxCrossEntropy> output_vertex(0, 3, 1);
+  output_vertex.mutable_act() << 0.0, 1.0, 2.0;
+  output_vertex.set_loss_path(true);
+  output_vertex.Activate();
+  output_vertex.mutable_act() << 2.0, 1.0, 0.0;
+  output_vertex.set_loss_path(false);
+  output_vertex.Activate();
+
+  // Logits of the loss path are not reused by later passes
+  MatrixX<double> class_index(1, 1);
+  class_index << 0.0;
+  double expected_loss = std::log(1.0 + std::exp(-1.0) + std::exp(-2.0));
+  EXPECT_NEAR(output_vertex.CalcLoss(class_index), expected_loss, 1e-12);
+}
+
+TEST(SoftmaxCrossEntropyTest, CalcDeltaSuccess) {
+  MatrixX<double> logits(4, 3);
+  logits << 0.5, -1.0, 2.0, 0.1, 0.3, -0.2, 1.5, 0.0, -0.7, 0.9, 0.4, 1.1;
+  MatrixX<double> class_index(1, 3);
+  class_index << 3.0, 0.0, 2.0;
+
+  OutputVertexImpl<double, SoftmaxCrossEntropy> output_vertex(0, 4, 3);
+  output_vertex.mutable_act() = logits;
+  output_vertex.Activate();
+  output_vertex.CalcDelta(class_index);
+  MatrixX<double> delta = output_vertex.mutable_delta();
+
+  // One-hot labels give the same delta
+  MatrixX<double> one_hot = MatrixX<double>::Zero(4, 3);
+  one_hot(3, 0) = one_hot(0, 1) = one_hot(2, 2) = 1.0;
+  output_vertex.CalcDelta(one_hot);
+  EXPECT_TRUE(output_vertex.mutable_delta().isApprox(delta));
+
+  // The delta is the gradient of the loss of each column with respect to its
+  // logits
+  constexpr double kEpsilon = 1e-6;
+  for (int row = 0; row < logits.rows(); ++row) {
+    for (int col = 0; col < logits.cols(); ++col) {
+      MatrixX<double> act = logits;
+      act(row, col) += kEpsilon;
+      SoftmaxCrossEntropy::Activate<double>(act);
+      double loss_plus =
+          SoftmaxCrossEntropy::CalcLoss<double>(act, class_index);
+      act = logits;
+      act(row, col) -= kEpsilon;
+      SoftmaxCrossEntropy::Activate<double>(act);
+      double loss_minus =
+          SoftmaxCrossEntropy::CalcLoss<double>(act, class_index);
+      // The loss is averaged over the batch
+      EXPECT_NEAR(delta(row, col),
+                  logits.cols() * (loss_plus - loss_minus) / (2 * kEpsilon),
+                  1e-6);
+    }
+  }
+}
+
+TEST(SoftmaxCrossEntropyTest, DeriveSuccess) {
+  OutputVertexImpl<double, SoftmaxCrossEntropy> output_vertex(0, 3, 1);
+  output_vertex.mutable_act() << 0.2, 0.3, 0.5;
+  output_vertex.mutable_delta() << 1.0, -1.0, 2.0;
+
+  output_vertex.Derive();
+
+  // $\mathcal{D}[a]-aa^T$ times the delta
+  VectorX<double> act(3);
+  act << 0.2, 0.3, 0.5;
+  VectorX<double> delta(3);
+  delta << 1.0, -1.0, 2.0;
+  MatrixX<double> jacobian =
+      MatrixX<double>(act.asDiagonal()) - act * act.transpose();
+  EXPECT_TRUE(output_vertex.mutable_delta().isApprox(jacobian * delta));
+}
+
+} // namespace
+} // namespace intellgraph
@@ -0,0 +1,112 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/edge/vertex/sparse_input_vertex_impl.h"
+
+#include <new>
+
+#include "src/logging.h"
+
+namespace intellgraph {
+
+template <typename T, class Transformer>
+SparseInputVertexImpl<T, Transformer>::SparseInputVertexImpl(int id, int row,
+                                                             int col)
+    : id_(id), row_(row), col_(col) {
+  DCHECK_GE(id_, 0);
+  DCHECK_GT(row, 0);
+  DCHECK_GT(col, 0);
+}
+
+template <typename T, class Transformer>
+SparseInputVertexImpl<T, Transformer>::SparseInputVertexImpl(
+    const VertexParameter &vtx_param, int batch_size)
+    : SparseInputVertexImpl(vtx_param.id(), vtx_param.dims(), batch_size) {}
+
+template <typename T, class Transformer>
+SparseInputVertexImpl<T, Transformer>::~SparseInputVertexImpl() = default;
+
+template <typename T, class Transformer>
+int SparseInputVertexImpl<T, Transformer>::id() const {
+  return id_;
+}
+
+template <typename T, class Transformer>
+int SparseInputVertexImpl<T, Transformer>::row() const {
+  return row_;
+}
+
+template <typename T, class Transformer>
+int SparseInputVertexImpl<T, Transformer>::col() const {
+  return col_;
+}
+
+template <typename T, class Transformer>
+const Eigen::Map<const MatrixX<T>> &
+SparseInputVertexImpl<T, Transformer>::act() const {
+  NOTREACHED();
+  return act_;
+}
+
+template <typename T, class Transformer>
+const Eigen::Map<const SparseMatrix<T>> *
+SparseInputVertexImpl<T, Transformer>::sparse_act() const {
+  DCHECK(feature_map_.outerIndexPtr());
+  return &feature_map_;
+}
+
+template <typename T, class Transformer>
+void SparseInputVertexImpl<T, Transformer>::set_feature(
+    const MatrixX<T> *feature) {
+  NOTREACHED();
+}
+
+template <typename T, class Transformer>
+void SparseInputVertexImpl<T, Transformer>::set_feature(
+    const MatrixX<T> *feature, int offset, int length) {
+  NOTREACHED();
+}
+
+template <typename T, class Transformer>
+void SparseInputVertexImpl<T, Transformer>::set_feature(
+    const Eigen::Map<const MatrixX<T>> &feature) {
+  NOTREACHED();
+}
+
+template <typename T, class Transformer>
+void SparseInputVertexImpl<T, Transformer>::set_feature(
+    const SparseMatrix<T> *feature, int offset, int length) {
+  DCHECK(feature);
+  DCHECK(feature->isCompressed());
+  DCHECK_EQ(row_, feature->rows());
+  DCHECK_GE(offset, 0);
+  DCHECK_GT(length, 0);
+  DCHECK_LE(offset + length, feature->cols());
+
+  IG_TRACE(2) << "SparseInputVertexImpl feeds a feature value.";
+  // Outer indices of the columns are offsets into the inner indices and
+  // values of the whole matrix, so the columns are mapped by shifting the
+  // outer indices only
+  const int *outer_index = feature->outerIndexPtr() + offset;
+  col_ = length;
+  new (&feature_map_) Eigen::Map<const SparseMatrix<T>>(
+      row_, col_, outer_index[length] - outer_index[0], outer_index,
+      feature->innerIndexPtr(), feature->valuePtr());
+}
+
+// Explicitly instantiation
+template class SparseInputVertexImpl<float, SparseTransformer>;
+template class SparseInputVertexImpl<double, SparseTransformer>;
+
+} // namespace intellgraph
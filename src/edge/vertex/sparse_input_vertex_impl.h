@@ -0,0 +1,68 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_EDGE_VERTEX_SPARSE_INPUT_VERTEX_IMPL_H_
+#define INTELLGRAPH_SRC_EDGE_VERTEX_SPARSE_INPUT_VERTEX_IMPL_H_
+
+#include "src/edge/vertex/input_vertex.h"
+#include "src/eigen.h"
+#include "src/proto/vertex_parameter.pb.h"
+
+namespace intellgraph {
+
+// SparseInputVertexImpl feeds compressed sparse features, e.g. one-hot or
+// bag-of-words features of a very high dimension, to SparseDense edges. The
+// feature is kept in its compressed form, so the vertex has no dense
+// activation matrix and dense features are not accepted.
+template <typename T, class Transformer>
+class SparseInputVertexImpl : public InputVertex<T> {
+public:
+  typedef T value_type;
+
+  explicit SparseInputVertexImpl(int id, int row, int col);
+  explicit SparseInputVertexImpl(const VertexParameter &vertex_param,
+                                 int batch_size);
+  ~SparseInputVertexImpl() override;
+
+  int id() const override;
+  int row() const override;
+  int col() const override;
+
+  const Eigen::Map<const MatrixX<T>> &act() const override;
+  const Eigen::Map<const SparseMatrix<T>> *sparse_act() const override;
+  void set_feature(const MatrixX<T> *feature) override;
+  void set_feature(const MatrixX<T> *feature, int offset, int length) override;
+  void set_feature(const Eigen::Map<const MatrixX<T>> &feature) override;
+  void set_feature(const SparseMatrix<T> *feature, int offset,
+                   int length) override;
+
+private:
+  int id_;
+  int row_;
+  int col_;
+
+  Eigen::Map<const MatrixX<T>> act_ =
+      Eigen::Map<const MatrixX<T>>(nullptr, -1, -1);
+  Eigen::Map<const SparseMatrix<T>> feature_map_ =
+      Eigen::Map<const SparseMatrix<T>>(0, 0, 0, nullptr, nullptr, nullptr);
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class SparseInputVertexImpl<float, SparseTransformer>;
+extern template class SparseInputVertexImpl<double, SparseTransformer>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_EDGE_VERTEX_SPARSE_INPUT_VERTEX_IMPL_H_
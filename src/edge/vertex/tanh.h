@@ -0,0 +1,62 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_EDGE_VERTEX_TANH_H_
+#define INTELLGRAPH_SRC_EDGE_VERTEX_TANH_H_
+
+#include "glog/logging.h"
+#include "src/edge/vertex/op_vertex_impl.h"
+#include "src/eigen.h"
+#include "src/kernel/activation.h"
+
+namespace intellgraph {
+
+class Tanh {
+public:
+  Tanh() = default;
+
+  template <typename T> static void Activate(OpVertex<T> &vertex) {
+    Activate<T>(vertex.mutable_act());
+  }
+
+  template <typename T> static void Activate(Eigen::Ref<MatrixX<T>> act) {
+    // Hyperbolic tangent activation function:
+    // $\tanh(z)=(e^z-e^{-z})/(e^z+e^{-z})$
+    ForEachContiguous<T>(act, [](T *data, size_t size) {
+      TanhForward(data, size);
+    });
+  }
+
+  template <typename T> static void Derive(OpVertex<T> &vertex) {
+    Derive<T>(vertex.act(), vertex.mutable_delta());
+  }
+
+  template <typename T>
+  static void Derive(const Eigen::Ref<const MatrixX<T>> &act,
+                     Eigen::Ref<MatrixX<T>> delta) {
+    // Derivative equation:
+    // $d\tanh/dz=1-\tanh^2(z)$
+    ForEachContiguous<T>(act, delta, [](const T *act_data, T *delta_data,
+                                        size_t size) {
+      TanhBackward(act_data, delta_data, size);
+    });
+  }
+
+protected:
+  ~Tanh() = default;
+};
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_EDGE_VERTEX_TANH_H_
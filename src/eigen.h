@@ -16,12 +16,18 @@ Contributor(s):
 #define INTELLGRAPH_SRC_EIGEN_H_
 
 #include "Eigen/Core"
+#include "Eigen/SparseCore"
 
 namespace intellgraph {
 
 template <typename T>
 using MatrixX = ::Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
 template <typename T> using VectorX = ::Eigen::Matrix<T, Eigen::Dynamic, 1>;
+template <typename T> using ArrayX = ::Eigen::Array<T, Eigen::Dynamic, 1>;
+// Column-major like MatrixX, so that a compressed sparse matrix with one
+// example per column stores the nonzero features of each example together
+template <typename T>
+using SparseMatrix = ::Eigen::SparseMatrix<T, Eigen::ColMajor, int>;
 
 } // namespace intellgraph
 
@@ -15,16 +15,25 @@ Contributor(s):
 #ifndef INTELLGRAPH_SRC_GRAPH_GRAPH_H_
 #define INTELLGRAPH_SRC_GRAPH_GRAPH_H_
 
+#include <algorithm>
+#include <map>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "boost/graph/topological_sort.hpp"
 #include "glog/logging.h"
 #include "src/boost.h"
 #include "src/edge.h"
+#include "src/edge/op_vertex.h"
 #include "src/eigen.h"
 #include "src/proto/edge_parameter.pb.h"
 #include "src/proto/graph_parameter.pb.h"
 #include "src/solver.h"
+#include "src/tensor/arena.h"
+#include "src/tensor/memory_planner.h"
+#include "src/tensor/workspace.h"
+#include "src/utility/task_scheduler.h"
 #include "src/visitor.h"
 
 namespace intellgraph {
@@ -49,47 +58,464 @@ public:
   }
   virtual ~Graph() = default;
 
-  // Traverses the graph
+  // Traverses the graph by visiting edges in the compiled forward order, and
+  // then the parameters owned by vertices
+  template <class Visitor> void Traverse(Visitor &visitor) {
+    for (Edge<T> *edge : forward_edges_) {
+      edge->Accept(visitor);
+    }
+    for (Edge<T> *parameters : vertex_parameters_) {
+      parameters->Accept(visitor);
+    }
+  }
+
+  // Traverses the graph reversely by visiting the parameters owned by
+  // vertices, and then edges in the compiled backward order
+  template <class Visitor> void RTraverse(Visitor &visitor) {
+    for (auto it = vertex_parameters_.rbegin(); it != vertex_parameters_.rend();
+         ++it) {
+      (*it)->Accept(visitor);
+    }
+    for (Edge<T> *edge : backward_edges_) {
+      edge->Accept(visitor);
+    }
+  }
+
+  // Propagates through the graph in the compiled forward order. For every
+  // vertex, its first inbound edge is visited by |assign_visitor| and the rest
+  // by |accumulate_visitor|, so that fan-in vertices sum up their inputs
+  // without a separate zero initialization pass. Each vertex is activated
+  // exactly once, right after its last inbound edge has been visited.
+  //
+  // With inter-op threads, a step runs as soon as the steps of all its
+  // producers have finished. Steps only write the activation of their own
+  // vertex, so independent branches run concurrently; visitors must therefore
+  // be safe to share between threads.
+  template <class Visitor>
+  void Propagate(Visitor &assign_visitor, Visitor &accumulate_visitor) {
+    if (task_scheduler_) {
+      task_scheduler_->Run(
+          forward_dependencies_.num_predecessors,
+          forward_dependencies_.successor_offsets,
+          forward_dependencies_.successors, [&](int index) {
+            RunStep(forward_steps_[index], forward_edges_, assign_visitor,
+                    accumulate_visitor);
+            ActivateStep(forward_steps_[index]);
+          });
+      return;
+    }
+    for (const Step &step : forward_steps_) {
+      RunStep(step, forward_edges_, assign_visitor, accumulate_visitor);
+      ActivateStep(step);
+    }
+  }
+
+  // Propagates through the graph in the compiled backward order, the first
+  // outbound edge of each vertex is visited by |assign_visitor|, unless the
+  // delta of the vertex is accumulated, see AccumulateDelta. Each vertex
+  // is derived exactly once, right after its last outbound edge has been
+  // visited; sink vertices are skipped since their deltas are calculated from
+  // labels, and so are source vertices, which are fed rather than activated.
+  // With inter-op threads, a step runs as soon as the steps of all its
+  // consumers have finished.
   template <class Visitor>
-  void Traverse(Visitor &visitor,
-                const std::map<int, std::unique_ptr<Edge<T>>> &edge_by_id) {
+  void BackPropagate(Visitor &assign_visitor, Visitor &accumulate_visitor) {
+    if (task_scheduler_) {
+      task_scheduler_->Run(
+          backward_dependencies_.num_predecessors,
+          backward_dependencies_.successor_offsets,
+          backward_dependencies_.successors, [&](int index) {
+            RunStep(backward_steps_[index], backward_edges_, assign_visitor,
+                    accumulate_visitor);
+            DeriveStep(backward_steps_[index]);
+          });
+      return;
+    }
+    for (const Step &step : backward_steps_) {
+      RunStep(step, backward_edges_, assign_visitor, accumulate_visitor);
+      DeriveStep(step);
+    }
+  }
+
+  // Runs forward and backward passes on |num_threads| threads, including the
+  // calling one. Values less than 2 run the passes sequentially.
+  void SetNumInterOpThreads(int num_threads) {
+    if (num_threads > 1) {
+      task_scheduler_ = std::make_unique<TaskScheduler>(num_threads);
+    } else {
+      task_scheduler_.reset();
+    }
+    // Buffer sharing depends on the execution order, forces new plans
+    for (MemoryPlan &plan : plans_) {
+      plan.capacity = 0;
+    }
+    bound_plan_ = nullptr;
+  }
+
+  // Makes BackPropagate add the delta of the outbound edges of vertex
+  // |vtx_id| onto the delta the vertex holds before the pass rather than
+  // overwriting it, e.g. onto the delta flowing back from the next time step
+  // of a recurrent graph. Must be called after CompileSchedule.
+  void AccumulateDelta(int vtx_id) {
+    for (Step &step : backward_steps_) {
+      if (step.vertex->id() == vtx_id) {
+        step.accumulate = true;
+      }
+    }
+  }
+
+  // Rounds the capacity of vertex buffers up to a power of two batch length
+  // if |batch_bucketing| is true, so that buffers are planned O(log n) times
+  // for batches growing up to n columns
+  void SetBatchBucketing(bool batch_bucketing) {
+    batch_bucketing_ = batch_bucketing;
+  }
+
+  // Returns the number of elements reserved for the buffers of the training
+  // or the |inference| plan, zero if PlanMemory has not planned it yet
+  size_t planned_size(bool inference) const {
+    return plans_[inference].arena.size();
+  }
+
+  virtual void Initialize(Visitor<T> &init_visitor) = 0;
+  virtual void Train(const MatrixX<T> &feature,
+                     const Eigen::Ref<const MatrixX<int>> &labels) = 0;
+  virtual T CalculateLoss(const MatrixX<T> &test_feature,
+                          const MatrixX<int> &test_labels) = 0;
+  virtual void SetSolver(std::unique_ptr<Solver<T>> solver) = 0;
+
+protected:
+  // A vertex together with the contiguous range [edge_begin, edge_end) of its
+  // edges in the corresponding edge schedule
+  struct Step {
+    OpVertex<T> *vertex;
+    size_t edge_begin;
+    size_t edge_end;
+    // Visits every edge by the accumulate visitor
+    bool accumulate = false;
+    // The vertex has no inbound edges
+    bool source = false;
+  };
+
+  // Dependencies between the steps of a schedule, successors of step i are
+  // successors[successor_offsets[i]] to successors[successor_offsets[i + 1]
+  // - 1]
+  struct Dependencies {
+    std::vector<int> num_predecessors;
+    std::vector<int> successor_offsets;
+    std::vector<int> successors;
+  };
+
+  // Compiles the graph topology into flat execution schedules. The forward
+  // schedule lists, for every vertex in topological order, its inbound edges;
+  // the backward schedule lists, for every vertex in reverse topological
+  // order, its outbound edges. Edges of a vertex are therefore contiguous in
+  // both schedules and hot loops run without map lookups or BGL iterators.
+  // Must be called once all vertices and edges have been instantiated.
+  void CompileSchedule(
+      const std::map<int, std::unique_ptr<OpVertex<T>>> &vertex_by_id,
+      const std::map<int, std::unique_ptr<Edge<T>>> &edge_by_id) {
+    forward_edges_.clear();
+    backward_edges_.clear();
+    forward_steps_.clear();
+    backward_steps_.clear();
+    vertex_parameters_.clear();
+
     for (auto it = topological_order_.rbegin(); it != topological_order_.rend();
          ++it) {
       int vtx_id = *it;
-      AdjacencyList::out_edge_iterator edge_it, edge_it_end;
-      for (std::tie(edge_it, edge_it_end) = out_edges(vtx_id, adjacency_list_);
+      if (!vertex_by_id.count(vtx_id)) {
+        // Skips descriptors that are not backed by any vertex
+        continue;
+      }
+      Step step = {vertex_by_id.at(vtx_id).get(), forward_edges_.size(), 0};
+      AdjacencyList::in_edge_iterator edge_it, edge_it_end;
+      for (std::tie(edge_it, edge_it_end) = in_edges(vtx_id, adjacency_list_);
            edge_it != edge_it_end; ++edge_it) {
         int edge_id = adjacency_list_[*edge_it].id;
-        edge_by_id.at(edge_id)->Accept(visitor);
+        Edge<T> *edge = edge_by_id.at(edge_id).get();
+        // The first inbound edge adds the bias, see ForwardVisitor
+        edge->set_owns_bias(forward_edges_.size() == step.edge_begin);
+        forward_edges_.push_back(edge);
+      }
+      step.edge_end = forward_edges_.size();
+      forward_steps_.push_back(step);
+      if (Edge<T> *parameters = step.vertex->parameters()) {
+        vertex_parameters_.push_back(parameters);
       }
     }
-  }
 
-  // Traverses the graph reversely
-  template <class Visitor>
-  void RTraverse(Visitor &visitor,
-                 const std::map<int, std::unique_ptr<Edge<T>>> &edge_by_id) {
     for (int vtx_id : topological_order_) {
-      AdjacencyList::in_edge_iterator edge_it, edge_it_end;
-      for (std::tie(edge_it, edge_it_end) = in_edges(vtx_id, adjacency_list_);
+      if (!vertex_by_id.count(vtx_id)) {
+        continue;
+      }
+      Step step = {vertex_by_id.at(vtx_id).get(), backward_edges_.size(), 0};
+      step.source = in_degree(vtx_id, adjacency_list_) == 0;
+      AdjacencyList::out_edge_iterator edge_it, edge_it_end;
+      for (std::tie(edge_it, edge_it_end) = out_edges(vtx_id, adjacency_list_);
            edge_it != edge_it_end; ++edge_it) {
         int edge_id = adjacency_list_[*edge_it].id;
-        edge_by_id.at(edge_id)->Accept(visitor);
+        backward_edges_.push_back(edge_by_id.at(edge_id).get());
       }
+      step.edge_end = backward_edges_.size();
+      backward_steps_.push_back(step);
     }
+
+    // A forward step depends on the steps of the vertices it consumes, and a
+    // backward step on the steps of the vertices consuming it
+    forward_dependencies_ = CompileDependencies(forward_steps_, false);
+    backward_dependencies_ = CompileDependencies(backward_steps_, true);
   }
 
-  virtual void Initialize(Visitor<T> &init_visitor) = 0;
-  virtual void Train(const MatrixX<T> &feature,
-                     const Eigen::Ref<const MatrixX<int>> &labels) = 0;
-  virtual T CalculateLoss(const MatrixX<T> &test_feature,
-                          const MatrixX<int> &test_labels) = 0;
-  virtual void SetSolver(std::unique_ptr<Solver<T>> solver) = 0;
+  // Plans activation and delta buffers of every computed vertex for batches
+  // of |length| columns, packs them into an arena and binds the vertices to
+  // their slices. Source vertices are fed externally and need no buffers.
+  //
+  // For training, all buffers stay live during the whole pass since
+  // activations and deltas are consumed when calculating nablas. For
+  // |inference|, deltas are released and an activation only lives from the
+  // step that computes it until the last step that consumes it, so that
+  // activations with disjoint lifetimes share storage, unless inter-op threads
+  // may run steps out of the schedule order.
+  //
+  // Training and inference plans are kept in arenas of their own, so that
+  // inference between training steps runs with shared activations at the
+  // cost of the smaller inference arena, and switching between them only
+  // rebinds the vertices. Each plan is planned for a capacity, the largest
+  // batch length it has seen so far. Within the capacity, a new length
+  // neither plans nor allocates: vertices are only bound to views of their
+  // planned slices sized to the batch.
+  void PlanMemory(int length, bool inference) {
+    DCHECK_GT(length, 0);
+    MemoryPlan &plan = plans_[inference];
+    if (length > plan.capacity) {
+      plan.capacity = BatchCapacity(std::max(length, plan.capacity));
+
+      MemoryPlanner planner(Arena<T>::kStride);
+      std::vector<int> act_buffers;
+      std::vector<int> delta_buffers;
+      AddBuffers(plan.capacity, inference, inference && !task_scheduler_,
+                 &planner, &act_buffers, &delta_buffers);
+      plan.arena.Reserve(planner.Plan());
+
+      T *data = plan.arena.data();
+      plan.buffers.assign(forward_steps_.size(), {nullptr, nullptr});
+      for (size_t i = 0; i < forward_steps_.size(); ++i) {
+        if (act_buffers[i] >= 0) {
+          plan.buffers[i].first = data + planner.offset(act_buffers[i]);
+        }
+        if (delta_buffers[i] >= 0) {
+          plan.buffers[i].second = data + planner.offset(delta_buffers[i]);
+        }
+      }
+      bound_plan_ = nullptr;
+    }
+
+    if (&plan == bound_plan_ && length == planned_length_) {
+      return;
+    }
+    bound_plan_ = &plan;
+    planned_length_ = length;
+    for (size_t i = 0; i < forward_steps_.size(); ++i) {
+      if (plan.buffers[i].first) {
+        forward_steps_[i].vertex->BindBuffers(
+            plan.buffers[i].first, plan.buffers[i].second, length);
+      }
+    }
+  }
+
+  // Lays out activations of every computed vertex for batches of |length|
+  // columns in |workspace|, in the same way as an inference plan of the graph.
+  // Like PlanMemory, the workspace is only laid out again when |length|
+  // exceeds its capacity, otherwise its activations are resized in place.
+  void PlanWorkspace(int length, Workspace<T> *workspace) const {
+    DCHECK_GT(length, 0);
+    DCHECK(workspace);
+    if (!workspace->IsPlannedFor(workspace_key_, length)) {
+      int capacity = BatchCapacity(length);
+      MemoryPlanner planner(Arena<T>::kStride);
+      std::vector<int> act_buffers;
+      std::vector<int> delta_buffers;
+      AddBuffers(capacity, true, true, &planner, &act_buffers, &delta_buffers);
+      T *data = workspace->Reserve(workspace_key_, capacity, planner.Plan());
+      for (size_t i = 0; i < forward_steps_.size(); ++i) {
+        if (act_buffers[i] < 0) {
+          continue;
+        }
+        OpVertex<T> *vertex = forward_steps_[i].vertex;
+        workspace->Bind(vertex->id(), data + planner.offset(act_buffers[i]),
+                        vertex->row(), capacity);
+      }
+    }
+    workspace->Resize(length);
+  }
+
+  // Returns the number of columns to plan buffers for batches of |length|
+  // columns
+  int BatchCapacity(int length) const {
+    if (!batch_bucketing_) {
+      return length;
+    }
+    int capacity = 1;
+    while (capacity < length) {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  // Propagates through the graph in the compiled forward order like
+  // Propagate, but calls |activate| with each computed vertex instead of
+  // activating it. Steps always run sequentially on the calling thread, so
+  // that concurrent calls with visitors and callbacks that do not modify the
+  // graph are safe.
+  template <class Visitor, class Callback>
+  void Propagate(Visitor &assign_visitor, Visitor &accumulate_visitor,
+                 Callback &&activate) const {
+    for (const Step &step : forward_steps_) {
+      if (step.edge_begin == step.edge_end) {
+        continue;
+      }
+      RunStep(step, forward_edges_, assign_visitor, accumulate_visitor);
+      activate(step.vertex);
+    }
+  }
+
+  // Compiled execution schedules
+  std::vector<Edge<T> *> forward_edges_;
+  std::vector<Edge<T> *> backward_edges_;
+  // Parameters owned by vertices, in the forward order of the vertices
+  std::vector<Edge<T> *> vertex_parameters_;
+  std::vector<Step> forward_steps_;
+  std::vector<Step> backward_steps_;
 
 private:
+  template <class Visitor>
+  static void RunStep(const Step &step, const std::vector<Edge<T> *> &edges,
+                      Visitor &assign_visitor, Visitor &accumulate_visitor) {
+    for (size_t i = step.edge_begin; i < step.edge_end; ++i) {
+      edges[i]->Accept(i == step.edge_begin && !step.accumulate
+                           ? assign_visitor
+                           : accumulate_visitor);
+    }
+  }
+
+  static void ActivateStep(const Step &step) {
+    if (step.edge_begin != step.edge_end) {
+      step.vertex->Activate();
+    }
+  }
+
+  static void DeriveStep(const Step &step) {
+    if (step.edge_begin != step.edge_end && !step.source) {
+      step.vertex->Derive();
+    }
+  }
+
+  // Registers buffers of every computed vertex for batches of |length|
+  // columns in |planner|, and returns their indices by forward step, or -1 if
+  // the step needs no buffer. Delta buffers are only registered unless
+  // |inference|. All buffers live during the whole pass, unless |share|, in
+  // which case an activation only lives from the step that computes it until
+  // the last step that consumes it.
+  void AddBuffers(int length, bool inference, bool share,
+                  MemoryPlanner *planner, std::vector<int> *act_buffers,
+                  std::vector<int> *delta_buffers) const {
+    std::map<int, int> step_by_vertex_id;
+    for (size_t i = 0; i < forward_steps_.size(); ++i) {
+      step_by_vertex_id[forward_steps_[i].vertex->id()] = i;
+    }
+    int last_step = forward_steps_.size() - 1;
+
+    act_buffers->assign(forward_steps_.size(), -1);
+    delta_buffers->assign(forward_steps_.size(), -1);
+    for (size_t i = 0; i < forward_steps_.size(); ++i) {
+      const Step &step = forward_steps_[i];
+      if (step.edge_begin == step.edge_end) {
+        continue;
+      }
+      size_t size = static_cast<size_t>(step.vertex->row()) * length;
+      if (!inference) {
+        (*delta_buffers)[i] = planner->AddBuffer(size, 0, last_step);
+      }
+      if (!share) {
+        (*act_buffers)[i] = planner->AddBuffer(size, 0, last_step);
+        continue;
+      }
+      // Sinks are live until the end, so that their activations can be read
+      int last_use = last_step;
+      AdjacencyList::out_edge_iterator edge_it, edge_it_end;
+      std::tie(edge_it, edge_it_end) =
+          out_edges(step.vertex->id(), adjacency_list_);
+      if (edge_it != edge_it_end) {
+        last_use = i;
+        for (; edge_it != edge_it_end; ++edge_it) {
+          int vtx_out_id = target(*edge_it, adjacency_list_);
+          last_use = std::max(last_use, step_by_vertex_id.at(vtx_out_id));
+        }
+      }
+      (*act_buffers)[i] = planner->AddBuffer(size, i, last_use);
+    }
+  }
+
+  Dependencies CompileDependencies(const std::vector<Step> &steps,
+                                   bool backward) {
+    std::map<int, int> step_by_vertex_id;
+    for (size_t i = 0; i < steps.size(); ++i) {
+      step_by_vertex_id[steps[i].vertex->id()] = i;
+    }
+    Dependencies dependencies;
+    dependencies.successor_offsets.push_back(0);
+    for (const Step &step : steps) {
+      int vtx_id = step.vertex->id();
+      dependencies.num_predecessors.push_back(
+          backward ? out_degree(vtx_id, adjacency_list_)
+                   : in_degree(vtx_id, adjacency_list_));
+      if (backward) {
+        AdjacencyList::in_edge_iterator edge_it, edge_it_end;
+        for (std::tie(edge_it, edge_it_end) = in_edges(vtx_id, adjacency_list_);
+             edge_it != edge_it_end; ++edge_it) {
+          dependencies.successors.push_back(
+              step_by_vertex_id.at(source(*edge_it, adjacency_list_)));
+        }
+      } else {
+        AdjacencyList::out_edge_iterator edge_it, edge_it_end;
+        for (std::tie(edge_it, edge_it_end) =
+                 out_edges(vtx_id, adjacency_list_);
+             edge_it != edge_it_end; ++edge_it) {
+          dependencies.successors.push_back(
+              step_by_vertex_id.at(target(*edge_it, adjacency_list_)));
+        }
+      }
+      dependencies.successor_offsets.push_back(dependencies.successors.size());
+    }
+    return dependencies;
+  }
+
   // Graph topology
   AdjacencyList adjacency_list_;
   std::vector<int> topological_order_;
+
+  // Inter-op parallel execution
+  Dependencies forward_dependencies_;
+  Dependencies backward_dependencies_;
+  std::unique_ptr<TaskScheduler> task_scheduler_;
+
+  // Storage of vertex activations and deltas planned by PlanMemory
+  struct MemoryPlan {
+    Arena<T> arena;
+    // Activation and delta slices of every forward step, nullptr if unplanned
+    std::vector<std::pair<T *, T *>> buffers;
+    // Largest batch length the arena is planned for
+    int capacity = 0;
+  };
+  // Training and inference plans, indexed by whether they are for inference
+  MemoryPlan plans_[2];
+  // Plan and batch length vertices are currently bound to
+  const MemoryPlan *bound_plan_ = nullptr;
+  int planned_length_ = 0;
+  bool batch_bucketing_ = false;
+  // Identifies the workspaces laid out by this graph
+  const uint64_t workspace_key_ = NewWorkspaceKey();
 };
 
 } // namespace intellgraph
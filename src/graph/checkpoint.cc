@@ -0,0 +1,244 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/graph/checkpoint.h"
+
+#include <cstring>
+#include <fstream>
+
+#include "glog/logging.h"
+#include "src/utility/util.h"
+
+namespace intellgraph {
+namespace {
+
+constexpr char kMagic[8] = "IGCKPT";
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t scalar_size;
+  uint64_t topology_size;
+  uint64_t num_blobs;
+};
+
+struct BlobEntry {
+  uint32_t type;
+  int32_t id;
+  int32_t index;
+  int32_t row;
+  int32_t col;
+  uint32_t reserved;
+  uint64_t offset;
+};
+
+uint64_t Align(uint64_t offset) {
+  return (offset + kCheckpointAlignment - 1) / kCheckpointAlignment *
+         kCheckpointAlignment;
+}
+
+// Number of scalars of a blob that holds a count
+template <typename T> constexpr int CountRows() {
+  return (sizeof(int64_t) + sizeof(T) - 1) / sizeof(T);
+}
+
+} // namespace
+
+template <typename T>
+CheckpointWriter<T>::CheckpointWriter(const GraphParameter &graph_parameter)
+    : graph_parameter_(graph_parameter) {}
+
+template <typename T> CheckpointWriter<T>::~CheckpointWriter() = default;
+
+template <typename T>
+void CheckpointWriter<T>::AddBlob(CheckpointBlob type, int id, int index,
+                                  const T *data, int row, int col) {
+  DCHECK(data);
+  DCHECK_GT(row, 0);
+  DCHECK_GT(col, 0);
+  blobs_.push_back({type, id, index, data, row, col});
+}
+
+template <typename T>
+void CheckpointWriter<T>::AddCount(CheckpointBlob type, int64_t count) {
+  static_assert(CountRows<T>() * sizeof(T) == sizeof(int64_t),
+                "Counts must fill whole scalars");
+  counts_.push_back(count);
+  AddBlob(type, 0, 0, reinterpret_cast<const T *>(&counts_.back()),
+          CountRows<T>(), 1);
+}
+
+template <typename T>
+bool CheckpointWriter<T>::Write(const std::string &path) const {
+  std::string topology = graph_parameter_.SerializeAsString();
+
+  Header header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kCheckpointVersion;
+  header.scalar_size = sizeof(T);
+  header.topology_size = topology.size();
+  header.num_blobs = blobs_.size();
+
+  // Lays out blobs after the table
+  std::vector<BlobEntry> entries;
+  uint64_t offset = sizeof(Header) + topology.size() +
+                    blobs_.size() * sizeof(BlobEntry);
+  for (const Blob &blob : blobs_) {
+    offset = Align(offset);
+    entries.push_back({EnumToNumber(blob.type), blob.id, blob.index, blob.row,
+                       blob.col, 0, offset});
+    offset += static_cast<uint64_t>(blob.row) * blob.col * sizeof(T);
+  }
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(topology.data(), topology.size());
+  file.write(reinterpret_cast<const char *>(entries.data()),
+             entries.size() * sizeof(BlobEntry));
+  const char padding[kCheckpointAlignment] = {};
+  uint64_t position = sizeof(Header) + topology.size() +
+                      entries.size() * sizeof(BlobEntry);
+  for (size_t i = 0; i < blobs_.size(); ++i) {
+    size_t bytes =
+        static_cast<size_t>(blobs_[i].row) * blobs_[i].col * sizeof(T);
+    file.write(padding, entries[i].offset - position);
+    file.write(reinterpret_cast<const char *>(blobs_[i].data), bytes);
+    position = entries[i].offset + bytes;
+  }
+  file.close();
+  if (!file) {
+    LOG(ERROR) << "Failed to write the checkpoint " << path << ".";
+    return false;
+  }
+  return true;
+}
+
+template <typename T>
+std::unique_ptr<CheckpointReader<T>>
+CheckpointReader<T>::Open(const std::string &path) {
+  std::unique_ptr<MappedFile> file = MappedFile::Open(path);
+  if (!file) {
+    return nullptr;
+  }
+  std::unique_ptr<CheckpointReader<T>> reader(
+      new CheckpointReader<T>(std::move(file)));
+  if (!reader->Parse()) {
+    LOG(ERROR) << path << " is not a valid checkpoint.";
+    return nullptr;
+  }
+  return reader;
+}
+
+template <typename T>
+CheckpointReader<T>::CheckpointReader(std::unique_ptr<MappedFile> file)
+    : file_(std::move(file)) {}
+
+template <typename T> CheckpointReader<T>::~CheckpointReader() = default;
+
+template <typename T> bool CheckpointReader<T>::Parse() {
+  const char *data = file_->data();
+  uint64_t size = file_->size();
+
+  Header header;
+  if (size < sizeof(header)) {
+    return false;
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kCheckpointVersion ||
+      header.scalar_size != sizeof(T)) {
+    LOG(ERROR) << "Unsupported checkpoint version " << header.version
+               << " or scalar size " << header.scalar_size << ".";
+    return false;
+  }
+
+  uint64_t offset = sizeof(header);
+  if (header.topology_size > size - offset ||
+      !graph_parameter_.ParseFromArray(data + offset, header.topology_size)) {
+    return false;
+  }
+  offset += header.topology_size;
+
+  if (header.num_blobs > (size - offset) / sizeof(BlobEntry)) {
+    return false;
+  }
+  for (uint64_t i = 0; i < header.num_blobs; ++i) {
+    BlobEntry entry;
+    std::memcpy(&entry, data + offset + i * sizeof(entry), sizeof(entry));
+    if (entry.row <= 0 || entry.col <= 0 ||
+        entry.offset % kCheckpointAlignment != 0 || entry.offset > size ||
+        static_cast<uint64_t>(entry.row) * entry.col >
+            (size - entry.offset) / sizeof(T)) {
+      return false;
+    }
+    T *blob_data = reinterpret_cast<T *>(file_->data() + entry.offset);
+    blobs_.try_emplace({static_cast<CheckpointBlob>(entry.type), entry.id,
+                        entry.index},
+                       Blob{blob_data, entry.row, entry.col});
+  }
+  return true;
+}
+
+template <typename T>
+T *CheckpointReader<T>::blob(CheckpointBlob type, int id, int index, int row,
+                             int col) {
+  auto iter = blobs_.find({type, id, index});
+  if (iter == blobs_.end()) {
+    LOG(ERROR) << "Blob " << index << " of type " << EnumToNumber(type)
+               << " of " << id << " is missing.";
+    return nullptr;
+  }
+  const Blob &blob = iter->second;
+  if (blob.row != row || blob.col != col) {
+    LOG(ERROR) << "Blob " << index << " of type " << EnumToNumber(type)
+               << " of " << id << " is " << blob.row << "x" << blob.col
+               << " instead of " << row << "x" << col << ".";
+    return nullptr;
+  }
+  return blob.data;
+}
+
+template <typename T>
+int CheckpointReader<T>::num_blobs(CheckpointBlob type, int id) const {
+  int count = 0;
+  while (blobs_.count({type, id, count}) != 0) {
+    ++count;
+  }
+  return count;
+}
+
+template <typename T>
+bool CheckpointReader<T>::count(CheckpointBlob type, int64_t *count) const {
+  DCHECK(count);
+  auto iter = blobs_.find({type, 0, 0});
+  if (iter == blobs_.end()) {
+    return false;
+  }
+  const Blob &blob = iter->second;
+  if (blob.row != CountRows<T>() || blob.col != 1) {
+    LOG(ERROR) << "Count of type " << EnumToNumber(type) << " is "
+               << blob.row << "x" << blob.col << ".";
+    return false;
+  }
+  std::memcpy(count, blob.data, sizeof(*count));
+  return true;
+}
+
+// Explicit instantiation
+template class CheckpointWriter<float>;
+template class CheckpointWriter<double>;
+template class CheckpointReader<float>;
+template class CheckpointReader<double>;
+
+} // namespace intellgraph
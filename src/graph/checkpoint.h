@@ -0,0 +1,149 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_GRAPH_CHECKPOINT_H_
+#define INTELLGRAPH_SRC_GRAPH_CHECKPOINT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "src/proto/graph_parameter.pb.h"
+#include "src/utility/mapped_file.h"
+
+namespace intellgraph {
+
+// A checkpoint file holds a trained graph in native byte order:
+//   - a header with a magic string, the format version, the size of a scalar,
+//     the size of the topology and the number of blobs
+//   - the topology, i.e. the GraphParameter serialized by protobuf
+//   - a table with the type, owner id, index, shape and file offset of every
+//     blob
+//   - the blobs, column-major matrices that each start at a multiple of
+//     kCheckpointAlignment bytes
+// Blobs are aligned in the file, so that a mapped checkpoint can be used in
+// place by vectorized code.
+constexpr uint32_t kCheckpointVersion = 1;
+constexpr size_t kCheckpointAlignment = 64;
+
+enum class CheckpointBlob : uint32_t {
+  // Weight of an edge
+  kWeight = 0,
+  // Bias of a vertex
+  kBias = 1,
+  // Solver state of an edge, see Edge::mutable_weight_stores
+  kWeightStore = 2,
+  kBiasStore = 3,
+  // Parameters held by a vertex and their solver state, see
+  // OpVertex::parameters
+  kVertexWeight = 4,
+  kVertexBias = 5,
+  kVertexWeightStore = 6,
+  kVertexBiasStore = 7,
+  // Steps taken by the solver, see Solver::num_steps, and by its learning
+  // rate schedule, see LrScheduler::step. Counts, see AddCount.
+  kSolverStep = 8,
+  kSchedulerStep = 9,
+};
+
+// CheckpointWriter collects blobs of a graph and writes them with the
+// topology into a checkpoint file
+template <typename T> class CheckpointWriter {
+public:
+  explicit CheckpointWriter(const GraphParameter &graph_parameter);
+  ~CheckpointWriter();
+
+  // Adds the |row| x |col| matrix |data| as blob |index| of |type| owned by
+  // the edge or vertex |id|. |data| is only read by Write.
+  void AddBlob(CheckpointBlob type, int id, int index, const T *data, int row,
+               int col);
+  // Adds |count| as the blob of |type| owned by id 0. Counts are kept in the
+  // bytes of the blob rather than as scalars, so that they are exact
+  // whatever the scalar type.
+  void AddCount(CheckpointBlob type, int64_t count);
+
+  // Writes the checkpoint, returns false if the file cannot be written
+  bool Write(const std::string &path) const;
+
+private:
+  struct Blob {
+    CheckpointBlob type;
+    int id;
+    int index;
+    const T *data;
+    int row;
+    int col;
+  };
+
+  const GraphParameter &graph_parameter_;
+  std::vector<Blob> blobs_;
+  // Storage of the counts, which does not move as counts are added
+  std::deque<int64_t> counts_;
+};
+
+// CheckpointReader maps a checkpoint file into memory and validates it.
+// Blobs point into the mapping, which lives as long as the reader.
+template <typename T> class CheckpointReader {
+public:
+  // Returns nullptr if the file cannot be mapped or is not a valid checkpoint
+  // of |T| scalars
+  static std::unique_ptr<CheckpointReader<T>> Open(const std::string &path);
+  ~CheckpointReader();
+
+  CheckpointReader(const CheckpointReader &) = delete;
+  CheckpointReader &operator=(const CheckpointReader &) = delete;
+
+  const GraphParameter &graph_parameter() const { return graph_parameter_; }
+
+  // Returns blob |index| of |type| owned by |id| if it exists with a shape
+  // of |row| x |col|, or nullptr otherwise
+  T *blob(CheckpointBlob type, int id, int index, int row, int col);
+
+  // Returns the number of blobs of |type| owned by |id|
+  int num_blobs(CheckpointBlob type, int id) const;
+
+  // Reads the count of |type| added by CheckpointWriter::AddCount into
+  // |count|, returns false if the checkpoint has none
+  bool count(CheckpointBlob type, int64_t *count) const;
+
+private:
+  struct Blob {
+    T *data;
+    int row;
+    int col;
+  };
+
+  explicit CheckpointReader(std::unique_ptr<MappedFile> file);
+  bool Parse();
+
+  std::unique_ptr<MappedFile> file_;
+  GraphParameter graph_parameter_;
+  std::map<std::tuple<CheckpointBlob, int, int>, Blob> blobs_;
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class CheckpointWriter<float>;
+extern template class CheckpointWriter<double>;
+extern template class CheckpointReader<float>;
+extern template class CheckpointReader<double>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_GRAPH_CHECKPOINT_H_
@@ -0,0 +1,224 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/graph/checkpoint.h"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "google/protobuf/text_format.h"
+#include "src/eigen.h"
+#include "src/graph/classifier_impl.h"
+#include "src/proto/graph_parameter.pb.h"
+#include "src/registry.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+constexpr char kGraphParameter[] = R"(
+  solver_config { type: "SGD" eta: 0.5 lambda: 0.0 }
+  length: 4
+  input_vertex_param { id: 0 type: INPUT operation: "DummyTransformer" dims: 2 }
+  output_vertex_param { id: 2 type: OUTPUT operation: "CrossEntropy" dims: 1 }
+  intermediate_vertex_params { id: 1 type: HIDDEN operation: "Tanh" dims: 3 }
+  edge_params { id: 0 type: "Dense" vertex_in_id: 0 vertex_out_id: 1 }
+  edge_params { id: 1 type: "Dense" vertex_in_id: 1 vertex_out_id: 2 }
+  edge_params { id: 2 type: "Dense" vertex_in_id: 0 vertex_out_id: 2 }
+)";
+
+class CheckpointTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    Registry::LoadRegistry();
+    ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(
+        kGraphParameter, &graph_parameter_));
+    feature_.resize(2, 4);
+    feature_ << 0.0, 0.0, 1.0, 1.0, 0.0, 1.0, 0.0, 1.0;
+    labels_.resize(1, 4);
+    labels_ << 0, 1, 1, 0;
+    path_ = ::testing::TempDir() + "checkpoint_test.igckpt";
+  }
+
+  void TearDown() override { std::remove(path_.c_str()); }
+
+  GraphParameter graph_parameter_;
+  MatrixX<double> feature_;
+  MatrixX<int> labels_;
+  std::string path_;
+};
+
+TEST_F(CheckpointTest, SaveAndLoadSuccess) {
+  ClassifierImpl<double> classifier(graph_parameter_);
+  for (int i = 0; i < 10; ++i) {
+    classifier.Train(feature_, labels_);
+  }
+  MatrixX<double> expected_result = classifier.GetProbabilityDist(feature_);
+  ASSERT_TRUE(classifier.SaveCheckpoint(path_));
+
+  std::unique_ptr<ClassifierImpl<double>> loaded_classifier =
+      ClassifierImpl<double>::LoadCheckpoint(path_);
+  ASSERT_TRUE(loaded_classifier);
+  EXPECT_EQ(loaded_classifier->GetProbabilityDist(feature_), expected_result);
+
+  // Training a loaded classifier copies the pages it writes, the file is left
+  // untouched
+  for (int i = 0; i < 10; ++i) {
+    loaded_classifier->Train(feature_, labels_);
+  }
+  EXPECT_NE(loaded_classifier->GetProbabilityDist(feature_), expected_result);
+  std::unique_ptr<ClassifierImpl<double>> reloaded_classifier =
+      ClassifierImpl<double>::LoadCheckpoint(path_);
+  ASSERT_TRUE(reloaded_classifier);
+  EXPECT_EQ(reloaded_classifier->GetProbabilityDist(feature_),
+            expected_result);
+}
+
+// Gate parameters of the recurrent vertex are held by the vertex rather than
+// by an edge, and are saved with their solver stores all the same
+TEST_F(CheckpointTest, VertexParametersSuccess) {
+  GraphParameter graph_parameter;
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(R"(
+    solver_config { type: "Momentum" eta: 0.5 lambda: 0.0 }
+    length: 2
+    input_vertex_param { id: 0 type: INPUT operation: "DummyTransformer"
+                         dims: 2 }
+    output_vertex_param { id: 2 type: OUTPUT operation: "CrossEntropy"
+                          dims: 1 }
+    intermediate_vertex_params { id: 1 type: HIDDEN operation: "Lstm"
+                                 dims: 3 }
+    edge_params { id: 0 type: "Dense" vertex_in_id: 0 vertex_out_id: 1 }
+    edge_params { id: 1 type: "Dense" vertex_in_id: 1 vertex_out_id: 2 }
+  )", &graph_parameter));
+  ClassifierImpl<double> classifier(graph_parameter);
+  for (int i = 0; i < 10; ++i) {
+    classifier.Train(feature_, labels_);
+  }
+  ASSERT_TRUE(classifier.SaveCheckpoint(path_));
+
+  std::unique_ptr<ClassifierImpl<double>> loaded_classifier =
+      ClassifierImpl<double>::LoadCheckpoint(path_);
+  ASSERT_TRUE(loaded_classifier);
+  EXPECT_EQ(loaded_classifier->GetProbabilityDist(feature_),
+            classifier.GetProbabilityDist(feature_));
+
+  // Momentum carries over, so that training resumes where it stopped
+  classifier.Train(feature_, labels_);
+  loaded_classifier->Train(feature_, labels_);
+  EXPECT_EQ(loaded_classifier->GetProbabilityDist(feature_),
+            classifier.GetProbabilityDist(feature_));
+}
+
+// Bias corrections of Adam and the learning rate schedule depend on the
+// number of steps taken, which is saved as well
+TEST_F(CheckpointTest, SolverStepsSuccess) {
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(
+      "type: 'Adam' eta: 0.05 schedule { type: 'Step' step_size: 4 "
+      "gamma: 0.5 warmup_steps: 2 }",
+      graph_parameter_.mutable_solver_config()));
+  ClassifierImpl<double> classifier(graph_parameter_);
+  for (int i = 0; i < 10; ++i) {
+    classifier.Train(feature_, labels_);
+  }
+  ASSERT_TRUE(classifier.SaveCheckpoint(path_));
+
+  std::unique_ptr<ClassifierImpl<double>> loaded_classifier =
+      ClassifierImpl<double>::LoadCheckpoint(path_);
+  ASSERT_TRUE(loaded_classifier);
+  for (int i = 0; i < 3; ++i) {
+    classifier.Train(feature_, labels_);
+    loaded_classifier->Train(feature_, labels_);
+  }
+  EXPECT_EQ(loaded_classifier->GetProbabilityDist(feature_),
+            classifier.GetProbabilityDist(feature_));
+}
+
+TEST_F(CheckpointTest, LoadFailure) {
+  EXPECT_FALSE(ClassifierImpl<double>::LoadCheckpoint(path_));
+
+  ClassifierImpl<double> classifier(graph_parameter_);
+  ASSERT_TRUE(classifier.SaveCheckpoint(path_));
+  // Scalars are doubles
+  EXPECT_FALSE(ClassifierImpl<float>::LoadCheckpoint(path_));
+
+  // Truncates the last blob
+  std::ifstream input(path_, std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(input)),
+                      std::istreambuf_iterator<char>());
+  input.close();
+  std::ofstream output(path_, std::ios::binary | std::ios::trunc);
+  output.write(content.data(), content.size() - 1);
+  output.close();
+  EXPECT_FALSE(ClassifierImpl<double>::LoadCheckpoint(path_));
+}
+
+TEST(CheckpointReaderTest, BlobSuccess) {
+  GraphParameter graph_parameter;
+  graph_parameter.set_length(3);
+  MatrixX<float> weight = MatrixX<float>::Random(3, 5);
+  VectorX<float> bias = VectorX<float>::Random(7);
+  CheckpointWriter<float> writer(graph_parameter);
+  writer.AddBlob(CheckpointBlob::kWeight, 4, 0, weight.data(), 3, 5);
+  writer.AddBlob(CheckpointBlob::kBias, 4, 0, bias.data(), 7, 1);
+  writer.AddBlob(CheckpointBlob::kWeightStore, 4, 0, weight.data(), 3, 5);
+  writer.AddBlob(CheckpointBlob::kWeightStore, 4, 1, weight.data(), 3, 5);
+  std::string path = ::testing::TempDir() + "checkpoint_reader_test.igckpt";
+  ASSERT_TRUE(writer.Write(path));
+
+  std::unique_ptr<CheckpointReader<float>> reader =
+      CheckpointReader<float>::Open(path);
+  ASSERT_TRUE(reader);
+  EXPECT_EQ(reader->graph_parameter().length(), 3);
+
+  float *weight_blob = reader->blob(CheckpointBlob::kWeight, 4, 0, 3, 5);
+  ASSERT_TRUE(weight_blob);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(weight_blob) % kCheckpointAlignment,
+            0);
+  EXPECT_EQ(Eigen::Map<MatrixX<float>>(weight_blob, 3, 5), weight);
+  float *bias_blob = reader->blob(CheckpointBlob::kBias, 4, 0, 7, 1);
+  ASSERT_TRUE(bias_blob);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(bias_blob) % kCheckpointAlignment, 0);
+  EXPECT_EQ(Eigen::Map<VectorX<float>>(bias_blob, 7), bias);
+
+  EXPECT_EQ(reader->num_blobs(CheckpointBlob::kWeightStore, 4), 2);
+  EXPECT_EQ(reader->num_blobs(CheckpointBlob::kBiasStore, 4), 0);
+  // Shapes must match
+  EXPECT_FALSE(reader->blob(CheckpointBlob::kWeight, 4, 0, 5, 3));
+  EXPECT_FALSE(reader->blob(CheckpointBlob::kWeight, 3, 0, 3, 5));
+  std::remove(path.c_str());
+}
+
+// Counts are exact beyond the integers a float represents
+TEST(CheckpointReaderTest, CountSuccess) {
+  GraphParameter graph_parameter;
+  CheckpointWriter<float> writer(graph_parameter);
+  int64_t count = (int64_t{1} << 40) + 3;
+  writer.AddCount(CheckpointBlob::kSolverStep, count);
+  std::string path = ::testing::TempDir() + "checkpoint_count_test.igckpt";
+  ASSERT_TRUE(writer.Write(path));
+
+  std::unique_ptr<CheckpointReader<float>> reader =
+      CheckpointReader<float>::Open(path);
+  ASSERT_TRUE(reader);
+  int64_t read_count = 0;
+  EXPECT_TRUE(reader->count(CheckpointBlob::kSolverStep, &read_count));
+  EXPECT_EQ(read_count, count);
+  EXPECT_FALSE(reader->count(CheckpointBlob::kSchedulerStep, &read_count));
+  std::remove(path.c_str());
+}
+
+} // namespace
+} // namespace intellgraph
@@ -14,27 +14,83 @@ Contributor(s):
 ==============================================================================*/
 #include "src/graph/classifier_impl.h"
 
+#include <algorithm>
+#include <cstdint>
+
 #include "boost/graph/adjacency_list.hpp"
 #include "glog/logging.h"
 #include "src/factory.h"
 #include "src/proto/graph_parameter.pb.h"
 #include "src/proto/vertex_parameter.pb.h"
-#include "src/visitor/backward_visitor.h"
-#include "src/visitor/forward_visitor.h"
-#include "src/visitor/init_vertex_visitor.h"
-#include "src/visitor/resize_vertex_visitor.h"
+#include "src/visitor/predict_visitor.h"
 
 namespace intellgraph {
 
+namespace {
+
+// Adds the solver stores of |edge|, which are saved as blobs of
+// |weight_type| and |bias_type| owned by |id|. Empty stores are skipped.
+template <typename T>
+void AddStoreBlobs(CheckpointBlob weight_type, CheckpointBlob bias_type,
+                   int id, Edge<T> *edge, CheckpointWriter<T> *writer) {
+  for (int i = 0; i < edge->num_weight_stores(); ++i) {
+    writer->AddBlob(weight_type, id, i, edge->mutable_weight_stores(i).data(),
+                    edge->row(), edge->col());
+  }
+  for (int i = 0; i < edge->num_bias_stores(); ++i) {
+    Eigen::Map<MatrixX<T>> bias_store = edge->mutable_bias_stores(i);
+    if (bias_store.size() > 0) {
+      writer->AddBlob(bias_type, id, i, bias_store.data(), bias_store.rows(),
+                      bias_store.cols());
+    }
+  }
+}
+
+// Copies the solver stores saved by AddStoreBlobs back into |edge|, returns
+// false if a store does not match the shape of |edge|
+template <typename T>
+bool BindStoreBlobs(CheckpointBlob weight_type, CheckpointBlob bias_type,
+                    int id, CheckpointReader<T> *checkpoint, Edge<T> *edge) {
+  int num_weight_stores = checkpoint->num_blobs(weight_type, id);
+  for (int i = 0; i < num_weight_stores; ++i) {
+    T *weight_store =
+        checkpoint->blob(weight_type, id, i, edge->row(), edge->col());
+    if (!weight_store) {
+      return false;
+    }
+    edge->mutable_weight_stores(i) =
+        Eigen::Map<MatrixX<T>>(weight_store, edge->row(), edge->col());
+  }
+  int num_bias_stores = checkpoint->num_blobs(bias_type, id);
+  for (int i = 0; i < num_bias_stores; ++i) {
+    Eigen::Map<MatrixX<T>> bias_store = edge->mutable_bias_stores(i);
+    T *data = checkpoint->blob(bias_type, id, i, bias_store.rows(),
+                               bias_store.cols());
+    if (!data) {
+      return false;
+    }
+    bias_store =
+        Eigen::Map<MatrixX<T>>(data, bias_store.rows(), bias_store.cols());
+  }
+  return true;
+}
+
+} // namespace
+
 template <typename T>
 ClassifierImpl<T>::ClassifierImpl(const GraphParameter &graph_parameter)
     : Graph<T>(graph_parameter.edge_params()),
+      graph_parameter_(graph_parameter),
       batch_size_(graph_parameter.length()) {
   DCHECK_GT(batch_size_, 0);
 
   if (graph_parameter.has_solver_config()) {
     solver_ =
         Factory::InstantiateSolver<Solver<T>>(graph_parameter.solver_config());
+    if (graph_parameter.solver_config().has_schedule()) {
+      scheduler_ =
+          std::make_unique<LrScheduler<T>>(graph_parameter.solver_config());
+    }
   }
 
   // Builds the default |threshold_|
@@ -77,44 +133,273 @@ ClassifierImpl<T>::ClassifierImpl(const GraphParameter &graph_parameter)
                      edge_type, edge_id, vertex_by_id_.at(vtx_in_id).get(),
                      vertex_by_id_.at(vtx_out_id).get()));
   }
+  for (auto &[edge_id, edge] : edge_by_id_) {
+    if (graph_parameter.flat_parameters() && !edge->nabla_weight_cols()) {
+      continue;
+    }
+    unflattened_edges_.push_back(edge.get());
+  }
+
+  this->CompileSchedule(vertex_by_id_, edge_by_id_);
+  this->SetNumInterOpThreads(graph_parameter.num_inter_op_threads());
+  this->SetBatchBucketing(graph_parameter.batch_bucketing());
+  this->PlanMemory(batch_size_, false);
+  if (graph_parameter.flat_parameters()) {
+    FlattenParameters();
+    FlattenStores();
+  }
+
+  // Instantiates replicas for data-parallel training, the calling thread
+  // works on the first chunk of each batch. Parameters held by vertices, e.g.
+  // gate parameters of recurrent vertices, are neither shared with replicas
+  // nor reduced from them, so such graphs train on the calling thread only.
+  int num_threads = graph_parameter.num_threads();
+  if (num_threads > 1) {
+    for (const auto &[vtx_id, vertex] : vertex_by_id_) {
+      if (vertex->parameters()) {
+        LOG(WARNING) << "Vertex " << vtx_id << " holds parameters that "
+                     << "replicas cannot share, training runs on one thread "
+                     << "instead of " << num_threads << ".";
+        num_threads = 1;
+        break;
+      }
+    }
+  }
+  if (num_threads > 1) {
+    GraphParameter replica_parameter = graph_parameter;
+    replica_parameter.clear_solver_config();
+    replica_parameter.clear_num_threads();
+    replica_parameter.clear_num_inter_op_threads();
+    thread_pool_ = std::make_unique<ThreadPool>(num_threads - 1);
+    for (int i = 1; i < num_threads; ++i) {
+      replicas_.push_back(
+          std::make_unique<ClassifierImpl<T>>(replica_parameter));
+      replicas_.back()->ShareParameters(*this);
+    }
+  }
 }
 
 template <typename T> ClassifierImpl<T>::~ClassifierImpl() = default;
 
 template <typename T>
 void ClassifierImpl<T>::Initialize(Visitor<T> &init_visitor) {
-  this->Traverse(init_visitor, edge_by_id_);
+  this->Traverse(init_visitor);
 }
 
 template <typename T>
 void ClassifierImpl<T>::Train(const MatrixX<T> &feature,
                               const Eigen::Ref<const MatrixX<int>> &labels) {
+  Train(Eigen::Map<const MatrixX<T>>(feature.data(), feature.rows(),
+                                     feature.cols()),
+        labels);
+}
+
+template <typename T>
+void ClassifierImpl<T>::Train(const Eigen::Map<const MatrixX<T>> &feature,
+                              const Eigen::Ref<const MatrixX<int>> &labels) {
+  DCHECK_GT(labels.cols(), 0);
+  DCHECK_EQ(feature.cols(), labels.cols());
+  DCHECK(solver_);
+
+  if (replicas_.empty() || feature.cols() < 2) {
+    this->Forward(feature, false);
+    this->Backward(labels);
+  } else {
+    this->ParallelForwardBackward(feature, labels);
+  }
+  UpdateParameters();
+}
+
+template <typename T>
+void ClassifierImpl<T>::Train(const SparseMatrix<T> &feature,
+                              const Eigen::Ref<const MatrixX<int>> &labels) {
   DCHECK_GT(labels.cols(), 0);
+  DCHECK_EQ(feature.cols(), labels.cols());
   DCHECK(solver_);
 
-  this->Forward(feature);
+  this->Forward(feature, false);
   this->Backward(labels);
-  this->Traverse(*solver_, edge_by_id_);
+  UpdateParameters();
 }
 
 template <typename T>
 T ClassifierImpl<T>::CalculateLoss(const MatrixX<T> &test_feature,
                                    const MatrixX<int> &test_labels) {
-  this->Forward(test_feature);
+  output_vertex_->set_loss_path(true);
+  this->Forward(test_feature, true);
+  output_vertex_->set_loss_path(false);
+  return output_vertex_->CalcLoss(test_labels.cast<T>());
+}
+
+template <typename T>
+T ClassifierImpl<T>::CalculateLoss(const SparseMatrix<T> &test_feature,
+                                   const MatrixX<int> &test_labels) {
+  output_vertex_->set_loss_path(true);
+  this->Forward(test_feature, true);
+  output_vertex_->set_loss_path(false);
   return output_vertex_->CalcLoss(test_labels.cast<T>());
 }
 
 template <typename T>
 const MatrixX<T>
 ClassifierImpl<T>::GetProbabilityDist(const MatrixX<T> &feature) {
-  this->Forward(feature);
+  this->Forward(feature, true);
   return output_vertex_->act();
 }
 
+template <typename T>
+const MatrixX<T>
+ClassifierImpl<T>::GetProbabilityDist(const SparseMatrix<T> &feature) {
+  this->Forward(feature, true);
+  return output_vertex_->act();
+}
+
+template <typename T>
+void ClassifierImpl<T>::GetTopK(const MatrixX<T> &feature, int k,
+                                MatrixX<int> *classes,
+                                MatrixX<T> *probabilities) {
+  this->Forward(feature, true);
+  output_vertex_->TopK(k, classes, probabilities);
+}
+
+template <typename T>
+bool ClassifierImpl<T>::SaveCheckpoint(const std::string &path) const {
+  CheckpointWriter<T> writer(graph_parameter_);
+  for (const auto &[edge_id, edge] : edge_by_id_) {
+    writer.AddBlob(CheckpointBlob::kWeight, edge_id, 0,
+                   edge->mutable_weight().data(), edge->row(), edge->col());
+    AddStoreBlobs(CheckpointBlob::kWeightStore, CheckpointBlob::kBiasStore,
+                  edge_id, edge.get(), &writer);
+  }
+  for (const auto &[vtx_id, vertex] : vertex_by_id_) {
+    if (vertex.get() == input_vertex_) {
+      continue;
+    }
+    writer.AddBlob(CheckpointBlob::kBias, vtx_id, 0,
+                   vertex->mutable_bias().data(), vertex->row(), 1);
+    Edge<T> *parameters = vertex->parameters();
+    if (!parameters) {
+      continue;
+    }
+    writer.AddBlob(CheckpointBlob::kVertexWeight, vtx_id, 0,
+                   parameters->mutable_weight().data(), parameters->row(),
+                   parameters->col());
+    Eigen::Map<MatrixX<T>> bias = parameters->mutable_bias();
+    if (bias.size() > 0) {
+      writer.AddBlob(CheckpointBlob::kVertexBias, vtx_id, 0, bias.data(),
+                     bias.rows(), bias.cols());
+    }
+    AddStoreBlobs(CheckpointBlob::kVertexWeightStore,
+                  CheckpointBlob::kVertexBiasStore, vtx_id, parameters,
+                  &writer);
+  }
+  // Steps of the solver and of its schedule, so that bias corrections and
+  // learning rates carry on when training resumes
+  if (solver_) {
+    writer.AddCount(CheckpointBlob::kSolverStep, solver_->num_steps());
+  }
+  if (scheduler_) {
+    writer.AddCount(CheckpointBlob::kSchedulerStep, scheduler_->step());
+  }
+  return writer.Write(path);
+}
+
+template <typename T>
+std::unique_ptr<ClassifierImpl<T>>
+ClassifierImpl<T>::LoadCheckpoint(const std::string &path) {
+  std::unique_ptr<CheckpointReader<T>> checkpoint =
+      CheckpointReader<T>::Open(path);
+  if (!checkpoint) {
+    return nullptr;
+  }
+  auto classifier =
+      std::make_unique<ClassifierImpl<T>>(checkpoint->graph_parameter());
+  if (!classifier->BindCheckpoint(checkpoint.get())) {
+    LOG(ERROR) << "The checkpoint " << path << " does not match its graph.";
+    return nullptr;
+  }
+  classifier->checkpoint_ = std::move(checkpoint);
+  return classifier;
+}
+
+template <typename T>
+Eigen::Map<const MatrixX<T>>
+ClassifierImpl<T>::Predict(const MatrixX<T> &feature,
+                           Workspace<T> *workspace) const {
+  return Predict(Eigen::Map<const MatrixX<T>>(feature.data(), feature.rows(),
+                                              feature.cols()),
+                 workspace);
+}
+
+template <typename T>
+Eigen::Map<const MatrixX<T>>
+ClassifierImpl<T>::Predict(const Eigen::Map<const MatrixX<T>> &feature,
+                           Workspace<T> *workspace) const {
+  DCHECK(workspace);
+  PredictVisitor<T> assign_visitor(workspace, false);
+  PredictVisitor<T> accumulate_visitor(workspace, true);
+  return Predict(feature, assign_visitor, accumulate_visitor, workspace);
+}
+
+template <typename T>
+Eigen::Map<const MatrixX<T>>
+ClassifierImpl<T>::Predict(const MatrixX<T> &feature,
+                           Visitor<T> &assign_visitor,
+                           Visitor<T> &accumulate_visitor,
+                           Workspace<T> *workspace) const {
+  return Predict(Eigen::Map<const MatrixX<T>>(feature.data(), feature.rows(),
+                                              feature.cols()),
+                 assign_visitor, accumulate_visitor, workspace);
+}
+
+template <typename T>
+Eigen::Map<const MatrixX<T>>
+ClassifierImpl<T>::Predict(const Eigen::Map<const MatrixX<T>> &feature,
+                           Visitor<T> &assign_visitor,
+                           Visitor<T> &accumulate_visitor,
+                           Workspace<T> *workspace) const {
+  DCHECK(workspace);
+  DCHECK_EQ(feature.rows(), input_vertex_->row());
+  DCHECK_GT(feature.cols(), 0);
+
+  this->PlanWorkspace(feature.cols(), workspace);
+  workspace->BindConst(input_vertex_->id(), feature.data(), feature.rows(),
+                       feature.cols());
+  this->Propagate(assign_visitor, accumulate_visitor,
+                  [workspace](OpVertex<T> *vertex) {
+                    vertex->Activate(workspace->mutable_act(vertex->id()));
+                  });
+  return workspace->act(output_vertex_->id());
+}
+
 template <typename T>
 void ClassifierImpl<T>::SetSolver(std::unique_ptr<Solver<T>> solver) {
   DCHECK(solver);
   solver_ = std::move(solver);
+  if (graph_parameter_.flat_parameters()) {
+    FlattenStores();
+  }
+}
+
+template <typename T>
+Eigen::Map<VectorX<T>> ClassifierImpl<T>::mutable_flat_parameters() {
+  DCHECK(graph_parameter_.flat_parameters());
+  return Eigen::Map<VectorX<T>>(flat_parameters_.param, flat_parameters_.size);
+}
+
+template <typename T>
+Eigen::Map<VectorX<T>> ClassifierImpl<T>::mutable_flat_nablas() {
+  DCHECK(graph_parameter_.flat_parameters());
+  return Eigen::Map<VectorX<T>>(nabla_arena_.data(), flat_parameters_.size);
+}
+
+template <typename T>
+Eigen::Map<VectorX<T>> ClassifierImpl<T>::mutable_flat_stores(int index) {
+  DCHECK(graph_parameter_.flat_parameters());
+  DCHECK_GE(index, 0);
+  DCHECK_LT(index, flat_parameters_.stores.size());
+  return Eigen::Map<VectorX<T>>(flat_parameters_.stores[index],
+                                flat_parameters_.size);
 }
 
 template <typename T>
@@ -128,12 +413,33 @@ const MatrixX<T> ClassifierImpl<T>::CalcConfusionMatrix(
     const MatrixX<T> &test_feature,
     const Eigen::Ref<const MatrixX<int>> &test_labels) {
   DCHECK_EQ(test_feature.cols(), test_labels.cols());
-  DCHECK_EQ(output_vertex_->row(), test_labels.rows());
 
-  this->Forward(test_feature);
-  const MatrixX<T> &activation = output_vertex_->act();
+  this->Forward(test_feature, true);
+  return CalcConfusionMatrixFromDist(output_vertex_->act(), test_labels);
+}
+
+template <typename T>
+const MatrixX<T> ClassifierImpl<T>::CalcConfusionMatrixFromDist(
+    const Eigen::Ref<const MatrixX<T>> &activation,
+    const Eigen::Ref<const MatrixX<int>> &test_labels) const {
+  DCHECK_EQ(activation.rows(), output_vertex_->row());
+  return CalcConfusionMatrixFromDist(activation, test_labels, threshold_);
+}
+
+template <typename T>
+const MatrixX<T> ClassifierImpl<T>::CalcConfusionMatrixFromDist(
+    const Eigen::Ref<const MatrixX<T>> &activation,
+    const Eigen::Ref<const MatrixX<int>> &test_labels,
+    const MatrixX<T> &threshold) {
+  DCHECK_EQ(activation.cols(), test_labels.cols());
+  DCHECK_EQ(activation.rows(), threshold.rows());
+  // Multi-class labels may hold the class index of each column in a single
+  // row rather than one-hot columns
+  DCHECK(activation.rows() == test_labels.rows() ||
+         (activation.rows() > 1 && test_labels.rows() == 1));
+
   int class_num = activation.rows() == 1 ? 2 : activation.rows();
-  int batch_size = output_vertex_->col();
+  int batch_size = activation.cols();
   MatrixX<T> confusion_matrix = MatrixX<T>::Zero(class_num, class_num);
 
   if (activation.rows() == 1) {
@@ -145,7 +451,7 @@ const MatrixX<T> ClassifierImpl<T>::CalcConfusionMatrix(
 
     MatrixX<int> predication = MatrixX<int>::Zero(1, batch_size);
     predication = (activation.leftCols(batch_size).array() >
-                   threshold_.array().replicate(1, batch_size))
+                   threshold.array().replicate(1, batch_size))
                       .template cast<int>();
     int correct_predication =
         (predication.leftCols(batch_size).array() == test_labels.array())
@@ -163,43 +469,314 @@ const MatrixX<T> ClassifierImpl<T>::CalcConfusionMatrix(
     // Multi-class classification
     MatrixX<T> weighted_probability =
         activation.leftCols(batch_size).array() *
-        threshold_.array().replicate(activation.rows(), batch_size);
+        threshold.array().replicate(1, batch_size);
     for (int i = 0; i < batch_size; ++i) {
       int predicted_class, actual_class;
       weighted_probability.col(i).maxCoeff(&predicted_class);
-      test_labels.col(i).maxCoeff(&actual_class);
+      if (test_labels.rows() == 1) {
+        actual_class = test_labels(0, i);
+      } else {
+        test_labels.col(i).maxCoeff(&actual_class);
+      }
       confusion_matrix(predicted_class, actual_class)++;
     }
   }
   return confusion_matrix;
 }
 
-template <typename T> void ClassifierImpl<T>::ZeroInitializeVertex() {
-  static InitVertexVisitor<T> init_vtx_visitor = InitVertexVisitor<T>();
-  this->Traverse(init_vtx_visitor, edge_by_id_);
+template <typename T>
+void ClassifierImpl<T>::Forward(const MatrixX<T> &feature, bool inference) {
+  Forward(Eigen::Map<const MatrixX<T>>(feature.data(), feature.rows(),
+                                       feature.cols()),
+          inference);
+}
+
+template <typename T>
+void ClassifierImpl<T>::Forward(const Eigen::Map<const MatrixX<T>> &feature,
+                                bool inference) {
+  batch_size_ = feature.cols();
+  this->PlanMemory(batch_size_, inference);
+  input_vertex_->set_feature(feature);
+  this->Propagate(forward_assign_visitor_, forward_accumulate_visitor_);
 }
 
 template <typename T>
-void ClassifierImpl<T>::Forward(const MatrixX<T> &feature) {
-  static ForwardVisitor<T> forward_visitor = ForwardVisitor<T>();
-  static ResizeVertexVisitor<T> resize_vertex_visitor =
-      ResizeVertexVisitor<T>(batch_size_);
-  if (batch_size_ != feature.cols()) {
-    batch_size_ = feature.cols();
-    resize_vertex_visitor.set_batch_size(batch_size_);
-    this->Traverse(resize_vertex_visitor, edge_by_id_);
-  }
-  input_vertex_->set_feature(&feature);
-  this->ZeroInitializeVertex();
-  this->Traverse(forward_visitor, edge_by_id_);
-  output_vertex_->Activate();
+void ClassifierImpl<T>::Forward(const SparseMatrix<T> &feature,
+                                bool inference) {
+  batch_size_ = feature.cols();
+  this->PlanMemory(batch_size_, inference);
+  input_vertex_->set_feature(&feature, 0, feature.cols());
+  this->Propagate(forward_assign_visitor_, forward_accumulate_visitor_);
 }
 
 template <typename T>
 void ClassifierImpl<T>::Backward(const Eigen::Ref<const MatrixX<int>> &labels) {
-  static BackwardVisitor<T> backward_visitor = BackwardVisitor<T>();
   output_vertex_->CalcDelta(labels.cast<T>());
-  this->RTraverse(backward_visitor, edge_by_id_);
+  this->BackPropagate(backward_assign_visitor_, backward_accumulate_visitor_);
+}
+
+template <typename T> void ClassifierImpl<T>::UpdateParameters() {
+  if (scheduler_) {
+    scheduler_->Step(solver_.get());
+  }
+  solver_->Step();
+  if (!graph_parameter_.flat_parameters()) {
+    this->Traverse(*solver_);
+    return;
+  }
+  solver_->Visit(flat_parameters_);
+  for (Edge<T> *edge : unflattened_edges_) {
+    edge->Accept(*solver_);
+  }
+  for (auto &[vtx_id, vertex] : vertex_by_id_) {
+    if (Edge<T> *parameters = vertex->parameters()) {
+      parameters->Accept(*solver_);
+    }
+  }
+}
+
+template <typename T>
+void ClassifierImpl<T>::ParallelForwardBackward(
+    const Eigen::Map<const MatrixX<T>> &feature,
+    const Eigen::Ref<const MatrixX<int>> &labels) {
+  int total = feature.cols();
+  int num_workers = std::min<int>(replicas_.size() + 1, total);
+  std::vector<ClassifierImpl<T> *> workers = {this};
+  for (int i = 0; i < num_workers - 1; ++i) {
+    workers.push_back(replicas_[i].get());
+  }
+
+  thread_pool_->ParallelFor(num_workers, [&](int i) {
+    // Splits the batch into chunks whose sizes differ by at most one
+    int offset = static_cast<int64_t>(total) * i / num_workers;
+    int length = static_cast<int64_t>(total) * (i + 1) / num_workers - offset;
+    ClassifierImpl<T> *worker = workers[i];
+    // Columns are contiguous in the column-major feature matrix
+    worker->Forward(Eigen::Map<const MatrixX<T>>(
+                        feature.data() +
+                            static_cast<size_t>(offset) * feature.rows(),
+                        feature.rows(), length),
+                    false);
+    worker->Backward(labels.middleCols(offset, length));
+    // Nablas are averaged over a chunk, weighting them by the share of the
+    // chunk makes their sum the average over the whole batch
+    worker->ScaleNablas(static_cast<T>(length) / total);
+  });
+
+  // Tree reduction: after the round of |stride|, worker i holds the sum of
+  // workers [i, i + 2 * stride). Weights are shared, so only this graph,
+  // i.e. worker 0, needs the reduced nablas
+  for (int stride = 1; stride < num_workers; stride *= 2) {
+    int num_pairs = (num_workers + stride - 1) / (2 * stride);
+    thread_pool_->ParallelFor(num_pairs, [&](int pair) {
+      int i = pair * 2 * stride;
+      workers[i]->AccumulateNablas(*workers[i + stride]);
+    });
+  }
+  batch_size_ = total;
+}
+
+template <typename T>
+void ClassifierImpl<T>::ShareParameters(ClassifierImpl<T> &graph) {
+  for (auto &[edge_id, edge] : edge_by_id_) {
+    edge->BindWeight(graph.edge_by_id_.at(edge_id)->mutable_weight().data());
+  }
+  for (auto &[vtx_id, vertex] : vertex_by_id_) {
+    if (vertex.get() == input_vertex_) {
+      continue;
+    }
+    vertex->BindBias(graph.vertex_by_id_.at(vtx_id)->mutable_bias().data());
+  }
+  if (graph_parameter_.flat_parameters()) {
+    // The parameter arena of this graph is no longer viewed
+    parameter_arena_ = Arena<T>();
+    flat_parameters_.param = graph.flat_parameters_.param;
+  }
+}
+
+template <typename T> void ClassifierImpl<T>::ScaleNablas(T scale) {
+  if (graph_parameter_.flat_parameters()) {
+    mutable_flat_nablas() *= scale;
+  }
+  for (Edge<T> *edge : unflattened_edges_) {
+    edge->mutable_nabla_weight() *= scale;
+    edge->mutable_nabla_bias() *= scale;
+  }
+}
+
+template <typename T>
+void ClassifierImpl<T>::AccumulateNablas(ClassifierImpl<T> &graph) {
+  if (graph_parameter_.flat_parameters()) {
+    mutable_flat_nablas() += graph.mutable_flat_nablas();
+  }
+  for (Edge<T> *edge : unflattened_edges_) {
+    Edge<T> *other_edge = graph.edge_by_id_.at(edge->id()).get();
+    edge->mutable_nabla_weight() += other_edge->mutable_nabla_weight();
+    edge->mutable_nabla_bias() += other_edge->mutable_nabla_bias();
+  }
+}
+
+template <typename T>
+bool ClassifierImpl<T>::BindCheckpoint(CheckpointReader<T> *checkpoint) {
+  for (auto &[edge_id, edge] : edge_by_id_) {
+    T *weight = checkpoint->blob(CheckpointBlob::kWeight, edge_id, 0,
+                                 edge->row(), edge->col());
+    if (!weight) {
+      return false;
+    }
+    edge->BindWeight(weight);
+    if (!BindStoreBlobs(CheckpointBlob::kWeightStore,
+                        CheckpointBlob::kBiasStore, edge_id, checkpoint,
+                        edge.get())) {
+      return false;
+    }
+  }
+
+  for (auto &[vtx_id, vertex] : vertex_by_id_) {
+    if (vertex.get() == input_vertex_) {
+      continue;
+    }
+    T *bias = checkpoint->blob(CheckpointBlob::kBias, vtx_id, 0,
+                               vertex->row(), 1);
+    if (!bias) {
+      return false;
+    }
+    vertex->BindBias(bias);
+
+    // Vertex parameters are bound like edges, except that their bias is
+    // copied, since edges do not bind biases of their own
+    Edge<T> *parameters = vertex->parameters();
+    if (!parameters) {
+      continue;
+    }
+    T *weight = checkpoint->blob(CheckpointBlob::kVertexWeight, vtx_id, 0,
+                                 parameters->row(), parameters->col());
+    if (!weight) {
+      return false;
+    }
+    parameters->BindWeight(weight);
+    Eigen::Map<MatrixX<T>> parameter_bias = parameters->mutable_bias();
+    if (parameter_bias.size() > 0) {
+      T *data = checkpoint->blob(CheckpointBlob::kVertexBias, vtx_id, 0,
+                                 parameter_bias.rows(), parameter_bias.cols());
+      if (!data) {
+        return false;
+      }
+      parameter_bias = Eigen::Map<MatrixX<T>>(data, parameter_bias.rows(),
+                                              parameter_bias.cols());
+    }
+    if (!BindStoreBlobs(CheckpointBlob::kVertexWeightStore,
+                        CheckpointBlob::kVertexBiasStore, vtx_id, checkpoint,
+                        parameters)) {
+      return false;
+    }
+  }
+
+  // Checkpoints without steps, e.g. of graphs that never had a solver,
+  // resume from the first step
+  int64_t num_steps = 0;
+  if (solver_ && checkpoint->count(CheckpointBlob::kSolverStep, &num_steps)) {
+    solver_->set_num_steps(static_cast<int>(num_steps));
+  }
+  if (scheduler_ &&
+      checkpoint->count(CheckpointBlob::kSchedulerStep, &num_steps)) {
+    scheduler_->set_step(static_cast<int>(num_steps));
+  }
+
+  // Flat parameters are copied back into the arena
+  if (graph_parameter_.flat_parameters()) {
+    FlattenParameters();
+  }
+
+  // Replicas were bound to the storage replaced above
+  for (auto &replica : replicas_) {
+    replica->ShareParameters(*this);
+  }
+  return true;
+}
+
+template <typename T> void ClassifierImpl<T>::FlattenParameters() {
+  std::map<int, int> vtx_out_id_by_edge_id;
+  for (const auto &edge_param : graph_parameter_.edge_params()) {
+    vtx_out_id_by_edge_id[edge_param.id()] = edge_param.vertex_out_id();
+  }
+
+  // Lays out weights of dense edges followed by biases of vertices, each of
+  // them starting aligned
+  size_t size = 0;
+  flat_edges_.clear();
+  for (auto &[edge_id, edge] : edge_by_id_) {
+    if (edge->nabla_weight_cols()) {
+      continue;
+    }
+    flat_edges_.push_back({edge.get(), size, 0, false});
+    size += Arena<T>::Align(static_cast<size_t>(edge->row()) * edge->col());
+  }
+  size_t num_weights = size;
+  std::map<int, size_t> bias_offset_by_id;
+  for (auto &[vtx_id, vertex] : vertex_by_id_) {
+    if (vertex.get() == input_vertex_) {
+      continue;
+    }
+    bias_offset_by_id[vtx_id] = size;
+    size += Arena<T>::Align(vertex->row());
+  }
+  for (FlatEdge &flat_edge : flat_edges_) {
+    int vtx_out_id = vtx_out_id_by_edge_id.at(flat_edge.edge->id());
+    flat_edge.bias_offset = bias_offset_by_id.at(vtx_out_id);
+    flat_edge.binds_bias = flat_edge.edge->owns_bias();
+  }
+
+  // Padding between parameters is zeroed, so that sweeps leave it as it is
+  parameter_arena_.Reserve(size);
+  nabla_arena_.Reserve(size);
+  T *param = parameter_arena_.data();
+  T *nabla = nabla_arena_.data();
+  std::fill_n(param, size, 0);
+  std::fill_n(nabla, size, 0);
+  for (const FlatEdge &flat_edge : flat_edges_) {
+    Edge<T> *edge = flat_edge.edge;
+    T *weight = param + flat_edge.weight_offset;
+    Eigen::Map<MatrixX<T>>(weight, edge->row(), edge->col()) =
+        edge->mutable_weight();
+    edge->BindWeight(weight);
+    edge->BindNablas(nabla + flat_edge.weight_offset,
+                     flat_edge.binds_bias ? nabla + flat_edge.bias_offset
+                                          : nullptr);
+  }
+  for (auto &[vtx_id, offset] : bias_offset_by_id) {
+    OpVertex<T> *vertex = vertex_by_id_.at(vtx_id).get();
+    Eigen::Map<MatrixX<T>>(param + offset, vertex->row(), 1) =
+        vertex->mutable_bias();
+    vertex->BindBias(param + offset);
+  }
+
+  flat_parameters_.param = param;
+  flat_parameters_.nabla = nabla;
+  flat_parameters_.num_weights = num_weights;
+  flat_parameters_.size = size;
+}
+
+template <typename T> void ClassifierImpl<T>::FlattenStores() {
+  flat_parameters_.stores.clear();
+  if (!solver_) {
+    return;
+  }
+
+  size_t size = flat_parameters_.size;
+  int num_stores = solver_->num_stores();
+  store_arena_.Reserve(num_stores * size);
+  std::fill_n(store_arena_.data(), num_stores * size, 0);
+  for (int i = 0; i < num_stores; ++i) {
+    T *store = store_arena_.data() + i * size;
+    for (const FlatEdge &flat_edge : flat_edges_) {
+      flat_edge.edge->BindStores(i, store + flat_edge.weight_offset,
+                                 flat_edge.binds_bias
+                                     ? store + flat_edge.bias_offset
+                                     : nullptr);
+    }
+    flat_parameters_.stores.push_back(store);
+  }
 }
 
 // Explicit instantiation
@@ -18,6 +18,8 @@ Contributor(s):
 #include <map>
 #include <memory>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "src/edge.h"
 #include "src/edge/op_vertex.h"
@@ -25,12 +27,31 @@ Contributor(s):
 #include "src/edge/vertex/input_vertex.h"
 #include "src/eigen.h"
 #include "src/graph.h"
+#include "src/graph/checkpoint.h"
 #include "src/proto/graph_parameter.pb.h"
 #include "src/solver.h"
+#include "src/solver/lr_scheduler.h"
+#include "src/tensor/arena.h"
+#include "src/tensor/workspace.h"
+#include "src/utility/thread_pool.h"
 #include "src/visitor.h"
+#include "src/visitor/backward_visitor.h"
+#include "src/visitor/forward_visitor.h"
 
 namespace intellgraph {
 
+// ClassifierImpl trains and evaluates a classification graph. When the graph
+// parameter asks for more than one thread, training batches are split into
+// chunks that run forward and backward passes concurrently on graph replicas.
+// Replicas own their vertex buffers and nablas but share weights and biases
+// with this graph, and their nablas are reduced into this graph before the
+// solver runs.
+//
+// When the graph parameter asks for flat parameters, weights of dense edges
+// and biases of vertices are packed into one aligned arena, in the order of
+// their ids, and nablas and solver stores into arenas of the same layout.
+// The solver then updates them in a single sweep, and replicas reduce their
+// nablas with a single operation.
 template <typename T> class ClassifierImpl : public Graph<T> {
 public:
   explicit ClassifierImpl(const GraphParameter &graph_parameter);
@@ -39,11 +60,79 @@ public:
   void Initialize(Visitor<T> &init_visitor) override;
   void Train(const MatrixX<T> &feature,
              const Eigen::Ref<const MatrixX<int>> &labels) override;
+  // Trains on the columns mapped by |feature| without copying them, e.g. a
+  // batch assembled by src/data/data_loader.h
+  void Train(const Eigen::Map<const MatrixX<T>> &feature,
+             const Eigen::Ref<const MatrixX<int>> &labels);
+  // Trains on the compressed sparse |feature|, which is fed to a sparse
+  // input vertex, see src/edge/vertex/sparse_input_vertex_impl.h. Nablas of
+  // SparseDense edges only hold the features present in a batch and cannot
+  // be reduced across replicas, so the batch is not split across threads.
+  void Train(const SparseMatrix<T> &feature,
+             const Eigen::Ref<const MatrixX<int>> &labels);
   T CalculateLoss(const MatrixX<T> &test_feature,
                   const MatrixX<int> &test_labels) override;
+  T CalculateLoss(const SparseMatrix<T> &test_feature,
+                  const MatrixX<int> &test_labels);
   void SetSolver(std::unique_ptr<Solver<T>> solver) override;
 
   const MatrixX<T> GetProbabilityDist(const MatrixX<T> &feature);
+  const MatrixX<T> GetProbabilityDist(const SparseMatrix<T> &feature);
+  // Writes the |k| most probable classes of each column of |feature| into
+  // |classes| and their probabilities into |probabilities|, see
+  // OutputVertex::TopK. Unlike GetProbabilityDist, this also predicts with
+  // output vertices that never build the whole distribution, e.g. the ones
+  // in src/edge/vertex/sampled_softmax_impl.h.
+  void GetTopK(const MatrixX<T> &feature, int k, MatrixX<int> *classes,
+               MatrixX<T> *probabilities);
+
+  // Writes the topology, weights, biases, solver stores and solver steps of
+  // the graph into a checkpoint file at |path|, see src/graph/checkpoint.h.
+  // Returns false if the file cannot be written.
+  bool SaveCheckpoint(const std::string &path) const;
+  // Builds a classifier from the checkpoint file at |path|, or returns
+  // nullptr if it is not a valid checkpoint. The file is mapped into memory
+  // and weights and biases point at the mapped pages without being copied,
+  // so that processes loading the same checkpoint share them through the
+  // page cache until they are trained. Solver stores are copied, and so are
+  // flat parameters, which stay in the arena of the graph.
+  static std::unique_ptr<ClassifierImpl<T>>
+  LoadCheckpoint(const std::string &path);
+
+  // Returns the probability distribution of the dense |feature| without
+  // modifying the graph. Activations are kept in the caller-owned
+  // |workspace|, so threads sharing a trained graph can predict concurrently
+  // as long as each passes its own workspace. The result is valid until the
+  // workspace is reused.
+  Eigen::Map<const MatrixX<T>> Predict(const MatrixX<T> &feature,
+                                       Workspace<T> *workspace) const;
+  // Predicts the columns mapped by |feature| without copying them, e.g. the
+  // leading columns of a reused batch buffer
+  Eigen::Map<const MatrixX<T>>
+  Predict(const Eigen::Map<const MatrixX<T>> &feature,
+          Workspace<T> *workspace) const;
+  // Runs Predict with visitors that forward the edges, e.g. with quantized
+  // weights. The visitors read and write activations in |workspace|.
+  Eigen::Map<const MatrixX<T>> Predict(const MatrixX<T> &feature,
+                                       Visitor<T> &assign_visitor,
+                                       Visitor<T> &accumulate_visitor,
+                                       Workspace<T> *workspace) const;
+  Eigen::Map<const MatrixX<T>>
+  Predict(const Eigen::Map<const MatrixX<T>> &feature,
+          Visitor<T> &assign_visitor, Visitor<T> &accumulate_visitor,
+          Workspace<T> *workspace) const;
+
+  // Number of threads training batches are split across, which is one if
+  // the graph has vertex parameters, see OpVertex::parameters
+  int num_threads() const { return replicas_.size() + 1; }
+
+  // Flat views of the weights and biases, of their nablas and of solver
+  // store |index| if the graph keeps flat parameters, e.g. to average the
+  // weights of several graphs or to all-reduce nablas with one operation.
+  // Parameters of edges with sparse nablas and of vertices are left out.
+  Eigen::Map<VectorX<T>> mutable_flat_parameters();
+  Eigen::Map<VectorX<T>> mutable_flat_nablas();
+  Eigen::Map<VectorX<T>> mutable_flat_stores(int index);
 
   // Used for threshold-moving/threshold-tuning
   // In the binary classification, predication that is greater than the
@@ -66,19 +155,89 @@ public:
   const MatrixX<T>
   CalcConfusionMatrix(const MatrixX<T> &test_feature,
                       const Eigen::Ref<const MatrixX<int>> &test_labels);
+  // Calculates the Confusion Matrix from the |activation| of the output
+  // vertex, i.e. the probability distribution, e.g. as returned by Predict
+  const MatrixX<T> CalcConfusionMatrixFromDist(
+      const Eigen::Ref<const MatrixX<T>> &activation,
+      const Eigen::Ref<const MatrixX<int>> &test_labels) const;
+  // Calculates the Confusion Matrix from |activation| with |threshold|, e.g.
+  // for models that predict without the graph
+  static const MatrixX<T> CalcConfusionMatrixFromDist(
+      const Eigen::Ref<const MatrixX<T>> &activation,
+      const Eigen::Ref<const MatrixX<int>> &test_labels,
+      const MatrixX<T> &threshold);
+
+  const GraphParameter &graph_parameter() const { return graph_parameter_; }
+  const MatrixX<T> &threshold() const { return threshold_; }
 
 private:
-  void ZeroInitializeVertex();
-  void Forward(const MatrixX<T> &feature);
+  // Runs the forward pass on the columns mapped by |feature|, with an
+  // |inference| memory plan if no backward pass follows
+  void Forward(const MatrixX<T> &feature, bool inference);
+  void Forward(const Eigen::Map<const MatrixX<T>> &feature, bool inference);
+  void Forward(const SparseMatrix<T> &feature, bool inference);
   void Backward(const Eigen::Ref<const MatrixX<int>> &labels);
+  // Runs the solver on all parameters after a backward pass
+  void UpdateParameters();
+
+  // Calculates nablas of |feature| by splitting it across replicas, and
+  // reduces them into nablas of this graph
+  void ParallelForwardBackward(const Eigen::Map<const MatrixX<T>> &feature,
+                               const Eigen::Ref<const MatrixX<int>> &labels);
+  // Binds weights and biases of this graph to the ones of |graph|
+  void ShareParameters(ClassifierImpl<T> &graph);
+  void ScaleNablas(T scale);
+  // Adds nablas of |graph| to the nablas of this graph
+  void AccumulateNablas(ClassifierImpl<T> &graph);
+  // Binds weights and biases to the blobs of |checkpoint| and copies solver
+  // stores from it. Returns false if a blob is missing.
+  bool BindCheckpoint(CheckpointReader<T> *checkpoint);
+  // Copies weights and biases of dense edges and vertices into the parameter
+  // arena and binds them and their nablas to the arenas
+  void FlattenParameters();
+  // Binds solver stores of dense edges to the store arena, which is zeroed
+  void FlattenStores();
+
+  ForwardVisitor<T> forward_assign_visitor_{false};
+  ForwardVisitor<T> forward_accumulate_visitor_{true};
+  BackwardVisitor<T> backward_assign_visitor_{false};
+  BackwardVisitor<T> backward_accumulate_visitor_{true};
+
+  std::unique_ptr<ThreadPool> thread_pool_;
+  std::vector<std::unique_ptr<ClassifierImpl<T>>> replicas_;
+
+  GraphParameter graph_parameter_;
+  // Mapped checkpoint the parameters are bound to, if any
+  std::unique_ptr<CheckpointReader<T>> checkpoint_;
 
   int batch_size_ = 0;
   std::unique_ptr<Solver<T>> solver_;
+  // Schedule of the learning rate of the solver, if the solver config has one
+  std::unique_ptr<LrScheduler<T>> scheduler_;
   MatrixX<T> threshold_;
   InputVertex<T> *input_vertex_ = nullptr;
   OutputVertex<T> *output_vertex_ = nullptr;
   std::map<int, std::unique_ptr<OpVertex<T>>> vertex_by_id_;
   std::map<int, std::unique_ptr<Edge<T>>> edge_by_id_;
+
+  // Dense edge in the arenas, with the offsets of its weight and of the bias
+  // of its outbound vertex. Only the edge that owns the bias, see
+  // Edge::owns_bias, binds its nabla bias and bias stores to the slots of
+  // that bias, so that the bias is updated once per sweep.
+  struct FlatEdge {
+    Edge<T> *edge;
+    size_t weight_offset;
+    size_t bias_offset;
+    bool binds_bias;
+  };
+  std::vector<FlatEdge> flat_edges_;
+  // Edges that are updated and reduced on their own, i.e. all edges unless
+  // the graph keeps flat parameters, and then the ones with sparse nablas
+  std::vector<Edge<T> *> unflattened_edges_;
+  Arena<T> parameter_arena_;
+  Arena<T> nabla_arena_;
+  Arena<T> store_arena_;
+  FlatParameters<T> flat_parameters_;
 };
 
 // Tells compiler not to instantiate the template in translation units that
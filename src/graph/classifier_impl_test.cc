@@ -0,0 +1,857 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/graph/classifier_impl.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google/protobuf/text_format.h"
+#include "src/edge/dense_edge_impl.h"
+#include "src/edge/sparse_dense_edge_impl.h"
+#include "src/eigen.h"
+#include "src/proto/graph_parameter.pb.h"
+#include "src/registry.h"
+#include "src/solver/ada_max.h"
+#include "src/solver/adadelta.h"
+#include "src/solver/adagrad.h"
+#include "src/solver/adam.h"
+#include "src/solver/momentum.h"
+#include "src/solver/sgd_solver.h"
+#include "src/tensor/arena.h"
+#include "src/utility/random.h"
+#include "src/visitor.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+constexpr char kGraphParameter[] = R"(
+  solver_config { type: "SGD" eta: 0.5 lambda: 0.0 }
+  length: 4
+  batch_bucketing: true
+  input_vertex_param { id: 0 type: INPUT operation: "DummyTransformer" dims: 2 }
+  output_vertex_param { id: 2 type: OUTPUT operation: "CrossEntropy" dims: 1 }
+  intermediate_vertex_params { id: 1 type: HIDDEN operation: "Tanh" dims: 3 }
+  edge_params { id: 0 type: "Dense" vertex_in_id: 0 vertex_out_id: 1 }
+  edge_params { id: 1 type: "Dense" vertex_in_id: 1 vertex_out_id: 2 }
+)";
+
+// Returns the graph parameter of |text|, whose operations are registered
+GraphParameter ParseGraphParameter(const char *text) {
+  Registry::LoadRegistry();
+  GraphParameter graph_parameter;
+  EXPECT_TRUE(
+      google::protobuf::TextFormat::ParseFromString(text, &graph_parameter));
+  return graph_parameter;
+}
+
+// Calls |function| with the id and the weight of every Dense and SparseDense
+// edge
+class WeightVisitor : public Visitor<double> {
+public:
+  using Function = std::function<void(int, Eigen::Map<MatrixX<double>>)>;
+
+  explicit WeightVisitor(Function function) : function_(std::move(function)) {}
+
+  void Visit(DenseEdgeImpl<double, OpVertex<double>, OpVertex<double>> &edge)
+      override {
+    function_(edge.id(), edge.mutable_weight());
+  }
+  void Visit(SparseDenseEdgeImpl<double, OpVertex<double>, OpVertex<double>>
+                 &edge) override {
+    function_(edge.id(), edge.mutable_weight());
+  }
+
+private:
+  Function function_;
+};
+
+// Returns the weights of the edges of |classifier| by edge id
+std::map<int, MatrixX<double>> GetWeights(ClassifierImpl<double> &classifier) {
+  std::map<int, MatrixX<double>> weights;
+  WeightVisitor visitor([&weights](int id, Eigen::Map<MatrixX<double>> weight) {
+    weights[id] = weight;
+  });
+  classifier.Initialize(visitor);
+  return weights;
+}
+
+// Overwrites the weight of edge |id| of |classifier|
+void SetWeight(ClassifierImpl<double> &classifier, int id,
+               const MatrixX<double> &weight) {
+  WeightVisitor visitor([id, &weight](int edge_id,
+                                      Eigen::Map<MatrixX<double>> edge_weight) {
+    if (edge_id == id) {
+      edge_weight = weight;
+    }
+  });
+  classifier.Initialize(visitor);
+}
+
+// Calls |function| with the name and the view of every parameter: weights of
+// Dense and SparseDense edges, biases of their outbound vertices, once per
+// inbound edge, and weights and biases held by vertices
+class ParameterVisitor : public Visitor<double> {
+public:
+  using Function =
+      std::function<void(const std::string &, Eigen::Map<MatrixX<double>>)>;
+
+  explicit ParameterVisitor(Function function)
+      : function_(std::move(function)) {}
+
+  void Visit(DenseEdgeImpl<double, OpVertex<double>, OpVertex<double>> &edge)
+      override {
+    VisitEdge(edge, edge.vertex_out()->id());
+  }
+  void Visit(SparseDenseEdgeImpl<double, OpVertex<double>, OpVertex<double>>
+                 &edge) override {
+    VisitEdge(edge, edge.vertex_out()->id());
+  }
+  void VisitParameters(Edge<double> &parameters) override {
+    std::string name = "Vertex " + std::to_string(parameters.id());
+    function_(name + " parameter weight", parameters.mutable_weight());
+    if (parameters.mutable_bias().size() > 0) {
+      function_(name + " parameter bias", parameters.mutable_bias());
+    }
+  }
+
+private:
+  void VisitEdge(Edge<double> &edge, int vtx_out_id) {
+    function_("Edge " + std::to_string(edge.id()) + " weight",
+              edge.mutable_weight());
+    function_("Vertex " + std::to_string(vtx_out_id) + " bias",
+              edge.mutable_bias());
+  }
+
+  Function function_;
+};
+
+// Returns the parameters of |classifier| by name
+std::map<std::string, MatrixX<double>>
+GetParameters(ClassifierImpl<double> &classifier) {
+  std::map<std::string, MatrixX<double>> parameters;
+  ParameterVisitor visitor(
+      [&parameters](const std::string &name,
+                    Eigen::Map<MatrixX<double>> parameter) {
+        parameters[name] = parameter;
+      });
+  classifier.Initialize(visitor);
+  return parameters;
+}
+
+// Overwrites the parameter |name| of |classifier|
+void SetParameter(ClassifierImpl<double> &classifier, const std::string &name,
+                  const MatrixX<double> &value) {
+  ParameterVisitor visitor(
+      [&name, &value](const std::string &parameter_name,
+                      Eigen::Map<MatrixX<double>> parameter) {
+        if (parameter_name == name) {
+          parameter = value;
+        }
+      });
+  classifier.Initialize(visitor);
+}
+
+// Trains |classifier| on the batch |num_steps| times, and returns the ratio of
+// the final loss to the initial one
+template <class Feature>
+double TrainLossRatio(ClassifierImpl<double> &classifier,
+                      const Feature &feature, const MatrixX<int> &labels,
+                      int num_steps) {
+  double loss = classifier.CalculateLoss(feature, labels);
+  for (int i = 0; i < num_steps; ++i) {
+    classifier.Train(feature, labels);
+  }
+  return classifier.CalculateLoss(feature, labels) / loss;
+}
+
+// Expects a SGD step of learning rate 1 on the batch to move every parameter
+// of |classifier|, including biases and parameters held by vertices, by the
+// central difference of the loss, i.e. the nablas of backpropagation to be
+// the gradient of CalculateLoss
+template <class Feature>
+void ExpectGradients(ClassifierImpl<double> &classifier,
+                     const Feature &feature, const MatrixX<int> &labels) {
+  constexpr double kEpsilon = 1e-6;
+  std::map<std::string, MatrixX<double>> parameters =
+      GetParameters(classifier);
+  ASSERT_FALSE(parameters.empty());
+  std::map<std::string, MatrixX<double>> expected_nablas;
+  for (auto &[name, parameter] : parameters) {
+    MatrixX<double> &nabla = expected_nablas[name];
+    nabla.resizeLike(parameter);
+    for (int i = 0; i < parameter.size(); ++i) {
+      double value = parameter(i);
+      parameter(i) = value + kEpsilon;
+      SetParameter(classifier, name, parameter);
+      double loss = classifier.CalculateLoss(feature, labels);
+      parameter(i) = value - kEpsilon;
+      SetParameter(classifier, name, parameter);
+      nabla(i) = (loss - classifier.CalculateLoss(feature, labels)) /
+                 (2.0 * kEpsilon);
+      parameter(i) = value;
+    }
+    SetParameter(classifier, name, parameter);
+  }
+
+  classifier.SetSolver(std::make_unique<SgdSolver<double>>(1.0, 0.0));
+  classifier.Train(feature, labels);
+  for (const auto &[name, parameter] : GetParameters(classifier)) {
+    SCOPED_TRACE(name);
+    MatrixX<double> nabla = parameters.at(name) - parameter;
+    const MatrixX<double> &expected_nabla = expected_nablas.at(name);
+    EXPECT_LE((nabla - expected_nabla).lpNorm<Eigen::Infinity>(),
+              1e-7 + 1e-5 * expected_nabla.lpNorm<Eigen::Infinity>())
+        << nabla << "\n\n"
+        << expected_nabla;
+  }
+}
+
+class ClassifierImplTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    Registry::LoadRegistry();
+    ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(
+        kGraphParameter, &graph_parameter_));
+    feature_.resize(2, 5);
+    feature_ << 0.0, 0.0, 1.0, 1.0, 0.5, 0.0, 1.0, 0.0, 1.0, -0.5;
+  }
+
+  GraphParameter graph_parameter_;
+  MatrixX<double> feature_;
+};
+
+TEST_F(ClassifierImplTest, RaggedBatchesSuccess) {
+  ClassifierImpl<double> classifier(graph_parameter_);
+  MatrixX<double> expected = classifier.GetProbabilityDist(feature_);
+  ASSERT_EQ(expected.cols(), 5);
+
+  // Shrinking and growing the batch within the capacity only rebinds views
+  for (int length : {2, 5, 3, 1, 4}) {
+    MatrixX<double> feature = feature_.leftCols(length);
+    MatrixX<double> act = classifier.GetProbabilityDist(feature);
+    ASSERT_EQ(act.cols(), length);
+    EXPECT_TRUE(act.isApprox(expected.leftCols(length)));
+  }
+}
+
+TEST_F(ClassifierImplTest, PredictRaggedBatchesSuccess) {
+  ClassifierImpl<double> classifier(graph_parameter_);
+  MatrixX<double> expected = classifier.GetProbabilityDist(feature_);
+
+  Workspace<double> workspace;
+  for (int length : {3, 5, 1, 2}) {
+    MatrixX<double> feature = feature_.leftCols(length);
+    MatrixX<double> act = classifier.Predict(feature, &workspace);
+    ASSERT_EQ(act.cols(), length);
+    EXPECT_TRUE(act.isApprox(expected.leftCols(length)));
+  }
+  // The workspace is planned for the power of two above the largest batch
+  EXPECT_EQ(workspace.capacity(), 8);
+}
+
+// Inference between training steps runs with its own plan, in which
+// activations of the chain share storage
+TEST_F(ClassifierImplTest, InferencePlanSharesMemory) {
+  // Replaces the edge from vertex 1 to the output by a chain
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(R"(
+    intermediate_vertex_params { id: 3 type: HIDDEN operation: "Tanh" dims: 3 }
+    intermediate_vertex_params { id: 4 type: HIDDEN operation: "Tanh" dims: 3 }
+    edge_params { id: 1 type: "Dense" vertex_in_id: 1 vertex_out_id: 3 }
+    edge_params { id: 2 type: "Dense" vertex_in_id: 3 vertex_out_id: 4 }
+    edge_params { id: 3 type: "Dense" vertex_in_id: 4 vertex_out_id: 2 }
+  )", &graph_parameter_));
+  graph_parameter_.mutable_edge_params()->DeleteSubrange(1, 1);
+  ClassifierImpl<double> classifier(graph_parameter_);
+  MatrixX<int> labels(1, 5);
+  labels << 0, 1, 1, 0, 1;
+
+  classifier.Train(feature_, labels);
+  EXPECT_EQ(classifier.planned_size(true), 0);
+  MatrixX<double> dist = classifier.GetProbabilityDist(feature_);
+  EXPECT_GT(classifier.planned_size(true), 0);
+  EXPECT_LT(classifier.planned_size(true), classifier.planned_size(false));
+
+  // Switching plans rebinds the vertices without changing the results
+  Workspace<double> workspace;
+  EXPECT_TRUE(dist.isApprox(MatrixX<double>(
+      classifier.Predict(feature_, &workspace))));
+  classifier.Train(feature_, labels);
+  EXPECT_TRUE(classifier.GetProbabilityDist(feature_).isApprox(
+      MatrixX<double>(classifier.Predict(feature_, &workspace))));
+}
+
+// Adds a second Tanh vertex between the input and the output, so that the
+// output vertex has two inbound edges
+constexpr char kFanInParameter[] = R"(
+  intermediate_vertex_params { id: 3 type: HIDDEN operation: "Tanh" dims: 2 }
+  edge_params { id: 2 type: "Dense" vertex_in_id: 0 vertex_out_id: 3 }
+  edge_params { id: 3 type: "Dense" vertex_in_id: 3 vertex_out_id: 2 }
+)";
+
+// The bias of a vertex with several inbound edges is added once by the
+// forward pass, so it is updated once by the solver
+TEST_F(ClassifierImplTest, FanInGradientsMatchLoss) {
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(
+      kFanInParameter, &graph_parameter_));
+  MatrixX<int> labels(1, 5);
+  labels << 0, 1, 1, 0, 1;
+  for (bool flat_parameters : {false, true}) {
+    SCOPED_TRACE(flat_parameters ? "Flat" : "Separate");
+    graph_parameter_.set_flat_parameters(flat_parameters);
+    ClassifierImpl<double> classifier(graph_parameter_);
+    ExpectGradients(classifier, feature_, labels);
+  }
+}
+
+// Reads weights and biases of dense edges in the order they are visited, or
+// writes them back in the same order, e.g. into another graph
+class ParameterCopier : public Visitor<double> {
+public:
+  void Visit(DenseEdgeImpl<double, OpVertex<double>, OpVertex<double>> &edge)
+      override {
+    if (write) {
+      edge.mutable_weight() = weights[index];
+      edge.mutable_bias() = biases[index];
+      ++index;
+    } else {
+      weights.push_back(edge.weight());
+      biases.push_back(edge.mutable_bias());
+    }
+  }
+
+  bool write = false;
+  int index = 0;
+  std::vector<MatrixX<double>> weights;
+  std::vector<MatrixX<double>> biases;
+};
+
+TEST_F(ClassifierImplTest, FlatParametersTrainSuccess) {
+  graph_parameter_.set_num_threads(2);
+  GraphParameter flat_parameter = graph_parameter_;
+  flat_parameter.set_flat_parameters(true);
+  ClassifierImpl<double> classifier(graph_parameter_);
+  ClassifierImpl<double> flat_classifier(flat_parameter);
+  ParameterCopier copier;
+  classifier.Initialize(copier);
+  copier.write = true;
+  flat_classifier.Initialize(copier);
+  classifier.SetSolver(std::make_unique<Momentum<double>>(0.5, 0.9, 0.001));
+  flat_classifier.SetSolver(
+      std::make_unique<Momentum<double>>(0.5, 0.9, 0.001));
+
+  // Both weights and both biases start aligned in the arenas
+  constexpr int kStride = Arena<double>::kStride;
+  EXPECT_EQ(flat_classifier.mutable_flat_parameters().size(), 4 * kStride);
+  EXPECT_EQ(flat_classifier.mutable_flat_stores(0).size(), 4 * kStride);
+
+  // Nablas of the replica are reduced through the arenas, and the solver
+  // sweeps over them like over each edge
+  MatrixX<int> labels(1, 5);
+  labels << 0, 1, 1, 0, 1;
+  for (int i = 0; i < 20; ++i) {
+    classifier.Train(feature_, labels);
+    flat_classifier.Train(feature_, labels);
+  }
+  EXPECT_TRUE(flat_classifier.GetProbabilityDist(feature_).isApprox(
+      classifier.GetProbabilityDist(feature_)));
+
+  ParameterCopier reader;
+  flat_classifier.Initialize(reader);
+  Eigen::Map<VectorX<double>> flat = flat_classifier.mutable_flat_parameters();
+  EXPECT_EQ(flat.head(6), Eigen::Map<VectorX<double>>(
+                              reader.weights[0].data(), 6));
+  EXPECT_EQ(flat.segment(kStride, 3), Eigen::Map<VectorX<double>>(
+                                          reader.weights[1].data(), 3));
+  EXPECT_EQ(flat.segment(2 * kStride, 3), reader.biases[0]);
+  EXPECT_EQ(flat.segment(3 * kStride, 1), reader.biases[1]);
+}
+
+// Solver configs of every registered solver, with and without schedules
+constexpr const char *kSolverConfigs[] = {
+    "type: 'Momentum' eta: 0.1 gamma: 0.5",
+    "type: 'Adagrad' eta: 0.1",
+    "type: 'Adadelta' eta: 1.0",
+    "type: 'Adam' eta: 0.01 beta1: 0.8 epsilon: 1e-6",
+    "type: 'AdaMax' eta: 0.01 schedule { type: 'Cosine' total_steps: 50 }",
+    "type: 'SGD' eta: 0.5 schedule { type: 'Step' step_size: 10 "
+    "gamma: 0.5 warmup_steps: 5 }"};
+
+TEST_F(ClassifierImplTest, ConfiguredSolversTrainSuccess) {
+  MatrixX<int> labels(1, 5);
+  labels << 0, 1, 1, 0, 1;
+  for (const char *solver_config : kSolverConfigs) {
+    SCOPED_TRACE(solver_config);
+    ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(
+        solver_config, graph_parameter_.mutable_solver_config()));
+    ClassifierImpl<double> classifier(graph_parameter_);
+    EXPECT_LT(TrainLossRatio(classifier, feature_, labels, 50), 1.0);
+  }
+}
+
+// A solver of the config updates the parameters like the same solver passed
+// to SetSolver, also through vertices with several inbound edges. Configs
+// hold floats, so values are exact in single precision.
+TEST_F(ClassifierImplTest, ConfiguredSolversMatchSetSolver) {
+  MatrixX<int> labels(1, 5);
+  labels << 0, 1, 1, 0, 1;
+  std::vector<std::pair<const char *, std::function<Solver<double> *()>>>
+      solvers = {
+          {"type: 'Momentum' eta: 0.125 gamma: 0.5",
+           [] { return new Momentum<double>(0.125, 0.5); }},
+          {"type: 'Adagrad' eta: 0.125",
+           [] { return new Adagrad<double>(0.125, 0.0); }},
+          {"type: 'Adadelta' gamma: 0.875",
+           [] { return new Adadelta<double>(0.875, 0.0); }},
+          {"type: 'Adam' eta: 0.0078125 beta1: 0.75 epsilon: 0.0009765625",
+           [] {
+             return new Adam<double>(0.0078125, 0.0, 0.75, 0.999,
+                                     0.0009765625);
+           }},
+          {"type: 'AdaMax' eta: 0.0078125 beta2: 0.984375",
+           [] { return new AdaMax<double>(0.0078125, 0.0, 0.9, 0.984375); }}};
+  for (const char *topology : {"", kFanInParameter}) {
+    SCOPED_TRACE(*topology ? "Fan-in" : "Chain");
+    ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(
+        topology, &graph_parameter_));
+    for (const auto &[solver_config, solver] : solvers) {
+      SCOPED_TRACE(solver_config);
+      ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(
+          solver_config, graph_parameter_.mutable_solver_config()));
+      ClassifierImpl<double> classifier(graph_parameter_);
+      ClassifierImpl<double> set_classifier(graph_parameter_);
+      set_classifier.SetSolver(std::unique_ptr<Solver<double>>(solver()));
+      for (const auto &[name, parameter] : GetParameters(classifier)) {
+        SetParameter(set_classifier, name, parameter);
+      }
+      for (int i = 0; i < 10; ++i) {
+        classifier.Train(feature_, labels);
+        set_classifier.Train(feature_, labels);
+      }
+      std::map<std::string, MatrixX<double>> parameters =
+          GetParameters(classifier);
+      for (const auto &[name, parameter] : GetParameters(set_classifier)) {
+        SCOPED_TRACE(name);
+        EXPECT_TRUE(parameter.isApprox(parameters.at(name)));
+      }
+    }
+  }
+}
+
+// Solvers sweep over the flat arenas like over each edge, also when a vertex
+// has several inbound edges, and schedules scale both the same way
+TEST_F(ClassifierImplTest, ConfiguredSolversTrainFlatParameters) {
+  MatrixX<int> labels(1, 5);
+  labels << 0, 1, 1, 0, 1;
+  for (const char *topology : {"", kFanInParameter}) {
+    SCOPED_TRACE(*topology ? "Fan-in" : "Chain");
+    ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(
+        topology, &graph_parameter_));
+    for (const char *solver_config : kSolverConfigs) {
+      SCOPED_TRACE(solver_config);
+      ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(
+          solver_config, graph_parameter_.mutable_solver_config()));
+      GraphParameter flat_parameter = graph_parameter_;
+      flat_parameter.set_flat_parameters(true);
+      ClassifierImpl<double> classifier(graph_parameter_);
+      ClassifierImpl<double> flat_classifier(flat_parameter);
+      for (const auto &[name, parameter] : GetParameters(classifier)) {
+        SetParameter(flat_classifier, name, parameter);
+      }
+      for (int i = 0; i < 20; ++i) {
+        classifier.Train(feature_, labels);
+        flat_classifier.Train(feature_, labels);
+      }
+      std::map<std::string, MatrixX<double>> parameters =
+          GetParameters(classifier);
+      for (const auto &[name, parameter] : GetParameters(flat_classifier)) {
+        SCOPED_TRACE(name);
+        EXPECT_TRUE(parameter.isApprox(parameters.at(name)));
+      }
+      EXPECT_TRUE(flat_classifier.GetProbabilityDist(feature_).isApprox(
+          classifier.GetProbabilityDist(feature_)));
+    }
+  }
+}
+
+// The first bias-corrected step of Adam moves every weight by about the
+// learning rate, against its nabla
+TEST_F(ClassifierImplTest, AdamFirstStepSuccess) {
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(
+      "type: 'Adam' eta: 0.01 epsilon: 1e-12",
+      graph_parameter_.mutable_solver_config()));
+  MatrixX<int> labels(1, 5);
+  labels << 0, 1, 1, 0, 1;
+  ClassifierImpl<double> classifier(graph_parameter_);
+  std::map<int, MatrixX<double>> weights = GetWeights(classifier);
+  classifier.Train(feature_, labels);
+  for (const auto &[id, weight] : GetWeights(classifier)) {
+    SCOPED_TRACE("Edge " + std::to_string(id));
+    MatrixX<double> step = (weights.at(id) - weight).cwiseAbs();
+    EXPECT_TRUE(step.isApprox(MatrixX<double>::Constant(
+        step.rows(), step.cols(), 0.01), 1e-6))
+        << step;
+  }
+}
+
+// One input, a recurrent vertex of six cells and a CrossEntropy output
+constexpr char kRecurrentGraphParameter[] = R"(
+  solver_config { type: "SGD" eta: 1.0 lambda: 0.0 }
+  length: 5
+  input_vertex_param { id: 0 type: INPUT operation: "DummyTransformer" dims: 1 }
+  output_vertex_param { id: 2 type: OUTPUT operation: "CrossEntropy" dims: 1 }
+  intermediate_vertex_params { id: 1 type: HIDDEN operation: "Lstm" dims: 6 }
+  edge_params { id: 0 type: "Dense" vertex_in_id: 0 vertex_out_id: 1 }
+  edge_params { id: 1 type: "Dense" vertex_in_id: 1 vertex_out_id: 2 }
+)";
+
+class ClassifierImplRecurrentTest : public ::testing::Test {
+protected:
+  static constexpr int kBatchSize = 8;
+
+  void SetUp() override {
+    graph_parameter_ = ParseGraphParameter(kRecurrentGraphParameter);
+    // Time-major sequences whose label is the input of the previous time
+    // step
+    feature_.resize(1, 5 * kBatchSize);
+    labels_ = MatrixX<int>::Zero(1, 5 * kBatchSize);
+    for (int b = 0; b < kBatchSize; ++b) {
+      for (int t = 0; t < 5; ++t) {
+        int bit = (b >> (t % 3)) & 1;
+        feature_(0, t * kBatchSize + b) = bit;
+        if (t + 1 < 5) {
+          labels_(0, (t + 1) * kBatchSize + b) = bit;
+        }
+      }
+    }
+  }
+
+  GraphParameter graph_parameter_;
+  MatrixX<double> feature_;
+  MatrixX<int> labels_;
+};
+
+TEST_F(ClassifierImplRecurrentTest, LstmTrainSuccess) {
+  ClassifierImpl<double> classifier(graph_parameter_);
+  EXPECT_LT(TrainLossRatio(classifier, feature_, labels_, 500), 0.02);
+}
+
+// Backpropagation through time matches the loss of whole sequences, for the
+// edges into and out of the recurrent vertex
+TEST_F(ClassifierImplRecurrentTest, GradientsMatchLoss) {
+  for (const char *operation : {"Lstm", "Gru"}) {
+    SCOPED_TRACE(operation);
+    graph_parameter_.mutable_intermediate_vertex_params(0)->set_operation(
+        operation);
+    ClassifierImpl<double> classifier(graph_parameter_);
+    ExpectGradients(classifier, feature_, labels_);
+  }
+}
+
+// Gate parameters are held by the recurrent vertex, which replicas would
+// train on their own, so the batch is not split across threads
+TEST_F(ClassifierImplRecurrentTest, VertexParametersTrainOnOneThread) {
+  graph_parameter_.set_length(2);
+  graph_parameter_.set_num_threads(4);
+  graph_parameter_.mutable_intermediate_vertex_params(0)->set_operation("Tanh");
+  EXPECT_EQ(ClassifierImpl<double>(graph_parameter_).num_threads(), 4);
+
+  graph_parameter_.mutable_intermediate_vertex_params(0)->set_operation("Lstm");
+  ClassifierImpl<double> classifier(graph_parameter_);
+  EXPECT_EQ(classifier.num_threads(), 1);
+
+  MatrixX<double> feature(1, 8);
+  feature << 0.0, 1.0, 1.0, 0.0, 1.0, 1.0, 0.0, 0.0;
+  MatrixX<int> labels(1, 8);
+  labels << 0, 0, 0, 0, 0, 1, 1, 0;
+  // Whole sequences stay on the calling thread
+  classifier.Train(feature, labels);
+  EXPECT_TRUE(std::isfinite(classifier.CalculateLoss(feature, labels)));
+}
+
+// Two inputs, eight Tanh neurons and a SoftmaxCrossEntropy output of three
+// classes
+constexpr char kSoftmaxGraphParameter[] = R"(
+  solver_config { type: "SGD" eta: 0.5 lambda: 0.0 }
+  length: 6
+  input_vertex_param { id: 0 type: INPUT operation: "DummyTransformer" dims: 2 }
+  output_vertex_param { id: 2 type: OUTPUT operation: "SoftmaxCrossEntropy"
+                        dims: 3 }
+  intermediate_vertex_params { id: 1 type: HIDDEN operation: "Tanh" dims: 8 }
+  edge_params { id: 0 type: "Dense" vertex_in_id: 0 vertex_out_id: 1 }
+  edge_params { id: 1 type: "Dense" vertex_in_id: 1 vertex_out_id: 2 }
+)";
+
+class ClassifierImplSoftmaxTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    graph_parameter_ = ParseGraphParameter(kSoftmaxGraphParameter);
+    // Three clusters labelled by class index rather than one-hot columns
+    feature_.resize(2, 6);
+    feature_ << 1.0, 0.9, -1.0, -0.9, 0.0, 0.1, 0.0, 0.1, 0.0, -0.1, 1.0, 0.9;
+    labels_.resize(1, 6);
+    labels_ << 0, 0, 1, 1, 2, 2;
+  }
+
+  GraphParameter graph_parameter_;
+  MatrixX<double> feature_;
+  MatrixX<int> labels_;
+};
+
+TEST_F(ClassifierImplSoftmaxTest, TrainSuccess) {
+  ClassifierImpl<double> classifier(graph_parameter_);
+  EXPECT_LT(TrainLossRatio(classifier, feature_, labels_, 300), 0.05);
+
+  MatrixX<double> dist = classifier.GetProbabilityDist(feature_);
+  EXPECT_TRUE(dist.colwise().sum().isApprox(MatrixX<double>::Ones(1, 6)));
+  EXPECT_EQ(classifier.CalcConfusionMatrix(feature_, labels_),
+            MatrixX<double>(Eigen::Vector3d::Constant(2.0).asDiagonal()));
+}
+
+// Zero weights and biases give every class the same probability
+TEST_F(ClassifierImplSoftmaxTest, KnownLoss) {
+  ClassifierImpl<double> classifier(graph_parameter_);
+  SetWeight(classifier, 1, MatrixX<double>::Zero(8, 3));
+  EXPECT_DOUBLE_EQ(classifier.CalculateLoss(feature_, labels_),
+                   std::log(3.0));
+
+  // Logits of the first class far beyond the range of the probabilities
+  // keep the loss exact rather than clamped, i.e. the last two examples
+  // cost about 8000 * tanh(1) each
+  MatrixX<double> weight = MatrixX<double>::Zero(8, 3);
+  weight.col(0).setConstant(1000.0);
+  SetWeight(classifier, 0, MatrixX<double>::Ones(2, 8));
+  SetWeight(classifier, 1, weight);
+  VectorX<double> logits =
+      8000.0 * feature_.colwise().sum().array().tanh().transpose();
+  double expected_loss = 0.0;
+  for (int col = 0; col < 6; ++col) {
+    double max_logit = std::max(logits(col), 0.0);
+    double lse = max_logit + std::log(std::exp(logits(col) - max_logit) +
+                                      2.0 * std::exp(-max_logit));
+    expected_loss += lse - (labels_(0, col) == 0 ? logits(col) : 0.0);
+  }
+  EXPECT_NEAR(classifier.CalculateLoss(feature_, labels_), expected_loss / 6,
+              1e-9 * expected_loss);
+}
+
+TEST_F(ClassifierImplSoftmaxTest, GradientsMatchLoss) {
+  ClassifierImpl<double> classifier(graph_parameter_);
+  ExpectGradients(classifier, feature_, labels_);
+}
+
+// One-hot labels train the same way as class indices
+TEST_F(ClassifierImplSoftmaxTest, OneHotLabelsMatchClassIndices) {
+  MatrixX<int> one_hot = MatrixX<int>::Zero(3, 6);
+  for (int col = 0; col < 6; ++col) {
+    one_hot(labels_(0, col), col) = 1;
+  }
+  ClassifierImpl<double> classifier(graph_parameter_);
+  ClassifierImpl<double> one_hot_classifier(graph_parameter_);
+  for (const auto &[id, weight] : GetWeights(classifier)) {
+    SetWeight(one_hot_classifier, id, weight);
+  }
+
+  EXPECT_DOUBLE_EQ(classifier.CalculateLoss(feature_, labels_),
+                   one_hot_classifier.CalculateLoss(feature_, one_hot));
+  classifier.Train(feature_, labels_);
+  one_hot_classifier.Train(feature_, one_hot);
+  EXPECT_TRUE(GetWeights(classifier).at(0).isApprox(
+      GetWeights(one_hot_classifier).at(0)));
+  EXPECT_TRUE(GetWeights(classifier).at(1).isApprox(
+      GetWeights(one_hot_classifier).at(1)));
+}
+
+// Eight inputs embedded straight into a sampled softmax of 5000 classes
+constexpr char kSampledSoftmaxGraphParameter[] = R"(
+  solver_config { type: "SGD" eta: 0.5 lambda: 0.0 }
+  length: 8
+  input_vertex_param { id: 0 type: INPUT operation: "DummyTransformer" dims: 8 }
+  output_vertex_param {
+    id: 1 type: OUTPUT operation: "LogUniformSampledSoftmax" dims: 8
+    sampled_softmax_param { num_classes: 5000 num_sampled: 32 }
+  }
+  edge_params { id: 0 type: "Dense" vertex_in_id: 0 vertex_out_id: 1 }
+)";
+
+class ClassifierImplSampledSoftmaxTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    graph_parameter_ = ParseGraphParameter(kSampledSoftmaxGraphParameter);
+    // Weights are initialized reproducibly, and the vertex draws negatives
+    // from a default-seeded generator
+    SeedRandom(1);
+    // One-hot features of classes scattered over the vocabulary
+    feature_ = MatrixX<double>::Identity(8, 8);
+    labels_.resize(1, 8);
+    labels_ << 3, 17, 256, 1000, 2048, 3071, 4000, 4999;
+  }
+
+  GraphParameter graph_parameter_;
+  MatrixX<double> feature_;
+  MatrixX<int> labels_;
+};
+
+TEST_F(ClassifierImplSampledSoftmaxTest, TrainSuccess) {
+  ClassifierImpl<double> classifier(graph_parameter_);
+  // Small initial logits spread the full softmax evenly over the classes
+  EXPECT_NEAR(classifier.CalculateLoss(feature_, labels_), std::log(5000.0),
+              0.5);
+  EXPECT_LT(TrainLossRatio(classifier, feature_, labels_, 300), 0.1);
+
+  // The exact top-k predicts the classes without the full distribution.
+  // Rare classes are seldom drawn as negatives, so the sampled loss ranks
+  // them only roughly against frequent ones, but every label makes the top
+  // three.
+  MatrixX<int> classes;
+  MatrixX<double> probabilities;
+  classifier.GetTopK(feature_, 3, &classes, &probabilities);
+  ASSERT_EQ(classes.rows(), 3);
+  ASSERT_EQ(classes.cols(), 8);
+  for (int col = 0; col < 8; ++col) {
+    EXPECT_TRUE((classes.col(col).array() == labels_(0, col)).any())
+        << "Class " << labels_(0, col) << " is not in the top three.";
+    EXPECT_GE(probabilities(0, col), probabilities(1, col));
+    EXPECT_GE(probabilities(1, col), probabilities(2, col));
+  }
+}
+
+// Zero embeddings score every class with its zero bias
+TEST_F(ClassifierImplSampledSoftmaxTest, KnownLoss) {
+  ClassifierImpl<double> classifier(graph_parameter_);
+  SetWeight(classifier, 0, MatrixX<double>::Zero(8, 8));
+  EXPECT_NEAR(classifier.CalculateLoss(feature_, labels_), std::log(5000.0),
+              1e-9);
+
+  MatrixX<int> classes;
+  MatrixX<double> probabilities;
+  classifier.GetTopK(feature_, 2, &classes, &probabilities);
+  EXPECT_TRUE(probabilities.isApprox(
+      MatrixX<double>::Constant(2, 8, 1.0 / 5000.0)));
+}
+
+// The blocked log-sum-exp of CalcLoss and the blocked top-k agree on the
+// probability of the classes they both score
+TEST_F(ClassifierImplSampledSoftmaxTest, TopKMatchesLoss) {
+  ClassifierImpl<double> classifier(graph_parameter_);
+  // Spreads the logits beyond the ones of a freshly initialized graph
+  SetWeight(classifier, 0, 10.0 * GetWeights(classifier).at(0));
+
+  MatrixX<int> classes;
+  MatrixX<double> probabilities;
+  classifier.GetTopK(feature_, 3, &classes, &probabilities);
+  for (int col = 0; col < 8; ++col) {
+    for (int k = 0; k < 3; ++k) {
+      MatrixX<int> label = classes.block(k, col, 1, 1);
+      EXPECT_NEAR(classifier.CalculateLoss(feature_.col(col), label),
+                  -std::log(probabilities(k, col)), 1e-9);
+    }
+  }
+}
+
+// A thousand bag-of-words inputs, four Tanh neurons and a CrossEntropy output
+constexpr char kSparseGraphParameter[] = R"(
+  solver_config { type: "SGD" eta: 0.5 lambda: 0.001 }
+  length: 8
+  input_vertex_param { id: 0 type: INPUT operation: "SparseTransformer"
+                       dims: 1000 }
+  output_vertex_param { id: 2 type: OUTPUT operation: "CrossEntropy" dims: 1 }
+  intermediate_vertex_params { id: 1 type: HIDDEN operation: "Tanh" dims: 4 }
+  edge_params { id: 0 type: "SparseDense" vertex_in_id: 0 vertex_out_id: 1 }
+  edge_params { id: 1 type: "Dense" vertex_in_id: 1 vertex_out_id: 2 }
+)";
+
+class ClassifierImplSparseTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    graph_parameter_ = ParseGraphParameter(kSparseGraphParameter);
+    // Bag-of-words examples whose label tells whether word 7 is present
+    std::vector<Eigen::Triplet<double>> triplets;
+    labels_.resize(1, 8);
+    for (int b = 0; b < 8; ++b) {
+      triplets.emplace_back(10 + b, b, 1.0);
+      if (b % 2 == 1) {
+        triplets.emplace_back(7, b, 1.0);
+      }
+      labels_(0, b) = b % 2;
+    }
+    feature_.resize(1000, 8);
+    feature_.setFromTriplets(triplets.begin(), triplets.end());
+  }
+
+  GraphParameter graph_parameter_;
+  SparseMatrix<double> feature_;
+  MatrixX<int> labels_;
+};
+
+TEST_F(ClassifierImplSparseTest, TrainSuccess) {
+  ClassifierImpl<double> classifier(graph_parameter_);
+  MatrixX<double> weight = GetWeights(classifier).at(0);
+
+  // Only the weight columns of words present in the batch are updated, and
+  // the L2 regularization of the other columns is skipped as well
+  classifier.Train(feature_, labels_);
+  MatrixX<double> trained_weight = GetWeights(classifier).at(0);
+  EXPECT_NE(trained_weight.col(7), weight.col(7));
+  EXPECT_NE(trained_weight.col(10), weight.col(10));
+  EXPECT_EQ(trained_weight.leftCols(7), weight.leftCols(7));
+  EXPECT_EQ(trained_weight.rightCols(982), weight.rightCols(982));
+
+  EXPECT_LT(TrainLossRatio(classifier, feature_, labels_, 200), 0.1);
+}
+
+// Nablas of the columns of absent words are zero, and those of present words
+// are gathered from the batch
+TEST_F(ClassifierImplSparseTest, GradientsMatchLoss) {
+  graph_parameter_.mutable_solver_config()->set_lambda(0.0);
+  ClassifierImpl<double> classifier(graph_parameter_);
+  ExpectGradients(classifier, feature_, labels_);
+}
+
+// A SparseDense edge trains like a Dense edge fed by the same features, whose
+// weight is the transpose of the sparse one
+TEST_F(ClassifierImplSparseTest, MatchesDenseEdge) {
+  graph_parameter_.mutable_solver_config()->set_lambda(0.0);
+  GraphParameter dense_parameter = graph_parameter_;
+  dense_parameter.mutable_input_vertex_param()->set_operation(
+      "DummyTransformer");
+  dense_parameter.mutable_edge_params(0)->set_type("Dense");
+  ClassifierImpl<double> classifier(graph_parameter_);
+  ClassifierImpl<double> dense_classifier(dense_parameter);
+  std::map<int, MatrixX<double>> weights = GetWeights(classifier);
+  SetWeight(dense_classifier, 0, weights.at(0).transpose());
+  SetWeight(dense_classifier, 1, weights.at(1));
+
+  MatrixX<double> dense_feature = feature_;
+  EXPECT_DOUBLE_EQ(classifier.CalculateLoss(feature_, labels_),
+                   dense_classifier.CalculateLoss(dense_feature, labels_));
+  for (int i = 0; i < 10; ++i) {
+    classifier.Train(feature_, labels_);
+    dense_classifier.Train(dense_feature, labels_);
+  }
+  EXPECT_TRUE(classifier.GetProbabilityDist(feature_).isApprox(
+      dense_classifier.GetProbabilityDist(dense_feature)));
+  EXPECT_TRUE(GetWeights(classifier).at(0).isApprox(
+      GetWeights(dense_classifier).at(0).transpose()));
+}
+
+} // namespace
+} // namespace intellgraph
@@ -105,6 +105,26 @@ template <typename T> GraphBuilder<T> &GraphBuilder<T>::SetLength(int length) {
   return *this;
 }
 
+template <typename T>
+GraphBuilder<T> &GraphBuilder<T>::SetNumThreads(int num_threads) {
+  DCHECK_GT(num_threads, 0);
+  graph_parameter_.set_num_threads(num_threads);
+  return *this;
+}
+
+template <typename T>
+GraphBuilder<T> &GraphBuilder<T>::SetNumInterOpThreads(int num_threads) {
+  DCHECK_GT(num_threads, 0);
+  graph_parameter_.set_num_inter_op_threads(num_threads);
+  return *this;
+}
+
+template <typename T>
+GraphBuilder<T> &GraphBuilder<T>::SetBatchBucketing(bool batch_bucketing) {
+  graph_parameter_.set_batch_bucketing(batch_bucketing);
+  return *this;
+}
+
 template <typename T> const GraphParameter &GraphBuilder<T>::graph_parameter() {
   return graph_parameter_;
 }
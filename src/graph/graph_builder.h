@@ -39,6 +39,9 @@ public:
   GraphBuilder<T> &AddEdge(const EdgeParameter &edge_param);
   GraphBuilder<T> &AddSolver(const SolverConfig &solver_config);
   GraphBuilder<T> &SetLength(int length);
+  GraphBuilder<T> &SetNumThreads(int num_threads);
+  GraphBuilder<T> &SetNumInterOpThreads(int num_threads);
+  GraphBuilder<T> &SetBatchBucketing(bool batch_bucketing);
   const GraphParameter &graph_parameter();
   ClassifierImpl<T> BuildClassifier();
 
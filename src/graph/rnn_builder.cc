@@ -22,11 +22,10 @@ template <typename T> RnnBuilder<T>::RnnBuilder() = default;
 template <typename T> RnnBuilder<T>::~RnnBuilder() = default;
 
 template <typename T>
-RnnBuilder<T> &RnnBuilder<T>::AddEdge(const std::string &edge_type,
+RnnBuilder<T> &RnnBuilder<T>::AddEdge(int edge_id, const std::string &edge_type,
                                       const VertexParameter &vtx_param_in,
                                       const VertexParameter &vtx_param_out) {
-  DCHECK(!edge_type.empty());
-  graph_builder_.add_edge(edge_type, vtx_param_in, vtx_param_out);
+  graph_builder_.AddEdge(edge_id, edge_type, vtx_param_in, vtx_param_out);
   return *this;
 }
 
@@ -36,39 +35,46 @@ RnnBuilder<T> &RnnBuilder<T>::AddStateVertexPair(int state_in, int state_out) {
   DCHECK_GE(state_out, 0);
   DCHECK_NE(state_in, state_out);
 
-  if (state_out_by_state_in_.find(state_in) != state_out_by_state_in_.end()) {
+  if (!rnn_parameter_.mutable_state_vertex_map()
+           ->insert({state_in, state_out})
+           .second) {
     LOG(ERROR) << "Failed to add state vertex pair (" << state_in << ", "
                << state_out << "), state vertices have already been added.";
-    return;
   }
-  state_out_by_state_in_.insert(state_in, state_out);
-}
-
-template <typename T> RnnBuilder<T> &RnnBuilder<T>::SetInputVertexId(int id) {
-  DCHECK_GE(id, 0);
-  graph_builder_.set_input_vertex_id(id);
   return *this;
 }
 
-template <typename T> RnnBuilder<T> &RnnBuilder<T>::SetOutputVertexId(int id) {
-  DCHECK_GE(id, 0);
-  graph_builder_.set_output_vertex_id(id);
+template <typename T>
+RnnBuilder<T> &RnnBuilder<T>::AddSolver(const SolverConfig &solver_config) {
+  graph_builder_.AddSolver(solver_config);
   return *this;
 }
 
 template <typename T>
-RnnBuilder<T> &
-RnnBuilder<T>::SetInitVisitor(std::unique_ptr<Visitor<T>> init_visitor) {
-  DCHECK(init_visitor);
-  init_visitor_ = std::move(init_visitor);
+RnnBuilder<T> &RnnBuilder<T>::SetSequenceLength(int sequence_length) {
+  graph_builder_.SetLength(sequence_length);
   return *this;
 }
 
 template <typename T>
-RnnBuilder<T> &RnnBuilder<T>::SetSolver(std::unique_ptr<Solver<T>> solver) {
-  DCHECK(solver);
-  solver_ = std::move(solver);
+RnnBuilder<T> &RnnBuilder<T>::SetTruncationLength(int truncation_length) {
+  DCHECK_GT(truncation_length, 0);
+  rnn_parameter_.set_truncation_length(truncation_length);
   return *this;
 }
 
+template <typename T> RnnImpl<T> RnnBuilder<T>::BuildRnn() {
+  GraphParameter graph_parameter = graph_builder_.graph_parameter();
+  LOG_IF(ERROR, graph_parameter.length() == 0)
+      << "Build the RNN failed, sequence length hasn't been set!";
+  LOG_IF(ERROR, rnn_parameter_.state_vertex_map().empty())
+      << "Build the RNN failed, state vertex pairs haven't been added!";
+  graph_parameter.MergeFrom(rnn_parameter_);
+  return RnnImpl<T>(graph_parameter);
+}
+
+// Explicit instantiation
+template class RnnBuilder<float>;
+template class RnnBuilder<double>;
+
 } // namespace intellgraph
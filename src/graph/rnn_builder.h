@@ -15,35 +15,43 @@ Contributor(s):
 #ifndef INTELLGRAPH_SRC_GRAPH_RNN_BUILDER_H_
 #define INTELLGRAPH_SRC_GRAPH_RNN_BUILDER_H_
 
-#include <map>
 #include <string>
 
 #include "src/graph/graph_builder.h"
+#include "src/graph/rnn_impl.h"
+#include "src/proto/graph_parameter.pb.h"
+#include "src/proto/vertex_parameter.pb.h"
 
 namespace intellgraph {
 
+// RnnBuilder builds the graph of a single time step like GraphBuilder, plus
+// the pairs of state vertices that connect consecutive time steps
 template <typename T> class RnnBuilder {
 public:
   RnnBuilder();
   ~RnnBuilder();
 
-  RnnBuilder &AddEdge(const std::string &edge_type,
-                      const VertexParameter &vtx_param_in,
-                      const VertexParameter &vtx_param_out);
-  RnnBuilder &AddStateVertexPair(int state_in, int state_out);
-
-  RnnBuilder &SetInputVertexId(int id);
-  RnnBuilder &SetOutputVertexId(int id);
-  RnnBuilder &SetInitVisitor(std::unique_ptr<Visitor<T>> init_visitor);
-  RnnBuilder &SetSolver(std::unique_ptr<Solver<T>> solver);
+  RnnBuilder<T> &AddEdge(int edge_id, const std::string &edge_type,
+                         const VertexParameter &vtx_param_in,
+                         const VertexParameter &vtx_param_out);
+  // Feeds vertex |state_in| with the activation vertex |state_out| had at the
+  // previous time step
+  RnnBuilder<T> &AddStateVertexPair(int state_in, int state_out);
+  RnnBuilder<T> &AddSolver(const SolverConfig &solver_config);
+  RnnBuilder<T> &SetSequenceLength(int sequence_length);
+  RnnBuilder<T> &SetTruncationLength(int truncation_length);
+  RnnImpl<T> BuildRnn();
 
 private:
   GraphBuilder<T> graph_builder_;
-  std::map<int, int> state_out_by_state_in_;
-  std::unique_ptr<Visitor<T>> init_visitor_;
-  std::unique_ptr<Solver<T>> solver_;
+  GraphParameter rnn_parameter_;
 };
 
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class RnnBuilder<float>;
+extern template class RnnBuilder<double>;
+
 } // namespace intellgraph
 
 #endif // INTELLGRAPH_SRC_GRAPH_RNN_BUILDER_H_
@@ -2,7 +2,7 @@
 Licensed under the Apache License, Version 2.0 (the "License");
 you may not use this file except in compliance with the License.
 You may obtain a copy of the License at
-    http://www.apache.org/licenses/LICENSE-1.0
+    http://www.apache.org/licenses/LICENSE-2.0
 Unless required by applicable law or agreed to in writing, software
 distributed under the License is distributed on an "AS IS" BASIS,
 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
@@ -14,15 +14,14 @@ Contributor(s):
 ==============================================================================*/
 #include "src/graph/rnn_impl.h"
 
-#include "boost/graph/adjacency_list.hpp"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
 #include "glog/logging.h"
 #include "src/factory.h"
 #include "src/proto/graph_parameter.pb.h"
 #include "src/proto/vertex_parameter.pb.h"
-#include "src/visitor/backward_visitor.h"
-#include "src/visitor/forward_visitor.h"
-#include "src/visitor/init_vertex_visitor.h"
-#include "src/visitor/resize_vertex_visitor.h"
 
 namespace intellgraph {
 
@@ -32,15 +31,20 @@ RnnImpl<T>::RnnImpl(const GraphParameter &graph_parameter)
       sequence_length_(graph_parameter.length()) {
   DCHECK_GT(sequence_length_, 0);
 
+  truncation_length_ = graph_parameter.truncation_length();
+  if (truncation_length_ < 1 || truncation_length_ > sequence_length_) {
+    truncation_length_ = sequence_length_;
+  }
+
   if (graph_parameter.has_solver_config()) {
     solver_ =
         Factory::InstantiateSolver<Solver<T>>(graph_parameter.solver_config());
+    if (graph_parameter.solver_config().has_schedule()) {
+      scheduler_ =
+          std::make_unique<LrScheduler<T>>(graph_parameter.solver_config());
+    }
   }
 
-  // Builds the default |threshold_|
-  threshold_ = MatrixX<T>(graph_parameter.output_vertex_param().dims(), 1);
-  threshold_.setConstant(0.5);
-
   // Instantiates the input vertex
   std::unique_ptr<InputVertex<T>> input_vertex =
       Factory::InstantiateVertex<InputVertex<T>>(
@@ -77,6 +81,239 @@ RnnImpl<T>::RnnImpl(const GraphParameter &graph_parameter)
                      edge_type, edge_id, vertex_by_id_.at(vtx_in_id).get(),
                      vertex_by_id_.at(vtx_out_id).get()));
   }
+
+  this->CompileSchedule(vertex_by_id_, edge_by_id_);
+  this->SetNumInterOpThreads(graph_parameter.num_inter_op_threads());
+
+  // Every vertex with inbound edges is computed at every time step
+  std::map<int, int> buffer_by_vertex_id;
+  for (const auto &step : this->forward_steps_) {
+    if (step.edge_begin != step.edge_end) {
+      buffer_by_vertex_id[step.vertex->id()] = window_buffers_.size();
+      window_buffers_.push_back({step.vertex, nullptr, nullptr, false});
+    }
+  }
+
+  for (const auto &[state_in_id, state_out_id] :
+       graph_parameter.state_vertex_map()) {
+    if (!vertex_by_id_.count(state_in_id) ||
+        buffer_by_vertex_id.count(state_in_id) ||
+        state_in_id == input_vertex_->id()) {
+      LOG(DFATAL) << "The state input vertex " << state_in_id
+                  << " must be a vertex without inbound edges.";
+      continue;
+    }
+    if (!buffer_by_vertex_id.count(state_out_id) ||
+        state_out_id == output_vertex_->id()) {
+      LOG(DFATAL) << "The state output vertex " << state_out_id
+                  << " must be an intermediate vertex with inbound edges.";
+      continue;
+    }
+    OpVertex<T> *state_in = vertex_by_id_.at(state_in_id).get();
+    int state_out = buffer_by_vertex_id.at(state_out_id);
+    DCHECK_EQ(state_in->row(), window_buffers_[state_out].vertex->row());
+    window_buffers_[state_out].state = true;
+    state_pairs_.push_back({state_in, state_out});
+    // The state output vertex also receives the delta of its state input
+    // vertex at the next time step
+    this->AccumulateDelta(state_out_id);
+  }
+}
+
+template <typename T> RnnImpl<T>::~RnnImpl() = default;
+
+template <typename T> void RnnImpl<T>::Initialize(Visitor<T> &init_visitor) {
+  this->Traverse(init_visitor);
+}
+
+template <typename T>
+void RnnImpl<T>::Train(const MatrixX<T> &feature,
+                       const Eigen::Ref<const MatrixX<int>> &labels) {
+  DCHECK(solver_);
+  DCHECK_EQ(feature.rows(), input_vertex_->row());
+  DCHECK_EQ(feature.cols(), labels.cols());
+  DCHECK_EQ(feature.cols() % sequence_length_, 0);
+
+  PlanWindow(feature.cols() / sequence_length_);
+  for (int begin = 0; begin < sequence_length_; begin += truncation_length_) {
+    int num_steps = std::min(truncation_length_, sequence_length_ - begin);
+    for (int step = 0; step < num_steps; ++step) {
+      BindStep(feature, begin, step);
+      this->Propagate(forward_assign_visitor_, forward_accumulate_visitor_);
+    }
+    BackwardWindow(feature, labels, begin, num_steps);
+    if (scheduler_) {
+      scheduler_->Step(solver_.get());
+    }
+    solver_->Step();
+    this->Traverse(*solver_);
+    CarryState(num_steps);
+  }
+}
+
+template <typename T>
+T RnnImpl<T>::CalculateLoss(const MatrixX<T> &test_feature,
+                            const MatrixX<int> &test_labels) {
+  DCHECK_EQ(test_feature.cols(), test_labels.cols());
+
+  T loss = 0;
+  output_vertex_->set_loss_path(true);
+  ForwardSequences(test_feature, [&](int time_step) {
+    loss += output_vertex_->CalcLoss(
+        test_labels.middleCols(time_step * batch_size_, batch_size_)
+            .template cast<T>());
+  });
+  output_vertex_->set_loss_path(false);
+  return loss / sequence_length_;
+}
+
+template <typename T>
+void RnnImpl<T>::SetSolver(std::unique_ptr<Solver<T>> solver) {
+  DCHECK(solver);
+  solver_ = std::move(solver);
+}
+
+template <typename T>
+MatrixX<T> RnnImpl<T>::GetProbabilityDist(const MatrixX<T> &feature) {
+  MatrixX<T> result(output_vertex_->row(), feature.cols());
+  ForwardSequences(feature, [&](int time_step) {
+    result.middleCols(time_step * batch_size_, batch_size_) =
+        output_vertex_->act();
+  });
+  return result;
+}
+
+template <typename T> void RnnImpl<T>::PlanWindow(int batch_size) {
+  DCHECK_GT(batch_size, 0);
+  if (batch_size != batch_size_) {
+    batch_size_ = batch_size;
+    // Buffers of the window are carved out of a single arena, which only
+    // grows, so windows and batches of the same size reuse the storage
+    size_t size = 0;
+    for (const WindowBuffer &buffer : window_buffers_) {
+      size += Arena<T>::Align(slot_size(buffer) *
+                              (truncation_length_ + buffer.state));
+      size += Arena<T>::Align(slot_size(buffer) * truncation_length_);
+    }
+    arena_.Reserve(size);
+    T *data = arena_.data();
+    for (WindowBuffer &buffer : window_buffers_) {
+      buffer.act = data;
+      data += Arena<T>::Align(slot_size(buffer) *
+                              (truncation_length_ + buffer.state));
+      buffer.delta = data;
+      data += Arena<T>::Align(slot_size(buffer) * truncation_length_);
+    }
+  }
+  // Sequences start from a zero state
+  for (const StatePair &pair : state_pairs_) {
+    const WindowBuffer &state_out = window_buffers_[pair.state_out];
+    std::fill_n(state_out.act, slot_size(state_out), T(0));
+  }
+}
+
+template <typename T>
+void RnnImpl<T>::BindStep(const MatrixX<T> &feature, int begin, int step) {
+  int time_step = begin + step;
+  input_vertex_->set_feature(Eigen::Map<const MatrixX<T>>(
+      feature.data() +
+          static_cast<size_t>(time_step) * batch_size_ * feature.rows(),
+      feature.rows(), batch_size_));
+  for (const WindowBuffer &buffer : window_buffers_) {
+    size_t size = slot_size(buffer);
+    buffer.vertex->BindBuffers(buffer.act + (step + buffer.state) * size,
+                               buffer.delta + step * size, batch_size_);
+  }
+  // A state input vertex reads the state of the previous time step, and
+  // writes its delta into the delta of that time step, except at the first
+  // time step of the window where backpropagation is truncated
+  for (const StatePair &pair : state_pairs_) {
+    const WindowBuffer &state_out = window_buffers_[pair.state_out];
+    size_t size = slot_size(state_out);
+    pair.state_in->BindBuffers(
+        state_out.act + step * size,
+        step > 0 ? state_out.delta + (step - 1) * size : nullptr,
+        batch_size_);
+  }
+}
+
+template <typename T>
+void RnnImpl<T>::BindWindow(const MatrixX<T> &feature, int begin,
+                            int num_steps) {
+  int length = num_steps * batch_size_;
+  input_vertex_->set_feature(Eigen::Map<const MatrixX<T>>(
+      feature.data() +
+          static_cast<size_t>(begin) * batch_size_ * feature.rows(),
+      feature.rows(), length));
+  for (const WindowBuffer &buffer : window_buffers_) {
+    buffer.vertex->BindBuffers(buffer.act + buffer.state * slot_size(buffer),
+                               buffer.delta, length);
+  }
+  for (const StatePair &pair : state_pairs_) {
+    pair.state_in->BindBuffers(window_buffers_[pair.state_out].act, nullptr,
+                               length);
+  }
+}
+
+template <typename T>
+template <class Callback>
+void RnnImpl<T>::ForwardSequences(const MatrixX<T> &feature,
+                                  Callback &&on_step) {
+  DCHECK_EQ(feature.rows(), input_vertex_->row());
+  DCHECK_EQ(feature.cols() % sequence_length_, 0);
+
+  PlanWindow(feature.cols() / sequence_length_);
+  for (int begin = 0; begin < sequence_length_; begin += truncation_length_) {
+    int num_steps = std::min(truncation_length_, sequence_length_ - begin);
+    for (int step = 0; step < num_steps; ++step) {
+      BindStep(feature, begin, step);
+      this->Propagate(forward_assign_visitor_, forward_accumulate_visitor_);
+      on_step(begin + step);
+    }
+    CarryState(num_steps);
+  }
+}
+
+template <typename T>
+void RnnImpl<T>::BackwardWindow(const MatrixX<T> &feature,
+                                const Eigen::Ref<const MatrixX<int>> &labels,
+                                int begin, int num_steps) {
+  for (int step = num_steps - 1; step >= 0; --step) {
+    BindStep(feature, begin, step);
+    output_vertex_->CalcDelta(
+        labels.middleCols((begin + step) * batch_size_, batch_size_)
+            .template cast<T>());
+    if (step == num_steps - 1) {
+      // No delta flows back from beyond the window
+      for (const StatePair &pair : state_pairs_) {
+        window_buffers_[pair.state_out].vertex->mutable_delta().setZero();
+      }
+    }
+    this->BackPropagate(backward_assign_visitor_,
+                        backward_accumulate_visitor_);
+  }
+
+  // Nablas are averaged over all time steps of the window at once
+  BindWindow(feature, begin, num_steps);
+  for (auto &[edge_id, edge] : edge_by_id_) {
+    edge->CalcNablaWeight();
+    if (edge->owns_bias()) {
+      edge->CalcNablaBias();
+    }
+  }
 }
 
+template <typename T> void RnnImpl<T>::CarryState(int num_steps) {
+  for (const StatePair &pair : state_pairs_) {
+    const WindowBuffer &state_out = window_buffers_[pair.state_out];
+    size_t size = slot_size(state_out);
+    std::memcpy(state_out.act, state_out.act + num_steps * size,
+                size * sizeof(T));
+  }
+}
+
+// Explicit instantiation
+template class RnnImpl<float>;
+template class RnnImpl<double>;
+
 } // namespace intellgraph
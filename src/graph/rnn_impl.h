@@ -2,7 +2,7 @@
 Licensed under the Apache License, Version 2.0 (the "License");
 you may not use this file except in compliance with the License.
 You may obtain a copy of the License at
-    http://www.apache.org/licenses/LICENSE-1.0
+    http://www.apache.org/licenses/LICENSE-2.0
 Unless required by applicable law or agreed to in writing, software
 distributed under the License is distributed on an "AS IS" BASIS,
 WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
@@ -16,7 +16,8 @@ Contributor(s):
 #define INTELLGRAPH_SRC_GRAPH_RNN_IMPL_H_
 
 #include <map>
-#include <set>
+#include <memory>
+#include <vector>
 
 #include "src/edge.h"
 #include "src/edge/op_vertex.h"
@@ -26,25 +27,115 @@ Contributor(s):
 #include "src/graph.h"
 #include "src/proto/graph_parameter.pb.h"
 #include "src/solver.h"
+#include "src/solver/lr_scheduler.h"
+#include "src/tensor/arena.h"
 #include "src/visitor.h"
+#include "src/visitor/backward_visitor.h"
+#include "src/visitor/forward_visitor.h"
 
 namespace intellgraph {
 
+// RnnImpl trains a recurrent graph with truncated backpropagation through
+// time. The graph describes a single time step: state input vertices, which
+// have no inbound edges, are fed with the activation their state output
+// vertex had at the previous time step, see state_vertex_map in
+// GraphParameter. Sequences start from a zero state.
+//
+// A batch holds sequences of |length| time steps, column t * batch_size + b
+// of a feature or label matrix being time step t of sequence b, so that the
+// columns of a time step are contiguous. A time step of all sequences runs as
+// one pass over the graph, i.e. one GEMM per edge. Sequences are unrolled for
+// |truncation_length| time steps at a time: activations and deltas of the
+// window are kept in an arena that is reused by every window, deltas flow
+// back within the window only, nablas are calculated with one GEMM per edge
+// over the whole window, and the solver runs once per window. The state is
+// carried over to the next window.
 template <typename T> class RnnImpl : public Graph<T> {
 public:
-  RnnImpl(const GraphParameter &graph_parameter);
-  ~RnnImpl() override = default;
+  explicit RnnImpl(const GraphParameter &graph_parameter);
+  ~RnnImpl() override;
+
+  void Initialize(Visitor<T> &init_visitor) override;
+  void Train(const MatrixX<T> &feature,
+             const Eigen::Ref<const MatrixX<int>> &labels) override;
+  // Returns the loss averaged over time steps and sequences
+  T CalculateLoss(const MatrixX<T> &test_feature,
+                  const MatrixX<int> &test_labels) override;
+  void SetSolver(std::unique_ptr<Solver<T>> solver) override;
+
+  // Returns the activations of the output vertex at every time step, in the
+  // layout of the labels
+  MatrixX<T> GetProbabilityDist(const MatrixX<T> &feature);
+
+  int sequence_length() const { return sequence_length_; }
+  int truncation_length() const { return truncation_length_; }
 
 private:
+  // Window buffers of a vertex computed at every time step. Activations of a
+  // state output vertex have an additional leading slot that holds the state
+  // carried over from the previous window, so that the activations of its
+  // state input vertex over the window are contiguous as well.
+  struct WindowBuffer {
+    OpVertex<T> *vertex;
+    T *act;
+    T *delta;
+    bool state;
+  };
+  struct StatePair {
+    OpVertex<T> *state_in;
+    // Index of the window buffer of the state output vertex
+    int state_out;
+  };
+
+  // Lays out window buffers for batches of |batch_size| sequences and zeros
+  // the states
+  void PlanWindow(int batch_size);
+  // Binds the vertices to time step |step| of the window starting at time
+  // step |begin|
+  void BindStep(const MatrixX<T> &feature, int begin, int step);
+  // Binds the vertices to all |num_steps| time steps of the window
+  void BindWindow(const MatrixX<T> &feature, int begin, int num_steps);
+  // Runs the forward passes of |feature| window by window, and calls
+  // |on_step| with the time step of the sequences after each pass
+  template <class Callback>
+  void ForwardSequences(const MatrixX<T> &feature, Callback &&on_step);
+  // Runs the backward passes of the window in reverse time order and
+  // calculates nablas over the window
+  void BackwardWindow(const MatrixX<T> &feature,
+                      const Eigen::Ref<const MatrixX<int>> &labels, int begin,
+                      int num_steps);
+  // Copies the last state of the window into the leading state slots
+  void CarryState(int num_steps);
+  size_t slot_size(const WindowBuffer &buffer) const {
+    return static_cast<size_t>(buffer.vertex->row()) * batch_size_;
+  }
+
+  ForwardVisitor<T> forward_assign_visitor_{false};
+  ForwardVisitor<T> forward_accumulate_visitor_{true};
+  BackwardVisitor<T> backward_assign_visitor_{false, false};
+  BackwardVisitor<T> backward_accumulate_visitor_{true, false};
+
   int sequence_length_;
+  int truncation_length_;
+  int batch_size_ = 0;
   std::unique_ptr<Solver<T>> solver_;
-  MatrixX<T> threshold_;
+  // Schedule of the learning rate of the solver, if the solver config has one
+  std::unique_ptr<LrScheduler<T>> scheduler_;
   InputVertex<T> *input_vertex_ = nullptr;
   OutputVertex<T> *output_vertex_ = nullptr;
   std::map<int, std::unique_ptr<OpVertex<T>>> vertex_by_id_;
   std::map<int, std::unique_ptr<Edge<T>>> edge_by_id_;
+
+  Arena<T> arena_;
+  std::vector<WindowBuffer> window_buffers_;
+  std::vector<StatePair> state_pairs_;
 };
 
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class RnnImpl<float>;
+extern template class RnnImpl<double>;
+
 } // namespace intellgraph
 
 #endif // INTELLGRAPH_SRC_GRAPH_RNN_IMPL_H_
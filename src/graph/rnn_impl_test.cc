@@ -0,0 +1,236 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/graph/rnn_impl.h"
+
+#include <map>
+#include <memory>
+
+#include "google/protobuf/text_format.h"
+#include "src/edge.h"
+#include "src/edge/dense_edge_impl.h"
+#include "src/eigen.h"
+#include "src/graph/rnn_builder.h"
+#include "src/proto/graph_parameter.pb.h"
+#include "src/proto/vertex_parameter.pb.h"
+#include "src/registry.h"
+#include "src/solver.h"
+#include "src/solver/sgd_solver.h"
+#include "src/visitor.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+// A single time step: the hidden vertex 2 is fed by the input vertex 0 and by
+// its own activation of the previous time step through the state vertex 1
+constexpr char kGraphParameter[] = R"(
+  solver_config { type: "SGD" eta: 0.5 lambda: 0.0 }
+  length: 6
+  input_vertex_param { id: 0 type: INPUT operation: "DummyTransformer" dims: 1 }
+  output_vertex_param { id: 3 type: OUTPUT operation: "CrossEntropy" dims: 1 }
+  intermediate_vertex_params { id: 1 type: HIDDEN operation: "Tanh" dims: 4 }
+  intermediate_vertex_params { id: 2 type: HIDDEN operation: "Tanh" dims: 4 }
+  edge_params { id: 0 type: "Dense" vertex_in_id: 0 vertex_out_id: 2 }
+  edge_params { id: 1 type: "Dense" vertex_in_id: 1 vertex_out_id: 2 }
+  edge_params { id: 2 type: "Dense" vertex_in_id: 2 vertex_out_id: 3 }
+  state_vertex_map { key: 1 value: 2 }
+)";
+
+// Records nablas rather than updating parameters
+class NablaRecorder : public Solver<double> {
+public:
+  void Visit(Edge<double> &edge) override {
+    nabla_weight_by_id[edge.id()] = edge.mutable_nabla_weight();
+  }
+
+  std::map<int, MatrixX<double>> nabla_weight_by_id;
+};
+
+// Adds |delta| to an element of the weight of an edge
+class WeightPerturber : public Visitor<double> {
+public:
+  WeightPerturber(int edge_id, int row, int col, double delta)
+      : edge_id_(edge_id), row_(row), col_(col), delta_(delta) {}
+
+  void Visit(DenseEdgeImpl<double, OpVertex<double>, OpVertex<double>> &edge)
+      override {
+    if (edge.id() == edge_id_) {
+      edge.mutable_weight()(row_, col_) += delta_;
+    }
+  }
+
+private:
+  int edge_id_;
+  int row_;
+  int col_;
+  double delta_;
+};
+
+// Adds |delta| to an element of the bias of the outbound vertex of an edge,
+// or copies that bias
+class BiasPerturber : public Visitor<double> {
+public:
+  BiasPerturber(int edge_id, int row, double delta)
+      : edge_id_(edge_id), row_(row), delta_(delta) {}
+
+  void Visit(DenseEdgeImpl<double, OpVertex<double>, OpVertex<double>> &edge)
+      override {
+    if (edge.id() == edge_id_) {
+      edge.mutable_bias()(row_, 0) += delta_;
+      bias = edge.mutable_bias();
+    }
+  }
+
+  MatrixX<double> bias;
+
+private:
+  int edge_id_;
+  int row_;
+  double delta_;
+};
+
+class RnnImplTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    Registry::LoadRegistry();
+    ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(
+        kGraphParameter, &graph_parameter_));
+
+    // The label of a time step is the input of the previous time step, so
+    // the task can only be learned through the state
+    constexpr int kBatchSize = 8;
+    int sequence_length = graph_parameter_.length();
+    feature_.resize(1, sequence_length * kBatchSize);
+    labels_.resize(1, sequence_length * kBatchSize);
+    for (int b = 0; b < kBatchSize; ++b) {
+      for (int t = 0; t < sequence_length; ++t) {
+        int bit = (b * 7 + t * 3 + b * t) % 5 < 2;
+        feature_(0, t * kBatchSize + b) = bit;
+        if (t + 1 < sequence_length) {
+          labels_(0, (t + 1) * kBatchSize + b) = bit;
+        }
+      }
+      labels_(0, b) = 0;
+    }
+  }
+
+  GraphParameter graph_parameter_;
+  MatrixX<double> feature_;
+  MatrixX<int> labels_;
+};
+
+TEST_F(RnnImplTest, GradientSuccess) {
+  RnnImpl<double> rnn(graph_parameter_);
+  ASSERT_EQ(rnn.truncation_length(), rnn.sequence_length());
+  auto recorder = std::make_unique<NablaRecorder>();
+  NablaRecorder *nablas = recorder.get();
+  rnn.SetSolver(std::move(recorder));
+  rnn.Train(feature_, labels_);
+
+  // Without truncation, nablas are the gradient of the loss averaged over
+  // time steps and sequences
+  constexpr double kEpsilon = 1e-6;
+  for (int edge_id : {0, 1, 2}) {
+    const MatrixX<double> &nabla_weight = nablas->nabla_weight_by_id[edge_id];
+    ASSERT_GT(nabla_weight.size(), 0);
+    for (int row = 0; row < nabla_weight.rows(); ++row) {
+      for (int col = 0; col < nabla_weight.cols(); ++col) {
+        WeightPerturber plus(edge_id, row, col, kEpsilon);
+        WeightPerturber minus(edge_id, row, col, -2 * kEpsilon);
+        WeightPerturber restore(edge_id, row, col, kEpsilon);
+        rnn.Traverse(plus);
+        double loss_plus = rnn.CalculateLoss(feature_, labels_);
+        rnn.Traverse(minus);
+        double loss_minus = rnn.CalculateLoss(feature_, labels_);
+        rnn.Traverse(restore);
+        EXPECT_NEAR(nabla_weight(row, col),
+                    (loss_plus - loss_minus) / (2 * kEpsilon), 1e-6);
+      }
+    }
+  }
+}
+
+// The hidden vertex is fed by the input and by the state, and its bias is
+// updated once per step rather than once per inbound edge
+TEST_F(RnnImplTest, HiddenBiasGradientSuccess) {
+  RnnImpl<double> rnn(graph_parameter_);
+  rnn.SetSolver(std::make_unique<SgdSolver<double>>(1.0, 0.0));
+
+  constexpr double kEpsilon = 1e-6;
+  BiasPerturber reader(0, 0, 0.0);
+  rnn.Traverse(reader);
+  MatrixX<double> bias = reader.bias;
+  ASSERT_EQ(bias.rows(), 4);
+  VectorX<double> expected_nabla(bias.rows());
+  for (int row = 0; row < bias.rows(); ++row) {
+    BiasPerturber plus(0, row, kEpsilon);
+    BiasPerturber minus(0, row, -2 * kEpsilon);
+    BiasPerturber restore(0, row, kEpsilon);
+    rnn.Traverse(plus);
+    double loss_plus = rnn.CalculateLoss(feature_, labels_);
+    rnn.Traverse(minus);
+    double loss_minus = rnn.CalculateLoss(feature_, labels_);
+    rnn.Traverse(restore);
+    expected_nabla(row) = (loss_plus - loss_minus) / (2 * kEpsilon);
+  }
+
+  rnn.Train(feature_, labels_);
+  rnn.Traverse(reader);
+  for (int row = 0; row < bias.rows(); ++row) {
+    EXPECT_NEAR(bias(row, 0) - reader.bias(row, 0), expected_nabla(row),
+                1e-6);
+  }
+}
+
+TEST_F(RnnImplTest, TruncatedTrainSuccess) {
+  RnnBuilder<double> rnn_builder;
+  VertexParameter vtx_param_in, vtx_param_state, vtx_param_hidden,
+      vtx_param_out;
+  google::protobuf::TextFormat::ParseFromString(
+      "id: 0 type: INPUT operation: 'DummyTransformer' dims: 1", &vtx_param_in);
+  google::protobuf::TextFormat::ParseFromString(
+      "id: 1 type: HIDDEN operation: 'Tanh' dims: 4", &vtx_param_state);
+  google::protobuf::TextFormat::ParseFromString(
+      "id: 2 type: HIDDEN operation: 'Tanh' dims: 4", &vtx_param_hidden);
+  google::protobuf::TextFormat::ParseFromString(
+      "id: 3 type: OUTPUT operation: 'CrossEntropy' dims: 1", &vtx_param_out);
+  RnnImpl<double> rnn =
+      rnn_builder.AddEdge(0, "Dense", vtx_param_in, vtx_param_hidden)
+          .AddEdge(1, "Dense", vtx_param_state, vtx_param_hidden)
+          .AddEdge(2, "Dense", vtx_param_hidden, vtx_param_out)
+          .AddStateVertexPair(1, 2)
+          .AddSolver(graph_parameter_.solver_config())
+          .SetSequenceLength(graph_parameter_.length())
+          .SetTruncationLength(2)
+          .BuildRnn();
+  ASSERT_EQ(rnn.truncation_length(), 2);
+
+  double loss = rnn.CalculateLoss(feature_, labels_);
+  for (int i = 0; i < 300; ++i) {
+    rnn.Train(feature_, labels_);
+  }
+  EXPECT_LT(rnn.CalculateLoss(feature_, labels_), 0.5 * loss);
+
+  MatrixX<double> act = rnn.GetProbabilityDist(feature_);
+  ASSERT_EQ(act.rows(), 1);
+  ASSERT_EQ(act.cols(), feature_.cols());
+  // The state carries the input of the previous time step, also across
+  // windows
+  EXPECT_EQ(((act.array() > 0.5).cast<int>() == labels_.array()).count(),
+            labels_.size());
+}
+
+} // namespace
+} // namespace intellgraph
@@ -0,0 +1,233 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_GRAPH_STATIC_GRAPH_H_
+#define INTELLGRAPH_SRC_GRAPH_STATIC_GRAPH_H_
+
+#include <cmath>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "glog/logging.h"
+#include "src/eigen.h"
+#include "src/proto/graph_parameter.pb.h"
+#include "src/utility/random.h"
+
+namespace intellgraph {
+
+// A fully connected layer of |Dims| neurons, activated with the |Algorithm|
+// policy of OpVertexImpl, e.g. Relu, or of OutputVertexImpl for the last
+// layer, e.g. CrossEntropy
+template <int Dims, class Algorithm> struct Layer {
+  static_assert(Dims > 0, "A layer has at least one neuron");
+  static constexpr int kDims = Dims;
+  using Operation = Algorithm;
+};
+
+// StaticGraph is a classifier made of a chain of Dense edges whose shapes are
+// known at compile time, e.g.
+//   StaticGraph<float, 2, Layer<4, Relu>, Layer<1, CrossEntropy>>
+// is a network with two inputs, a hidden layer of four Relu neurons and a
+// single output neuron.
+//
+// Unlike ClassifierImpl, there are no vertices, edges or visitors: weights and
+// biases are fixed-size Eigen matrices held by value, unless they exceed
+// kMaxFixedSize coefficients and are allocated on the heap instead, and
+// layers are unrolled by templates, so that the forward pass, the backward
+// pass and the SGD update of a training step are inlined into Train(). It
+// suits small networks, whose training is dominated by virtual dispatch in
+// ClassifierImpl. Headers declaring a StaticGraph can be generated from a
+// GraphParameter with static_graph_codegen.
+template <typename T, int InputDims, class... Layers> class StaticGraph {
+public:
+  static constexpr int kNumLayers = sizeof...(Layers);
+  static_assert(kNumLayers > 0, "A graph has at least one layer");
+
+  // Dimensions of the input, followed by dimensions of the layers
+  static constexpr int kDims[kNumLayers + 1] = {InputDims, Layers::kDims...};
+
+  // Coefficients of the largest weight or bias held by value. Larger ones
+  // would overflow the stack of a graph declared as a local variable
+  static constexpr int kMaxFixedSize = 4096;
+
+  template <int I>
+  using LayerAt = std::tuple_element_t<I, std::tuple<Layers...>>;
+  // The weight and the bias of the edge that feeds layer |I|
+  template <int I>
+  using Weight =
+      std::conditional_t<kDims[I] * kDims[I + 1] <= kMaxFixedSize,
+                         Eigen::Matrix<T, kDims[I], kDims[I + 1]>, MatrixX<T>>;
+  template <int I>
+  using Bias = std::conditional_t<kDims[I + 1] <= kMaxFixedSize,
+                                  Eigen::Matrix<T, kDims[I + 1], 1>,
+                                  Eigen::Matrix<T, Eigen::Dynamic, 1>>;
+  // Activations and deltas of layer |I|, with a column per instance
+  template <int I>
+  using Activation = Eigen::Matrix<T, kDims[I + 1], Eigen::Dynamic>;
+  using Output = Activation<kNumLayers - 1>;
+
+  // Instantiates the graph with the SGD solver of |graph_parameter|, which
+  // describes the same chain of layers
+  explicit StaticGraph(const GraphParameter &graph_parameter)
+      : StaticGraph(graph_parameter.solver_config().eta(),
+                    graph_parameter.solver_config().lambda()) {
+    DCHECK_EQ(graph_parameter.input_vertex_param().dims(), InputDims);
+    DCHECK_EQ(graph_parameter.output_vertex_param().dims(),
+              kDims[kNumLayers]);
+    DCHECK_EQ(graph_parameter.intermediate_vertex_params_size(),
+              kNumLayers - 1);
+    DCHECK_EQ(graph_parameter.edge_params_size(), kNumLayers);
+    CHECK(!graph_parameter.has_solver_config() ||
+          graph_parameter.solver_config().type() == "SGD")
+        << "StaticGraph only supports the SGD solver.";
+  }
+
+  // Instantiates the graph with a SGD solver of learning rate |eta| and
+  // weight decay |lambda|
+  StaticGraph(T eta, T lambda) : eta_(eta), lambda_(lambda) {
+    DCHECK_GE(eta_, 0.0);
+    DCHECK_GE(lambda_, 0.0);
+    Initialize<0>();
+  }
+
+  void Train(const MatrixX<T> &feature,
+             const Eigen::Ref<const MatrixX<int>> &labels) {
+    DCHECK_EQ(feature.cols(), labels.cols());
+    Forward<0>(feature);
+    labels_ = labels.cast<T>();
+    Output &act = std::get<kNumLayers - 1>(acts_);
+    Output &delta = std::get<kNumLayers - 1>(deltas_);
+    delta.resize(Eigen::NoChange, act.cols());
+    LayerAt<kNumLayers - 1>::Operation::template CalcDelta<T>(
+        AsMatrix(act), AsMatrix(labels_), AsMatrix(delta));
+    Backward<kNumLayers - 1>(feature);
+  }
+
+  T CalculateLoss(const MatrixX<T> &test_feature,
+                  const MatrixX<int> &test_labels) {
+    Forward<0>(test_feature);
+    labels_ = test_labels.cast<T>();
+    return LayerAt<kNumLayers - 1>::Operation::template CalcLoss<T>(
+        AsMatrix(std::get<kNumLayers - 1>(acts_)), AsMatrix(labels_));
+  }
+
+  // Returns the probability distribution of |feature|, which is valid until
+  // the next call
+  const Output &GetProbabilityDist(const MatrixX<T> &feature) {
+    Forward<0>(feature);
+    return std::get<kNumLayers - 1>(acts_);
+  }
+
+  template <int I> Weight<I> &mutable_weight() {
+    return std::get<I>(weights_);
+  }
+
+  template <int I> Bias<I> &mutable_bias() { return std::get<I>(biases_); }
+
+private:
+  template <size_t... Is>
+  static std::tuple<Weight<Is>...> WeightsOf(std::index_sequence<Is...>);
+  template <size_t... Is>
+  static std::tuple<Bias<Is>...> BiasesOf(std::index_sequence<Is...>);
+  template <size_t... Is>
+  static std::tuple<Activation<Is>...>
+  ActivationsOf(std::index_sequence<Is...>);
+
+  using Indices = std::make_index_sequence<kNumLayers>;
+
+  // Layer policies work on dynamic matrices. Single-row activations are
+  // stored row-major by Eigen, so they are mapped rather than referenced
+  template <class Matrix> static Eigen::Map<MatrixX<T>> AsMatrix(Matrix &m) {
+    return Eigen::Map<MatrixX<T>>(m.data(), m.rows(), m.cols());
+  }
+
+  template <class Matrix>
+  static Eigen::Map<const MatrixX<T>> AsMatrix(const Matrix &m) {
+    return Eigen::Map<const MatrixX<T>>(m.data(), m.rows(), m.cols());
+  }
+
+  // Initializes weights of layer |I| and the following ones the same way as
+  // DenseEdgeImpl, and zeroes their biases
+  template <int I> void Initialize() {
+    Weight<I> &weight = std::get<I>(weights_);
+    weight = Weight<I>::Zero(kDims[I], kDims[I + 1])
+                 .unaryExpr(std::function<T(T)>(
+                     NormalFunctor<T>(0.0, std::sqrt(2.0 / kDims[I + 1]))));
+    std::get<I>(biases_).setZero(kDims[I + 1]);
+    if constexpr (I + 1 < kNumLayers) {
+      Initialize<I + 1>();
+    }
+  }
+
+  // Returns the input of layer |I|
+  template <int I> const auto &InputOf(const MatrixX<T> &feature) const {
+    if constexpr (I == 0) {
+      return feature;
+    } else {
+      return std::get<I - 1>(acts_);
+    }
+  }
+
+  // Calculates activations of layer |I| and the following ones
+  template <int I> void Forward(const MatrixX<T> &feature) {
+    if constexpr (I == 0) {
+      DCHECK_EQ(feature.rows(), InputDims);
+    }
+    Activation<I> &act = std::get<I>(acts_);
+    act.noalias() = std::get<I>(weights_).transpose() * InputOf<I>(feature);
+    act.colwise() += std::get<I>(biases_);
+    LayerAt<I>::Operation::template Activate<T>(AsMatrix(act));
+    if constexpr (I + 1 < kNumLayers) {
+      Forward<I + 1>(feature);
+    }
+  }
+
+  // Propagates the delta of layer |I| to the previous layers, and updates
+  // weights and biases of the edges along the way
+  template <int I> void Backward(const MatrixX<T> &feature) {
+    const Activation<I> &delta = std::get<I>(deltas_);
+    Weight<I> &weight = std::get<I>(weights_);
+    if constexpr (I > 0) {
+      // The delta is propagated before |weight| is updated
+      Activation<I - 1> &delta_in = std::get<I - 1>(deltas_);
+      delta_in.noalias() = weight * delta;
+      LayerAt<I - 1>::Operation::template Derive<T>(
+          AsMatrix(std::get<I - 1>(acts_)), AsMatrix(delta_in));
+    }
+
+    // Nablas are averaged over the batch
+    T scale = eta_ / delta.cols();
+    weight *= 1.0 - eta_ * lambda_;
+    weight.noalias() -= scale * InputOf<I>(feature) * delta.transpose();
+    std::get<I>(biases_).noalias() -= scale * delta.rowwise().sum();
+
+    if constexpr (I > 0) {
+      Backward<I - 1>(feature);
+    }
+  }
+
+  T eta_ = 0.0;
+  T lambda_ = 0.0;
+  decltype(WeightsOf(Indices())) weights_;
+  decltype(BiasesOf(Indices())) biases_;
+  decltype(ActivationsOf(Indices())) acts_;
+  decltype(ActivationsOf(Indices())) deltas_;
+  Output labels_;
+};
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_GRAPH_STATIC_GRAPH_H_
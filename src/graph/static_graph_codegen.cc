@@ -0,0 +1,56 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "glog/logging.h"
+#include "google/protobuf/text_format.h"
+#include "src/graph/static_graph_generator.h"
+#include "src/proto/graph_parameter.pb.h"
+
+// Generates a StaticGraph header from a GraphParameter in the protobuf text
+// format, and writes it to the standard output:
+//   static_graph_codegen <graph_parameter.pbtxt> <name> > <name>.h
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  if (argc != 3) {
+    LOG(ERROR) << "Usage: " << argv[0] << " <graph_parameter.pbtxt> <name>";
+    return 1;
+  }
+
+  std::ifstream file(argv[1]);
+  if (!file) {
+    LOG(ERROR) << "Failed to open " << argv[1];
+    return 1;
+  }
+  std::stringstream text;
+  text << file.rdbuf();
+
+  intellgraph::GraphParameter graph_parameter;
+  if (!google::protobuf::TextFormat::ParseFromString(text.str(),
+                                                     &graph_parameter)) {
+    LOG(ERROR) << "Failed to parse " << argv[1];
+    return 1;
+  }
+
+  std::string header;
+  if (!intellgraph::GenerateStaticGraph(graph_parameter, argv[2], &header)) {
+    return 1;
+  }
+  std::cout << header;
+  return 0;
+}
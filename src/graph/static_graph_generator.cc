@@ -0,0 +1,150 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/graph/static_graph_generator.h"
+
+#include <cctype>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include "glog/logging.h"
+#include "src/proto/edge_parameter.pb.h"
+#include "src/proto/vertex_parameter.pb.h"
+
+namespace intellgraph {
+
+namespace {
+
+// Headers of operations that are supported by StaticGraph
+const std::map<std::string, std::string> &IntermediateOperations() {
+  static const std::map<std::string, std::string> operations = {
+      {"LeakyRelu", "src/edge/vertex/leaky_relu.h"},
+      {"Relu", "src/edge/vertex/relu.h"},
+      {"Sigmoid", "src/edge/vertex/sigmoid.h"},
+      {"Tanh", "src/edge/vertex/tanh.h"}};
+  return operations;
+}
+
+const std::map<std::string, std::string> &OutputOperations() {
+  static const std::map<std::string, std::string> operations = {
+      {"CrossEntropy", "src/edge/vertex/cross_entropy.h"},
+      {"SigmoidL2", "src/edge/vertex/sigmoid_l2.h"},
+      {"SoftmaxCrossEntropy", "src/edge/vertex/softmax_cross_entropy.h"}};
+  return operations;
+}
+
+} // namespace
+
+bool GenerateStaticGraph(const GraphParameter &graph_parameter,
+                         const std::string &name, std::string *header) {
+  DCHECK(!name.empty());
+  DCHECK(header);
+
+  // Train() of StaticGraph only implements the SGD update
+  if (graph_parameter.has_solver_config() &&
+      graph_parameter.solver_config().type() != "SGD") {
+    LOG(ERROR) << "Solver " << graph_parameter.solver_config().type()
+               << " is not supported.";
+    return false;
+  }
+
+  std::map<int, const VertexParameter *> vertex_by_id;
+  vertex_by_id[graph_parameter.input_vertex_param().id()] =
+      &graph_parameter.input_vertex_param();
+  vertex_by_id[graph_parameter.output_vertex_param().id()] =
+      &graph_parameter.output_vertex_param();
+  for (const auto &vertex_param :
+       graph_parameter.intermediate_vertex_params()) {
+    vertex_by_id[vertex_param.id()] = &vertex_param;
+  }
+
+  // Every vertex of a chain has at most one outbound edge
+  std::map<int, int> next_by_id;
+  for (const auto &edge_param : graph_parameter.edge_params()) {
+    if (edge_param.type() != "Dense") {
+      LOG(ERROR) << "Edge " << edge_param.id() << " is not a Dense edge.";
+      return false;
+    }
+    if (!next_by_id.try_emplace(edge_param.vertex_in_id(),
+                                edge_param.vertex_out_id())
+             .second) {
+      LOG(ERROR) << "Vertex " << edge_param.vertex_in_id()
+                 << " has more than one outbound edge.";
+      return false;
+    }
+  }
+
+  // Walks the chain from the input vertex to the output vertex
+  std::vector<const VertexParameter *> layers;
+  std::set<std::string> includes = {"src/graph/static_graph.h"};
+  int output_id = graph_parameter.output_vertex_param().id();
+  int vertex_id = graph_parameter.input_vertex_param().id();
+  while (vertex_id != output_id) {
+    auto next = next_by_id.find(vertex_id);
+    if (next == next_by_id.end() || !vertex_by_id.count(next->second) ||
+        layers.size() == vertex_by_id.size()) {
+      LOG(ERROR) << "Vertex " << vertex_id << " is not connected to the "
+                 << "output vertex.";
+      return false;
+    }
+    vertex_id = next->second;
+    const VertexParameter *vertex_param = vertex_by_id.at(vertex_id);
+    const auto &operations =
+        vertex_id == output_id ? OutputOperations() : IntermediateOperations();
+    auto operation = operations.find(vertex_param->operation());
+    if (operation == operations.end()) {
+      LOG(ERROR) << "Operation " << vertex_param->operation() << " of vertex "
+                 << vertex_id << " is not supported.";
+      return false;
+    }
+    includes.insert(operation->second);
+    layers.push_back(vertex_param);
+  }
+  size_t num_edges = graph_parameter.edge_params_size();
+  if (layers.size() + 1 != vertex_by_id.size() || layers.size() != num_edges) {
+    LOG(ERROR) << "The graph is not a chain.";
+    return false;
+  }
+
+  std::string guard = "INTELLGRAPH_GENERATED_";
+  for (char c : name) {
+    unsigned char uc = static_cast<unsigned char>(c);
+    guard += std::isalnum(uc) ? static_cast<char>(std::toupper(uc)) : '_';
+  }
+  guard += "_H_";
+
+  std::ostringstream out;
+  out << "// Generated by static_graph_codegen, do not edit.\n"
+      << "#ifndef " << guard << "\n"
+      << "#define " << guard << "\n\n";
+  for (const auto &include : includes) {
+    out << "#include \"" << include << "\"\n";
+  }
+  out << "\nnamespace intellgraph {\n\n"
+      << "template <typename T>\n"
+      << "using " << name << " = StaticGraph<T, "
+      << graph_parameter.input_vertex_param().dims();
+  for (const VertexParameter *layer : layers) {
+    out << ", Layer<" << layer->dims() << ", " << layer->operation() << ">";
+  }
+  out << ">;\n\n"
+      << "} // namespace intellgraph\n\n"
+      << "#endif // " << guard << "\n";
+  *header = out.str();
+  return true;
+}
+
+} // namespace intellgraph
@@ -0,0 +1,36 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_GRAPH_STATIC_GRAPH_GENERATOR_H_
+#define INTELLGRAPH_SRC_GRAPH_STATIC_GRAPH_GENERATOR_H_
+
+#include <string>
+
+#include "src/proto/graph_parameter.pb.h"
+
+namespace intellgraph {
+
+// Generates a header that declares |name| as an alias template of the
+// StaticGraph described by |graph_parameter|, e.g.
+//   template <typename T>
+//   using Name = StaticGraph<T, 2, Layer<4, Relu>, Layer<1, CrossEntropy>>;
+// Returns false if the graph is not a chain of Dense edges from the input
+// vertex to the output vertex, or uses an operation or a solver StaticGraph
+// cannot run.
+bool GenerateStaticGraph(const GraphParameter &graph_parameter,
+                         const std::string &name, std::string *header);
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_GRAPH_STATIC_GRAPH_GENERATOR_H_
@@ -0,0 +1,160 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/graph/static_graph.h"
+
+#include <cmath>
+#include <string>
+
+#include "google/protobuf/text_format.h"
+#include "src/edge/vertex/cross_entropy.h"
+#include "src/edge/vertex/relu.h"
+#include "src/edge/vertex/tanh.h"
+#include "src/eigen.h"
+#include "src/graph/static_graph_generator.h"
+#include "src/proto/graph_parameter.pb.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+// Two inputs, three Relu neurons and a CrossEntropy output
+constexpr char kGraphParameter[] = R"(
+  solver_config { type: "SGD" eta: 0.5 lambda: 0.0 }
+  length: 4
+  input_vertex_param { id: 0 type: INPUT operation: "DummyTransformer" dims: 2 }
+  output_vertex_param { id: 2 type: OUTPUT operation: "CrossEntropy" dims: 1 }
+  intermediate_vertex_params { id: 1 type: HIDDEN operation: "Relu" dims: 3 }
+  edge_params { id: 0 type: "Dense" vertex_in_id: 0 vertex_out_id: 1 }
+  edge_params { id: 1 type: "Dense" vertex_in_id: 1 vertex_out_id: 2 }
+)";
+
+TEST(StaticGraphTest, GetProbabilityDistSuccess) {
+  StaticGraph<float, 2, Layer<3, Relu>, Layer<1, CrossEntropy>> graph(0.5f,
+                                                                      0.0f);
+  graph.mutable_weight<0>() << 1.0f, -1.0f, 0.5f, 2.0f, 1.0f, -0.5f;
+  graph.mutable_bias<0>() << 0.1f, 0.2f, 0.3f;
+  graph.mutable_weight<1>() << 1.0f, -2.0f, 0.5f;
+  graph.mutable_bias<1>() << -0.1f;
+
+  MatrixX<float> feature(2, 2);
+  feature << 1.0f, -1.0f, 0.5f, 2.0f;
+
+  MatrixX<float> hidden =
+      (graph.mutable_weight<0>().transpose() * feature).colwise() +
+      graph.mutable_bias<0>();
+  hidden = hidden.cwiseMax(0.0f);
+  MatrixX<float> output =
+      (graph.mutable_weight<1>().transpose() * hidden).array() - 0.1f;
+  output = 1.0f / (1.0f + (-output.array()).exp());
+
+  const auto &act = graph.GetProbabilityDist(feature);
+  ASSERT_EQ(act.cols(), 2);
+  EXPECT_FLOAT_EQ(act(0, 0), output(0, 0));
+  EXPECT_FLOAT_EQ(act(0, 1), output(0, 1));
+}
+
+TEST(StaticGraphTest, TrainSuccess) {
+  StaticGraph<double, 2, Layer<2, Tanh>, Layer<1, CrossEntropy>> graph(0.1,
+                                                                       0.0);
+  MatrixX<double> feature(2, 4);
+  feature << 0.0, 0.0, 1.0, 1.0, 0.0, 1.0, 0.0, 1.0;
+  MatrixX<int> labels(1, 4);
+  labels << 0, 1, 1, 0;
+
+  // The output weight moves against the nabla of the cross entropy loss,
+  // averaged over the batch
+  MatrixX<double> hidden =
+      ((graph.mutable_weight<0>().transpose() * feature).colwise() +
+       graph.mutable_bias<0>())
+          .array()
+          .tanh();
+  MatrixX<double> delta =
+      graph.GetProbabilityDist(feature) - labels.cast<double>();
+  Eigen::Matrix<double, 2, 1> expected_weight =
+      graph.mutable_weight<1>() - 0.1 / 4 * hidden * delta.transpose();
+
+  double loss = graph.CalculateLoss(feature, labels);
+  graph.Train(feature, labels);
+  EXPECT_TRUE(graph.mutable_weight<1>().isApprox(expected_weight));
+
+  // Loss decreases along the gradient
+  for (int i = 0; i < 100; ++i) {
+    graph.Train(feature, labels);
+  }
+  EXPECT_LT(graph.CalculateLoss(feature, labels), loss);
+}
+
+TEST(StaticGraphTest, GenerateStaticGraphSuccess) {
+  GraphParameter graph_parameter;
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(kGraphParameter,
+                                                            &graph_parameter));
+
+  std::string header;
+  ASSERT_TRUE(GenerateStaticGraph(graph_parameter, "Mlp", &header));
+  EXPECT_NE(header.find("#include \"src/edge/vertex/cross_entropy.h\""),
+            std::string::npos);
+  EXPECT_NE(header.find("#include \"src/edge/vertex/relu.h\""),
+            std::string::npos);
+  EXPECT_NE(header.find("using Mlp = StaticGraph<T, 2, Layer<3, Relu>, "
+                        "Layer<1, CrossEntropy>>;"),
+            std::string::npos);
+
+  // The generated graph is fed by the same parameter
+  StaticGraph<float, 2, Layer<3, Relu>, Layer<1, CrossEntropy>> graph(
+      graph_parameter);
+  EXPECT_EQ(graph.GetProbabilityDist(MatrixX<float>::Ones(2, 4)).cols(), 4);
+}
+
+TEST(StaticGraphTest, GenerateStaticGraphFailure) {
+  GraphParameter graph_parameter;
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(kGraphParameter,
+                                                            &graph_parameter));
+  // A skip connection makes the graph a DAG rather than a chain
+  EdgeParameter *edge_param = graph_parameter.add_edge_params();
+  edge_param->set_id(2);
+  edge_param->set_type("Dense");
+  edge_param->set_vertex_in_id(0);
+  edge_param->set_vertex_out_id(2);
+
+  std::string header;
+  EXPECT_FALSE(GenerateStaticGraph(graph_parameter, "Mlp", &header));
+
+  // StaticGraph only updates its parameters with SGD
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(kGraphParameter,
+                                                            &graph_parameter));
+  graph_parameter.mutable_solver_config()->set_type("Adam");
+  EXPECT_FALSE(GenerateStaticGraph(graph_parameter, "Mlp", &header));
+}
+
+TEST(StaticGraphTest, WideLayerSuccess) {
+  // The hidden weight has 1M coefficients, which are kept on the heap
+  using Graph = StaticGraph<float, 1024, Layer<1024, Relu>,
+                            Layer<1, CrossEntropy>>;
+  static_assert(Graph::Weight<0>::RowsAtCompileTime == Eigen::Dynamic, "");
+  static_assert(Graph::Weight<1>::RowsAtCompileTime == 1024, "");
+  Graph graph(0.1f, 0.0f);
+  EXPECT_EQ(graph.mutable_weight<0>().rows(), 1024);
+  EXPECT_EQ(graph.mutable_weight<0>().cols(), 1024);
+  EXPECT_EQ(graph.mutable_bias<0>().size(), 1024);
+
+  MatrixX<float> feature = MatrixX<float>::Random(1024, 2);
+  MatrixX<int> labels(1, 2);
+  labels << 0, 1;
+  graph.Train(feature, labels);
+  EXPECT_TRUE(std::isfinite(graph.CalculateLoss(feature, labels)));
+}
+
+} // namespace
+} // namespace intellgraph
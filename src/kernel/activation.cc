@@ -0,0 +1,321 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/kernel/activation.h"
+
+#include <cstdint>
+#include <cstring>
+
+// Compiles a kernel for every instruction set in the list, the dynamic
+// loader resolves the kernel to the best version supported by the CPU.
+// Loops only vectorize without trapping math, see src/kernel/CMakeLists.txt
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(__APPLE__)
+#define IG_KERNEL                                                              \
+  __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define IG_KERNEL
+#endif
+
+#define IG_ALWAYS_INLINE inline __attribute__((always_inline))
+
+namespace intellgraph {
+namespace {
+
+// Constants of the exponential, see Cephes Mathematical Library. The input is
+// clamped to the range where the result is a normal number, and reduced to
+// $x=n\ln2+r$ with $|r|\le\ln2/2$, where $\ln2$ is split into a high part
+// exact in the mantissa and a low correction.
+template <typename T> struct ExpTraits;
+
+template <> struct ExpTraits<float> {
+  using Bits = int32_t;
+  static constexpr float kMax = 88.3762626647949f;
+  static constexpr float kMin = -87.3365447504019f;
+  static constexpr float kLog2e = 1.44269504088896341f;
+  static constexpr float kLn2Hi = 0.693359375f;
+  static constexpr float kLn2Lo = -2.12194440e-4f;
+  // Adding 1.5 * 2^23 rounds to the nearest integer, which is then found in
+  // the low bits of the mantissa
+  static constexpr float kRound = 12582912.0f;
+  static constexpr int kMantissa = 23;
+  static constexpr int kBias = 127;
+};
+
+template <> struct ExpTraits<double> {
+  using Bits = int64_t;
+  static constexpr double kMax = 709.437;
+  static constexpr double kMin = -708.396;
+  static constexpr double kLog2e = 1.4426950408889634073599;
+  static constexpr double kLn2Hi = 6.93145751953125E-1;
+  static constexpr double kLn2Lo = 1.42860682030941723212E-6;
+  static constexpr double kRound = 6755399441055744.0;
+  static constexpr int kMantissa = 52;
+  static constexpr int kBias = 1023;
+};
+
+template <typename To, typename From> IG_ALWAYS_INLINE To BitCast(From from) {
+  static_assert(sizeof(To) == sizeof(From), "Sizes do not match");
+  To to;
+  std::memcpy(&to, &from, sizeof(To));
+  return to;
+}
+
+// Returns $e^r$ for $|r|\le\ln2/2$
+IG_ALWAYS_INLINE float ExpReduced(float r) {
+  float p = 1.9875691500E-4f;
+  p = p * r + 1.3981999507E-3f;
+  p = p * r + 8.3334519073E-3f;
+  p = p * r + 4.1665795894E-2f;
+  p = p * r + 1.6666665459E-1f;
+  p = p * r + 5.0000001201E-1f;
+  return p * r * r + r + 1.0f;
+}
+
+IG_ALWAYS_INLINE double ExpReduced(double r) {
+  // Padé approximation $e^r=1+2rP(r^2)/(Q(r^2)-rP(r^2))$
+  double rr = r * r;
+  double p = 1.26177193074810590878E-4;
+  p = p * rr + 3.02994407707441961300E-2;
+  p = p * rr + 9.99999999999999999910E-1;
+  p *= r;
+  double q = 3.00198505138664455042E-6;
+  q = q * rr + 2.52448340349684104192E-3;
+  q = q * rr + 2.27265548208155028766E-1;
+  q = q * rr + 2.00000000000000000009E0;
+  return 1.0 + 2.0 * p / (q - p);
+}
+
+template <typename T> IG_ALWAYS_INLINE T ExpApprox(T x) {
+  using Traits = ExpTraits<T>;
+  using Bits = typename Traits::Bits;
+  x = x < Traits::kMax ? x : Traits::kMax;
+  x = x > Traits::kMin ? x : Traits::kMin;
+  T shifted = x * Traits::kLog2e + Traits::kRound;
+  T n = shifted - Traits::kRound;
+  T r = x - n * Traits::kLn2Hi;
+  r = r - n * Traits::kLn2Lo;
+  // Builds $2^n$ from the exponent bits
+  Bits exponent = BitCast<Bits>(shifted) - BitCast<Bits>(Traits::kRound);
+  T scale = BitCast<T>((exponent + Traits::kBias) << Traits::kMantissa);
+  return ExpReduced(r) * scale;
+}
+
+// Returns $\tanh x$ for $|x|<0.625$, where $1-2/(e^{2x}+1)$ cancels
+IG_ALWAYS_INLINE float TanhSmall(float x) {
+  float z = x * x;
+  float p = -5.70498872745E-3f;
+  p = p * z + 2.06390887954E-2f;
+  p = p * z - 5.37397155531E-2f;
+  p = p * z + 1.33314422036E-1f;
+  p = p * z - 3.33332819422E-1f;
+  return x + x * z * p;
+}
+
+IG_ALWAYS_INLINE double TanhSmall(double x) {
+  double z = x * x;
+  double p = -9.64399179425052238628E-1;
+  p = p * z - 9.92877231001918586564E1;
+  p = p * z - 1.61468768441708447952E3;
+  double q = z + 1.12811678491632931402E2;
+  q = q * z + 2.23548839060100448583E3;
+  q = q * z + 4.84406305325125486048E3;
+  return x + x * z * p / q;
+}
+
+template <typename T> IG_ALWAYS_INLINE T TanhApprox(T x) {
+  T abs_x = x < 0 ? -x : x;
+  T large = static_cast<T>(1) - static_cast<T>(2) / (ExpApprox(2 * abs_x) + 1);
+  large = x < 0 ? -large : large;
+  return abs_x < static_cast<T>(0.625) ? TanhSmall(x) : large;
+}
+
+template <typename T>
+IG_ALWAYS_INLINE void ReluForwardImpl(T *__restrict act, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    act[i] = act[i] > 0 ? act[i] : 0;
+  }
+}
+
+template <typename T>
+IG_ALWAYS_INLINE void ReluBackwardImpl(const T *__restrict act,
+                                       T *__restrict delta, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    delta[i] = act[i] > 0 ? delta[i] : 0;
+  }
+}
+
+template <typename T>
+IG_ALWAYS_INLINE void LeakyReluForwardImpl(T *__restrict act, size_t size,
+                                           T alpha) {
+  for (size_t i = 0; i < size; ++i) {
+    act[i] = act[i] > 0 ? act[i] : alpha * act[i];
+  }
+}
+
+template <typename T>
+IG_ALWAYS_INLINE void LeakyReluBackwardImpl(const T *__restrict act,
+                                            T *__restrict delta, size_t size,
+                                            T alpha) {
+  for (size_t i = 0; i < size; ++i) {
+    delta[i] = act[i] > 0 ? delta[i] : alpha * delta[i];
+  }
+}
+
+template <typename T>
+IG_ALWAYS_INLINE void SigmoidForwardImpl(T *__restrict act, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    act[i] = static_cast<T>(1) / (static_cast<T>(1) + ExpApprox(-act[i]));
+  }
+}
+
+template <typename T>
+IG_ALWAYS_INLINE void SigmoidBackwardImpl(const T *__restrict act,
+                                          T *__restrict delta, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    delta[i] *= act[i] * (static_cast<T>(1) - act[i]);
+  }
+}
+
+template <typename T>
+IG_ALWAYS_INLINE void TanhForwardImpl(T *__restrict act, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    act[i] = TanhApprox(act[i]);
+  }
+}
+
+template <typename T>
+IG_ALWAYS_INLINE void TanhBackwardImpl(const T *__restrict act,
+                                       T *__restrict delta, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    delta[i] *= static_cast<T>(1) - act[i] * act[i];
+  }
+}
+
+template <typename T>
+IG_ALWAYS_INLINE void SoftmaxForwardImpl(T *__restrict act, size_t size) {
+  T max = act[0];
+  for (size_t i = 1; i < size; ++i) {
+    max = act[i] > max ? act[i] : max;
+  }
+  T sum = 0;
+  for (size_t i = 0; i < size; ++i) {
+    act[i] = ExpApprox(act[i] - max);
+    sum += act[i];
+  }
+  T scale = static_cast<T>(1) / sum;
+  for (size_t i = 0; i < size; ++i) {
+    act[i] *= scale;
+  }
+}
+
+template <typename T>
+IG_ALWAYS_INLINE void SoftmaxBackwardImpl(const T *__restrict act,
+                                          T *__restrict delta, size_t size) {
+  // Multiplies |delta| by the Jacobian of the softmax:
+  // $\partial a_i/\partial z_j=a_i(\delta_{ij}-a_j)$
+  T dot = 0;
+  for (size_t i = 0; i < size; ++i) {
+    dot += act[i] * delta[i];
+  }
+  for (size_t i = 0; i < size; ++i) {
+    delta[i] = act[i] * (delta[i] - dot);
+  }
+}
+
+} // namespace
+
+IG_KERNEL void ReluForward(float *act, size_t size) {
+  ReluForwardImpl(act, size);
+}
+
+IG_KERNEL void ReluForward(double *act, size_t size) {
+  ReluForwardImpl(act, size);
+}
+
+IG_KERNEL void ReluBackward(const float *act, float *delta, size_t size) {
+  ReluBackwardImpl(act, delta, size);
+}
+
+IG_KERNEL void ReluBackward(const double *act, double *delta, size_t size) {
+  ReluBackwardImpl(act, delta, size);
+}
+
+IG_KERNEL void LeakyReluForward(float *act, size_t size, float alpha) {
+  LeakyReluForwardImpl(act, size, alpha);
+}
+
+IG_KERNEL void LeakyReluForward(double *act, size_t size, double alpha) {
+  LeakyReluForwardImpl(act, size, alpha);
+}
+
+IG_KERNEL void LeakyReluBackward(const float *act, float *delta, size_t size,
+                                 float alpha) {
+  LeakyReluBackwardImpl(act, delta, size, alpha);
+}
+
+IG_KERNEL void LeakyReluBackward(const double *act, double *delta, size_t size,
+                                 double alpha) {
+  LeakyReluBackwardImpl(act, delta, size, alpha);
+}
+
+IG_KERNEL void SigmoidForward(float *act, size_t size) {
+  SigmoidForwardImpl(act, size);
+}
+
+IG_KERNEL void SigmoidForward(double *act, size_t size) {
+  SigmoidForwardImpl(act, size);
+}
+
+IG_KERNEL void SigmoidBackward(const float *act, float *delta, size_t size) {
+  SigmoidBackwardImpl(act, delta, size);
+}
+
+IG_KERNEL void SigmoidBackward(const double *act, double *delta, size_t size) {
+  SigmoidBackwardImpl(act, delta, size);
+}
+
+IG_KERNEL void TanhForward(float *act, size_t size) {
+  TanhForwardImpl(act, size);
+}
+
+IG_KERNEL void TanhForward(double *act, size_t size) {
+  TanhForwardImpl(act, size);
+}
+
+IG_KERNEL void TanhBackward(const float *act, float *delta, size_t size) {
+  TanhBackwardImpl(act, delta, size);
+}
+
+IG_KERNEL void TanhBackward(const double *act, double *delta, size_t size) {
+  TanhBackwardImpl(act, delta, size);
+}
+
+IG_KERNEL void SoftmaxForward(float *act, size_t size) {
+  SoftmaxForwardImpl(act, size);
+}
+
+IG_KERNEL void SoftmaxForward(double *act, size_t size) {
+  SoftmaxForwardImpl(act, size);
+}
+
+IG_KERNEL void SoftmaxBackward(const float *act, float *delta, size_t size) {
+  SoftmaxBackwardImpl(act, delta, size);
+}
+
+IG_KERNEL void SoftmaxBackward(const double *act, double *delta,
+                               size_t size) {
+  SoftmaxBackwardImpl(act, delta, size);
+}
+
+} // namespace intellgraph
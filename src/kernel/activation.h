@@ -0,0 +1,99 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_KERNEL_ACTIVATION_H_
+#define INTELLGRAPH_SRC_KERNEL_ACTIVATION_H_
+
+#include <cstddef>
+
+#include "glog/logging.h"
+#include "src/eigen.h"
+
+namespace intellgraph {
+
+// Activation kernels over |size| contiguous elements. Forward kernels apply
+// the activation function to |act| in place, and backward kernels multiply
+// |delta| element-wise by the derivative evaluated from the activated |act|.
+//
+// Every kernel is compiled for AVX-512, AVX2 and the baseline instruction
+// set, and the best version the CPU supports is selected by CPUID when the
+// program is loaded. Loops are branch-free, so that they vectorize, and
+// exponentials are evaluated with polynomial approximations within a few
+// ULPs of the C library.
+void ReluForward(float *act, size_t size);
+void ReluForward(double *act, size_t size);
+void ReluBackward(const float *act, float *delta, size_t size);
+void ReluBackward(const double *act, double *delta, size_t size);
+
+void LeakyReluForward(float *act, size_t size, float alpha);
+void LeakyReluForward(double *act, size_t size, double alpha);
+void LeakyReluBackward(const float *act, float *delta, size_t size,
+                       float alpha);
+void LeakyReluBackward(const double *act, double *delta, size_t size,
+                       double alpha);
+
+void SigmoidForward(float *act, size_t size);
+void SigmoidForward(double *act, size_t size);
+void SigmoidBackward(const float *act, float *delta, size_t size);
+void SigmoidBackward(const double *act, double *delta, size_t size);
+
+void TanhForward(float *act, size_t size);
+void TanhForward(double *act, size_t size);
+void TanhBackward(const float *act, float *delta, size_t size);
+void TanhBackward(const double *act, double *delta, size_t size);
+
+// Softmax kernels over a single distribution of |size| contiguous elements,
+// e.g. a column of the activation matrix. The maximum is subtracted from the
+// inputs before they are exponentiated, i.e. the log-sum-exp trick, so that
+// large inputs do not overflow.
+void SoftmaxForward(float *act, size_t size);
+void SoftmaxForward(double *act, size_t size);
+void SoftmaxBackward(const float *act, float *delta, size_t size);
+void SoftmaxBackward(const double *act, double *delta, size_t size);
+
+// Applies |kernel| to every contiguous run of |matrix|, i.e. to the whole
+// matrix at once if its columns are not strided, or column by column
+// otherwise
+template <typename T, class Kernel>
+void ForEachContiguous(Eigen::Ref<MatrixX<T>> matrix, Kernel &&kernel) {
+  if (matrix.outerStride() == matrix.rows()) {
+    kernel(matrix.data(), static_cast<size_t>(matrix.size()));
+    return;
+  }
+  for (int col = 0; col < matrix.cols(); ++col) {
+    kernel(matrix.col(col).data(), static_cast<size_t>(matrix.rows()));
+  }
+}
+
+// Applies |kernel| to every pair of contiguous runs of |input| and |output|,
+// which are of the same size
+template <typename T, class Kernel>
+void ForEachContiguous(const Eigen::Ref<const MatrixX<T>> &input,
+                       Eigen::Ref<MatrixX<T>> output, Kernel &&kernel) {
+  DCHECK_EQ(input.rows(), output.rows());
+  DCHECK_EQ(input.cols(), output.cols());
+  if (input.outerStride() == input.rows() &&
+      output.outerStride() == output.rows()) {
+    kernel(input.data(), output.data(), static_cast<size_t>(input.size()));
+    return;
+  }
+  for (int col = 0; col < input.cols(); ++col) {
+    kernel(input.col(col).data(), output.col(col).data(),
+           static_cast<size_t>(input.rows()));
+  }
+}
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_KERNEL_ACTIVATION_H_
@@ -0,0 +1,145 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/kernel/activation.h"
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+// Sizes are not multiples of the vector width, so that remainder loops are
+// exercised as well
+constexpr size_t kSize = 4099;
+
+template <typename T> std::vector<T> Range(T low, T high) {
+  std::vector<T> values(kSize);
+  for (size_t i = 0; i < kSize; ++i) {
+    values[i] = low + (high - low) * i / (kSize - 1);
+  }
+  return values;
+}
+
+TEST(ActivationTest, ReluSuccess) {
+  std::vector<float> act = Range(-4.0f, 4.0f);
+  std::vector<float> input = act;
+  ReluForward(act.data(), act.size());
+  std::vector<float> delta(kSize, 2.0f);
+  ReluBackward(act.data(), delta.data(), delta.size());
+  for (size_t i = 0; i < kSize; ++i) {
+    EXPECT_EQ(act[i], input[i] > 0 ? input[i] : 0.0f);
+    EXPECT_EQ(delta[i], input[i] > 0 ? 2.0f : 0.0f);
+  }
+}
+
+TEST(ActivationTest, LeakyReluSuccess) {
+  std::vector<double> act = Range(-4.0, 4.0);
+  std::vector<double> input = act;
+  LeakyReluForward(act.data(), act.size(), 0.01);
+  std::vector<double> delta(kSize, 2.0);
+  LeakyReluBackward(act.data(), delta.data(), delta.size(), 0.01);
+  for (size_t i = 0; i < kSize; ++i) {
+    EXPECT_EQ(act[i], input[i] > 0 ? input[i] : 0.01 * input[i]);
+    EXPECT_EQ(delta[i], input[i] > 0 ? 2.0 : 0.02);
+  }
+}
+
+TEST(ActivationTest, SigmoidSuccess) {
+  std::vector<float> act_float = Range(-80.0f, 80.0f);
+  std::vector<double> act_double = Range(-80.0, 80.0);
+  std::vector<float> input_float = act_float;
+  std::vector<double> input_double = act_double;
+  SigmoidForward(act_float.data(), act_float.size());
+  SigmoidForward(act_double.data(), act_double.size());
+  for (size_t i = 0; i < kSize; ++i) {
+    EXPECT_FLOAT_EQ(act_float[i], 1.0f / (1.0f + std::exp(-input_float[i])));
+    EXPECT_DOUBLE_EQ(act_double[i], 1.0 / (1.0 + std::exp(-input_double[i])));
+  }
+
+  std::vector<float> delta(kSize, 2.0f);
+  SigmoidBackward(act_float.data(), delta.data(), delta.size());
+  for (size_t i = 0; i < kSize; ++i) {
+    EXPECT_FLOAT_EQ(delta[i], 2.0f * act_float[i] * (1.0f - act_float[i]));
+  }
+}
+
+TEST(ActivationTest, TanhSuccess) {
+  std::vector<float> act_float = Range(-20.0f, 20.0f);
+  std::vector<double> act_double = Range(-20.0, 20.0);
+  std::vector<float> input_float = act_float;
+  std::vector<double> input_double = act_double;
+  TanhForward(act_float.data(), act_float.size());
+  TanhForward(act_double.data(), act_double.size());
+  for (size_t i = 0; i < kSize; ++i) {
+    EXPECT_FLOAT_EQ(act_float[i], std::tanh(input_float[i]));
+    EXPECT_DOUBLE_EQ(act_double[i], std::tanh(input_double[i]));
+  }
+
+  std::vector<double> delta(kSize, 2.0);
+  TanhBackward(act_double.data(), delta.data(), delta.size());
+  // Contraction into a fused multiply-add is allowed, so the derivative is
+  // compared in absolute terms where $1-a^2$ cancels
+  for (size_t i = 0; i < kSize; ++i) {
+    EXPECT_NEAR(delta[i], 2.0 * (1.0 - act_double[i] * act_double[i]), 1e-14);
+  }
+}
+
+TEST(ActivationTest, SoftmaxSuccess) {
+  // Inputs this large overflow the exponential unless their maximum is
+  // subtracted first
+  std::vector<double> act = Range(600.0, 800.0);
+  std::vector<double> input = act;
+  SoftmaxForward(act.data(), act.size());
+  double sum = 0.0;
+  for (size_t i = 0; i < kSize; ++i) {
+    EXPECT_NEAR(act[i], std::exp(input[i] - 800.0) * act[kSize - 1], 1e-15);
+    sum += act[i];
+  }
+  EXPECT_DOUBLE_EQ(sum, 1.0);
+
+  // The Jacobian of the softmax is $\mathcal{D}[a]-aa^T$
+  std::vector<double> delta = Range(-1.0, 1.0);
+  std::vector<double> expected_delta(kSize);
+  double dot = 0.0;
+  for (size_t i = 0; i < kSize; ++i) {
+    dot += act[i] * delta[i];
+  }
+  for (size_t i = 0; i < kSize; ++i) {
+    expected_delta[i] = act[i] * (delta[i] - dot);
+  }
+  SoftmaxBackward(act.data(), delta.data(), delta.size());
+  for (size_t i = 0; i < kSize; ++i) {
+    EXPECT_NEAR(delta[i], expected_delta[i], 1e-15);
+  }
+}
+
+TEST(ActivationTest, ForEachContiguousSuccess) {
+  MatrixX<float> matrix = MatrixX<float>::Constant(4, 3, -1.0f);
+  matrix.col(1).setConstant(1.0f);
+  // A block of rows is strided, and is processed column by column
+  ForEachContiguous<float>(matrix.topRows(2), [](float *data, size_t size) {
+    EXPECT_EQ(size, 2);
+    ReluForward(data, size);
+  });
+  MatrixX<float> expected_result(4, 3);
+  expected_result << 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, -1.0f, 1.0f, -1.0f,
+      -1.0f, 1.0f, -1.0f;
+  EXPECT_EQ(matrix, expected_result);
+}
+
+} // namespace
+} // namespace intellgraph
@@ -0,0 +1,271 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/kernel/quantize.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(__APPLE__)
+#include <immintrin.h>
+// See src/kernel/activation.cc
+#define IG_KERNEL                                                              \
+  __attribute__((target_clones("avx512f", "avx2", "default")))
+#define IG_VNNI
+#define IG_TARGET_VNNI __attribute__((target("avx512f,avx512bw,avx512vnni")))
+#else
+#define IG_KERNEL
+#endif
+
+namespace intellgraph {
+namespace {
+
+// A block of the output of GemmU8S8S32 is kBlockRows packed row blocks by up
+// to kBlockCols columns, held in 24 of the 32 vector registers
+constexpr int kBlockRows = 4;
+constexpr int kBlockCols = 6;
+// Bytes of a packed step, i.e. kPackDepth inputs of every output channel of
+// a row block
+constexpr int kStep = kPackRows * kPackDepth;
+
+template <typename T>
+inline void Quantize(const T *input, size_t size, T inv_scale, int zero_point,
+                     uint8_t *output) {
+  for (size_t i = 0; i < size; ++i) {
+    T value = input[i] * inv_scale + static_cast<T>(zero_point);
+    value = std::min<T>(std::max<T>(value, 0), 255);
+    // The value is not negative, truncation after adding one half rounds to
+    // nearest without calls to the C library
+    output[i] = static_cast<uint8_t>(static_cast<int32_t>(value + T(0.5)));
+  }
+}
+
+template <typename T>
+inline void Dequantize(int m, int n, const int32_t *c, int ldc,
+                       const int32_t *offset, const T *scale, const T *bias,
+                       bool accumulate, T *output) {
+  for (int j = 0; j < n; ++j) {
+    const int32_t *c_col = c + static_cast<size_t>(j) * ldc;
+    T *output_col = output + static_cast<size_t>(j) * m;
+    if (accumulate) {
+      for (int i = 0; i < m; ++i) {
+        output_col[i] += static_cast<T>(c_col[i] - offset[i]) * scale[i];
+      }
+    } else if (bias) {
+      for (int i = 0; i < m; ++i) {
+        output_col[i] =
+            static_cast<T>(c_col[i] - offset[i]) * scale[i] + bias[i];
+      }
+    } else {
+      for (int i = 0; i < m; ++i) {
+        output_col[i] = static_cast<T>(c_col[i] - offset[i]) * scale[i];
+      }
+    }
+  }
+}
+
+// Multiplies one packed row block with a column whose steps are repeated
+// for every output channel of the block, so that products are element-wise.
+// A product of int8 and uint8 fits in int16.
+IG_KERNEL void GemmColumn(int depth, const int8_t *a, const uint8_t *b,
+                          int32_t *c) {
+  int32_t sum[kStep] = {};
+  for (int p = 0; p < depth * kPackRows; p += kStep) {
+    for (int t = 0; t < kStep; ++t) {
+      sum[t] += static_cast<int16_t>(a[p + t] * b[p + t]);
+    }
+  }
+  for (int i = 0; i < kPackRows; ++i) {
+    c[i] = sum[i * 4] + sum[i * 4 + 1] + sum[i * 4 + 2] + sum[i * 4 + 3];
+  }
+}
+
+void Gemm(int m, int n, int k, const int8_t *packed_a, const uint8_t *b,
+          int ldb, int32_t *c, int ldc) {
+  int depth = RoundUp(k, kPackDepth);
+  // Each column is repeated once and reused by all row blocks
+  std::vector<uint8_t> column(static_cast<size_t>(depth) * kPackRows);
+  for (int j = 0; j < n; ++j) {
+    const uint8_t *b_col = b + static_cast<size_t>(j) * ldb;
+    for (int p = 0; p < depth; p += kPackDepth) {
+      for (int i = 0; i < kPackRows; ++i) {
+        std::memcpy(&column[p * kPackRows + i * kPackDepth],
+                    b_col + p, kPackDepth);
+      }
+    }
+    for (int i = 0; i < m; i += kPackRows) {
+      GemmColumn(depth, packed_a + static_cast<size_t>(i) * depth,
+                 column.data(), c + static_cast<size_t>(j) * ldc + i);
+    }
+  }
+}
+
+#ifdef IG_VNNI
+// Multiplies |Rows| packed row blocks with |Cols| columns. Every step
+// broadcasts kPackDepth bytes of each column, whose products with a block
+// are summed into the int32 lanes of the block's output channels by one
+// VPDPBUSD
+template <int Rows, int Cols>
+IG_TARGET_VNNI inline void GemmBlockVnni(int depth, const int8_t *a,
+                                         const uint8_t *b, int ldb, int32_t *c,
+                                         int ldc) {
+  __m512i sum[Rows][Cols];
+  for (int r = 0; r < Rows; ++r) {
+    for (int j = 0; j < Cols; ++j) {
+      sum[r][j] = _mm512_setzero_si512();
+    }
+  }
+  size_t row_stride = static_cast<size_t>(depth) * kPackRows;
+  for (int p = 0; p < depth; p += kPackDepth) {
+    __m512i a_step[Rows];
+    for (int r = 0; r < Rows; ++r) {
+      a_step[r] = _mm512_loadu_si512(a + r * row_stride + p * kPackRows);
+    }
+    for (int j = 0; j < Cols; ++j) {
+      int32_t b_step;
+      std::memcpy(&b_step, b + static_cast<size_t>(j) * ldb + p,
+                  sizeof(b_step));
+      __m512i b_broadcast = _mm512_set1_epi32(b_step);
+      for (int r = 0; r < Rows; ++r) {
+        sum[r][j] = _mm512_dpbusd_epi32(sum[r][j], b_broadcast, a_step[r]);
+      }
+    }
+  }
+  for (int r = 0; r < Rows; ++r) {
+    for (int j = 0; j < Cols; ++j) {
+      _mm512_storeu_si512(c + static_cast<size_t>(j) * ldc + r * kPackRows,
+                          sum[r][j]);
+    }
+  }
+}
+
+template <int Rows>
+IG_TARGET_VNNI void GemmPanelVnni(int n, int depth, const int8_t *a,
+                                  const uint8_t *b, int ldb, int32_t *c,
+                                  int ldc) {
+  int j = 0;
+  for (; j + kBlockCols <= n; j += kBlockCols) {
+    GemmBlockVnni<Rows, kBlockCols>(depth, a, b + static_cast<size_t>(j) * ldb,
+                                    ldb, c + static_cast<size_t>(j) * ldc,
+                                    ldc);
+  }
+  const uint8_t *b_rest = b + static_cast<size_t>(j) * ldb;
+  int32_t *c_rest = c + static_cast<size_t>(j) * ldc;
+  switch (n - j) {
+  case 5:
+    GemmBlockVnni<Rows, 5>(depth, a, b_rest, ldb, c_rest, ldc);
+    break;
+  case 4:
+    GemmBlockVnni<Rows, 4>(depth, a, b_rest, ldb, c_rest, ldc);
+    break;
+  case 3:
+    GemmBlockVnni<Rows, 3>(depth, a, b_rest, ldb, c_rest, ldc);
+    break;
+  case 2:
+    GemmBlockVnni<Rows, 2>(depth, a, b_rest, ldb, c_rest, ldc);
+    break;
+  case 1:
+    GemmBlockVnni<Rows, 1>(depth, a, b_rest, ldb, c_rest, ldc);
+    break;
+  }
+}
+
+// Panels of kBlockRows row blocks stay in the L1 cache while they are
+// multiplied with all columns
+IG_TARGET_VNNI void GemmVnni(int m, int n, int k, const int8_t *packed_a,
+                             const uint8_t *b, int ldb, int32_t *c, int ldc) {
+  int depth = RoundUp(k, kPackDepth);
+  int num_blocks = RoundUp(m, kPackRows) / kPackRows;
+  for (int block = 0; block < num_blocks; block += kBlockRows) {
+    const int8_t *a = packed_a + static_cast<size_t>(block) * kPackRows * depth;
+    int32_t *c_panel = c + block * kPackRows;
+    switch (std::min(num_blocks - block, kBlockRows)) {
+    case 4:
+      GemmPanelVnni<4>(n, depth, a, b, ldb, c_panel, ldc);
+      break;
+    case 3:
+      GemmPanelVnni<3>(n, depth, a, b, ldb, c_panel, ldc);
+      break;
+    case 2:
+      GemmPanelVnni<2>(n, depth, a, b, ldb, c_panel, ldc);
+      break;
+    case 1:
+      GemmPanelVnni<1>(n, depth, a, b, ldb, c_panel, ldc);
+      break;
+    }
+  }
+}
+#endif
+
+using GemmKernel = void (*)(int, int, int, const int8_t *, const uint8_t *,
+                            int, int32_t *, int);
+
+GemmKernel SelectGemm() {
+#ifdef IG_VNNI
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512bw") &&
+      __builtin_cpu_supports("avx512vnni")) {
+    return GemmVnni;
+  }
+#endif
+  return Gemm;
+}
+
+} // namespace
+
+void PackS8(int m, int k, const int8_t *a, int8_t *packed) {
+  int depth = RoundUp(k, kPackDepth);
+  std::memset(packed, 0, PackedSizeS8(m, k));
+  for (int i = 0; i < m; ++i) {
+    int8_t *block = packed + static_cast<size_t>(i / kPackRows) * kPackRows *
+                                 depth;
+    for (int p = 0; p < k; ++p) {
+      block[(p / kPackDepth * kPackRows + i % kPackRows) * kPackDepth +
+            p % kPackDepth] = a[static_cast<size_t>(i) * k + p];
+    }
+  }
+}
+
+IG_KERNEL void QuantizeU8(const float *input, size_t size, float inv_scale,
+                          int zero_point, uint8_t *output) {
+  Quantize(input, size, inv_scale, zero_point, output);
+}
+
+IG_KERNEL void QuantizeU8(const double *input, size_t size, double inv_scale,
+                          int zero_point, uint8_t *output) {
+  Quantize(input, size, inv_scale, zero_point, output);
+}
+
+void GemmU8S8S32(int m, int n, int k, const int8_t *packed_a,
+                 const uint8_t *b, int ldb, int32_t *c, int ldc) {
+  static const GemmKernel kernel = SelectGemm();
+  kernel(m, n, k, packed_a, b, ldb, c, ldc);
+}
+
+IG_KERNEL void DequantizeS32(int m, int n, const int32_t *c, int ldc,
+                             const int32_t *offset, const float *scale,
+                             const float *bias, bool accumulate,
+                             float *output) {
+  Dequantize(m, n, c, ldc, offset, scale, bias, accumulate, output);
+}
+
+IG_KERNEL void DequantizeS32(int m, int n, const int32_t *c, int ldc,
+                             const int32_t *offset, const double *scale,
+                             const double *bias, bool accumulate,
+                             double *output) {
+  Dequantize(m, n, c, ldc, offset, scale, bias, accumulate, output);
+}
+
+} // namespace intellgraph
@@ -0,0 +1,83 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_KERNEL_QUANTIZE_H_
+#define INTELLGRAPH_SRC_KERNEL_QUANTIZE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace intellgraph {
+
+// Int8 kernels of quantized inference. A real value $x$ is represented by an
+// integer $q=round(x/s)+z$ for a scale $s$ and a zero point $z$. Weights are
+// quantized symmetrically to int8 in [-127, 127] with $z=0$, activations
+// asymmetrically to uint8 in [0, 255], so that products are accumulated
+// exactly in int32 and the zero point is subtracted from the accumulators
+// once, as $z$ times the sum of the weights.
+//
+// GemmU8S8S32 runs on AVX-512 VNNI if the CPU supports it, and otherwise
+// like activation kernels on the best of AVX-512, AVX2 and the baseline
+// instruction set.
+
+// Weights are packed in blocks of kPackRows output channels by kPackDepth
+// consecutive inputs, so that one vector holds a block
+constexpr int kPackRows = 16;
+constexpr int kPackDepth = 4;
+
+// Returns |size| rounded up to a multiple of |alignment|
+constexpr int RoundUp(int size, int alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+// Returns the number of bytes of the packed |m| x |k| matrix
+constexpr size_t PackedSizeS8(int m, int k) {
+  return static_cast<size_t>(RoundUp(m, kPackRows)) * RoundUp(k, kPackDepth);
+}
+
+// Packs the |m| x |k| matrix |a| stored row by row, e.g. a weight whose
+// columns are output channels, into |packed| of PackedSizeS8(m, k) bytes.
+// Padding is filled with zeros.
+void PackS8(int m, int k, const int8_t *a, int8_t *packed);
+
+// Quantizes |size| contiguous elements of |input| with the reciprocal of the
+// scale |inv_scale| and |zero_point|, rounding to nearest and saturating
+void QuantizeU8(const float *input, size_t size, float inv_scale,
+                int zero_point, uint8_t *output);
+void QuantizeU8(const double *input, size_t size, double inv_scale,
+                int zero_point, uint8_t *output);
+
+// Multiplies the packed |m| x |k| matrix |packed_a| with the |k| x |n|
+// matrix |b| stored column by column with a stride of |ldb| bytes, and
+// stores the product in the column-major matrix |c| with a stride of |ldc|
+// elements. |ldb| is at least |k| rounded up to kPackDepth, the values in
+// the padding are ignored, and |ldc| is at least |m| rounded up to
+// kPackRows.
+void GemmU8S8S32(int m, int n, int k, const int8_t *packed_a,
+                 const uint8_t *b, int ldb, int32_t *c, int ldc);
+
+// Scales the |m| x |n| int32 matrix |c| back to real values: row i is
+// subtracted |offset|[i], multiplied by |scale|[i], and added |bias|[i]
+// unless |bias| is nullptr. The column-major result overwrites |output|, or
+// is added to it with |accumulate|.
+void DequantizeS32(int m, int n, const int32_t *c, int ldc,
+                   const int32_t *offset, const float *scale,
+                   const float *bias, bool accumulate, float *output);
+void DequantizeS32(int m, int n, const int32_t *c, int ldc,
+                   const int32_t *offset, const double *scale,
+                   const double *bias, bool accumulate, double *output);
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_KERNEL_QUANTIZE_H_
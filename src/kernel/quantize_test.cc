@@ -0,0 +1,97 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/kernel/quantize.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+TEST(QuantizeTest, QuantizeU8Success) {
+  std::vector<float> input = {-1.0f, 0.0f, 0.26f, 0.74f, 1.25f, 100.0f};
+  std::vector<uint8_t> output(input.size());
+  // A scale of 0.5 and a zero point of 2 represent [-1, 126.5]
+  QuantizeU8(input.data(), input.size(), 2.0f, 2, output.data());
+  EXPECT_EQ(output, std::vector<uint8_t>({0, 2, 3, 3, 5, 202}));
+
+  std::vector<double> saturated = {-10.0, 10.0};
+  QuantizeU8(saturated.data(), saturated.size(), 100.0, 0, output.data());
+  EXPECT_EQ(output[0], 0);
+  EXPECT_EQ(output[1], 255);
+}
+
+TEST(QuantizeTest, GemmU8S8S32Success) {
+  // Sizes exercise full and partial row blocks, column blocks and padded
+  // depths
+  for (int m : {1, 16, 37, 130}) {
+    for (int n : {1, 5, 6, 13}) {
+      for (int k : {3, 4, 19, 64}) {
+        std::vector<int8_t> a(static_cast<size_t>(m) * k);
+        for (int8_t &value : a) {
+          value = static_cast<int8_t>(std::rand() % 255 - 127);
+        }
+        int ldb = RoundUp(k, kPackDepth);
+        int ldc = RoundUp(m, kPackRows);
+        std::vector<uint8_t> b(static_cast<size_t>(ldb) * n, 255);
+        for (int j = 0; j < n; ++j) {
+          for (int p = 0; p < k; ++p) {
+            b[static_cast<size_t>(j) * ldb + p] =
+                static_cast<uint8_t>(std::rand() % 256);
+          }
+        }
+        std::vector<int8_t> packed_a(PackedSizeS8(m, k));
+        PackS8(m, k, a.data(), packed_a.data());
+        std::vector<int32_t> c(static_cast<size_t>(ldc) * n);
+        GemmU8S8S32(m, n, k, packed_a.data(), b.data(), ldb, c.data(), ldc);
+
+        for (int j = 0; j < n; ++j) {
+          for (int i = 0; i < m; ++i) {
+            const int8_t *a_row = a.data() + static_cast<size_t>(i) * k;
+            const uint8_t *b_col = b.data() + static_cast<size_t>(j) * ldb;
+            int32_t expected = 0;
+            for (int p = 0; p < k; ++p) {
+              expected += a_row[p] * static_cast<int32_t>(b_col[p]);
+            }
+            ASSERT_EQ(c[static_cast<size_t>(j) * ldc + i], expected)
+                << "m=" << m << " n=" << n << " k=" << k;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(QuantizeTest, DequantizeS32Success) {
+  // Two rows by two columns, stored with a stride of three
+  std::vector<int32_t> c = {10, 20, 0, 30, 40, 0};
+  std::vector<int32_t> offset = {2, 4};
+  std::vector<float> scale = {0.5f, 0.25f};
+  std::vector<float> bias = {1.0f, -1.0f};
+  std::vector<float> output(4);
+  DequantizeS32(2, 2, c.data(), 3, offset.data(), scale.data(), bias.data(),
+                false, output.data());
+  EXPECT_EQ(output, std::vector<float>({5.0f, 3.0f, 15.0f, 8.0f}));
+
+  DequantizeS32(2, 2, c.data(), 3, offset.data(), scale.data(), nullptr, true,
+                output.data());
+  EXPECT_EQ(output, std::vector<float>({9.0f, 7.0f, 29.0f, 17.0f}));
+}
+
+} // namespace
+} // namespace intellgraph
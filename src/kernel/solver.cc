@@ -0,0 +1,208 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/kernel/solver.h"
+
+#include <cmath>
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(__APPLE__)
+// See src/kernel/activation.cc
+#define IG_KERNEL                                                              \
+  __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define IG_KERNEL
+#endif
+
+#define IG_ALWAYS_INLINE inline __attribute__((always_inline))
+
+namespace intellgraph {
+namespace {
+
+template <typename T>
+IG_ALWAYS_INLINE void SgdUpdateImpl(T *__restrict param,
+                                    const T *__restrict nabla, size_t size,
+                                    T eta, T lambda) {
+  T decay = static_cast<T>(1) - eta * lambda;
+  for (size_t i = 0; i < size; ++i) {
+    param[i] = decay * param[i] - eta * nabla[i];
+  }
+}
+
+template <typename T>
+IG_ALWAYS_INLINE void
+MomentumUpdateImpl(T *__restrict param, const T *__restrict nabla,
+                   T *__restrict velocity, size_t size, T eta, T lambda,
+                   T gamma) {
+  for (size_t i = 0; i < size; ++i) {
+    T g = nabla[i] + lambda * param[i];
+    T v = gamma * velocity[i] + eta * g;
+    velocity[i] = v;
+    param[i] -= v;
+  }
+}
+
+template <typename T>
+IG_ALWAYS_INLINE void
+AdagradUpdateImpl(T *__restrict param, const T *__restrict nabla,
+                  T *__restrict square_sum, size_t size, T eta, T lambda,
+                  T epsilon) {
+  for (size_t i = 0; i < size; ++i) {
+    T g = nabla[i] + lambda * param[i];
+    T s = square_sum[i] + g * g;
+    square_sum[i] = s;
+    param[i] -= eta * g / std::sqrt(s + epsilon);
+  }
+}
+
+template <typename T>
+IG_ALWAYS_INLINE void
+AdadeltaUpdateImpl(T *__restrict param, const T *__restrict nabla,
+                   T *__restrict g_mean, T *__restrict update_square_mean,
+                   size_t size, T lambda, T gamma, T epsilon) {
+  T rest = static_cast<T>(1) - gamma;
+  for (size_t i = 0; i < size; ++i) {
+    T g = nabla[i] + lambda * param[i];
+    T mean = gamma * g_mean[i] + rest * g * g;
+    g_mean[i] = mean;
+    T update = std::sqrt(update_square_mean[i] + epsilon) * g /
+               std::sqrt(mean + epsilon);
+    param[i] -= update;
+    update_square_mean[i] =
+        gamma * update_square_mean[i] + rest * update * update;
+  }
+}
+
+template <typename T>
+IG_ALWAYS_INLINE void
+AdamUpdateImpl(T *__restrict param, const T *__restrict nabla,
+               T *__restrict first_moment, T *__restrict second_moment,
+               size_t size, T lambda, T beta1, T beta2, T step,
+               T second_moment_scale, T epsilon) {
+  T rest1 = static_cast<T>(1) - beta1;
+  T rest2 = static_cast<T>(1) - beta2;
+  for (size_t i = 0; i < size; ++i) {
+    T g = nabla[i] + lambda * param[i];
+    T m = beta1 * first_moment[i] + rest1 * g;
+    T v = beta2 * second_moment[i] + rest2 * g * g;
+    first_moment[i] = m;
+    second_moment[i] = v;
+    param[i] -= step * m / (std::sqrt(second_moment_scale * v) + epsilon);
+  }
+}
+
+template <typename T>
+IG_ALWAYS_INLINE void
+AdaMaxUpdateImpl(T *__restrict param, const T *__restrict nabla,
+                 T *__restrict first_moment, T *__restrict ut, size_t size,
+                 T lambda, T beta1, T beta2, T step, T epsilon) {
+  T rest1 = static_cast<T>(1) - beta1;
+  for (size_t i = 0; i < size; ++i) {
+    T g = nabla[i] + lambda * param[i];
+    T m = beta1 * first_moment[i] + rest1 * g;
+    T decayed = beta2 * ut[i];
+    T abs_g = std::abs(g);
+    T u = decayed > abs_g ? decayed : abs_g;
+    first_moment[i] = m;
+    ut[i] = u;
+    param[i] -= step * m / (u + epsilon);
+  }
+}
+
+} // namespace
+
+IG_KERNEL void SgdUpdate(float *param, const float *nabla, size_t size,
+                         float eta, float lambda) {
+  SgdUpdateImpl(param, nabla, size, eta, lambda);
+}
+
+IG_KERNEL void SgdUpdate(double *param, const double *nabla, size_t size,
+                         double eta, double lambda) {
+  SgdUpdateImpl(param, nabla, size, eta, lambda);
+}
+
+IG_KERNEL void MomentumUpdate(float *param, const float *nabla,
+                              float *velocity, size_t size, float eta,
+                              float lambda, float gamma) {
+  MomentumUpdateImpl(param, nabla, velocity, size, eta, lambda, gamma);
+}
+
+IG_KERNEL void MomentumUpdate(double *param, const double *nabla,
+                              double *velocity, size_t size, double eta,
+                              double lambda, double gamma) {
+  MomentumUpdateImpl(param, nabla, velocity, size, eta, lambda, gamma);
+}
+
+IG_KERNEL void AdagradUpdate(float *param, const float *nabla,
+                             float *square_sum, size_t size, float eta,
+                             float lambda, float epsilon) {
+  AdagradUpdateImpl(param, nabla, square_sum, size, eta, lambda, epsilon);
+}
+
+IG_KERNEL void AdagradUpdate(double *param, const double *nabla,
+                             double *square_sum, size_t size, double eta,
+                             double lambda, double epsilon) {
+  AdagradUpdateImpl(param, nabla, square_sum, size, eta, lambda, epsilon);
+}
+
+IG_KERNEL void AdadeltaUpdate(float *param, const float *nabla,
+                              float *g_mean, float *update_square_mean,
+                              size_t size, float lambda, float gamma,
+                              float epsilon) {
+  AdadeltaUpdateImpl(param, nabla, g_mean, update_square_mean, size, lambda,
+                     gamma, epsilon);
+}
+
+IG_KERNEL void AdadeltaUpdate(double *param, const double *nabla,
+                              double *g_mean, double *update_square_mean,
+                              size_t size, double lambda, double gamma,
+                              double epsilon) {
+  AdadeltaUpdateImpl(param, nabla, g_mean, update_square_mean, size, lambda,
+                     gamma, epsilon);
+}
+
+IG_KERNEL void AdamUpdate(float *param, const float *nabla,
+                          float *first_moment, float *second_moment,
+                          size_t size, float lambda, float beta1, float beta2,
+                          float step, float second_moment_scale,
+                          float epsilon) {
+  AdamUpdateImpl(param, nabla, first_moment, second_moment, size, lambda,
+                 beta1, beta2, step, second_moment_scale, epsilon);
+}
+
+IG_KERNEL void AdamUpdate(double *param, const double *nabla,
+                          double *first_moment, double *second_moment,
+                          size_t size, double lambda, double beta1,
+                          double beta2, double step,
+                          double second_moment_scale, double epsilon) {
+  AdamUpdateImpl(param, nabla, first_moment, second_moment, size, lambda,
+                 beta1, beta2, step, second_moment_scale, epsilon);
+}
+
+IG_KERNEL void AdaMaxUpdate(float *param, const float *nabla,
+                            float *first_moment, float *ut, size_t size,
+                            float lambda, float beta1, float beta2,
+                            float step, float epsilon) {
+  AdaMaxUpdateImpl(param, nabla, first_moment, ut, size, lambda, beta1, beta2,
+                   step, epsilon);
+}
+
+IG_KERNEL void AdaMaxUpdate(double *param, const double *nabla,
+                            double *first_moment, double *ut, size_t size,
+                            double lambda, double beta1, double beta2,
+                            double step, double epsilon) {
+  AdaMaxUpdateImpl(param, nabla, first_moment, ut, size, lambda, beta1, beta2,
+                   step, epsilon);
+}
+
+} // namespace intellgraph
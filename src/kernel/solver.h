@@ -0,0 +1,85 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_KERNEL_SOLVER_H_
+#define INTELLGRAPH_SRC_KERNEL_SOLVER_H_
+
+#include <cstddef>
+
+namespace intellgraph {
+
+// Solver kernels update |size| contiguous parameters |param| against their
+// nablas |nabla| in a single pass, i.e. every element of the parameters,
+// the nablas and the solver stores is read once and written at most once.
+// The L2 regularization term |lambda| * |param| is added to the nabla on the
+// fly, so that |nabla| itself is left untouched. Parameters are views of
+// whole weight matrices, bias vectors or single weight columns alike.
+//
+// Like activation kernels, every kernel is compiled for AVX-512, AVX2 and
+// the baseline instruction set, see src/kernel/activation.h.
+
+// $w\leftarrow(1-\eta\lambda)w-\eta g$
+void SgdUpdate(float *param, const float *nabla, size_t size, float eta,
+               float lambda);
+void SgdUpdate(double *param, const double *nabla, size_t size, double eta,
+               double lambda);
+
+// $v\leftarrow\gamma v+\eta g$, $w\leftarrow w-v$
+void MomentumUpdate(float *param, const float *nabla, float *velocity,
+                    size_t size, float eta, float lambda, float gamma);
+void MomentumUpdate(double *param, const double *nabla, double *velocity,
+                    size_t size, double eta, double lambda, double gamma);
+
+// $G\leftarrow G+g^2$, $w\leftarrow w-\eta g/\sqrt{G+\epsilon}$
+void AdagradUpdate(float *param, const float *nabla, float *square_sum,
+                   size_t size, float eta, float lambda, float epsilon);
+void AdagradUpdate(double *param, const double *nabla, double *square_sum,
+                   size_t size, double eta, double lambda, double epsilon);
+
+// Keeps running means of the squared nablas |g_mean| and of the squared
+// updates |update_square_mean| with decay |gamma|, and moves |param| by the
+// ratio of their root mean squares times the nabla
+void AdadeltaUpdate(float *param, const float *nabla, float *g_mean,
+                    float *update_square_mean, size_t size, float lambda,
+                    float gamma, float epsilon);
+void AdadeltaUpdate(double *param, const double *nabla, double *g_mean,
+                    double *update_square_mean, size_t size, double lambda,
+                    double gamma, double epsilon);
+
+// Updates the moments with decays |beta1| and |beta2| and moves |param| by
+// |step| times the first moment over the root of |second_moment_scale|
+// times the second moment plus |epsilon|. |step| and |second_moment_scale|
+// fold in the learning rate and the bias corrections of the moments.
+void AdamUpdate(float *param, const float *nabla, float *first_moment,
+                float *second_moment, size_t size, float lambda, float beta1,
+                float beta2, float step, float second_moment_scale,
+                float epsilon);
+void AdamUpdate(double *param, const double *nabla, double *first_moment,
+                double *second_moment, size_t size, double lambda,
+                double beta1, double beta2, double step,
+                double second_moment_scale, double epsilon);
+
+// Like AdamUpdate, with the second moment replaced by the exponentially
+// weighted infinity norm |ut| of the nablas. |epsilon| keeps parameters whose
+// nablas have all been zero, e.g. the padding of flat arenas, finite.
+void AdaMaxUpdate(float *param, const float *nabla, float *first_moment,
+                  float *ut, size_t size, float lambda, float beta1,
+                  float beta2, float step, float epsilon);
+void AdaMaxUpdate(double *param, const double *nabla, double *first_moment,
+                  double *ut, size_t size, double lambda, double beta1,
+                  double beta2, double step, double epsilon);
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_KERNEL_SOLVER_H_
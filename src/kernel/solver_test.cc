@@ -0,0 +1,170 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/kernel/solver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+// Sizes are not multiples of the vector width, so that remainder loops are
+// exercised as well
+constexpr size_t kSize = 4099;
+constexpr double kLambda = 0.01;
+
+// Returns values in [low, high] that are neither sorted nor zero
+std::vector<double> Values(double low, double high, int seed) {
+  std::vector<double> values(kSize);
+  for (size_t i = 0; i < kSize; ++i) {
+    double fraction = ((i * 7919 + seed * 104729) % 1000 + 0.5) / 1000.0;
+    values[i] = low + (high - low) * fraction;
+  }
+  return values;
+}
+
+// Every test runs a few steps, so that stores carry over between steps, and
+// checks that the nabla is left untouched
+class SolverKernelTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    param = Values(-1.0, 1.0, 1);
+    nabla = Values(-0.5, 0.5, 2);
+    expected_param = param;
+  }
+
+  void TearDown() override {
+    EXPECT_EQ(nabla, Values(-0.5, 0.5, 2));
+    for (size_t i = 0; i < kSize; ++i) {
+      EXPECT_NEAR(param[i], expected_param[i], 1e-12);
+    }
+  }
+
+  std::vector<double> param;
+  std::vector<double> nabla;
+  std::vector<double> expected_param;
+};
+
+TEST_F(SolverKernelTest, SgdSuccess) {
+  for (int step = 0; step < 3; ++step) {
+    SgdUpdate(param.data(), nabla.data(), kSize, 0.1, kLambda);
+    for (size_t i = 0; i < kSize; ++i) {
+      expected_param[i] -= 0.1 * (nabla[i] + kLambda * expected_param[i]);
+    }
+  }
+}
+
+TEST_F(SolverKernelTest, MomentumSuccess) {
+  std::vector<double> velocity(kSize, 0.0);
+  std::vector<double> expected_velocity(kSize, 0.0);
+  for (int step = 0; step < 3; ++step) {
+    MomentumUpdate(param.data(), nabla.data(), velocity.data(), kSize, 0.1,
+                   kLambda, 0.9);
+    for (size_t i = 0; i < kSize; ++i) {
+      double g = nabla[i] + kLambda * expected_param[i];
+      expected_velocity[i] = 0.9 * expected_velocity[i] + 0.1 * g;
+      expected_param[i] -= expected_velocity[i];
+    }
+  }
+}
+
+TEST_F(SolverKernelTest, AdagradSuccess) {
+  std::vector<double> square_sum(kSize, 0.0);
+  std::vector<double> expected_square_sum(kSize, 0.0);
+  for (int step = 0; step < 3; ++step) {
+    AdagradUpdate(param.data(), nabla.data(), square_sum.data(), kSize, 0.1,
+                  kLambda, 1e-8);
+    for (size_t i = 0; i < kSize; ++i) {
+      double g = nabla[i] + kLambda * expected_param[i];
+      expected_square_sum[i] += g * g;
+      expected_param[i] -= 0.1 * g / std::sqrt(expected_square_sum[i] + 1e-8);
+    }
+  }
+}
+
+TEST_F(SolverKernelTest, AdadeltaSuccess) {
+  std::vector<double> g_mean(kSize, 0.0), update_mean(kSize, 0.0);
+  std::vector<double> expected_g_mean(kSize, 0.0);
+  std::vector<double> expected_update_mean(kSize, 0.0);
+  for (int step = 0; step < 3; ++step) {
+    AdadeltaUpdate(param.data(), nabla.data(), g_mean.data(),
+                   update_mean.data(), kSize, kLambda, 0.95, 1e-6);
+    for (size_t i = 0; i < kSize; ++i) {
+      double g = nabla[i] + kLambda * expected_param[i];
+      expected_g_mean[i] = 0.95 * expected_g_mean[i] + 0.05 * g * g;
+      double update = std::sqrt(expected_update_mean[i] + 1e-6) * g /
+                      std::sqrt(expected_g_mean[i] + 1e-6);
+      expected_param[i] -= update;
+      expected_update_mean[i] =
+          0.95 * expected_update_mean[i] + 0.05 * update * update;
+    }
+  }
+}
+
+TEST_F(SolverKernelTest, AdamSuccess) {
+  std::vector<double> first(kSize, 0.0), second(kSize, 0.0);
+  std::vector<double> expected_first(kSize, 0.0), expected_second(kSize, 0.0);
+  for (int step = 1; step <= 3; ++step) {
+    double first_factor = 1.0 - std::pow(0.9, step);
+    double second_factor = 1.0 - std::pow(0.999, step);
+    AdamUpdate(param.data(), nabla.data(), first.data(), second.data(), kSize,
+               kLambda, 0.9, 0.999, 0.001 / first_factor, 1.0 / second_factor,
+               1e-8);
+    for (size_t i = 0; i < kSize; ++i) {
+      double g = nabla[i] + kLambda * expected_param[i];
+      expected_first[i] = 0.9 * expected_first[i] + 0.1 * g;
+      expected_second[i] = 0.999 * expected_second[i] + 0.001 * g * g;
+      expected_param[i] -=
+          0.001 * (expected_first[i] / first_factor) /
+          (std::sqrt(expected_second[i] / second_factor) + 1e-8);
+    }
+  }
+}
+
+TEST_F(SolverKernelTest, AdaMaxSuccess) {
+  std::vector<double> first(kSize, 0.0), ut(kSize, 0.0);
+  std::vector<double> expected_first(kSize, 0.0), expected_ut(kSize, 0.0);
+  for (int step = 1; step <= 3; ++step) {
+    double first_factor = 1.0 - std::pow(0.9, step);
+    AdaMaxUpdate(param.data(), nabla.data(), first.data(), ut.data(), kSize,
+                 kLambda, 0.9, 0.999, 0.002 / first_factor, 1e-8);
+    for (size_t i = 0; i < kSize; ++i) {
+      double g = nabla[i] + kLambda * expected_param[i];
+      expected_first[i] = 0.9 * expected_first[i] + 0.1 * g;
+      expected_ut[i] = std::max(0.999 * expected_ut[i], std::abs(g));
+      expected_param[i] -=
+          0.002 / first_factor * expected_first[i] / (expected_ut[i] + 1e-8);
+    }
+  }
+}
+
+// Parameters that never had a nabla, e.g. the padding of flat arenas, have
+// zero moments and must stay as they are
+TEST(SolverKernelZeroNablaTest, AdaMaxKeepsParameters) {
+  std::vector<float> param = {0.5f, -1.0f, 0.0f};
+  std::vector<float> nabla(param.size(), 0.0f);
+  std::vector<float> first(param.size(), 0.0f), ut(param.size(), 0.0f);
+  for (int step = 1; step <= 3; ++step) {
+    AdaMaxUpdate(param.data(), nabla.data(), first.data(), ut.data(),
+                 param.size(), 0.0f, 0.9f, 0.999f, 0.002f, 1e-8f);
+  }
+  EXPECT_EQ(param, std::vector<float>({0.5f, -1.0f, 0.0f}));
+}
+
+} // namespace
+} // namespace intellgraph
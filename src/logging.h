@@ -23,6 +23,17 @@ namespace logging {
 #define NOTREACHED() DCHECK(false)
 #endif
 
+// Compile-time trace level. Traces above INTELLGRAPH_TRACE_LEVEL are removed
+// by the compiler, so they never build a log stream on the hot path. Level 1
+// traces edges and level 2 traces vertices; the default 0 disables both.
+#ifndef INTELLGRAPH_TRACE_LEVEL
+#define INTELLGRAPH_TRACE_LEVEL 0
+#endif
+
+#ifndef IG_TRACE
+#define IG_TRACE(level) LOG_IF(INFO, (level) <= INTELLGRAPH_TRACE_LEVEL)
+#endif
+
 } // namespace logging
 
 #endif // INTELLGRAPH_SRC_LOGGING_H_
@@ -21,18 +21,33 @@ Contributor(s):
 #include "src/edge/output_vertex.h"
 #include "src/edge/seq_output.h"
 #include "src/edge/seq_vertex.h"
+#include "src/edge/sparse_dense_edge_impl.h"
 #include "src/edge/vertex/cross_entropy.h"
+#include "src/edge/vertex/gru.h"
 #include "src/edge/vertex/input_vertex.h"
 #include "src/edge/vertex/input_vertex_impl.h"
+#include "src/edge/vertex/leaky_relu.h"
+#include "src/edge/vertex/lstm.h"
 #include "src/edge/vertex/op_vertex_impl.h"
 #include "src/edge/vertex/output_vertex_impl.h"
+#include "src/edge/vertex/recurrent_vertex_impl.h"
 #include "src/edge/vertex/relu.h"
+#include "src/edge/vertex/sampled_softmax.h"
+#include "src/edge/vertex/sampled_softmax_impl.h"
 #include "src/edge/vertex/seq_output_impl.h"
 #include "src/edge/vertex/seq_vertex_impl.h"
 #include "src/edge/vertex/sigmoid.h"
 #include "src/edge/vertex/sigmoid_l2.h"
+#include "src/edge/vertex/softmax_cross_entropy.h"
+#include "src/edge/vertex/sparse_input_vertex_impl.h"
+#include "src/edge/vertex/tanh.h"
 #include "src/factory.h"
 #include "src/solver.h"
+#include "src/solver/ada_max.h"
+#include "src/solver/adadelta.h"
+#include "src/solver/adagrad.h"
+#include "src/solver/adam.h"
+#include "src/solver/momentum.h"
 #include "src/solver/sgd_solver.h"
 
 namespace intellgraph {
@@ -43,10 +58,26 @@ void Registry::LoadRegistry() {
   REGISTER_VERTEX(OpVertex, OpVertexImpl, Relu);
   REGISTER_VERTEX(SeqVertex, SeqVertexImpl, Relu);
 
+  LOG(INFO) << "Registering the LeakyRelu vertex...";
+  REGISTER_VERTEX(OpVertex, OpVertexImpl, LeakyRelu);
+  REGISTER_VERTEX(SeqVertex, SeqVertexImpl, LeakyRelu);
+
   LOG(INFO) << "Registering the Sigmoid vertex...";
   REGISTER_VERTEX(OpVertex, OpVertexImpl, Sigmoid);
   REGISTER_VERTEX(SeqVertex, SeqVertexImpl, Sigmoid);
 
+  LOG(INFO) << "Registering the Tanh vertex...";
+  REGISTER_VERTEX(OpVertex, OpVertexImpl, Tanh);
+  REGISTER_VERTEX(SeqVertex, SeqVertexImpl, Tanh);
+
+  LOG(INFO) << "Registering the Lstm vertex...";
+  REGISTER_VERTEX(OpVertex, RecurrentVertexImpl, Lstm);
+  REGISTER_VERTEX(SeqVertex, RecurrentVertexImpl, Lstm);
+
+  LOG(INFO) << "Registering the Gru vertex...";
+  REGISTER_VERTEX(OpVertex, RecurrentVertexImpl, Gru);
+  REGISTER_VERTEX(SeqVertex, RecurrentVertexImpl, Gru);
+
   LOG(INFO) << "Registering the SigmoidL2 ouput vertex...";
   REGISTER_VERTEX(OutputVertex, OutputVertexImpl, SigmoidL2);
   REGISTER_VERTEX(SeqOutput, SeqOutputImpl, SigmoidL2);
@@ -55,14 +86,35 @@ void Registry::LoadRegistry() {
   REGISTER_VERTEX(OutputVertex, OutputVertexImpl, CrossEntropy);
   REGISTER_VERTEX(SeqOutput, SeqOutputImpl, CrossEntropy);
 
+  LOG(INFO) << "Registering the SoftmaxCrossEntropy ouput vertex...";
+  REGISTER_VERTEX(OutputVertex, OutputVertexImpl, SoftmaxCrossEntropy);
+  REGISTER_VERTEX(SeqOutput, SeqOutputImpl, SoftmaxCrossEntropy);
+
+  LOG(INFO) << "Registering the SampledSoftmax ouput vertices...";
+  REGISTER_VERTEX(OutputVertex, SampledSoftmaxImpl, UniformSampledSoftmax);
+  REGISTER_VERTEX(OutputVertex, SampledSoftmaxImpl, LogUniformSampledSoftmax);
+
   LOG(INFO) << "Registering the Input vertex...";
   REGISTER_VERTEX(InputVertex, InputVertexImpl, DummyTransformer);
 
+  LOG(INFO) << "Registering the SparseInput vertex...";
+  REGISTER_VERTEX(InputVertex, SparseInputVertexImpl, SparseTransformer);
+
   LOG(INFO) << "Registering the Dense edge...";
   REGISTER_EDGE(Edge, DenseEdgeImpl, OpVertex, OpVertex, Dense);
 
+  LOG(INFO) << "Registering the SparseDense edge...";
+  REGISTER_EDGE(Edge, SparseDenseEdgeImpl, OpVertex, OpVertex, SparseDense);
+
   LOG(INFO) << "Registering the Stochastic Gradient Descent solver...";
   REGISTER_SOLVER(Solver, SgdSolver, SGD);
+
+  LOG(INFO) << "Registering the adaptive and momentum solvers...";
+  REGISTER_SOLVER(Solver, Momentum, Momentum);
+  REGISTER_SOLVER(Solver, Adagrad, Adagrad);
+  REGISTER_SOLVER(Solver, Adadelta, Adadelta);
+  REGISTER_SOLVER(Solver, Adam, Adam);
+  REGISTER_SOLVER(Solver, AdaMax, AdaMax);
 }
 
 } // namespace intellgraph
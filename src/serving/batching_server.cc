@@ -0,0 +1,137 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/serving/batching_server.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "glog/logging.h"
+#include "src/tensor/workspace.h"
+
+namespace intellgraph {
+
+template <typename T>
+BatchingServer<T>::BatchingServer(const ClassifierImpl<T> *classifier,
+                                  const BatchingOptions &options)
+    : classifier_(classifier), options_(options) {
+  DCHECK(classifier_);
+  DCHECK_GT(options_.max_batch_size, 0);
+  DCHECK_GE(options_.max_latency.count(), 0);
+  DCHECK_GT(options_.num_threads, 0);
+
+  for (int i = 0; i < options_.num_threads; ++i) {
+    workers_.emplace_back([this] { ServeLoop(); });
+  }
+}
+
+template <typename T> BatchingServer<T>::~BatchingServer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+template <typename T>
+std::future<VectorX<T>>
+BatchingServer<T>::Predict(const Eigen::Ref<const VectorX<T>> &feature) {
+  Request request;
+  request.feature = feature;
+  request.arrival = std::chrono::steady_clock::now();
+  std::future<VectorX<T>> result = request.result.get_future();
+
+  size_t size = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    DCHECK(!stopped_);
+    requests_.push_back(std::move(request));
+    size = requests_.size();
+  }
+  // Wakes a worker for the first request of a batch, which starts the
+  // deadline, and once a batch is full
+  if (size == 1 || size >= static_cast<size_t>(options_.max_batch_size)) {
+    cv_.notify_one();
+  }
+  return result;
+}
+
+template <typename T> void BatchingServer<T>::ServeLoop() {
+  // Buffers are reused across batches. The batch buffer is allocated for
+  // the largest batch once the feature size is known, and smaller batches
+  // map its leading columns.
+  Workspace<T> workspace;
+  MatrixX<T> batch;
+  std::vector<Request> requests;
+  requests.reserve(options_.max_batch_size);
+  size_t max_batch_size = options_.max_batch_size;
+
+  while (true) {
+    bool has_more = false;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stopped_ || !requests_.empty(); });
+      if (requests_.empty()) {
+        // Stopped and drained
+        return;
+      }
+      // Waits for the batch to fill up until the oldest request is due
+      cv_.wait_until(lock, requests_.front().arrival + options_.max_latency,
+                     [this, max_batch_size] {
+                       return stopped_ || requests_.empty() ||
+                              requests_.size() >= max_batch_size;
+                     });
+      // Another worker may have taken the batch in the meantime
+      if (requests_.empty()) {
+        continue;
+      }
+      size_t count = std::min(requests_.size(), max_batch_size);
+      for (size_t i = 0; i < count; ++i) {
+        requests.push_back(std::move(requests_.front()));
+        requests_.pop_front();
+      }
+      has_more = !requests_.empty();
+    }
+    if (has_more) {
+      cv_.notify_one();
+    }
+
+    // Gathers features into columns of a batch, and scatters columns of the
+    // probability distribution back to the requests
+    int rows = requests.front().feature.rows();
+    if (batch.rows() != rows) {
+      batch.resize(rows, max_batch_size);
+    }
+    for (size_t i = 0; i < requests.size(); ++i) {
+      batch.col(i) = requests[i].feature;
+    }
+    Eigen::Map<const MatrixX<T>> result = classifier_->Predict(
+        Eigen::Map<const MatrixX<T>>(batch.data(), rows, requests.size()),
+        &workspace);
+    ++num_batches_;
+    for (size_t i = 0; i < requests.size(); ++i) {
+      requests[i].result.set_value(result.col(i));
+    }
+    requests.clear();
+  }
+}
+
+// Explicit instantiation
+template class BatchingServer<float>;
+template class BatchingServer<double>;
+
+} // namespace intellgraph
@@ -0,0 +1,92 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_SERVING_BATCHING_SERVER_H_
+#define INTELLGRAPH_SRC_SERVING_BATCHING_SERVER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "src/eigen.h"
+#include "src/graph/classifier_impl.h"
+
+namespace intellgraph {
+
+struct BatchingOptions {
+  // Maximum number of requests that are coalesced into a batch
+  int max_batch_size = 32;
+  // Maximum time the oldest queued request waits for a batch to fill up
+  std::chrono::microseconds max_latency{1000};
+  // Number of threads that run batches concurrently
+  int num_threads = 1;
+};
+
+// BatchingServer serves single-example prediction requests of a trained
+// classifier. Requests are queued and coalesced into batches of up to
+// |max_batch_size| columns, a batch being run as soon as it is full or its
+// oldest request has waited for |max_latency|. Each batch is predicted with a
+// single forward pass, whose result columns are scattered back to the futures
+// of the requests. The classifier must outlive the server and must not be
+// trained while the server runs.
+template <typename T> class BatchingServer {
+public:
+  BatchingServer(const ClassifierImpl<T> *classifier,
+                 const BatchingOptions &options);
+  // Stops the server once queued requests have been served
+  ~BatchingServer();
+
+  BatchingServer(const BatchingServer &) = delete;
+  BatchingServer &operator=(const BatchingServer &) = delete;
+
+  // Queues the prediction of |feature|, a single column, and returns the
+  // future probability distribution. Thread-safe.
+  std::future<VectorX<T>> Predict(const Eigen::Ref<const VectorX<T>> &feature);
+
+  // Returns the number of batches run so far
+  int64_t num_batches() const { return num_batches_.load(); }
+
+private:
+  struct Request {
+    VectorX<T> feature;
+    std::promise<VectorX<T>> result;
+    std::chrono::steady_clock::time_point arrival;
+  };
+
+  void ServeLoop();
+
+  const ClassifierImpl<T> *classifier_ = nullptr;
+  const BatchingOptions options_;
+
+  std::deque<Request> requests_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopped_ = false;
+  std::atomic<int64_t> num_batches_{0};
+  std::vector<std::thread> workers_;
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class BatchingServer<float>;
+extern template class BatchingServer<double>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_SERVING_BATCHING_SERVER_H_
@@ -0,0 +1,109 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/serving/batching_server.h"
+
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "google/protobuf/text_format.h"
+#include "src/eigen.h"
+#include "src/graph/classifier_impl.h"
+#include "src/graph/graph_builder.h"
+#include "src/proto/graph_parameter.pb.h"
+#include "src/proto/vertex_parameter.pb.h"
+#include "src/registry.h"
+#include "src/tensor/workspace.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+ClassifierImpl<float> BuildClassifier() {
+  Registry::LoadRegistry();
+  VertexParameter vtx_param_in, vtx_param_hidden, vtx_param_out;
+  google::protobuf::TextFormat::ParseFromString(
+      "id: 0 type: INPUT operation: 'DummyTransformer' dims: 4", &vtx_param_in);
+  google::protobuf::TextFormat::ParseFromString(
+      "id: 1 type: HIDDEN operation: 'Relu' dims: 8", &vtx_param_hidden);
+  google::protobuf::TextFormat::ParseFromString(
+      "id: 2 type: OUTPUT operation: 'CrossEntropy' dims: 3", &vtx_param_out);
+  GraphBuilder<float> graph_builder;
+  return graph_builder.AddEdge(0, "Dense", vtx_param_in, vtx_param_hidden)
+      .AddEdge(1, "Dense", vtx_param_hidden, vtx_param_out)
+      .SetLength(1)
+      .BuildClassifier();
+}
+
+TEST(BatchingServerTest, PredictSuccess) {
+  ClassifierImpl<float> classifier = BuildClassifier();
+  MatrixX<float> feature = MatrixX<float>::Random(4, 64);
+  Workspace<float> workspace;
+  MatrixX<float> expected_result = classifier.Predict(feature, &workspace);
+
+  BatchingOptions options;
+  options.max_batch_size = 8;
+  options.num_threads = 2;
+  BatchingServer<float> server(&classifier, options);
+
+  // Clients send requests concurrently, each for a different column
+  std::vector<std::thread> clients;
+  std::vector<VectorX<float>> results(feature.cols());
+  for (int client = 0; client < 4; ++client) {
+    clients.emplace_back([&, client] {
+      for (int i = client; i < feature.cols(); i += 4) {
+        results[i] = server.Predict(feature.col(i)).get();
+      }
+    });
+  }
+  for (auto &client : clients) {
+    client.join();
+  }
+
+  for (int i = 0; i < feature.cols(); ++i) {
+    EXPECT_TRUE(results[i].isApprox(expected_result.col(i)));
+  }
+}
+
+TEST(BatchingServerTest, PredictCoalescesRequests) {
+  ClassifierImpl<float> classifier = BuildClassifier();
+  MatrixX<float> feature = MatrixX<float>::Random(4, 9);
+
+  // The deadline is far enough that only full batches are run before the
+  // last request
+  BatchingOptions options;
+  options.max_batch_size = 4;
+  options.max_latency = std::chrono::milliseconds(100);
+  BatchingServer<float> server(&classifier, options);
+
+  std::vector<std::future<VectorX<float>>> results;
+  for (int i = 0; i < 8; ++i) {
+    results.push_back(server.Predict(feature.col(i)));
+  }
+  for (auto &result : results) {
+    result.wait();
+  }
+  EXPECT_EQ(server.num_batches(), 2);
+
+  // A partial batch is run once its deadline has passed
+  auto start = std::chrono::steady_clock::now();
+  server.Predict(feature.col(8)).wait();
+  EXPECT_GE(std::chrono::steady_clock::now() - start, options.max_latency);
+  EXPECT_EQ(server.num_batches(), 3);
+}
+
+} // namespace
+} // namespace intellgraph
@@ -0,0 +1,143 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+#include "google/protobuf/text_format.h"
+#include "src/eigen.h"
+#include "src/graph/classifier_impl.h"
+#include "src/graph/graph_builder.h"
+#include "src/proto/vertex_parameter.pb.h"
+#include "src/registry.h"
+#include "src/serving/batching_server.h"
+#include "src/serving/quantized_classifier.h"
+#include "src/tensor/workspace.h"
+
+using namespace intellgraph;
+
+namespace {
+
+// Runs |num_clients| closed-loop clients sending |num_requests| requests each
+// through |predict|, and prints throughput and CPU time per request
+template <class Predict>
+void Run(const char *name, int num_clients, int num_requests,
+         const MatrixX<float> &feature, Predict &&predict) {
+  std::clock_t cpu_start = std::clock();
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> clients;
+  for (int client = 0; client < num_clients; ++client) {
+    clients.emplace_back([&, client] {
+      for (int i = 0; i < num_requests; ++i) {
+        predict(client, feature.col((client + i) % feature.cols()));
+      }
+    });
+  }
+  for (auto &client : clients) {
+    client.join();
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  double cpu_seconds =
+      static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+  int total = num_clients * num_requests;
+  std::printf("%-10s %10.0f requests/s %8.2f us CPU/request\n", name,
+              total / seconds, cpu_seconds / total * 1e6);
+}
+
+} // namespace
+
+// Compares serving single-example requests one by one in float and in int8
+// against the batching server. Batching trades a queue round trip per
+// request for replacing matrix-vector products by matrix-matrix products,
+// which pays off once the weights no longer fit in the cache. Quantization
+// reads a quarter of the weight bytes, and the agreement of int8 with float
+// predictions is reported from the Confusion Matrix:
+//   load_generator [num_clients] [num_requests] [max_batch_size]
+//                  [max_latency_us]
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  int num_clients = argc > 1 ? std::atoi(argv[1]) : 64;
+  int num_requests = argc > 2 ? std::atoi(argv[2]) : 1000;
+  int max_batch_size = argc > 3 ? std::atoi(argv[3]) : 32;
+  int max_latency_us = argc > 4 ? std::atoi(argv[4]) : 500;
+
+  Registry::LoadRegistry();
+  VertexParameter vtx_param_in, vtx_param_hidden, vtx_param_out;
+  google::protobuf::TextFormat::ParseFromString(
+      "id: 0 type: INPUT operation: 'DummyTransformer' dims: 512",
+      &vtx_param_in);
+  google::protobuf::TextFormat::ParseFromString(
+      "id: 1 type: HIDDEN operation: 'Relu' dims: 1024", &vtx_param_hidden);
+  google::protobuf::TextFormat::ParseFromString(
+      "id: 2 type: OUTPUT operation: 'CrossEntropy' dims: 10", &vtx_param_out);
+  GraphBuilder<float> graph_builder;
+  ClassifierImpl<float> classifier =
+      graph_builder.AddEdge(0, "Dense", vtx_param_in, vtx_param_hidden)
+          .AddEdge(1, "Dense", vtx_param_hidden, vtx_param_out)
+          .SetLength(1)
+          .BuildClassifier();
+  MatrixX<float> feature = MatrixX<float>::Random(512, 1024);
+
+  std::vector<Workspace<float>> workspaces(num_clients);
+  Run("unbatched", num_clients, num_requests, feature,
+      [&](int client, const Eigen::Ref<const VectorX<float>> &column) {
+        MatrixX<float> single = column;
+        classifier.Predict(single, &workspaces[client]);
+      });
+
+  QuantizedClassifier<float> quantized_classifier(&classifier, feature);
+  Run("int8", num_clients, num_requests, feature,
+      [&](int client, const Eigen::Ref<const VectorX<float>> &column) {
+        MatrixX<float> single = column;
+        quantized_classifier.Predict(single, &workspaces[client]);
+      });
+  std::printf("%zu bytes of int8 weights, %zu of float weights\n",
+              quantized_classifier.weight_bytes(),
+              (512 * 1024 + 1024 * 10) * sizeof(float));
+
+  // Labels are the classes predicted in float, so that the trace of the int8
+  // Confusion Matrix counts the predictions both paths agree on
+  MatrixX<float> act = classifier.Predict(feature, &workspaces[0]);
+  MatrixX<int> labels = MatrixX<int>::Zero(act.rows(), act.cols());
+  for (int i = 0; i < act.cols(); ++i) {
+    int predicted_class;
+    act.col(i).maxCoeff(&predicted_class);
+    labels(predicted_class, i) = 1;
+  }
+  MatrixX<float> confusion_matrix = quantized_classifier.CalcConfusionMatrix(
+      feature, labels, &workspaces[0]);
+  std::printf("int8 agrees with float on %.2f%% of %d examples\n",
+              100.0 * confusion_matrix.trace() / feature.cols(),
+              static_cast<int>(feature.cols()));
+
+  BatchingOptions options;
+  options.max_batch_size = max_batch_size;
+  options.max_latency = std::chrono::microseconds(max_latency_us);
+  BatchingServer<float> server(&classifier, options);
+  Run("batched", num_clients, num_requests, feature,
+      [&](int client, const Eigen::Ref<const VectorX<float>> &column) {
+        server.Predict(column).get();
+      });
+  std::printf("%.1f requests per batch\n",
+              static_cast<double>(num_clients) * num_requests /
+                  server.num_batches());
+  return 0;
+}
@@ -0,0 +1,150 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/serving/quantized_classifier.h"
+
+#include <map>
+
+#include "glog/logging.h"
+#include "src/edge/output_vertex.h"
+#include "src/factory.h"
+#include "src/proto/graph_parameter.pb.h"
+#include "src/proto/vertex_parameter.pb.h"
+#include "src/tensor/arena.h"
+#include "src/visitor/calibrate_visitor.h"
+
+namespace intellgraph {
+
+template <typename T>
+QuantizedClassifier<T>::QuantizedClassifier(
+    const ClassifierImpl<T> *classifier,
+    const MatrixX<T> &calibration_feature) {
+  DCHECK(classifier);
+  DCHECK_GT(calibration_feature.cols(), 0);
+
+  const GraphParameter &graph_parameter = classifier->graph_parameter();
+  for (const auto &edge_param : graph_parameter.edge_params()) {
+    CHECK(edge_param.type() == "Dense")
+        << "Edge " << edge_param.id() << " of type " << edge_param.type()
+        << " cannot be quantized.";
+  }
+
+  // A float pass over the sample quantizes weights and records activation
+  // ranges, biases and the order of edges
+  Workspace<T> workspace;
+  CalibrateVisitor<T> assign_visitor(&model_, &workspace, false);
+  CalibrateVisitor<T> accumulate_visitor(&model_, &workspace, true);
+  classifier->Predict(calibration_feature, assign_visitor, accumulate_visitor,
+                      &workspace);
+  DCHECK_EQ(model_.edges.size(), graph_parameter.edge_params_size());
+
+  input_vertex_id_ = graph_parameter.input_vertex_param().id();
+  input_vertex_row_ = graph_parameter.input_vertex_param().dims();
+  output_vertex_id_ = graph_parameter.output_vertex_param().id();
+  threshold_ = classifier->threshold();
+
+  // Vertices only activate columns of workspaces, so they are instantiated
+  // for a single column
+  std::map<int, const VertexParameter *> vertex_param_by_id;
+  for (const auto &vertex_param :
+       graph_parameter.intermediate_vertex_params()) {
+    vertex_param_by_id[vertex_param.id()] = &vertex_param;
+  }
+  for (size_t i = 0; i < model_.edges.size(); ++i) {
+    int vtx_out_id = model_.edges[i].vtx_out_id;
+    if (!steps_.empty() && steps_.back().vertex->id() == vtx_out_id) {
+      steps_.back().edge_end = i + 1;
+      continue;
+    }
+    Step step;
+    if (vtx_out_id == output_vertex_id_) {
+      step.vertex = Factory::InstantiateVertex<OutputVertex<T>>(
+          graph_parameter.output_vertex_param(), 1);
+    } else {
+      step.vertex = Factory::InstantiateVertex<OpVertex<T>>(
+          *vertex_param_by_id.at(vtx_out_id), 1);
+    }
+    CHECK(!step.vertex->parameters())
+        << "Vertex " << vtx_out_id << " holds parameters that cannot be "
+        << "quantized.";
+    step.edge_begin = i;
+    step.edge_end = i + 1;
+    steps_.push_back(std::move(step));
+  }
+}
+
+template <typename T>
+Eigen::Map<const MatrixX<T>>
+QuantizedClassifier<T>::Predict(const MatrixX<T> &feature,
+                                Workspace<T> *workspace) const {
+  DCHECK(workspace);
+  DCHECK_EQ(feature.rows(), input_vertex_row_);
+  DCHECK_GT(feature.cols(), 0);
+
+  PlanWorkspace(feature.cols(), workspace);
+  workspace->BindConst(input_vertex_id_, feature.data(), feature.rows(),
+                       feature.cols());
+  QuantizedPredictVisitor<T> assign_visitor(&model_, workspace, false);
+  QuantizedPredictVisitor<T> accumulate_visitor(&model_, workspace, true);
+  for (const Step &step : steps_) {
+    int vtx_id = step.vertex->id();
+    assign_visitor.Forward(model_.edges[step.edge_begin],
+                           model_.bias_by_vertex.at(vtx_id).data());
+    for (size_t i = step.edge_begin + 1; i < step.edge_end; ++i) {
+      accumulate_visitor.Forward(model_.edges[i], nullptr);
+    }
+    step.vertex->Activate(workspace->mutable_act(vtx_id));
+  }
+  return workspace->act(output_vertex_id_);
+}
+
+template <typename T>
+const MatrixX<T> QuantizedClassifier<T>::CalcConfusionMatrix(
+    const MatrixX<T> &test_feature,
+    const Eigen::Ref<const MatrixX<int>> &test_labels,
+    Workspace<T> *workspace) const {
+  return ClassifierImpl<T>::CalcConfusionMatrixFromDist(
+      Predict(test_feature, workspace), test_labels, threshold_);
+}
+
+template <typename T> size_t QuantizedClassifier<T>::weight_bytes() const {
+  size_t bytes = 0;
+  for (const auto &[edge_id, weight] : model_.weight_by_edge) {
+    bytes += weight.bytes();
+  }
+  return bytes;
+}
+
+template <typename T>
+void QuantizedClassifier<T>::PlanWorkspace(int length,
+                                           Workspace<T> *workspace) const {
+  if (!workspace->IsPlannedFor(workspace_key_, length)) {
+    size_t size = 0;
+    for (const Step &step : steps_) {
+      size += Arena<T>::Align(static_cast<size_t>(step.vertex->row()) * length);
+    }
+    T *data = workspace->Reserve(workspace_key_, length, size);
+    for (const Step &step : steps_) {
+      workspace->Bind(step.vertex->id(), data, step.vertex->row(), length);
+      data += Arena<T>::Align(static_cast<size_t>(step.vertex->row()) * length);
+    }
+  }
+  workspace->Resize(length);
+}
+
+// Explicit instantiation
+template class QuantizedClassifier<float>;
+template class QuantizedClassifier<double>;
+
+} // namespace intellgraph
@@ -0,0 +1,94 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_SERVING_QUANTIZED_CLASSIFIER_H_
+#define INTELLGRAPH_SRC_SERVING_QUANTIZED_CLASSIFIER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "src/edge/op_vertex.h"
+#include "src/eigen.h"
+#include "src/graph/classifier_impl.h"
+#include "src/tensor/workspace.h"
+#include "src/visitor/quantized_predict_visitor.h"
+
+namespace intellgraph {
+
+// QuantizedClassifier runs post-training quantized inference of a trained
+// classifier. Weights of Dense edges are quantized to int8 per output
+// channel, and the range of every activation that feeds an edge is
+// calibrated on sample features, so that forward passes multiply int8
+// weights with uint8 activations. The quantized classifier keeps the int8
+// weights, the biases, the topology and activation functions of its own,
+// so the float classifier may be freed once it is built. Classifiers must
+// only have Dense edges and vertices without parameters, see
+// OpVertex::parameters.
+template <typename T> class QuantizedClassifier {
+public:
+  QuantizedClassifier(const ClassifierImpl<T> *classifier,
+                      const MatrixX<T> &calibration_feature);
+
+  QuantizedClassifier(const QuantizedClassifier &) = delete;
+  QuantizedClassifier &operator=(const QuantizedClassifier &) = delete;
+
+  // Returns the probability distribution of |feature| like
+  // ClassifierImpl::Predict. Thread-safe as long as each thread passes its
+  // own |workspace|.
+  Eigen::Map<const MatrixX<T>> Predict(const MatrixX<T> &feature,
+                                       Workspace<T> *workspace) const;
+
+  // Calculates the Confusion Matrix of the quantized predictions, in the
+  // format of ClassifierImpl::CalcConfusionMatrix, e.g. to compare the
+  // accuracy of both
+  const MatrixX<T>
+  CalcConfusionMatrix(const MatrixX<T> &test_feature,
+                      const Eigen::Ref<const MatrixX<int>> &test_labels,
+                      Workspace<T> *workspace) const;
+
+  // Size of the quantized weights in bytes
+  size_t weight_bytes() const;
+
+private:
+  // Vertex computed by a forward pass, activated after its inbound edges
+  // model_.edges[edge_begin, edge_end)
+  struct Step {
+    std::unique_ptr<OpVertex<T>> vertex;
+    size_t edge_begin = 0;
+    size_t edge_end = 0;
+  };
+
+  // Lays out activations of every computed vertex for batches of |length|
+  // columns, like Graph::PlanWorkspace
+  void PlanWorkspace(int length, Workspace<T> *workspace) const;
+
+  QuantizedModel<T> model_;
+  std::vector<Step> steps_;
+  int input_vertex_id_ = 0;
+  int input_vertex_row_ = 0;
+  int output_vertex_id_ = 0;
+  MatrixX<T> threshold_;
+  uint64_t workspace_key_ = NewWorkspaceKey();
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class QuantizedClassifier<float>;
+extern template class QuantizedClassifier<double>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_SERVING_QUANTIZED_CLASSIFIER_H_
@@ -0,0 +1,113 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/serving/quantized_classifier.h"
+
+#include <memory>
+
+#include "google/protobuf/text_format.h"
+#include "src/eigen.h"
+#include "src/graph/classifier_impl.h"
+#include "src/graph/graph_builder.h"
+#include "src/proto/vertex_parameter.pb.h"
+#include "src/registry.h"
+#include "src/tensor/workspace.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+ClassifierImpl<float> BuildClassifier() {
+  Registry::LoadRegistry();
+  VertexParameter vtx_param_in, vtx_param_hidden, vtx_param_out;
+  google::protobuf::TextFormat::ParseFromString(
+      "id: 0 type: INPUT operation: 'DummyTransformer' dims: 16",
+      &vtx_param_in);
+  google::protobuf::TextFormat::ParseFromString(
+      "id: 1 type: HIDDEN operation: 'Relu' dims: 32", &vtx_param_hidden);
+  google::protobuf::TextFormat::ParseFromString(
+      "id: 2 type: OUTPUT operation: 'CrossEntropy' dims: 4", &vtx_param_out);
+  GraphBuilder<float> graph_builder;
+  return graph_builder.AddEdge(0, "Dense", vtx_param_in, vtx_param_hidden)
+      .AddEdge(1, "Dense", vtx_param_hidden, vtx_param_out)
+      .AddEdge(2, "Dense", vtx_param_in, vtx_param_out)
+      .SetLength(1)
+      .BuildClassifier();
+}
+
+TEST(QuantizedClassifierTest, PredictSuccess) {
+  ClassifierImpl<float> classifier = BuildClassifier();
+  MatrixX<float> feature = MatrixX<float>::Random(16, 256);
+  Workspace<float> workspace;
+  MatrixX<float> expected_result = classifier.Predict(feature, &workspace);
+
+  QuantizedClassifier<float> quantized_classifier(&classifier, feature);
+  MatrixX<float> result = quantized_classifier.Predict(feature, &workspace);
+  ASSERT_EQ(result.rows(), expected_result.rows());
+  ASSERT_EQ(result.cols(), expected_result.cols());
+  EXPECT_LT((result - expected_result).cwiseAbs().maxCoeff(), 0.02f);
+
+  // Weights take a byte each, output channels being padded to blocks of 16,
+  // plus a float scale and an int32 sum per output channel
+  EXPECT_EQ(quantized_classifier.weight_bytes(),
+            32 * 16 + 16 * 32 + 16 * 16 + (4 + 4) * (32 + 4 + 4));
+}
+
+TEST(QuantizedClassifierTest, PredictWithoutClassifierSuccess) {
+  std::unique_ptr<ClassifierImpl<float>> classifier(
+      new ClassifierImpl<float>(BuildClassifier()));
+  MatrixX<float> feature = MatrixX<float>::Random(16, 64);
+  QuantizedClassifier<float> quantized_classifier(classifier.get(), feature);
+  Workspace<float> workspace;
+  MatrixX<float> expected_result =
+      quantized_classifier.Predict(feature, &workspace);
+
+  // The quantized classifier keeps everything it predicts with
+  classifier.reset();
+  Workspace<float> new_workspace;
+  MatrixX<float> result = quantized_classifier.Predict(feature, &new_workspace);
+  EXPECT_EQ(result, expected_result);
+  // Batches of another length round differently in the vectorized tails of
+  // the float kernels
+  result = quantized_classifier.Predict(feature.leftCols(3), &workspace);
+  EXPECT_TRUE(result.isApprox(expected_result.leftCols(3), 1e-5f));
+}
+
+TEST(QuantizedClassifierTest, CalcConfusionMatrixSuccess) {
+  ClassifierImpl<float> classifier = BuildClassifier();
+  MatrixX<float> feature = MatrixX<float>::Random(16, 256);
+  Workspace<float> workspace;
+  MatrixX<float> act = classifier.Predict(feature, &workspace);
+
+  // Labels are the classes predicted in float, so that the float Confusion
+  // Matrix is diagonal and the quantized one counts disagreements
+  MatrixX<int> labels = MatrixX<int>::Zero(4, feature.cols());
+  for (int i = 0; i < feature.cols(); ++i) {
+    int predicted_class;
+    act.col(i).maxCoeff(&predicted_class);
+    labels(predicted_class, i) = 1;
+  }
+  MatrixX<float> expected_result =
+      classifier.CalcConfusionMatrix(feature, labels);
+  EXPECT_EQ(expected_result.trace(), feature.cols());
+
+  QuantizedClassifier<float> quantized_classifier(&classifier, feature);
+  MatrixX<float> result =
+      quantized_classifier.CalcConfusionMatrix(feature, labels, &workspace);
+  EXPECT_EQ(result.sum(), feature.cols());
+  EXPECT_GE(result.trace(), 0.95f * feature.cols());
+}
+
+} // namespace
+} // namespace intellgraph
@@ -15,19 +15,62 @@ Contributor(s):
 #ifndef INTELLGRAPH_SRC_SOLVER_H_
 #define INTELLGRAPH_SRC_SOLVER_H_
 
+#include <cstddef>
+#include <vector>
+
+#include "src/logging.h"
+
 namespace intellgraph {
 
 // Forward declaration
 template <typename T> class Edge;
 
+// FlatParameters views parameters kept in a contiguous arena, see the
+// flat_parameters option of GraphParameter. Weights take the first
+// |num_weights| of the |size| elements and biases take the rest. Nablas and
+// each of the solver stores are laid out like the parameters.
+template <typename T> struct FlatParameters {
+  T *param = nullptr;
+  const T *nabla = nullptr;
+  std::vector<T *> stores;
+  size_t num_weights = 0;
+  size_t size = 0;
+};
+
 template <typename T> class Solver {
 public:
   Solver() = default;
   virtual ~Solver() = default;
 
+  // Starts an update of all of the parameters, before any of them is visited.
+  // Solvers whose updates depend on the number of updates so far, e.g. the
+  // bias corrections of Adam, advance it here rather than per visit.
+  virtual void Step() {}
+  // Number of steps taken so far by solvers whose updates depend on it, and
+  // restores it, e.g. when training resumes from a checkpoint
+  virtual int num_steps() const { return 0; }
+  virtual void set_num_steps(int num_steps) {}
+
   virtual void Visit(Edge<T> &edge) = 0;
+  // Updates all of the flat |parameters| in a single sweep, with the
+  // num_stores() stores they hold
+  virtual void Visit(FlatParameters<T> &parameters) { NOTREACHED(); }
+
+  // Number of stores the solver keeps per parameter, e.g. two moments for
+  // Adam
+  virtual int num_stores() const { return 0; }
+
+  // Sets the learning rate of the next updates, e.g. as scheduled by
+  // src/solver/lr_scheduler.h. Solvers without a learning rate ignore it.
+  virtual void set_eta(T eta) {}
 };
 
+// Returns the optional hyperparameter |value| of a solver config, or
+// |default_value| if it is left at zero
+template <typename T> T ConfigValueOr(float value, T default_value) {
+  return value > 0 ? value : default_value;
+}
+
 } // namespace intellgraph
 
 #endif // INTELLGRAPH_SRC_SOLVER_H_
@@ -14,66 +14,46 @@ Contributor(s):
 ==============================================================================*/
 #include "src/solver/ada_max.h"
 
-#include <algorithm>
 #include <cmath>
-
-#include "glog/logging.h"
+#include "src/kernel/solver.h"
+#include "src/logging.h"
 
 namespace intellgraph {
 
 template <typename T>
-AdaMax<T>::AdaMax(T eta, T lambda, T beta1, T beta2)
-    : eta_(eta), lambda_(lambda), beta1_(beta1), beta2_(beta2) {
+AdaMax<T>::AdaMax(T eta, T lambda, T beta1, T beta2, T epsilon)
+    : KernelSolver<T, AdaMax<T>, 2>(lambda), eta_(eta), beta1_(beta1),
+      beta2_(beta2), epsilon_(epsilon) {
   DCHECK_GT(eta_, 0);
-  DCHECK_GE(lambda_, 0);
   DCHECK(beta1_ > 0 && beta1_ < 1);
   DCHECK(beta2_ > 0 && beta2_ < 1);
+  DCHECK_GT(epsilon_, 0);
 }
 
-template <typename T> AdaMax<T>::~AdaMax() = default;
-
-template <typename T> void AdaMax<T>::Visit(Edge<T> &edge) {
-  LOG(INFO) << "Edge " << edge.id() << " is updated with the Adam.";
-
-  ++iteration_count_;
-
-  Eigen::Map<MatrixX<T>> bias = edge.mutable_bias();
-  Eigen::Map<MatrixX<T>> weight = edge.mutable_weight();
-
-  MatrixX<T> nabla_weight;
-  nabla_weight.noalias() = edge.CalcNablaWeight() + lambda_ * weight;
-  const MatrixX<T> nabla_bias = edge.CalcNablaBias();
-
-  Eigen::Map<MatrixX<T>> weight_first_moment = edge.mutable_weight_stores(0);
-  Eigen::Map<MatrixX<T>> bias_first_moment = edge.mutable_bias_stores(0);
-  Eigen::Map<MatrixX<T>> weight_ut = edge.mutable_weight_stores(1);
-  Eigen::Map<MatrixX<T>> bias_ut = edge.mutable_bias_stores(1);
-
-  // Updates first moments
-  weight_first_moment.noalias() =
-      beta1_ * weight_first_moment + (1.0 - beta1_) * nabla_weight;
-  bias_first_moment.noalias() =
-      beta1_ * bias_first_moment + (1.0 - beta1_) * nabla_bias;
+template <typename T>
+AdaMax<T>::AdaMax(const SolverConfig &config)
+    : AdaMax(config.eta(), config.lambda(),
+             ConfigValueOr<T>(config.beta1(), 0.9),
+             ConfigValueOr<T>(config.beta2(), 0.999),
+             ConfigValueOr<T>(config.epsilon(), 1e-8)) {}
 
-  // Updates |weight_ut| and |bias_ut|
-  DCHECK_EQ(weight_ut.cols(), bias_ut.rows());
-  for (int col = 0; col < weight_ut.cols(); ++col) {
-    for (int row = 0; row < weight_ut.rows(); ++row) {
-      weight_ut(row, col) = std::max(beta2_ * weight_ut(row, col),
-                                     std::abs(nabla_weight(row, col)));
-    }
-    bias_ut(col) = std::max(beta2_ * bias_ut(col), std::abs(nabla_bias(col)));
-  }
+template <typename T> AdaMax<T>::~AdaMax() = default;
 
-  double first_moment_factor = 1.0 - std::pow(beta1_, iteration_count_);
+template <typename T> void AdaMax<T>::Step() {
+  set_num_steps(iteration_count_ + 1);
+}
 
-  // Updates |weight| matrix
-  weight.array() -= (eta_ / first_moment_factor) * weight_first_moment.array() /
-                    weight_ut.array();
+template <typename T> void AdaMax<T>::set_num_steps(int num_steps) {
+  DCHECK_GE(num_steps, 0);
+  iteration_count_ = num_steps;
+  first_moment_factor_ = 1.0 - std::pow(beta1_, iteration_count_);
+}
 
-  // Updates |bias| vector
-  bias.array() -= (eta_ / first_moment_factor) * bias_first_moment.array() /
-                  bias_ut.array();
+template <typename T>
+void AdaMax<T>::Update(T *param, const T *nabla, T *const *stores, size_t size,
+                       T lambda) const {
+  AdaMaxUpdate(param, nabla, stores[0], stores[1], size, lambda, beta1_,
+               beta2_, eta_ / first_moment_factor_, epsilon_);
 }
 
 // Explicit instantiation
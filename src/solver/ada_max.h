@@ -15,25 +15,40 @@ Contributor(s):
 #ifndef INTELLGRAPH_SRC_SOLVER_ADA_MAX_H_
 #define INTELLGRAPH_SRC_SOLVER_ADA_MAX_H_
 
-#include "src/edge.h"
+#include <cstddef>
+
 #include "src/proto/graph_parameter.pb.h"
-#include "src/solver.h"
+#include "src/solver/kernel_solver.h"
 
 namespace intellgraph {
 
-template <typename T> class AdaMax : public Solver<T> {
+template <typename T> class AdaMax : public KernelSolver<T, AdaMax<T>, 2> {
 public:
-  explicit AdaMax(T eta = 0.002, T lambda = 0.0, T beta1 = 0.9, T beta2 = 0.999);
+  explicit AdaMax(T eta = 0.002, T lambda = 0.0, T beta1 = 0.9,
+                  T beta2 = 0.999, T epsilon = 1e-8);
+  explicit AdaMax(const SolverConfig &config);
   ~AdaMax() override;
 
-  void Visit(Edge<T> &edge) override;
+  void Step() override;
+  int num_steps() const override { return iteration_count_; }
+  void set_num_steps(int num_steps) override;
+
+  void set_eta(T eta) override { eta_ = eta; }
 
 private:
+  friend class KernelSolver<T, AdaMax<T>, 2>;
+  static constexpr const char *kName = "AdaMax";
+
+  void Update(T *param, const T *nabla, T *const *stores, size_t size,
+              T lambda) const;
+
   T eta_ = 0;
-  T lambda_ = 0;
   T beta1_ = 0;
   T beta2_ = 0;
+  T epsilon_ = 0;
   int iteration_count_ = 0;
+  // Bias correction of the first moments at |iteration_count_|
+  T first_moment_factor_ = 1;
 };
 
 // Tells compiler not to instantiate the template in translation units that
@@ -14,61 +14,31 @@ Contributor(s):
 ==============================================================================*/
 #include "src/solver/adadelta.h"
 
-#include "glog/logging.h"
+#include "src/kernel/solver.h"
+#include "src/logging.h"
 
 namespace intellgraph {
 
 template <typename T>
 Adadelta<T>::Adadelta(T gamma, T lambda, T epsilon)
-    : gamma_(gamma), lambda_(lambda), epsilon_(epsilon) {
+    : KernelSolver<T, Adadelta<T>, 2>(lambda), gamma_(gamma),
+      epsilon_(epsilon) {
   DCHECK(gamma_ > 0 && gamma_ < 1);
-  DCHECK_GE(lambda_, 0);
   DCHECK_GT(epsilon_, 0);
 }
 
-template <typename T> Adadelta<T>::~Adadelta() = default;
-
-template <typename T> void Adadelta<T>::Visit(Edge<T> &edge) {
-  LOG(INFO) << "Edge " << edge.id() << " is updated with the Adadetla.";
-
-  Eigen::Map<MatrixX<T>> bias = edge.mutable_bias();
-  Eigen::Map<MatrixX<T>> weight = edge.mutable_weight();
-
-  MatrixX<T> nabla_weight;
-  nabla_weight.noalias() = edge.CalcNablaWeight() + lambda_ * weight;
-  const MatrixX<T> nabla_bias = edge.CalcNablaBias();
-
-  Eigen::Map<MatrixX<T>> g_mean = edge.mutable_weight_stores(0);
-  Eigen::Map<MatrixX<T>> g_bias_mean = edge.mutable_bias_stores(0);
-  Eigen::Map<MatrixX<T>> weight_update_square_mean =
-      edge.mutable_weight_stores(1);
-  Eigen::Map<MatrixX<T>> bias_update_square_mean = edge.mutable_bias_stores(1);
-
-  // Updates |g_mean| and |g_bias_mean|
-  g_mean.array() =
-      gamma_ * g_mean.array() + (1.0 - gamma_) * nabla_weight.array().square();
-  g_bias_mean.array() = gamma_ * g_bias_mean.array() +
-                        (1.0 - gamma_) * nabla_bias.array().square();
-
-  // Calcuates weight and bias updates
-  MatrixX<T> weight_update =
-      (weight_update_square_mean.array() + epsilon_).sqrt() *
-      nabla_weight.array() / (g_mean.array() + epsilon_).sqrt();
-  MatrixX<T> bias_update = (bias_update_square_mean.array() + epsilon_).sqrt() *
-                           nabla_bias.array() /
-                           (g_bias_mean.array() + epsilon_).sqrt();
+template <typename T>
+Adadelta<T>::Adadelta(const SolverConfig &config)
+    : Adadelta(ConfigValueOr<T>(config.gamma(), 0.95), config.lambda(),
+               ConfigValueOr<T>(config.epsilon(), 1e-8)) {}
 
-  // Updates |weight| and |bias|
-  weight.noalias() -= weight_update;
-  bias.noalias() -= bias_update;
+template <typename T> Adadelta<T>::~Adadelta() = default;
 
-  // Updates weight and bias updates
-  weight_update_square_mean.array() =
-      gamma_ * weight_update_square_mean.array() +
-      (1.0 - gamma_) * weight_update.array().square();
-  bias_update_square_mean.array() =
-      gamma_ * bias_update_square_mean.array() +
-      (1.0 - gamma_) * bias_update.array().square();
+template <typename T>
+void Adadelta<T>::Update(T *param, const T *nabla, T *const *stores,
+                         size_t size, T lambda) const {
+  AdadeltaUpdate(param, nabla, stores[0], stores[1], size, lambda, gamma_,
+                 epsilon_);
 }
 
 // Explicit instantiation
@@ -15,22 +15,27 @@ Contributor(s):
 #ifndef INTELLGRAPH_SRC_SOLVER_ADADELTA_H_
 #define INTELLGRAPH_SRC_SOLVER_ADADELTA_H_
 
-#include "src/edge.h"
+#include <cstddef>
+
 #include "src/proto/graph_parameter.pb.h"
-#include "src/solver.h"
+#include "src/solver/kernel_solver.h"
 
 namespace intellgraph {
 
-template <typename T> class Adadelta : public Solver<T> {
+template <typename T> class Adadelta : public KernelSolver<T, Adadelta<T>, 2> {
 public:
   explicit Adadelta(T gamma, T lambda, T epsilon = 1e-8);
+  explicit Adadelta(const SolverConfig &config);
   ~Adadelta() override;
 
-  void Visit(Edge<T> &edge) override;
-
 private:
+  friend class KernelSolver<T, Adadelta<T>, 2>;
+  static constexpr const char *kName = "Adadelta";
+
+  void Update(T *param, const T *nabla, T *const *stores, size_t size,
+              T lambda) const;
+
   T gamma_ = 0;
-  T lambda_ = 0;
   T epsilon_ = 0;
 };
 
@@ -14,42 +14,30 @@ Contributor(s):
 ==============================================================================*/
 #include "src/solver/adagrad.h"
 
-#include "glog/logging.h"
+#include "src/kernel/solver.h"
+#include "src/logging.h"
 
 namespace intellgraph {
 
 template <typename T>
 Adagrad<T>::Adagrad(T eta, T lambda, T epsilon)
-    : eta_(eta), lambda_(lambda), epsilon_(epsilon) {
+    : KernelSolver<T, Adagrad<T>, 1>(lambda), eta_(eta),
+      epsilon_(epsilon) {
   DCHECK_GT(eta_, 0);
-  DCHECK_GE(lambda_, 0);
   DCHECK_GT(epsilon, 0);
 }
 
-template <typename T> Adagrad<T>::~Adagrad() = default;
-
-template <typename T> void Adagrad<T>::Visit(Edge<T> &edge) {
-  LOG(INFO) << "Edge " << edge.id() << " is updated with the Adagrad.";
-
-  Eigen::Map<MatrixX<T>> bias = edge.mutable_bias();
-  Eigen::Map<MatrixX<T>> weight = edge.mutable_weight();
-
-  MatrixX<T> nabla_weight;
-  nabla_weight.noalias() = edge.CalcNablaWeight() + lambda_ * weight;
-  const MatrixX<T> nabla_bias = edge.CalcNablaBias();
-
-  Eigen::Map<MatrixX<T>> g = edge.mutable_weight_stores(0);
-  Eigen::Map<MatrixX<T>> g_bias = edge.mutable_bias_stores(0);
-
-  g.array() += nabla_weight.array().square();
-  g_bias.array() += nabla_bias.array().square();
+template <typename T>
+Adagrad<T>::Adagrad(const SolverConfig &config)
+    : Adagrad(config.eta(), config.lambda(),
+              ConfigValueOr<T>(config.epsilon(), 1e-8)) {}
 
-  // Updates |weight| matrix
-  weight.array() -= eta_ * nabla_weight.array() / (g.array() + epsilon_).sqrt();
+template <typename T> Adagrad<T>::~Adagrad() = default;
 
-  // Updates |bias| vector
-  bias.array() -=
-      eta_ * nabla_bias.array() / (g_bias.array() + epsilon_).sqrt();
+template <typename T>
+void Adagrad<T>::Update(T *param, const T *nabla, T *const *stores, size_t size,
+                        T lambda) const {
+  AdagradUpdate(param, nabla, stores[0], size, eta_, lambda, epsilon_);
 }
 
 // Explicit instantiation
@@ -15,22 +15,29 @@ Contributor(s):
 #ifndef INTELLGRAPH_SRC_SOLVER_ADAGRAD_H_
 #define INTELLGRAPH_SRC_SOLVER_ADAGRAD_H_
 
-#include "src/edge.h"
+#include <cstddef>
+
 #include "src/proto/graph_parameter.pb.h"
-#include "src/solver.h"
+#include "src/solver/kernel_solver.h"
 
 namespace intellgraph {
 
-template <typename T> class Adagrad : public Solver<T> {
+template <typename T> class Adagrad : public KernelSolver<T, Adagrad<T>, 1> {
 public:
   explicit Adagrad(T eta, T lambda, T epsilon = 1e-8);
+  explicit Adagrad(const SolverConfig &config);
   ~Adagrad() override;
 
-  void Visit(Edge<T> &edge) override;
+  void set_eta(T eta) override { eta_ = eta; }
 
 private:
+  friend class KernelSolver<T, Adagrad<T>, 1>;
+  static constexpr const char *kName = "Adagrad";
+
+  void Update(T *param, const T *nabla, T *const *stores, size_t size,
+              T lambda) const;
+
   T eta_ = 0;
-  T lambda_ = 0;
   T epsilon_ = 0;
 };
 
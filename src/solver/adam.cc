@@ -15,62 +15,47 @@ Contributor(s):
 #include "src/solver/adam.h"
 
 #include <cmath>
-
-#include "glog/logging.h"
+#include "src/kernel/solver.h"
+#include "src/logging.h"
 
 namespace intellgraph {
 
 template <typename T>
 Adam<T>::Adam(T eta, T lambda, T beta1, T beta2, T epsilon)
-    : eta_(eta), lambda_(lambda), beta1_(beta1), beta2_(beta2),
-      epsilon_(epsilon) {
+    : KernelSolver<T, Adam<T>, 2>(lambda), eta_(eta), beta1_(beta1),
+      beta2_(beta2), epsilon_(epsilon) {
   DCHECK_GT(eta_, 0);
-  DCHECK_GE(lambda_, 0);
   DCHECK(beta1_ > 0 && beta1_ < 1);
   DCHECK(beta2_ > 0 && beta2_ < 1);
   DCHECK_GT(epsilon_, 0);
 }
 
-template <typename T> Adam<T>::~Adam() = default;
-
-template <typename T> void Adam<T>::Visit(Edge<T> &edge) {
-  LOG(INFO) << "Edge " << edge.id() << " is updated with the Adam.";
-
-  ++iteration_count_;
-
-  Eigen::Map<MatrixX<T>> bias = edge.mutable_bias();
-  Eigen::Map<MatrixX<T>> weight = edge.mutable_weight();
-
-  MatrixX<T> nabla_weight;
-  nabla_weight.noalias() = edge.CalcNablaWeight() + lambda_ * weight;
-  const MatrixX<T> nabla_bias = edge.CalcNablaBias();
+template <typename T>
+Adam<T>::Adam(const SolverConfig &config)
+    : Adam(config.eta(), config.lambda(),
+           ConfigValueOr<T>(config.beta1(), 0.9),
+           ConfigValueOr<T>(config.beta2(), 0.999),
+           ConfigValueOr<T>(config.epsilon(), 1e-8)) {}
 
-  Eigen::Map<MatrixX<T>> weight_first_moment = edge.mutable_weight_stores(0);
-  Eigen::Map<MatrixX<T>> bias_first_moment = edge.mutable_bias_stores(0);
-  Eigen::Map<MatrixX<T>> weight_second_moment = edge.mutable_weight_stores(1);
-  Eigen::Map<MatrixX<T>> bias_second_moment = edge.mutable_bias_stores(1);
+template <typename T> Adam<T>::~Adam() = default;
 
-  // Updates first and second moments
-  weight_first_moment.noalias() =
-      beta1_ * weight_first_moment + (1.0 - beta1_) * nabla_weight;
-  weight_second_moment.array() = beta2_ * weight_second_moment.array() +
-                                 (1.0 - beta2_) * nabla_weight.array().square();
-  bias_first_moment.noalias() =
-      beta1_ * bias_first_moment + (1.0 - beta1_) * nabla_bias;
-  bias_second_moment.array() = beta2_ * bias_second_moment.array() +
-                               (1.0 - beta2_) * nabla_bias.array().square();
+template <typename T> void Adam<T>::Step() {
+  set_num_steps(iteration_count_ + 1);
+}
 
-  double first_moment_factor = 1.0 - std::pow(beta1_, iteration_count_);
-  double second_moment_factor = 1.0 - std::pow(beta2_, iteration_count_);
-  // Updates |weight| matrix
-  weight.array() -=
-      (eta_ / first_moment_factor) * weight_first_moment.array() /
-      ((weight_second_moment.array() / second_moment_factor).sqrt() + epsilon_);
+template <typename T> void Adam<T>::set_num_steps(int num_steps) {
+  DCHECK_GE(num_steps, 0);
+  iteration_count_ = num_steps;
+  first_moment_factor_ = 1.0 - std::pow(beta1_, iteration_count_);
+  second_moment_factor_ = 1.0 - std::pow(beta2_, iteration_count_);
+}
 
-  // Updates |bias| vector
-  bias.array() -=
-      (eta_ / first_moment_factor) * bias_first_moment.array() /
-      ((bias_second_moment.array() / second_moment_factor).sqrt() + epsilon_);
+template <typename T>
+void Adam<T>::Update(T *param, const T *nabla, T *const *stores, size_t size,
+                     T lambda) const {
+  AdamUpdate(param, nabla, stores[0], stores[1], size, lambda, beta1_, beta2_,
+             eta_ / first_moment_factor_, 1.0 / second_moment_factor_,
+             epsilon_);
 }
 
 // Explicit instantiation
@@ -15,27 +15,41 @@ Contributor(s):
 #ifndef INTELLGRAPH_SRC_SOLVER_ADAM_H_
 #define INTELLGRAPH_SRC_SOLVER_ADAM_H_
 
-#include "src/edge.h"
+#include <cstddef>
+
 #include "src/proto/graph_parameter.pb.h"
-#include "src/solver.h"
+#include "src/solver/kernel_solver.h"
 
 namespace intellgraph {
 
-template <typename T> class Adam : public Solver<T> {
+template <typename T> class Adam : public KernelSolver<T, Adam<T>, 2> {
 public:
   explicit Adam(T eta = 0.001, T lambda = 0.0, T beta1 = 0.9, T beta2 = 0.999,
                 T epsilon = 1e-8);
+  explicit Adam(const SolverConfig &config);
   ~Adam() override;
 
-  void Visit(Edge<T> &edge) override;
+  void Step() override;
+  int num_steps() const override { return iteration_count_; }
+  void set_num_steps(int num_steps) override;
+
+  void set_eta(T eta) override { eta_ = eta; }
 
 private:
+  friend class KernelSolver<T, Adam<T>, 2>;
+  static constexpr const char *kName = "Adam";
+
+  void Update(T *param, const T *nabla, T *const *stores, size_t size,
+              T lambda) const;
+
   T eta_ = 0;
-  T lambda_ = 0;
   T beta1_ = 0;
   T beta2_ = 0;
   T epsilon_ = 0;
   int iteration_count_ = 0;
+  // Bias corrections of the moments at |iteration_count_|
+  T first_moment_factor_ = 1;
+  T second_moment_factor_ = 1;
 };
 
 // Tells compiler not to instantiate the template in translation units that
@@ -0,0 +1,77 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/solver/adam.h"
+
+#include <cmath>
+
+#include "src/edge/dense_edge_impl.h"
+#include "src/edge/vertex/op_vertex_impl.h"
+#include "src/edge/vertex/sigmoid.h"
+#include "src/eigen.h"
+#include "src/solver/ada_max.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+// Runs |num_steps| steps of |solver| over two edges with the same weights
+// and nablas, and checks that both edges see the same bias corrections, i.e.
+// that the step count advances once per step rather than once per edge
+void ExpectStepsShared(Solver<double> *solver, int num_steps) {
+  OpVertexImpl<double, Sigmoid> vtx_in(0, 2, 3);
+  // Biases are held by the outbound vertices, so each edge has its own
+  OpVertexImpl<double, Sigmoid> first_out(1, 4, 3);
+  OpVertexImpl<double, Sigmoid> second_out(2, 4, 3);
+  DenseEdgeImpl<double, OpVertex<double>> first(0, &vtx_in, &first_out);
+  DenseEdgeImpl<double, OpVertex<double>> second(1, &vtx_in, &second_out);
+  for (auto *edge : {&first, &second}) {
+    edge->mutable_weight().setConstant(1.0);
+    edge->mutable_bias().setConstant(1.0);
+    edge->mutable_nabla_weight().setConstant(0.5);
+    edge->mutable_nabla_bias().setConstant(-0.5);
+  }
+
+  for (int step = 0; step < num_steps; ++step) {
+    solver->Step();
+    first.Accept(*solver);
+    second.Accept(*solver);
+  }
+
+  EXPECT_EQ(first.mutable_weight(), second.mutable_weight());
+  EXPECT_EQ(first.mutable_bias(), second.mutable_bias());
+  // With a constant nabla g, the bias-corrected moments are g and g^2, so
+  // every step moves the parameters by eta against the sign of g
+  MatrixX<double> weight = first.mutable_weight();
+  MatrixX<double> bias = first.mutable_bias();
+  for (int i = 0; i < weight.size(); ++i) {
+    EXPECT_NEAR(weight(i), 1.0 - num_steps * 0.01, 1e-6);
+  }
+  for (int i = 0; i < bias.size(); ++i) {
+    EXPECT_NEAR(bias(i), 1.0 + num_steps * 0.01, 1e-6);
+  }
+}
+
+TEST(AdamTest, StepAdvancesOncePerStep) {
+  Adam<double> adam(0.01);
+  ExpectStepsShared(&adam, 3);
+}
+
+TEST(AdaMaxTest, StepAdvancesOncePerStep) {
+  AdaMax<double> ada_max(0.01);
+  ExpectStepsShared(&ada_max, 3);
+}
+
+} // namespace
+} // namespace intellgraph
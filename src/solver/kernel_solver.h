@@ -0,0 +1,116 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_SOLVER_KERNEL_SOLVER_H_
+#define INTELLGRAPH_SRC_SOLVER_KERNEL_SOLVER_H_
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "src/edge.h"
+#include "src/eigen.h"
+#include "src/logging.h"
+#include "src/solver.h"
+
+namespace intellgraph {
+
+// KernelSolver implements the visits of solvers whose updates are kernels of
+// src/kernel/solver.h. |Derived| names itself by kName and updates |size|
+// contiguous parameters |param| against their nablas |nabla| and its
+// NumStores stores |stores|, each at the same offsets as the parameters, in
+// a single pass with
+//
+//   void Update(T *param, const T *nabla, T *const *stores, size_t size,
+//               T lambda) const;
+//
+// where |lambda| is the L2 regularization factor of |param|. KernelSolver
+// breaks edges and flat arenas into such views, i.e. weight matrices, bias
+// vectors and the weight columns with a nabla of sparse edges, so that every
+// solver updates them alike. Biases are not regularized, and the weights and
+// stores of columns without a nabla are lazily left as they are.
+template <typename T, class Derived, int NumStores>
+class KernelSolver : public Solver<T> {
+public:
+  explicit KernelSolver(T lambda) : lambda_(lambda) { DCHECK_GE(lambda_, 0); }
+
+  void Visit(Edge<T> &edge) final {
+    IG_TRACE(1) << "Edge " << edge.id() << " is updated with the "
+                << Derived::kName << ".";
+
+    Eigen::Map<MatrixX<T>> weight = edge.mutable_weight();
+    Eigen::Map<MatrixX<T>> nabla_weight = edge.mutable_nabla_weight();
+    // Stores are lazily allocated in the order of their indices, so they are
+    // fetched one by one rather than within the updates
+    std::array<T *, NumStores> weight_stores;
+    for (int i = 0; i < NumStores; ++i) {
+      weight_stores[i] = edge.mutable_weight_stores(i).data();
+    }
+    const Derived &solver = static_cast<const Derived &>(*this);
+    if (edge.owns_bias()) {
+      Eigen::Map<MatrixX<T>> bias = edge.mutable_bias();
+      std::array<T *, NumStores> bias_stores;
+      for (int i = 0; i < NumStores; ++i) {
+        bias_stores[i] = edge.mutable_bias_stores(i).data();
+      }
+      solver.Update(bias.data(), edge.mutable_nabla_bias().data(),
+                    bias_stores.data(), bias.size(), 0);
+    }
+
+    const std::vector<int> *cols = edge.nabla_weight_cols();
+    if (!cols) {
+      solver.Update(weight.data(), nabla_weight.data(), weight_stores.data(),
+                    weight.size(), lambda_);
+      return;
+    }
+    std::array<T *, NumStores> col_stores;
+    for (int i = 0; i < cols->size(); ++i) {
+      int col = (*cols)[i];
+      size_t offset = static_cast<size_t>(col) * weight.rows();
+      for (int j = 0; j < NumStores; ++j) {
+        col_stores[j] = weight_stores[j] + offset;
+      }
+      solver.Update(weight.col(col).data(), nabla_weight.col(i).data(),
+                    col_stores.data(), weight.rows(), lambda_);
+    }
+  }
+
+  void Visit(FlatParameters<T> &parameters) final {
+    IG_TRACE(1) << "Flat parameters are updated with the " << Derived::kName
+                << ".";
+    DCHECK_EQ(parameters.stores.size(), NumStores);
+
+    size_t num_weights = parameters.num_weights;
+    std::array<T *, NumStores> bias_stores;
+    for (int i = 0; i < NumStores; ++i) {
+      bias_stores[i] = parameters.stores[i] + num_weights;
+    }
+
+    const Derived &solver = static_cast<const Derived &>(*this);
+    solver.Update(parameters.param, parameters.nabla, parameters.stores.data(),
+                  num_weights, lambda_);
+    solver.Update(parameters.param + num_weights,
+                  parameters.nabla + num_weights, bias_stores.data(),
+                  parameters.size - num_weights, 0);
+  }
+
+  int num_stores() const final { return NumStores; }
+
+private:
+  T lambda_ = 0;
+};
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_SOLVER_KERNEL_SOLVER_H_
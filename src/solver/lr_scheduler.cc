@@ -0,0 +1,82 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/solver/lr_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "glog/logging.h"
+
+namespace intellgraph {
+
+template <typename T>
+LrScheduler<T>::LrScheduler(const SolverConfig &config)
+    : eta_(config.eta()), step_size_(config.schedule().step_size()),
+      gamma_(config.schedule().gamma()),
+      total_steps_(config.schedule().total_steps()),
+      min_eta_(config.schedule().min_eta()),
+      warmup_steps_(config.schedule().warmup_steps()) {
+  DCHECK_GT(eta_, 0);
+  DCHECK_GE(warmup_steps_, 0);
+
+  const std::string &type = config.schedule().type();
+  if (type.empty() || type == "Constant") {
+    type_ = Type::kConstant;
+  } else if (type == "Step") {
+    type_ = Type::kStep;
+    DCHECK_GT(step_size_, 0);
+    DCHECK(gamma_ > 0 && gamma_ <= 1);
+  } else if (type == "Cosine") {
+    type_ = Type::kCosine;
+    DCHECK_GT(total_steps_, 0);
+    DCHECK(min_eta_ >= 0 && min_eta_ <= eta_);
+  } else {
+    LOG(FATAL) << "Unknown learning rate schedule " << type;
+  }
+}
+
+template <typename T> LrScheduler<T>::~LrScheduler() = default;
+
+template <typename T> T LrScheduler<T>::eta(int step) const {
+  DCHECK_GE(step, 0);
+
+  if (step < warmup_steps_) {
+    return eta_ * (step + 1) / (warmup_steps_ + 1);
+  }
+  step -= warmup_steps_;
+  switch (type_) {
+  case Type::kStep:
+    return eta_ * std::pow(gamma_, step / step_size_);
+  case Type::kCosine: {
+    T progress = std::min<T>(static_cast<T>(step) / total_steps_, 1);
+    T cosine = (1 + std::cos(static_cast<T>(M_PI) * progress)) / 2;
+    return min_eta_ + (eta_ - min_eta_) * cosine;
+  }
+  default:
+    return eta_;
+  }
+}
+
+template <typename T> void LrScheduler<T>::Step(Solver<T> *solver) {
+  DCHECK(solver);
+  solver->set_eta(eta(step_++));
+}
+
+// Explicit instantiation
+template class LrScheduler<float>;
+template class LrScheduler<double>;
+
+} // namespace intellgraph
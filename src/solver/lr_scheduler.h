@@ -0,0 +1,69 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_SOLVER_LR_SCHEDULER_H_
+#define INTELLGRAPH_SRC_SOLVER_LR_SCHEDULER_H_
+
+#include "src/proto/graph_parameter.pb.h"
+#include "src/solver.h"
+
+namespace intellgraph {
+
+// LrScheduler sets the learning rate of a solver before each of its steps,
+// as given by the schedule of a solver config, so that hyperparameters change
+// without reconstructing the solver and its stores. With the learning rate
+// |eta| of the config, step |step| is run at:
+// - "Constant": eta
+// - "Step": eta * gamma^floor(step / step_size)
+// - "Cosine": min_eta + (eta - min_eta) * (1 + cos(pi * t)) / 2, where
+//   t = min(step / total_steps, 1)
+// Warmup steps run at eta * (step + 1) / (warmup_steps + 1) and precede the
+// schedule, whose steps are counted from the end of the warmup.
+template <typename T> class LrScheduler {
+public:
+  explicit LrScheduler(const SolverConfig &config);
+  ~LrScheduler();
+
+  // Returns the learning rate of step |step|, counted from zero
+  T eta(int step) const;
+
+  // Sets the learning rate of the next step on |solver| and advances
+  void Step(Solver<T> *solver);
+
+  // Number of steps taken so far, and restores it, e.g. when training
+  // resumes from a checkpoint
+  int step() const { return step_; }
+  void set_step(int step) { step_ = step; }
+
+private:
+  enum class Type { kConstant, kStep, kCosine };
+
+  Type type_ = Type::kConstant;
+  T eta_ = 0;
+  int step_size_ = 0;
+  T gamma_ = 0;
+  int total_steps_ = 0;
+  T min_eta_ = 0;
+  int warmup_steps_ = 0;
+  int step_ = 0;
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class LrScheduler<float>;
+extern template class LrScheduler<double>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_SOLVER_LR_SCHEDULER_H_
@@ -0,0 +1,95 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/solver/lr_scheduler.h"
+
+#include "google/protobuf/text_format.h"
+#include "src/proto/graph_parameter.pb.h"
+#include "src/solver.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+// Records the learning rate it is set to
+class EtaRecorder : public Solver<double> {
+public:
+  void Visit(Edge<double> &edge) override {}
+  void set_eta(double eta) override { this->eta = eta; }
+
+  double eta = 0;
+};
+
+SolverConfig ParseSolverConfig(const char *text) {
+  SolverConfig config;
+  EXPECT_TRUE(google::protobuf::TextFormat::ParseFromString(text, &config));
+  return config;
+}
+
+TEST(LrSchedulerTest, ConstantSuccess) {
+  LrScheduler<double> scheduler(
+      ParseSolverConfig("type: 'SGD' eta: 0.5 schedule { }"));
+  EXPECT_DOUBLE_EQ(scheduler.eta(0), 0.5);
+  EXPECT_DOUBLE_EQ(scheduler.eta(1000), 0.5);
+}
+
+TEST(LrSchedulerTest, StepSuccess) {
+  LrScheduler<double> scheduler(ParseSolverConfig(
+      "type: 'SGD' eta: 0.5 schedule { type: 'Step' step_size: 3 "
+      "gamma: 0.5 }"));
+  EXPECT_DOUBLE_EQ(scheduler.eta(0), 0.5);
+  EXPECT_DOUBLE_EQ(scheduler.eta(2), 0.5);
+  EXPECT_DOUBLE_EQ(scheduler.eta(3), 0.25);
+  EXPECT_DOUBLE_EQ(scheduler.eta(7), 0.125);
+}
+
+TEST(LrSchedulerTest, CosineSuccess) {
+  LrScheduler<double> scheduler(ParseSolverConfig(
+      "type: 'SGD' eta: 0.5 schedule { type: 'Cosine' total_steps: 10 "
+      "min_eta: 0.1 }"));
+  EXPECT_DOUBLE_EQ(scheduler.eta(0), 0.5);
+  EXPECT_NEAR(scheduler.eta(5), 0.3, 1e-6);
+  EXPECT_NEAR(scheduler.eta(10), 0.1, 1e-6);
+  EXPECT_NEAR(scheduler.eta(100), 0.1, 1e-6);
+  // The learning rate decreases monotonically
+  for (int step = 0; step < 10; ++step) {
+    EXPECT_GT(scheduler.eta(step), scheduler.eta(step + 1));
+  }
+}
+
+TEST(LrSchedulerTest, WarmupSuccess) {
+  LrScheduler<double> scheduler(ParseSolverConfig(
+      "type: 'SGD' eta: 0.5 schedule { type: 'Step' step_size: 2 "
+      "gamma: 0.5 warmup_steps: 3 }"));
+  EXPECT_DOUBLE_EQ(scheduler.eta(0), 0.125);
+  EXPECT_DOUBLE_EQ(scheduler.eta(2), 0.375);
+  // The schedule starts after the warmup
+  EXPECT_DOUBLE_EQ(scheduler.eta(3), 0.5);
+  EXPECT_DOUBLE_EQ(scheduler.eta(5), 0.25);
+}
+
+TEST(LrSchedulerTest, StepSetsSolverEta) {
+  LrScheduler<double> scheduler(ParseSolverConfig(
+      "type: 'SGD' eta: 0.5 schedule { type: 'Step' step_size: 1 "
+      "gamma: 0.5 }"));
+  EtaRecorder solver;
+  scheduler.Step(&solver);
+  EXPECT_DOUBLE_EQ(solver.eta, 0.5);
+  scheduler.Step(&solver);
+  EXPECT_DOUBLE_EQ(solver.eta, 0.25);
+  EXPECT_EQ(scheduler.step(), 2);
+}
+
+} // namespace
+} // namespace intellgraph
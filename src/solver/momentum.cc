@@ -14,43 +14,29 @@ Contributor(s):
 ==============================================================================*/
 #include "src/solver/momentum.h"
 
-#include "glog/logging.h"
-#include "src/edge/op_vertex.h"
+#include "src/kernel/solver.h"
+#include "src/logging.h"
 
 namespace intellgraph{
 
 template <typename T>
 Momentum<T>::Momentum(T eta, T gamma, T lambda)
-    : eta_(eta), gamma_(gamma), lambda_(lambda) {
+    : KernelSolver<T, Momentum<T>, 1>(lambda), eta_(eta), gamma_(gamma) {
   DCHECK_GT(eta_, 0.0);
   DCHECK(gamma_ > 0 && gamma_ < 1);
-  DCHECK_GE(lambda_, 0.0);
 }
 
-template <typename T> Momentum<T>::~Momentum() = default;
-
-template <typename T> void Momentum<T>::Visit(Edge<T> &edge) {
-  LOG(INFO) << "Edge " << edge.id() << " is updated with the Momentum.";
-
-  Eigen::Map<MatrixX<T>> bias = edge.mutable_bias();
-  Eigen::Map<MatrixX<T>> weight = edge.mutable_weight();
-
-  MatrixX<T> nabla_weight;
-  nabla_weight.noalias() = edge.CalcNablaWeight() + lambda_ * weight;
-  const MatrixX<T> nabla_bias = edge.CalcNablaBias();
-
-  Eigen::Map<MatrixX<T>> weight_update = edge.mutable_weight_stores(0);
-  Eigen::Map<MatrixX<T>> bias_update = edge.mutable_bias_stores(0);
-
-  // Updates the Moment
-  weight_update.noalias() = gamma_ * weight_update + eta_ * nabla_weight;
-  bias_update.noalias() = gamma_ * bias_update + eta_ * nabla_bias;
+template <typename T>
+Momentum<T>::Momentum(const SolverConfig &config)
+    : Momentum(config.eta(), ConfigValueOr<T>(config.gamma(), 0.9),
+               config.lambda()) {}
 
-  // Updates |weight| matrix
-  weight.noalias() -= weight_update;
+template <typename T> Momentum<T>::~Momentum() = default;
 
-  // Updates |bias| vector
-  bias.noalias() -= bias_update;
+template <typename T>
+void Momentum<T>::Update(T *param, const T *nabla, T *const *stores,
+                         size_t size, T lambda) const {
+  MomentumUpdate(param, nabla, stores[0], size, eta_, lambda, gamma_);
 }
 
 // Explicitly instantiation
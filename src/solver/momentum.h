@@ -15,24 +15,31 @@ Contributor(s):
 #ifndef INTELLGRAPH_SRC_SOLVER_MOMENTUM_H_
 #define INTELLGRAPH_SRC_SOLVER_MOMENTUM_H_
 
-#include "src/edge.h"
+#include <cstddef>
+
 #include "src/proto/graph_parameter.pb.h"
-#include "src/solver.h"
+#include "src/solver/kernel_solver.h"
 
 namespace intellgraph {
 
 // Class that implements the Stochastic Gradient Descent algorithm with momentum
-template <typename T> class Momentum : public Solver<T> {
+template <typename T> class Momentum : public KernelSolver<T, Momentum<T>, 1> {
 public:
   explicit Momentum(T eta, T gamma = 0.9, T lambda = 0);
+  explicit Momentum(const SolverConfig &config);
   ~Momentum() override;
 
-  void Visit(Edge<T> &edge) override;
+  void set_eta(T eta) override { eta_ = eta; }
 
 private:
+  friend class KernelSolver<T, Momentum<T>, 1>;
+  static constexpr const char *kName = "Momentum";
+
+  void Update(T *param, const T *nabla, T *const *stores, size_t size,
+              T lambda) const;
+
   T eta_ = 0;
   T gamma_ = 0;
-  T lambda_ = 0;
 };
 
 // Tells compiler not to instantiate the template in translation units that
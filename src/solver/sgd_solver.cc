@@ -14,41 +14,27 @@ Contributor(s):
 ==============================================================================*/
 #include "src/solver/sgd_solver.h"
 
-#include "glog/logging.h"
-#include "src/edge/dense_edge_impl.h"
-#include "src/eigen.h"
+#include "src/kernel/solver.h"
+#include "src/logging.h"
 
 namespace intellgraph {
 
 template <typename T>
-SgdSolver<T>::SgdSolver(T eta, T lambda) : eta_(eta), lambda_(lambda) {
+SgdSolver<T>::SgdSolver(T eta, T lambda)
+    : KernelSolver<T, SgdSolver<T>, 0>(lambda), eta_(eta) {
   DCHECK_GT(eta_, 0.0);
-  DCHECK_GE(lambda_, 0.0);
 }
 
 template <typename T>
 SgdSolver<T>::SgdSolver(const SolverConfig &config)
-    : eta_(config.eta()), lambda_(config.lambda()) {
-  DCHECK_GT(eta_, 0.0);
-  DCHECK_GE(lambda_, 0.0);
-}
+    : SgdSolver(config.eta(), config.lambda()) {}
 
 template <typename T> SgdSolver<T>::~SgdSolver() = default;
 
-template <typename T> void SgdSolver<T>::Visit(Edge<T> &edge) {
-  LOG(INFO) << "Edge " << edge.id() << " is updated with the SGD solver.";
-
-  Eigen::Map<MatrixX<T>> bias = edge.mutable_bias();
-  Eigen::Map<MatrixX<T>> weight = edge.mutable_weight();
-
-  const MatrixX<T> nabla_weight = edge.CalcNablaWeight();
-  const MatrixX<T> nabla_bias = edge.CalcNablaBias();
-
-  // Updates |weight| matrix
-  weight.noalias() = (1.0 - eta_ * lambda_) * weight - eta_ * nabla_weight;
-
-  // Updates |bias| vector
-  bias.noalias() -= eta_ * nabla_bias;
+template <typename T>
+void SgdSolver<T>::Update(T *param, const T *nabla, T *const *stores,
+                          size_t size, T lambda) const {
+  SgdUpdate(param, nabla, size, eta_, lambda);
 }
 
 // Explicitly instantiation
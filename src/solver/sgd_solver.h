@@ -15,24 +15,31 @@ Contributor(s):
 #ifndef INTELLGRAPH_SRC_SOLVER_SGD_SOLVER_H_
 #define INTELLGRAPH_SRC_SOLVER_SGD_SOLVER_H_
 
-#include "src/edge.h"
+#include <cstddef>
+
 #include "src/proto/graph_parameter.pb.h"
-#include "src/solver.h"
+#include "src/solver/kernel_solver.h"
 
 namespace intellgraph {
 
 // Class that implements the Stochastic Gradient Descent algorithm
-template <typename T> class SgdSolver : public Solver<T> {
+template <typename T>
+class SgdSolver : public KernelSolver<T, SgdSolver<T>, 0> {
 public:
   explicit SgdSolver(T eta, T lambda);
   explicit SgdSolver(const SolverConfig &config);
   ~SgdSolver() override;
 
-  void Visit(Edge<T> &edge) override;
+  void set_eta(T eta) override { eta_ = eta; }
 
 private:
+  friend class KernelSolver<T, SgdSolver<T>, 0>;
+  static constexpr const char *kName = "SGD solver";
+
+  void Update(T *param, const T *nabla, T *const *stores, size_t size,
+              T lambda) const;
+
   T eta_ = 0;
-  T lambda_ = 0;
 };
 
 // Tells compiler not to instantiate the template in translation units that
@@ -0,0 +1,43 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/tensor/arena.h"
+
+#include "glog/logging.h"
+
+namespace intellgraph {
+
+template <typename T> bool Arena<T>::Reserve(size_t size) {
+  if (size <= size_) {
+    return false;
+  }
+  size_ = Align(size);
+  // std::aligned_alloc requires the byte size to be a multiple of alignment,
+  // which Align guarantees
+  T *data = static_cast<T *>(std::aligned_alloc(kAlignment, size_ * sizeof(T)));
+  CHECK(data) << "Failed to allocate an arena of " << size_ * sizeof(T)
+              << " bytes.";
+  data_.reset(data);
+  return true;
+}
+
+template <typename T> size_t Arena<T>::Align(size_t size) {
+  return (size + kStride - 1) / kStride * kStride;
+}
+
+// Explicit instantiation
+template class Arena<float>;
+template class Arena<double>;
+
+} // namespace intellgraph
@@ -0,0 +1,73 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_TENSOR_ARENA_H_
+#define INTELLGRAPH_SRC_TENSOR_ARENA_H_
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+
+namespace intellgraph {
+
+// Arena is a single cache-line aligned block of memory from which the graph
+// carves out vertex buffers. It only grows: reserving a capacity that is not
+// larger than the current one keeps the existing block, so buffers bound to it
+// stay valid.
+template <typename T> class Arena {
+public:
+  // Alignment of the block in bytes, which also suits AVX-512 loads
+  static constexpr size_t kAlignment = 64;
+  // Alignment in number of elements
+  static constexpr size_t kStride = kAlignment / sizeof(T);
+
+  Arena() = default;
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  // Moving keeps the block in place, so bound buffers stay valid
+  Arena(Arena &&) = default;
+  Arena &operator=(Arena &&) = default;
+
+  ~Arena() = default;
+
+  // Ensures the arena can hold at least |size| elements and returns true if
+  // the block has been reallocated. The content is not preserved.
+  bool Reserve(size_t size);
+
+  size_t size() const { return size_; }
+
+  T *data() { return data_.get(); }
+
+  // Rounds |size| elements up so that the next buffer starts aligned
+  static size_t Align(size_t size);
+
+private:
+  struct FreeDeleter {
+    void operator()(T *data) const { std::free(data); }
+  };
+
+  size_t size_ = 0;
+  std::unique_ptr<T, FreeDeleter> data_;
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class Arena<float>;
+extern template class Arena<double>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_TENSOR_ARENA_H_
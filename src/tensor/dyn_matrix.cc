@@ -27,17 +27,19 @@ DynMatrix<T>::DynMatrix(int row, int col)
   DCHECK_GT(size_, 0);
   // Allocates raw data.
   data_ = std::make_unique<T[]>(row_ * col_);
-  new (&data_map_) Eigen::Map<MatrixX<T>>(data_.get(), row_, col_);
-  new (&const_data_map_) Eigen::Map<const MatrixX<T>>(data_.get(), row_, col_);
+  ptr_ = data_.get();
+  new (&data_map_) Eigen::Map<MatrixX<T>>(ptr_, row_, col_);
+  new (&const_data_map_) Eigen::Map<const MatrixX<T>>(ptr_, row_, col_);
   data_map_.setZero();
 }
 
 template <typename T>
 DynMatrix<T>::DynMatrix(DynMatrix &&matrix)
     : row_(matrix.row()), col_(matrix.col()), size_(matrix.size()),
-      data_(std::move(matrix.data_)) {
-  new (&data_map_) Eigen::Map<MatrixX<T>>(data_.get(), row_, col_);
-  new (&const_data_map_) Eigen::Map<const MatrixX<T>>(data_.get(), row_, col_);
+      data_(std::move(matrix.data_)), ptr_(matrix.ptr_) {
+  matrix.ptr_ = nullptr;
+  new (&data_map_) Eigen::Map<MatrixX<T>>(ptr_, row_, col_);
+  new (&const_data_map_) Eigen::Map<const MatrixX<T>>(ptr_, row_, col_);
 }
 
 template <typename T>
@@ -46,8 +48,10 @@ DynMatrix<T> &DynMatrix<T>::operator=(DynMatrix &&matrix) {
   col_ = matrix.col();
   size_ = matrix.size();
   data_ = std::move(matrix.data_);
-  new (&data_map_) Eigen::Map<MatrixX<T>>(data_.get(), row_, col_);
-  new (&const_data_map_) Eigen::Map<const MatrixX<T>>(data_.get(), row_, col_);
+  ptr_ = matrix.ptr_;
+  matrix.ptr_ = nullptr;
+  new (&data_map_) Eigen::Map<MatrixX<T>>(ptr_, row_, col_);
+  new (&const_data_map_) Eigen::Map<const MatrixX<T>>(ptr_, row_, col_);
   return *this;
 }
 
@@ -63,13 +67,41 @@ template <typename T> void DynMatrix<T>::Resize(int row, int col) {
   row_ = row;
   col_ = col;
   if (size_ < row_ * col_) {
-    data_ = std::make_unique<T[]>(row_ * col_);
+    size_ = row_ * col_;
+    data_ = std::make_unique<T[]>(size_);
+    ptr_ = data_.get();
   }
-  new (&data_map_) Eigen::Map<MatrixX<T>>(data_.get(), row_, col_);
-  new (&const_data_map_) Eigen::Map<const MatrixX<T>>(data_.get(), row_, col_);
+  new (&data_map_) Eigen::Map<MatrixX<T>>(ptr_, row_, col_);
+  new (&const_data_map_) Eigen::Map<const MatrixX<T>>(ptr_, row_, col_);
   data_map_.setZero();
 }
 
+template <typename T>
+void DynMatrix<T>::Bind(T *data, int size, int row, int col) {
+  DCHECK(data);
+  DCHECK_GT(row, 0);
+  DCHECK_GT(col, 0);
+  DCHECK_GE(size, row * col);
+
+  data_.reset();
+  ptr_ = data;
+  row_ = row;
+  col_ = col;
+  size_ = size;
+  new (&data_map_) Eigen::Map<MatrixX<T>>(ptr_, row_, col_);
+  new (&const_data_map_) Eigen::Map<const MatrixX<T>>(ptr_, row_, col_);
+}
+
+template <typename T> void DynMatrix<T>::Release() {
+  data_.reset();
+  ptr_ = nullptr;
+  row_ = 0;
+  col_ = 0;
+  size_ = 0;
+  new (&data_map_) Eigen::Map<MatrixX<T>>(nullptr, -1, -1);
+  new (&const_data_map_) Eigen::Map<const MatrixX<T>>(nullptr, -1, -1);
+}
+
 // Explicit instantiation
 template class DynMatrix<float>;
 template class DynMatrix<double>;
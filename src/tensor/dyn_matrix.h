@@ -22,6 +22,9 @@ Contributor(s):
 
 namespace intellgraph {
 
+// DynMatrix is a matrix whose shape can change at runtime. By default it owns
+// its storage; alternatively it can be bound to external storage, e.g. a slice
+// of an arena managed by the graph, in which case it never allocates.
 template <typename T> class DynMatrix {
 public:
   DynMatrix();
@@ -40,22 +43,36 @@ public:
 
   int col() const { return col_; }
 
+  // Number of elements the current storage can hold
   int size() const { return size_; }
 
+  bool owns_data() const { return static_cast<bool>(data_); }
+
   const Eigen::Map<const MatrixX<T>> &map() const { return const_data_map_; }
 
   Eigen::Map<MatrixX<T>> mutable_map() { return data_map_; }
 
-  T *data() { return data_.get(); }
+  T *data() { return ptr_; }
 
+  // Resizes the matrix and zeros it. Bound external storage is reused as long
+  // as it is large enough; otherwise owned storage is allocated.
   void Resize(int row, int col);
 
+  // Views |size| elements of external storage starting at |data| as a |row| by
+  // |col| matrix. The storage is not zeroed and must outlive the binding.
+  void Bind(T *data, int size, int row, int col);
+
+  // Drops the storage, leaving an empty matrix
+  void Release();
+
 private:
   int row_ = 0;
   int col_ = 0;
   int size_ = 0;
 
   std::unique_ptr<T[]> data_;
+  // Points to either |data_| or bound external storage
+  T *ptr_ = nullptr;
   Eigen::Map<MatrixX<T>> data_map_ = Eigen::Map<MatrixX<T>>(nullptr, -1, -1);
   Eigen::Map<const MatrixX<T>> const_data_map_ =
       Eigen::Map<const MatrixX<T>>(nullptr, -1, -1);
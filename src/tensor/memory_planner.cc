@@ -0,0 +1,82 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/tensor/memory_planner.h"
+
+#include <algorithm>
+#include <numeric>
+
+#include "glog/logging.h"
+
+namespace intellgraph {
+
+MemoryPlanner::MemoryPlanner(size_t alignment) : alignment_(alignment) {
+  DCHECK_GT(alignment_, 0);
+}
+
+MemoryPlanner::~MemoryPlanner() = default;
+
+int MemoryPlanner::AddBuffer(size_t size, int first_use, int last_use) {
+  DCHECK_LE(first_use, last_use);
+
+  size_t aligned_size = (size + alignment_ - 1) / alignment_ * alignment_;
+  buffers_.push_back({aligned_size, first_use, last_use, 0});
+  return buffers_.size() - 1;
+}
+
+size_t MemoryPlanner::Plan() {
+  std::vector<int> order(buffers_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](int lhs, int rhs) {
+    return buffers_[lhs].size > buffers_[rhs].size;
+  });
+
+  total_size_ = 0;
+  // Placed buffers, kept sorted by offset
+  std::vector<int> placed;
+  for (int index : order) {
+    Buffer &buffer = buffers_[index];
+    size_t offset = 0;
+    for (int other_index : placed) {
+      const Buffer &other = buffers_[other_index];
+      if (other.last_use < buffer.first_use ||
+          buffer.last_use < other.first_use) {
+        // Lifetimes are disjoint
+        continue;
+      }
+      if (offset + buffer.size <= other.offset) {
+        // Fits into the gap in front of |other|
+        break;
+      }
+      offset = std::max(offset, other.offset + other.size);
+    }
+    buffer.offset = offset;
+    total_size_ = std::max(total_size_, offset + buffer.size);
+    placed.insert(std::upper_bound(placed.begin(), placed.end(), index,
+                                   [this](int lhs, int rhs) {
+                                     return buffers_[lhs].offset <
+                                            buffers_[rhs].offset;
+                                   }),
+                  index);
+  }
+  return total_size_;
+}
+
+size_t MemoryPlanner::offset(int index) const {
+  DCHECK_GE(index, 0);
+  DCHECK_LT(index, buffers_.size());
+  return buffers_[index].offset;
+}
+
+} // namespace intellgraph
@@ -0,0 +1,61 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_TENSOR_MEMORY_PLANNER_H_
+#define INTELLGRAPH_SRC_TENSOR_MEMORY_PLANNER_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace intellgraph {
+
+// MemoryPlanner packs buffers with known sizes and lifetimes into a single
+// block. A lifetime is an inclusive range of schedule steps during which the
+// buffer is live; buffers whose lifetimes do not overlap may share storage.
+// Buffers are placed greedily from the largest to the smallest at the lowest
+// offset that does not collide with any already placed, lifetime-overlapping
+// buffer.
+class MemoryPlanner {
+public:
+  // All offsets are multiples of |alignment| elements
+  explicit MemoryPlanner(size_t alignment = 1);
+  ~MemoryPlanner();
+
+  // Registers a buffer of |size| elements that is live from step |first_use|
+  // to step |last_use| and returns its index
+  int AddBuffer(size_t size, int first_use, int last_use);
+
+  // Assigns offsets to all registered buffers and returns the number of
+  // elements needed to hold them
+  size_t Plan();
+
+  size_t offset(int index) const;
+  size_t total_size() const { return total_size_; }
+
+private:
+  struct Buffer {
+    size_t size;
+    int first_use;
+    int last_use;
+    size_t offset;
+  };
+
+  size_t alignment_;
+  size_t total_size_ = 0;
+  std::vector<Buffer> buffers_;
+};
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_TENSOR_MEMORY_PLANNER_H_
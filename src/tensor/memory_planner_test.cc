@@ -0,0 +1,70 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/tensor/memory_planner.h"
+
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+TEST(MemoryPlannerTest, OverlappingBuffersDoNotShare) {
+  MemoryPlanner planner;
+  int first = planner.AddBuffer(4, 0, 2);
+  int second = planner.AddBuffer(8, 1, 3);
+  EXPECT_EQ(planner.Plan(), 12);
+  // The larger buffer is placed first
+  EXPECT_EQ(planner.offset(second), 0);
+  EXPECT_EQ(planner.offset(first), 8);
+}
+
+TEST(MemoryPlannerTest, DisjointBuffersShare) {
+  // A chain of buffers where each one is only live while it is produced and
+  // consumed by the next step
+  MemoryPlanner planner;
+  int first = planner.AddBuffer(16, 0, 1);
+  int second = planner.AddBuffer(8, 1, 2);
+  int third = planner.AddBuffer(16, 2, 3);
+  EXPECT_EQ(planner.Plan(), 24);
+  EXPECT_EQ(planner.offset(first), 0);
+  EXPECT_EQ(planner.offset(third), 0);
+  EXPECT_EQ(planner.offset(second), 16);
+}
+
+TEST(MemoryPlannerTest, FillsGaps) {
+  MemoryPlanner planner;
+  int outer = planner.AddBuffer(16, 0, 0);
+  int left = planner.AddBuffer(8, 1, 2);
+  int right = planner.AddBuffer(8, 2, 3);
+  int inner = planner.AddBuffer(4, 3, 3);
+  EXPECT_EQ(planner.Plan(), 16);
+  EXPECT_EQ(planner.offset(outer), 0);
+  EXPECT_EQ(planner.offset(left), 0);
+  EXPECT_EQ(planner.offset(right), 8);
+  // |left| is dead at step 3
+  EXPECT_EQ(planner.offset(inner), 0);
+}
+
+TEST(MemoryPlannerTest, AlignsOffsets) {
+  MemoryPlanner planner(16);
+  int first = planner.AddBuffer(3, 0, 1);
+  int second = planner.AddBuffer(5, 0, 1);
+  EXPECT_EQ(planner.Plan(), 32);
+  EXPECT_EQ(planner.offset(first) % 16, 0);
+  EXPECT_EQ(planner.offset(second) % 16, 0);
+  EXPECT_NE(planner.offset(first), planner.offset(second));
+}
+
+} // namespace
+} // namespace intellgraph
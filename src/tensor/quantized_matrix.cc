@@ -0,0 +1,58 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/tensor/quantized_matrix.h"
+
+#include <cmath>
+
+#include "glog/logging.h"
+#include "src/kernel/quantize.h"
+
+namespace intellgraph {
+
+template <typename T>
+QuantizedMatrix<T>::QuantizedMatrix(const Eigen::Ref<const MatrixX<T>> &weight)
+    : channels_(weight.cols()), depth_(weight.rows()),
+      data_(PackedSizeS8(weight.cols(), weight.rows())),
+      scale_(weight.cols()), sum_(weight.cols()) {
+  DCHECK_GT(channels_, 0);
+  DCHECK_GT(depth_, 0);
+
+  // Quantized channels are stored row by row before they are packed
+  std::vector<int8_t> rows(static_cast<size_t>(channels_) * depth_);
+  for (int channel = 0; channel < channels_; ++channel) {
+    T max = weight.col(channel).cwiseAbs().maxCoeff();
+    scale_[channel] = max > 0 ? max / 127 : 1;
+    int32_t sum = 0;
+    for (int i = 0; i < depth_; ++i) {
+      int8_t value = static_cast<int8_t>(
+          std::lround(weight(i, channel) / scale_[channel]));
+      rows[static_cast<size_t>(channel) * depth_ + i] = value;
+      sum += value;
+    }
+    sum_[channel] = sum;
+  }
+  PackS8(channels_, depth_, rows.data(), data_.data());
+}
+
+template <typename T> size_t QuantizedMatrix<T>::bytes() const {
+  return data_.size() * sizeof(int8_t) + scale_.size() * sizeof(T) +
+         sum_.size() * sizeof(int32_t);
+}
+
+// Explicit instantiation
+template class QuantizedMatrix<float>;
+template class QuantizedMatrix<double>;
+
+} // namespace intellgraph
@@ -0,0 +1,66 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_TENSOR_QUANTIZED_MATRIX_H_
+#define INTELLGRAPH_SRC_TENSOR_QUANTIZED_MATRIX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "src/eigen.h"
+
+namespace intellgraph {
+
+// QuantizedMatrix holds a weight matrix in int8 for GemmU8S8S32, see
+// src/kernel/quantize.h. Every column of the weight is an output channel
+// that is quantized symmetrically with its own scale, so that channels of
+// small weights keep their precision.
+template <typename T> class QuantizedMatrix {
+public:
+  QuantizedMatrix() = default;
+  // Quantizes |weight| whose rows are inputs and columns output channels
+  explicit QuantizedMatrix(const Eigen::Ref<const MatrixX<T>> &weight);
+
+  // Number of output channels
+  int channels() const { return channels_; }
+  // Number of inputs of each output channel
+  int depth() const { return depth_; }
+  // Size of the quantized weights in bytes
+  size_t bytes() const;
+
+  // Weights packed by PackS8
+  const int8_t *data() const { return data_.data(); }
+  // Scale of each output channel
+  const T *scale() const { return scale_.data(); }
+  // Sum of the quantized weights of each output channel, which multiplies
+  // the zero point of the inputs
+  const int32_t *sum() const { return sum_.data(); }
+
+private:
+  int channels_ = 0;
+  int depth_ = 0;
+  std::vector<int8_t> data_;
+  std::vector<T> scale_;
+  std::vector<int32_t> sum_;
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class QuantizedMatrix<float>;
+extern template class QuantizedMatrix<double>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_TENSOR_QUANTIZED_MATRIX_H_
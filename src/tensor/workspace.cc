@@ -0,0 +1,106 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/tensor/workspace.h"
+
+#include <atomic>
+
+#include "glog/logging.h"
+
+namespace intellgraph {
+
+uint64_t NewWorkspaceKey() {
+  static std::atomic<uint64_t> next_key(1);
+  return next_key.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename T> Workspace<T>::Workspace() = default;
+
+template <typename T> Workspace<T>::~Workspace() = default;
+
+template <typename T>
+Eigen::Map<const MatrixX<T>> Workspace<T>::act(int vtx_id) const {
+  DCHECK_GE(vtx_id, 0);
+  DCHECK_LT(vtx_id, buffers_.size());
+  const Buffer &buffer = buffers_[vtx_id];
+  DCHECK(buffer.data);
+  return Eigen::Map<const MatrixX<T>>(buffer.data, buffer.row, buffer.col);
+}
+
+template <typename T>
+Eigen::Map<MatrixX<T>> Workspace<T>::mutable_act(int vtx_id) {
+  DCHECK_GE(vtx_id, 0);
+  DCHECK_LT(vtx_id, buffers_.size());
+  Buffer &buffer = buffers_[vtx_id];
+  DCHECK(buffer.mutable_data);
+  return Eigen::Map<MatrixX<T>>(buffer.mutable_data, buffer.row, buffer.col);
+}
+
+template <typename T>
+bool Workspace<T>::IsPlannedFor(uint64_t key, int length) const {
+  return key_ == key && length <= capacity_;
+}
+
+template <typename T>
+T *Workspace<T>::Reserve(uint64_t key, int capacity, size_t size) {
+  DCHECK_NE(key, 0u);
+  key_ = key;
+  capacity_ = capacity;
+  buffers_.clear();
+  arena_.Reserve(size);
+  return arena_.data();
+}
+
+template <typename T> void Workspace<T>::Resize(int length) {
+  DCHECK_GT(length, 0);
+  DCHECK_LE(length, capacity_);
+  for (Buffer &buffer : buffers_) {
+    if (buffer.mutable_data) {
+      buffer.col = length;
+    }
+  }
+}
+
+template <typename T>
+void Workspace<T>::Bind(int vtx_id, T *data, int row, int col) {
+  Buffer &buffer = this->buffer(vtx_id);
+  buffer.data = data;
+  buffer.mutable_data = data;
+  buffer.row = row;
+  buffer.col = col;
+}
+
+template <typename T>
+void Workspace<T>::BindConst(int vtx_id, const T *data, int row, int col) {
+  Buffer &buffer = this->buffer(vtx_id);
+  buffer.data = data;
+  buffer.mutable_data = nullptr;
+  buffer.row = row;
+  buffer.col = col;
+}
+
+template <typename T>
+typename Workspace<T>::Buffer &Workspace<T>::buffer(int vtx_id) {
+  DCHECK_GE(vtx_id, 0);
+  if (vtx_id >= static_cast<int>(buffers_.size())) {
+    buffers_.resize(vtx_id + 1);
+  }
+  return buffers_[vtx_id];
+}
+
+// Explicit instantiation
+template class Workspace<float>;
+template class Workspace<double>;
+
+} // namespace intellgraph
@@ -0,0 +1,92 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_TENSOR_WORKSPACE_H_
+#define INTELLGRAPH_SRC_TENSOR_WORKSPACE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "src/eigen.h"
+#include "src/tensor/arena.h"
+
+namespace intellgraph {
+
+// Returns a key no other call has returned in this process. Graphs identify
+// the workspaces they laid out by such a key rather than by their address,
+// which may be reused by a later graph.
+uint64_t NewWorkspaceKey();
+
+// Workspace holds the activations of a graph for one inference call, indexed
+// by vertex id. It is owned by the caller, so that threads sharing a trained
+// graph each run inference in their own workspace. Workspaces are laid out by
+// the graph for a capacity, and are reused by the same graph for any batch
+// length up to the capacity.
+template <typename T> class Workspace {
+public:
+  Workspace();
+  ~Workspace();
+
+  Workspace(const Workspace &) = delete;
+  Workspace &operator=(const Workspace &) = delete;
+
+  Eigen::Map<const MatrixX<T>> act(int vtx_id) const;
+  Eigen::Map<MatrixX<T>> mutable_act(int vtx_id);
+
+  // Returns true if the workspace has been laid out by the graph of |key| for
+  // batches of at least |length| columns
+  bool IsPlannedFor(uint64_t key, int length) const;
+
+  // Drops all bindings and returns storage of at least |size| elements for
+  // the graph of |key| to lay out activations of |capacity| columns in
+  T *Reserve(uint64_t key, int capacity, size_t size);
+
+  // Resizes activations bound with Bind to |length| columns without moving
+  // them. |length| must not exceed the capacity.
+  void Resize(int length);
+
+  int capacity() const { return capacity_; }
+
+  // Binds the activation of vertex |vtx_id| to |data|
+  void Bind(int vtx_id, T *data, int row, int col);
+  // Binds the activation of vertex |vtx_id| to read-only |data|, e.g. to the
+  // feature matrix
+  void BindConst(int vtx_id, const T *data, int row, int col);
+
+private:
+  struct Buffer {
+    const T *data = nullptr;
+    T *mutable_data = nullptr;
+    int row = 0;
+    int col = 0;
+  };
+
+  Buffer &buffer(int vtx_id);
+
+  // Key of the graph the workspace is laid out by, 0 if not laid out
+  uint64_t key_ = 0;
+  int capacity_ = 0;
+  Arena<T> arena_;
+  std::vector<Buffer> buffers_;
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class Workspace<float>;
+extern template class Workspace<double>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_TENSOR_WORKSPACE_H_
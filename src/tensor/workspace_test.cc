@@ -0,0 +1,59 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/tensor/workspace.h"
+
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+TEST(WorkspaceTest, ReusedWithinCapacity) {
+  Workspace<float> workspace;
+  uint64_t key = NewWorkspaceKey();
+  EXPECT_FALSE(workspace.IsPlannedFor(key, 1));
+
+  float *data = workspace.Reserve(key, 8, 16);
+  workspace.Bind(1, data, 2, 8);
+  EXPECT_EQ(workspace.capacity(), 8);
+  EXPECT_TRUE(workspace.IsPlannedFor(key, 3));
+  EXPECT_TRUE(workspace.IsPlannedFor(key, 8));
+  EXPECT_FALSE(workspace.IsPlannedFor(key, 9));
+
+  uint64_t other_key = NewWorkspaceKey();
+  EXPECT_FALSE(workspace.IsPlannedFor(other_key, 3));
+}
+
+TEST(WorkspaceTest, ResizeKeepsStorage) {
+  Workspace<double> workspace;
+  uint64_t key = NewWorkspaceKey();
+  double *data = workspace.Reserve(key, 4, 8);
+  workspace.Bind(1, data, 2, 4);
+  const double feature[] = {1.0, 2.0};
+  workspace.BindConst(0, feature, 2, 1);
+
+  workspace.Resize(3);
+  EXPECT_EQ(workspace.act(1).data(), data);
+  EXPECT_EQ(workspace.act(1).rows(), 2);
+  EXPECT_EQ(workspace.act(1).cols(), 3);
+  // Read-only bindings are left untouched
+  EXPECT_EQ(workspace.act(0).cols(), 1);
+
+  workspace.Resize(4);
+  EXPECT_EQ(workspace.mutable_act(1).data(), data);
+  EXPECT_EQ(workspace.mutable_act(1).cols(), 4);
+}
+
+} // namespace
+} // namespace intellgraph
@@ -0,0 +1,64 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/utility/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "glog/logging.h"
+
+namespace intellgraph {
+
+std::unique_ptr<MappedFile> MappedFile::Open(const std::string &path,
+                                             bool writable) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    LOG(ERROR) << "Failed to open " << path << ".";
+    return nullptr;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+    LOG(ERROR) << "Failed to stat " << path << " or the file is empty.";
+    close(fd);
+    return nullptr;
+  }
+  size_t size = static_cast<size_t>(file_stat.st_size);
+  // A private writable mapping of a read-only descriptor copies pages on
+  // write instead of failing, e.g. when a loaded graph is trained further
+  int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+  void *data = mmap(nullptr, size, protection, MAP_PRIVATE, fd, 0);
+  // The mapping holds its own reference to the file
+  close(fd);
+  if (data == MAP_FAILED) {
+    LOG(ERROR) << "Failed to map " << path << ".";
+    return nullptr;
+  }
+  return std::unique_ptr<MappedFile>(
+      new MappedFile(static_cast<char *>(data), size));
+}
+
+MappedFile::MappedFile(char *data, size_t size) : data_(data), size_(size) {}
+
+MappedFile::~MappedFile() { munmap(data_, size_); }
+
+void MappedFile::Advise(int advice) const {
+  if (madvise(data_, size_, advice) != 0) {
+    LOG(WARNING) << "Failed to advise the kernel on a mapped file.";
+  }
+}
+
+} // namespace intellgraph
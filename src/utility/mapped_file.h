@@ -0,0 +1,57 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_UTILITY_MAPPED_FILE_H_
+#define INTELLGRAPH_SRC_UTILITY_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace intellgraph {
+
+// MappedFile maps a whole file into memory. Pages are copy-on-write: they are
+// shared through the page cache with every process mapping the same file
+// until they are written, and writes never reach the file.
+class MappedFile {
+public:
+  // Maps the file at |path|, returns nullptr if it cannot be mapped. A
+  // read-only mapping, i.e. if not |writable|, reserves no memory for copied
+  // pages, so that it can be larger than the memory of the machine.
+  static std::unique_ptr<MappedFile> Open(const std::string &path,
+                                          bool writable = true);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // The mapping starts at a page boundary
+  char *data() { return data_; }
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+
+  // Tells the kernel how the mapping will be accessed, e.g. MADV_RANDOM
+  // disables read-ahead of pages around a fault
+  void Advise(int advice) const;
+
+private:
+  MappedFile(char *data, size_t size);
+
+  char *data_ = nullptr;
+  size_t size_ = 0;
+};
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_UTILITY_MAPPED_FILE_H_
@@ -16,13 +16,27 @@ Contributor(s):
 
 static std::random_device rd;
 static std::mt19937 gen;
+// Whether the generator has been seeded by SeedRandom
+static bool seeded = false;
+
+// Reseeds the generator from the random device unless SeedRandom seeded it
+static void Reseed() {
+  if (!seeded) {
+    gen = std::mt19937(rd());
+  }
+}
 
 namespace intellgraph {
 
+void SeedRandom(unsigned int seed) {
+  gen = std::mt19937(seed);
+  seeded = true;
+}
+
 template <typename T>
 NormalFunctor<T>::NormalFunctor(T mean, T standard_deviation) noexcept
     : mean_(mean), standard_deviation_(standard_deviation) {
-  gen = std::mt19937(rd());
+  Reseed();
   nd_ = std::normal_distribution<T>(mean, standard_deviation);
 }
 
@@ -36,7 +50,7 @@ template class NormalFunctor<double>;
 
 template <typename T>
 UniformFunctor<T>::UniformFunctor(T a, T b) noexcept : a_(a), b_(b) {
-  gen = std::mt19937(rd());
+  Reseed();
   dis_ = std::uniform_real_distribution<>(a, b);
 }
 
@@ -46,7 +60,7 @@ template <typename T> T UniformFunctor<T>::operator()(const T) {
 
 template <typename T>
 BernoulliFunctor<T>::BernoulliFunctor(T a) noexcept : a_(a) {
-  gen = std::mt19937(rd());
+  Reseed();
   dis_ = std::bernoulli_distribution(a);
 }
 
@@ -21,6 +21,12 @@ Contributor(s):
 
 namespace intellgraph {
 
+// Functors draw from one generator that each of them reseeds from
+// std::random_device when constructed. After SeedRandom, the generator is
+// seeded with |seed| instead and is no longer reseeded, so that weights are
+// initialized reproducibly, e.g. in tests.
+void SeedRandom(unsigned int seed);
+
 // Normal distribution functor
 template <typename T> class NormalFunctor {
 public:
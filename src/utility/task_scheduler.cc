@@ -0,0 +1,186 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/utility/task_scheduler.h"
+
+#include "glog/logging.h"
+
+namespace intellgraph {
+
+TaskScheduler::TaskScheduler(int num_threads) {
+  DCHECK_GT(num_threads, 0);
+
+  for (int i = 0; i < num_threads; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  // The calling thread works as the first thread
+  for (int i = 1; i < num_threads; ++i) {
+    threads_.emplace_back(&TaskScheduler::WorkerLoop, this, i);
+  }
+}
+
+TaskScheduler::~TaskScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  for (std::thread &thread : threads_) {
+    thread.join();
+  }
+}
+
+void TaskScheduler::Run(const std::vector<int> &num_predecessors,
+                        const std::vector<int> &successor_offsets,
+                        const std::vector<int> &successors,
+                        const std::function<void(int)> &task) {
+  int num_nodes = num_predecessors.size();
+  DCHECK_EQ(successor_offsets.size(), num_nodes + 1);
+  if (num_nodes == 0) {
+    return;
+  }
+
+  successor_offsets_ = &successor_offsets;
+  successors_ = &successors;
+  task_ = &task;
+  if (pending_.size() < static_cast<size_t>(num_nodes)) {
+    pending_ = std::vector<std::atomic<int>>(num_nodes);
+  }
+  for (int i = 0; i < num_nodes; ++i) {
+    pending_[i].store(num_predecessors[i], std::memory_order_relaxed);
+    if (num_predecessors[i] == 0) {
+      Push(0, i);
+    }
+  }
+  remaining_.store(num_nodes, std::memory_order_release);
+
+  if (!threads_.empty()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      active_workers_.store(threads_.size(), std::memory_order_relaxed);
+      ++generation_;
+    }
+    cv_.notify_all();
+  }
+  Work(0);
+  // Workers may still hold references to the DAG until they leave Work
+  Wait(finished_cv_, [this]() { return active_workers_.load() == 0; });
+}
+
+void TaskScheduler::WorkerLoop(int index) {
+  uint64_t generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this, generation]() {
+        return stopped_ || generation_ != generation;
+      });
+      if (stopped_) {
+        return;
+      }
+      generation = generation_;
+    }
+    Work(index);
+    if (active_workers_.fetch_sub(1) == 1) {
+      Notify(finished_cv_);
+    }
+  }
+}
+
+void TaskScheduler::Work(int index) {
+  while (remaining_.load(std::memory_order_acquire) > 0) {
+    int node;
+    if (!Pop(index, &node)) {
+      Wait(ready_cv_, [this]() {
+        return num_ready_.load() > 0 || remaining_.load() == 0;
+      });
+      continue;
+    }
+    (*task_)(node);
+    for (int i = (*successor_offsets_)[node];
+         i < (*successor_offsets_)[node + 1]; ++i) {
+      int successor = (*successors_)[i];
+      if (pending_[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        Push(index, successor);
+      }
+    }
+    if (remaining_.fetch_sub(1) == 1) {
+      Notify(ready_cv_);
+    }
+  }
+}
+
+bool TaskScheduler::Pop(int index, int *node) {
+  {
+    Queue &queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.nodes.empty()) {
+      *node = queue.nodes.back();
+      queue.nodes.pop_back();
+      num_ready_.fetch_sub(1);
+      return true;
+    }
+  }
+  // Steals from other threads
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    Queue &queue = *queues_[(index + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.nodes.empty()) {
+      *node = queue.nodes.front();
+      queue.nodes.pop_front();
+      num_ready_.fetch_sub(1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void TaskScheduler::Push(int index, int node) {
+  {
+    Queue &queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.nodes.push_back(node);
+    num_ready_.fetch_add(1);
+  }
+  Notify(ready_cv_);
+}
+
+template <class Predicate>
+void TaskScheduler::Wait(std::condition_variable &cv, Predicate ready) {
+  for (int i = 0; i < kSpinCount; ++i) {
+    if (ready()) {
+      return;
+    }
+    std::this_thread::yield();
+  }
+  // Threads announce themselves before checking |ready| and notifiers
+  // change what |ready| reads before checking for idle threads, both
+  // sequentially consistent, so either side sees the other
+  std::unique_lock<std::mutex> lock(idle_mutex_);
+  num_idle_.fetch_add(1);
+  cv.wait(lock, ready);
+  num_idle_.fetch_sub(1);
+}
+
+void TaskScheduler::Notify(std::condition_variable &cv) {
+  if (num_idle_.load() == 0) {
+    return;
+  }
+  // Taking the mutex orders the notification after a waiter that has
+  // checked |ready| has started waiting
+  { std::lock_guard<std::mutex> lock(idle_mutex_); }
+  cv.notify_all();
+}
+
+} // namespace intellgraph
@@ -0,0 +1,108 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_UTILITY_TASK_SCHEDULER_H_
+#define INTELLGRAPH_SRC_UTILITY_TASK_SCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace intellgraph {
+
+// TaskScheduler runs the nodes of a DAG concurrently as soon as all of their
+// predecessors have finished. Every node carries an atomic counter of
+// unfinished predecessors; the thread that finishes the last predecessor of a
+// node pushes it to its own queue. Threads pop nodes from the back of their
+// own queues, so a thread tends to continue along the branch it is on, and
+// steal from the front of other queues when they run dry. Threads without a
+// ready node spin for a short bounded time, since the next node is usually
+// pushed soon, and then block until one is pushed or the DAG has finished.
+class TaskScheduler {
+public:
+  // |num_threads| includes the thread calling Run
+  explicit TaskScheduler(int num_threads);
+  ~TaskScheduler();
+
+  TaskScheduler(const TaskScheduler &) = delete;
+  TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+  int num_threads() const { return queues_.size(); }
+
+  // Runs |task| for every node and blocks until all of them have finished.
+  // |num_predecessors[i]| is the in-degree of node i and its successors are
+  // |successors[successor_offsets[i]]| to
+  // |successors[successor_offsets[i + 1] - 1]|.
+  void Run(const std::vector<int> &num_predecessors,
+           const std::vector<int> &successor_offsets,
+           const std::vector<int> &successors,
+           const std::function<void(int)> &task);
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<int> nodes;
+  };
+
+  void WorkerLoop(int index);
+  // Runs ready nodes until all nodes of the current DAG have finished
+  void Work(int index);
+  bool Pop(int index, int *node);
+  void Push(int index, int node);
+  // Returns once |ready| returns true, after spinning for at most kSpinCount
+  // yields and then blocking on |cv|, which must be notified through Notify
+  // whenever the result of |ready| may change
+  template <class Predicate>
+  void Wait(std::condition_variable &cv, Predicate ready);
+  void Notify(std::condition_variable &cv);
+
+  // Yields of a thread without work before it blocks
+  static constexpr int kSpinCount = 64;
+
+  std::vector<std::thread> threads_;
+  std::vector<std::unique_ptr<Queue>> queues_;
+
+  // The DAG that is currently being run
+  const std::vector<int> *successor_offsets_ = nullptr;
+  const std::vector<int> *successors_ = nullptr;
+  const std::function<void(int)> *task_ = nullptr;
+  std::vector<std::atomic<int>> pending_;
+  std::atomic<int> remaining_{0};
+  std::atomic<int> active_workers_{0};
+  // Number of nodes in all queues
+  std::atomic<int> num_ready_{0};
+
+  // Threads blocked in Wait, which only take |idle_mutex_| when there are
+  // any. |ready_cv_| is notified when a node is pushed or the DAG has
+  // finished, |finished_cv_| when the last worker leaves Work.
+  std::mutex idle_mutex_;
+  std::condition_variable ready_cv_;
+  std::condition_variable finished_cv_;
+  std::atomic<int> num_idle_{0};
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  uint64_t generation_ = 0;
+  bool stopped_ = false;
+};
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_UTILITY_TASK_SCHEDULER_H_
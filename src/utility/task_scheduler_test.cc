@@ -0,0 +1,124 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/utility/task_scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+TEST(TaskSchedulerTest, RunRespectsDependencies) {
+  // Diamond: 0 -> {1, 2} -> 3
+  std::vector<int> num_predecessors = {0, 1, 1, 2};
+  std::vector<int> successor_offsets = {0, 2, 3, 4, 4};
+  std::vector<int> successors = {1, 2, 3, 3};
+
+  TaskScheduler task_scheduler(4);
+  for (int run = 0; run < 100; ++run) {
+    std::atomic<int> clock(0);
+    std::vector<int> finished_at(4, -1);
+    task_scheduler.Run(num_predecessors, successor_offsets, successors,
+                       [&clock, &finished_at](int node) {
+                         finished_at[node] = clock++;
+                       });
+    EXPECT_EQ(finished_at[0], 0);
+    EXPECT_GT(finished_at[1], finished_at[0]);
+    EXPECT_GT(finished_at[2], finished_at[0]);
+    EXPECT_EQ(finished_at[3], 3);
+  }
+}
+
+TEST(TaskSchedulerTest, RunVisitsEveryNodeOnce) {
+  // A wide layer of independent nodes between a source and a sink
+  int width = 64;
+  std::vector<int> num_predecessors = {0};
+  std::vector<int> successor_offsets = {0, width};
+  std::vector<int> successors;
+  for (int i = 1; i <= width; ++i) {
+    successors.push_back(i);
+  }
+  for (int i = 1; i <= width; ++i) {
+    num_predecessors.push_back(1);
+    successors.push_back(width + 1);
+    successor_offsets.push_back(successors.size());
+  }
+  num_predecessors.push_back(width);
+  successor_offsets.push_back(successors.size());
+
+  TaskScheduler task_scheduler(3);
+  std::vector<std::atomic<int>> visits(width + 2);
+  task_scheduler.Run(num_predecessors, successor_offsets, successors,
+                     [&visits](int node) { ++visits[node]; });
+  for (const std::atomic<int> &visit : visits) {
+    EXPECT_EQ(visit, 1);
+  }
+}
+
+// Threads without ready nodes block rather than spin, so a chain of slow
+// nodes keeps about one core busy whatever the number of threads
+TEST(TaskSchedulerTest, IdleThreadsBlock) {
+  int length = 10;
+  std::vector<int> num_predecessors = {0};
+  std::vector<int> successor_offsets = {0};
+  std::vector<int> successors;
+  for (int i = 1; i < length; ++i) {
+    num_predecessors.push_back(1);
+    successors.push_back(i);
+    successor_offsets.push_back(successors.size());
+  }
+  successor_offsets.push_back(successors.size());
+
+  TaskScheduler task_scheduler(4);
+  std::vector<int> order;
+  auto wall_begin = std::chrono::steady_clock::now();
+  std::clock_t cpu_begin = std::clock();
+  task_scheduler.Run(num_predecessors, successor_offsets, successors,
+                     [&order](int node) {
+                       std::this_thread::sleep_for(
+                           std::chrono::milliseconds(5));
+                       order.push_back(node);
+                     });
+  double cpu_seconds =
+      static_cast<double>(std::clock() - cpu_begin) / CLOCKS_PER_SEC;
+  double wall_seconds = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - wall_begin)
+                            .count();
+  ASSERT_EQ(order.size(), length);
+  for (int i = 0; i < length; ++i) {
+    EXPECT_EQ(order[i], i);
+  }
+  EXPECT_LT(cpu_seconds, wall_seconds);
+}
+
+TEST(TaskSchedulerTest, SingleThreadSuccess) {
+  std::vector<int> num_predecessors = {0, 1};
+  std::vector<int> successor_offsets = {0, 1, 1};
+  std::vector<int> successors = {1};
+
+  TaskScheduler task_scheduler(1);
+  std::vector<int> order;
+  task_scheduler.Run(num_predecessors, successor_offsets, successors,
+                     [&order](int node) { order.push_back(node); });
+  EXPECT_EQ(order, std::vector<int>({0, 1}));
+}
+
+} // namespace
+} // namespace intellgraph
@@ -0,0 +1,112 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/utility/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "glog/logging.h"
+
+namespace intellgraph {
+
+ThreadPool::ThreadPool(int num_threads) {
+  DCHECK_GT(num_threads, 0);
+
+  workers_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  cv_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Schedule(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  cv_.notify_one();
+}
+
+void ThreadPool::ParallelFor(int count, const std::function<void(int)> &fn) {
+  if (count <= 0) {
+    return;
+  }
+  if (count == 1) {
+    fn(0);
+    return;
+  }
+
+  // Indices are claimed dynamically, so uneven calls are balanced across
+  // whichever threads are free
+  struct State {
+    std::atomic<int> next{0};
+    int done = 0;
+    std::mutex mutex;
+    std::condition_variable cv;
+  };
+  auto state = std::make_shared<State>();
+  auto run = [state, count, &fn]() {
+    int finished = 0;
+    for (int i = state->next++; i < count; i = state->next++) {
+      fn(i);
+      ++finished;
+    }
+    if (finished) {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->done += finished;
+      if (state->done == count) {
+        state->cv.notify_all();
+      }
+    }
+  };
+
+  int helpers = std::min<int>(count - 1, workers_.size());
+  for (int i = 0; i < helpers; ++i) {
+    Schedule(run);
+  }
+  run();
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->cv.wait(lock, [&state, count]() { return state->done == count; });
+}
+
+void ThreadPool::WorkerLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return stopped_ || !tasks_.empty(); });
+      if (stopped_ && tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+} // namespace intellgraph
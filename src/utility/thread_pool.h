@@ -0,0 +1,58 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_UTILITY_THREAD_POOL_H_
+#define INTELLGRAPH_SRC_UTILITY_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace intellgraph {
+
+// ThreadPool runs tasks on a fixed number of worker threads
+class ThreadPool {
+public:
+  explicit ThreadPool(int num_threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  int num_threads() const { return workers_.size(); }
+
+  // Schedules |task| to run on a worker thread
+  void Schedule(std::function<void()> task);
+
+  // Runs |fn| for every index in [0, |count|) and blocks until all calls
+  // have returned. The calling thread takes part in the work, so nesting
+  // ParallelFor inside a task does not deadlock.
+  void ParallelFor(int count, const std::function<void(int)> &fn);
+
+private:
+  void WorkerLoop();
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopped_ = false;
+};
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_UTILITY_THREAD_POOL_H_
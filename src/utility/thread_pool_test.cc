@@ -0,0 +1,56 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/utility/thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndexOnce) {
+  ThreadPool thread_pool(4);
+  std::vector<int> visits(1000, 0);
+  thread_pool.ParallelFor(visits.size(), [&visits](int i) { ++visits[i]; });
+  for (int visit : visits) {
+    EXPECT_EQ(visit, 1);
+  }
+}
+
+TEST(ThreadPoolTest, NestedParallelForSuccess) {
+  ThreadPool thread_pool(2);
+  std::atomic<int> sum(0);
+  thread_pool.ParallelFor(4, [&thread_pool, &sum](int) {
+    thread_pool.ParallelFor(8, [&sum](int i) { sum += i; });
+  });
+  EXPECT_EQ(sum, 4 * 28);
+}
+
+TEST(ThreadPoolTest, ScheduleSuccess) {
+  std::atomic<int> count(0);
+  {
+    ThreadPool thread_pool(3);
+    for (int i = 0; i < 10; ++i) {
+      thread_pool.Schedule([&count]() { ++count; });
+    }
+    // Pending tasks are drained before the workers are joined
+  }
+  EXPECT_EQ(count, 10);
+}
+
+} // namespace
+} // namespace intellgraph
@@ -16,11 +16,14 @@ Contributor(s):
 #define INTELLGRAPH_SRC_VISITOR_H_
 
 #include "src/edge/op_vertex.h"
+#include "src/logging.h"
 
 namespace intellgraph {
 
 // Forward declaration
 template <typename T, class V1, class V2> class DenseEdgeImpl;
+template <typename T, class V1, class V2> class SparseDenseEdgeImpl;
+template <typename T> class Edge;
 
 template <typename T> class Visitor {
 public:
@@ -28,6 +31,14 @@ public:
   virtual ~Visitor() = default;
 
   virtual void Visit(DenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) = 0;
+  // Visitors that only run on dense graphs, e.g. predict visitors, do not
+  // override this
+  virtual void Visit(SparseDenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) {
+    NOTREACHED();
+  }
+  // Parameters held by vertices, see OpVertex::parameters, are calculated by
+  // the vertices themselves, so most visitors leave them as they are
+  virtual void VisitParameters(Edge<T> &parameters) {}
 };
 
 template class Visitor<float>;
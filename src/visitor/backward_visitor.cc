@@ -14,24 +14,26 @@ Contributor(s):
 ==============================================================================*/
 #include "src/visitor/backward_visitor.h"
 
-#include "glog/logging.h"
 #include "src/edge/dense_edge_impl.h"
+#include "src/edge/sparse_dense_edge_impl.h"
 #include "src/eigen.h"
+#include "src/logging.h"
 
 namespace intellgraph {
 
-template <typename T> BackwardVisitor<T>::BackwardVisitor() = default;
+template <typename T>
+BackwardVisitor<T>::BackwardVisitor(bool accumulate, bool calc_nablas)
+    : accumulate_(accumulate), calc_nablas_(calc_nablas) {}
 template <typename T> BackwardVisitor<T>::~BackwardVisitor() = default;
 
 template <typename T>
 void BackwardVisitor<T>::Visit(
     DenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) {
-  LOG(INFO) << "DenseEdge " << edge.id() << " is backwarded.";
+  IG_TRACE(1) << "DenseEdge " << edge.id() << " is backwarded.";
 
   OpVertex<T> *vtx_in = edge.vertex_in();
   OpVertex<T> *vtx_out = edge.vertex_out();
 
-  const Eigen::Map<const MatrixX<T>> &act_in = vtx_in->act();
   const Eigen::Map<const MatrixX<T>> &weight = edge.weight();
 
   Eigen::Map<MatrixX<T>> delta_in = vtx_in->mutable_delta();
@@ -39,10 +41,40 @@ void BackwardVisitor<T>::Visit(
 
   // Calculates |delta_in|:
   // $\delta^l= \mathcal{D}[f^\prime(z^l)]W^{l+1}\delta^{l+1}$
-  // Delta matrix data are updated rather than overwritten
+  // Only $W^{l+1}\delta^{l+1}$ is calculated here, the derivative is applied
+  // by the graph once all outbound edges of the inbound vertex were visited
   if (delta_in.data()) {
-    vtx_in->Derive();
-    delta_in.array() += (weight * delta_out).array() * act_in.array();
+    if (accumulate_) {
+      // Delta matrix data are updated rather than overwritten
+      delta_in.noalias() += weight * delta_out;
+    } else {
+      delta_in.noalias() = weight * delta_out;
+    }
+  }
+
+  // |delta_out| is final at this point, so nablas are calculated while it is
+  // still hot in cache
+  if (calc_nablas_) {
+    edge.CalcNablaWeight();
+    if (edge.owns_bias()) {
+      edge.CalcNablaBias();
+    }
+  }
+}
+
+template <typename T>
+void BackwardVisitor<T>::Visit(
+    SparseDenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) {
+  IG_TRACE(1) << "SparseDenseEdge " << edge.id() << " is backwarded.";
+
+  // The sparse inbound vertex is fed rather than activated, so it has no
+  // delta and only nablas are calculated
+  DCHECK(!edge.vertex_in()->mutable_delta().data());
+  if (calc_nablas_) {
+    edge.CalcNablaWeight();
+    if (edge.owns_bias()) {
+      edge.CalcNablaBias();
+    }
   }
 }
 
@@ -17,16 +17,28 @@ Contributor(s):
 
 #include "src/edge/dense_edge_impl.h"
 #include "src/edge/op_vertex.h"
+#include "src/edge/sparse_dense_edge_impl.h"
 #include "src/visitor.h"
 
 namespace intellgraph {
 
 template <typename T> class BackwardVisitor : public Visitor<T> {
 public:
-  BackwardVisitor();
+  // By default, the delta matrix of the inbound vertex is overwritten, i.e.
+  // deltas are lazily zeroed by the first outbound edge of each vertex. When
+  // |accumulate| is true, the delta matrix is updated rather than overwritten.
+  // Nabla weight and nabla bias of the visited edge are calculated as well,
+  // unless |calc_nablas| is false, e.g. when nablas are calculated once for
+  // several passes.
+  explicit BackwardVisitor(bool accumulate = false, bool calc_nablas = true);
   ~BackwardVisitor() override;
 
   void Visit(DenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) override;
+  void Visit(SparseDenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) override;
+
+private:
+  bool accumulate_ = false;
+  bool calc_nablas_ = true;
 };
 
 // Tells compiler not to instantiate the template in translation units that
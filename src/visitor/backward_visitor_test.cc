@@ -14,8 +14,13 @@ Contributor(s):
 ==============================================================================*/
 #include "src/visitor/backward_visitor.h"
 
+#include <vector>
+
+#include "src/edge/sparse_dense_edge_impl.h"
 #include "src/edge/vertex/op_vertex_impl.h"
 #include "src/edge/vertex/sigmoid.h"
+#include "src/edge/vertex/sparse_input_vertex_impl.h"
+#include "src/eigen.h"
 #include "gtest/gtest.h"
 
 namespace intellgraph {
@@ -52,14 +57,62 @@ TEST(BackwardVisitorTest, VisitSuccess) {
   edge_float.Accept(visitor_float);
   edge_double.Accept(visitor_double);
 
-  EXPECT_EQ(vtx_in_float.mutable_delta(),
-            ((weight_float * delta_out_float).array() *
-             (act_in_float.array() * (1.0f - act_in_float.array())))
-                .matrix());
-  EXPECT_EQ(vtx_in_double.mutable_delta(),
-            ((weight_double * delta_out_double).array() *
-             (act_in_double.array() * (1.0 - act_in_double.array())))
-                .matrix());
+  // The derivative is applied by the graph rather than by the visitor, and
+  // the activation of the inbound vertex is left untouched
+  EXPECT_EQ(vtx_in_float.mutable_delta(), weight_float * delta_out_float);
+  EXPECT_EQ(vtx_in_double.mutable_delta(), weight_double * delta_out_double);
+  EXPECT_EQ(vtx_in_float.mutable_act(), act_in_float);
+  EXPECT_EQ(vtx_in_double.mutable_act(), act_in_double);
+}
+
+TEST(BackwardVisitorTest, VisitCalculatesNablas) {
+  OpVertexImpl<float, Sigmoid> vtx_in(0, 2, 2);
+  OpVertexImpl<float, Sigmoid> vtx_out(1, 4, 2);
+  DenseEdgeImpl<float, OpVertex<float>> edge(0, &vtx_in, &vtx_out);
+
+  vtx_in.mutable_act().setConstant(1.5f);
+  vtx_out.mutable_delta().setConstant(2.0f);
+
+  BackwardVisitor<float> visitor;
+  edge.Accept(visitor);
+
+  // Nablas are averaged over the batch
+  EXPECT_EQ(edge.mutable_nabla_weight(), MatrixX<float>::Constant(2, 4, 3.0f));
+  EXPECT_EQ(edge.mutable_nabla_bias(), MatrixX<float>::Constant(4, 1, 2.0f));
+}
+
+TEST(BackwardVisitorTest, SparseDenseVisitCalculatesNablas) {
+  SparseInputVertexImpl<double, SparseTransformer> vtx_in(0, 6, 3);
+  OpVertexImpl<double, Sigmoid> vtx_out(1, 4, 3);
+  SparseDenseEdgeImpl<double, OpVertex<double>> edge(0, &vtx_in, &vtx_out);
+
+  MatrixX<double> dense = MatrixX<double>::Zero(6, 4);
+  dense(1, 0) = 2.0;
+  dense(4, 0) = -1.0;
+  dense(5, 1) = 1.0;
+  dense(1, 1) = 2.0;
+  dense(5, 3) = 3.0;
+  SparseMatrix<double> feature = dense.sparseView();
+  vtx_in.set_feature(&feature, 1, 3);
+  vtx_out.mutable_delta().setRandom();
+
+  BackwardVisitor<double> visitor;
+  edge.Accept(visitor);
+
+  // Only the weight columns of features present in the batch have a nabla,
+  // which is averaged over the batch
+  MatrixX<double> expected =
+      vtx_out.mutable_delta() * dense.rightCols(3).transpose() / 3.0;
+  ASSERT_TRUE(edge.nabla_weight_cols());
+  const std::vector<int> &cols = *edge.nabla_weight_cols();
+  ASSERT_EQ(cols, std::vector<int>({1, 5}));
+  ASSERT_EQ(edge.mutable_nabla_weight().cols(), 2);
+  for (int i = 0; i < cols.size(); ++i) {
+    EXPECT_TRUE(
+        edge.mutable_nabla_weight().col(i).isApprox(expected.col(cols[i])));
+  }
+  EXPECT_TRUE(edge.mutable_nabla_bias().isApprox(
+      vtx_out.mutable_delta().rowwise().mean()));
 }
 
 } // namespace
@@ -0,0 +1,59 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/visitor/calibrate_visitor.h"
+
+#include <algorithm>
+
+#include "src/edge/dense_edge_impl.h"
+#include "src/eigen.h"
+#include "src/logging.h"
+
+namespace intellgraph {
+
+template <typename T>
+CalibrateVisitor<T>::CalibrateVisitor(QuantizedModel<T> *model,
+                                      Workspace<T> *workspace, bool accumulate)
+    : PredictVisitor<T>(workspace, accumulate), model_(model),
+      workspace_(workspace) {
+  DCHECK(model_);
+}
+
+template <typename T> CalibrateVisitor<T>::~CalibrateVisitor() = default;
+
+template <typename T>
+void CalibrateVisitor<T>::Visit(
+    DenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) {
+  int vtx_in_id = edge.vertex_in()->id();
+  int vtx_out_id = edge.vertex_out()->id();
+  if (model_->weight_by_edge.count(edge.id()) == 0) {
+    model_->weight_by_edge.try_emplace(edge.id(), edge.weight());
+    model_->edges.push_back({edge.id(), vtx_in_id, vtx_out_id});
+    model_->bias_by_vertex.try_emplace(vtx_out_id,
+                                       edge.vertex_out()->mutable_bias());
+  }
+
+  const Eigen::Map<const MatrixX<T>> act_in = workspace_->act(vtx_in_id);
+  ActivationRange<T> &range = model_->range_by_vertex[vtx_in_id];
+  range.min = std::min(range.min, act_in.minCoeff());
+  range.max = std::max(range.max, act_in.maxCoeff());
+
+  PredictVisitor<T>::Visit(edge);
+}
+
+// Explicit instantiation
+template class CalibrateVisitor<float>;
+template class CalibrateVisitor<double>;
+
+} // namespace intellgraph
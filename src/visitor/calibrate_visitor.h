@@ -0,0 +1,50 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_VISITOR_CALIBRATE_VISITOR_H_
+#define INTELLGRAPH_SRC_VISITOR_CALIBRATE_VISITOR_H_
+
+#include "src/edge/dense_edge_impl.h"
+#include "src/edge/op_vertex.h"
+#include "src/tensor/workspace.h"
+#include "src/visitor/predict_visitor.h"
+#include "src/visitor/quantized_predict_visitor.h"
+
+namespace intellgraph {
+
+// CalibrateVisitor forwards activations in float like PredictVisitor, and
+// builds a QuantizedModel on the way: the weight of every visited edge is
+// quantized and recorded with the bias of its outbound vertex, and the range
+// of its inbound activation is extended to the values seen in |workspace|.
+template <typename T> class CalibrateVisitor : public PredictVisitor<T> {
+public:
+  CalibrateVisitor(QuantizedModel<T> *model, Workspace<T> *workspace,
+                   bool accumulate = false);
+  ~CalibrateVisitor() override;
+
+  void Visit(DenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) override;
+
+private:
+  QuantizedModel<T> *model_ = nullptr;
+  Workspace<T> *workspace_ = nullptr;
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class CalibrateVisitor<float>;
+extern template class CalibrateVisitor<double>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_VISITOR_CALIBRATE_VISITOR_H_
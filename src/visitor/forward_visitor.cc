@@ -14,19 +14,22 @@ Contributor(s):
 ==============================================================================*/
 #include "src/visitor/forward_visitor.h"
 
-#include "glog/logging.h"
 #include "src/edge/dense_edge_impl.h"
+#include "src/edge/sparse_dense_edge_impl.h"
 #include "src/eigen.h"
+#include "src/logging.h"
 
 namespace intellgraph {
 
-template <typename T> ForwardVisitor<T>::ForwardVisitor() = default;
+template <typename T>
+ForwardVisitor<T>::ForwardVisitor(bool accumulate)
+    : accumulate_(accumulate) {}
 template <typename T> ForwardVisitor<T>::~ForwardVisitor() = default;
 
 template <typename T>
 void ForwardVisitor<T>::Visit(
     DenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) {
-  LOG(INFO) << "DenseEdge " << edge.id() << " is forwarded.";
+  IG_TRACE(1) << "DenseEdge " << edge.id() << " is forwarded.";
 
   OpVertex<T> *vtx_in = edge.vertex_in();
   OpVertex<T> *vtx_out = edge.vertex_out();
@@ -37,11 +40,40 @@ void ForwardVisitor<T>::Visit(
   Eigen::Map<MatrixX<T>> act_out = vtx_out->mutable_act();
   Eigen::Map<MatrixX<T>> bias_out = vtx_out->mutable_bias();
 
-  // Activation matrix data of the outbound vertex is updated rather than
-  // overwritten
-  vtx_in->Activate();
-  act_out.noalias() +=
-      (weight.transpose() * act_in).colwise() + bias_out.col(0);
+  // |act_in| has already been activated by the graph once all of its inbound
+  // edges were visited
+  if (accumulate_) {
+    // Activation matrix data of the outbound vertex is updated rather than
+    // overwritten, the bias has already been added by the first edge
+    act_out.noalias() += weight.transpose() * act_in;
+  } else {
+    act_out.noalias() = weight.transpose() * act_in;
+    act_out.colwise() += bias_out.col(0);
+  }
+}
+
+template <typename T>
+void ForwardVisitor<T>::Visit(
+    SparseDenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) {
+  IG_TRACE(1) << "SparseDenseEdge " << edge.id() << " is forwarded.";
+
+  const Eigen::Map<const SparseMatrix<T>> *act_in =
+      edge.vertex_in()->sparse_act();
+  DCHECK(act_in);
+  const Eigen::Map<const MatrixX<T>> &weight = edge.weight();
+
+  OpVertex<T> *vtx_out = edge.vertex_out();
+  Eigen::Map<MatrixX<T>> act_out = vtx_out->mutable_act();
+  Eigen::Map<MatrixX<T>> bias_out = vtx_out->mutable_bias();
+
+  // The weight matrix is stored transposed, so only the weight columns of
+  // features present in |act_in| are read
+  if (accumulate_) {
+    act_out.noalias() += weight * *act_in;
+  } else {
+    act_out.noalias() = weight * *act_in;
+    act_out.colwise() += bias_out.col(0);
+  }
 }
 
 // Explicit instantiation
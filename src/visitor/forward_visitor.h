@@ -17,16 +17,25 @@ Contributor(s):
 
 #include "src/edge/dense_edge_impl.h"
 #include "src/edge/op_vertex.h"
+#include "src/edge/sparse_dense_edge_impl.h"
 #include "src/visitor.h"
 
 namespace intellgraph {
 
 template <typename T> class ForwardVisitor : public Visitor<T> {
 public:
-  ForwardVisitor();
+  // By default, the visitor overwrites the activation matrix of the outbound
+  // vertex, so that it does not need to be zero initialized beforehand. When
+  // |accumulate| is true, the weighted input is added to the activation matrix
+  // instead, which is used for the remaining inbound edges of a fan-in vertex.
+  explicit ForwardVisitor(bool accumulate = false);
   ~ForwardVisitor() override;
 
   void Visit(DenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) override;
+  void Visit(SparseDenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) override;
+
+private:
+  bool accumulate_ = false;
 };
 
 // Tells compiler not to instantiate the template in translation units that
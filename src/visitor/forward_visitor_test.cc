@@ -16,7 +16,9 @@ Contributor(s):
 
 #include "src/edge/dense_edge_impl.h"
 #include "src/edge/vertex/op_vertex_impl.h"
+#include "src/edge/sparse_dense_edge_impl.h"
 #include "src/edge/vertex/sigmoid.h"
+#include "src/edge/vertex/sparse_input_vertex_impl.h"
 #include "src/eigen.h"
 #include "gtest/gtest.h"
 
@@ -34,6 +36,8 @@ TEST(ForwardVisitorTest, VisitSuccess) {
   DenseEdgeImpl<double, OpVertex<double>> edge_double(0, &vtx_in_double,
                                                       &vtx_out_double);
 
+  vtx_in_float.mutable_act().setConstant(0.5f);
+  vtx_in_double.mutable_act().setConstant(0.5);
   vtx_out_float.mutable_bias().setConstant(1.0f);
   vtx_out_double.mutable_bias().setConstant(1.0f);
   edge_float.mutable_weight().setIdentity();
@@ -53,5 +57,49 @@ TEST(ForwardVisitorTest, VisitSuccess) {
   EXPECT_EQ(vtx_out_double.mutable_act(), expected_result_double);
 }
 
+TEST(ForwardVisitorTest, VisitOverwritesActivation) {
+  OpVertexImpl<float, Sigmoid> vtx_in(0, 2, 2);
+  OpVertexImpl<float, Sigmoid> vtx_out(1, 4, 2);
+  DenseEdgeImpl<float, OpVertex<float>> edge(0, &vtx_in, &vtx_out);
+
+  vtx_in.mutable_act().setConstant(0.5f);
+  vtx_out.mutable_act().setConstant(7.0f);
+  vtx_out.mutable_bias().setConstant(1.0f);
+  edge.mutable_weight().setIdentity();
+
+  // The stale activation is overwritten rather than accumulated
+  ForwardVisitor<float> visitor;
+  edge.Accept(visitor);
+
+  Eigen::Matrix<float, 4, 2> expected_result;
+  expected_result << 1.5f, 1.5f, 1.5f, 1.5f, 1.0f, 1.0f, 1.0f, 1.0f;
+  EXPECT_EQ(vtx_out.mutable_act(), expected_result);
+}
+
+TEST(ForwardVisitorTest, SparseDenseVisitSuccess) {
+  SparseInputVertexImpl<double, SparseTransformer> vtx_in(0, 6, 3);
+  OpVertexImpl<double, Sigmoid> vtx_out(1, 4, 3);
+  SparseDenseEdgeImpl<double, OpVertex<double>> edge(0, &vtx_in, &vtx_out);
+  vtx_out.mutable_bias().setConstant(0.5);
+
+  MatrixX<double> dense = MatrixX<double>::Zero(6, 4);
+  dense(1, 0) = 2.0;
+  dense(4, 0) = -1.0;
+  dense(0, 1) = 1.0;
+  dense(1, 1) = 2.0;
+  dense(5, 3) = 3.0;
+  SparseMatrix<double> feature = dense.sparseView();
+  // Feeds the last three columns, including one without any feature
+  vtx_in.set_feature(&feature, 1, 3);
+
+  ForwardVisitor<double> visitor;
+  edge.Accept(visitor);
+
+  // The weight matrix is stored transposed
+  MatrixX<double> expected = edge.weight() * dense.rightCols(3);
+  expected.array() += 0.5;
+  EXPECT_TRUE(vtx_out.mutable_act().isApprox(expected));
+}
+
 } // namespace
 } // namespace intellgraph
@@ -14,9 +14,10 @@ Contributor(s):
 ==============================================================================*/
 #include "src/visitor/init_vertex_visitor.h"
 
-#include "glog/logging.h"
 #include "src/edge/dense_edge_impl.h"
+#include "src/edge/sparse_dense_edge_impl.h"
 #include "src/eigen.h"
+#include "src/logging.h"
 
 namespace intellgraph {
 
@@ -27,8 +28,19 @@ template <typename T> InitVertexVisitor<T>::~InitVertexVisitor() = default;
 template <typename T>
 void InitVertexVisitor<T>::Visit(
     DenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) {
-  LOG(INFO) << "OpVertex " << edge.vertex_out()->id()
-            << " is zero initialized.";
+  IG_TRACE(1) << "OpVertex " << edge.vertex_out()->id()
+              << " is zero initialized.";
+
+  OpVertex<T> *const vtx_out = edge.vertex_out();
+  vtx_out->mutable_act().setZero();
+  vtx_out->mutable_delta().setZero();
+}
+
+template <typename T>
+void InitVertexVisitor<T>::Visit(
+    SparseDenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) {
+  IG_TRACE(1) << "OpVertex " << edge.vertex_out()->id()
+              << " is zero initialized.";
 
   OpVertex<T> *const vtx_out = edge.vertex_out();
   vtx_out->mutable_act().setZero();
@@ -17,6 +17,7 @@ Contributor(s):
 
 #include "src/edge/dense_edge_impl.h"
 #include "src/edge/op_vertex.h"
+#include "src/edge/sparse_dense_edge_impl.h"
 #include "src/visitor.h"
 
 namespace intellgraph {
@@ -27,6 +28,7 @@ public:
   ~InitVertexVisitor() override;
 
   void Visit(DenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) override;
+  void Visit(SparseDenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) override;
 };
 
 // Tells compiler not to instantiate the template in translation units that
@@ -19,6 +19,7 @@ Contributor(s):
 
 #include "glog/logging.h"
 #include "src/edge/dense_edge_impl.h"
+#include "src/edge/sparse_dense_edge_impl.h"
 #include "src/utility/random.h"
 
 namespace intellgraph {
@@ -40,6 +41,21 @@ void NormalInitVisitor<T>::Visit(
       NormalFunctor<T>(0.0, std::sqrt(2.0 / weight.cols()))));
 }
 
+template <typename T>
+void NormalInitVisitor<T>::Visit(
+    SparseDenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) {
+  LOG(INFO) << "SparseDenseEdge " << edge.id() << " and "
+            << "OpVertex " << edge.vertex_out()->id()
+            << " are initialized with the Normal Distribution function";
+
+  // The weight matrix is stored transposed, its rows are the dimensions of
+  // the outbound vertex
+  Eigen::Map<MatrixX<T>> weight = edge.mutable_weight();
+
+  weight.array() = weight.array().unaryExpr(std::function<T(T)>(
+      NormalFunctor<T>(0.0, std::sqrt(2.0 / weight.rows()))));
+}
+
 // Explicit instantiation
 template class NormalInitVisitor<float>;
 template class NormalInitVisitor<double>;
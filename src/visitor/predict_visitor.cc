@@ -0,0 +1,56 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/visitor/predict_visitor.h"
+
+#include "src/edge/dense_edge_impl.h"
+#include "src/eigen.h"
+#include "src/logging.h"
+
+namespace intellgraph {
+
+template <typename T>
+PredictVisitor<T>::PredictVisitor(Workspace<T> *workspace, bool accumulate)
+    : workspace_(workspace), accumulate_(accumulate) {
+  DCHECK(workspace_);
+}
+template <typename T> PredictVisitor<T>::~PredictVisitor() = default;
+
+template <typename T>
+void PredictVisitor<T>::Visit(
+    DenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) {
+  IG_TRACE(1) << "DenseEdge " << edge.id() << " is predicted.";
+
+  OpVertex<T> *vtx_in = edge.vertex_in();
+  OpVertex<T> *vtx_out = edge.vertex_out();
+
+  const Eigen::Map<const MatrixX<T>> act_in = workspace_->act(vtx_in->id());
+  const Eigen::Map<const MatrixX<T>> &weight = edge.weight();
+
+  Eigen::Map<MatrixX<T>> act_out = workspace_->mutable_act(vtx_out->id());
+  Eigen::Map<MatrixX<T>> bias_out = vtx_out->mutable_bias();
+
+  if (accumulate_) {
+    act_out.noalias() += weight.transpose() * act_in;
+  } else {
+    act_out.noalias() = weight.transpose() * act_in;
+    act_out.colwise() += bias_out.col(0);
+  }
+}
+
+// Explicit instantiation
+template class PredictVisitor<float>;
+template class PredictVisitor<double>;
+
+} // namespace intellgraph
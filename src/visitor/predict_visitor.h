@@ -0,0 +1,48 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_VISITOR_PREDICT_VISITOR_H_
+#define INTELLGRAPH_SRC_VISITOR_PREDICT_VISITOR_H_
+
+#include "src/edge/dense_edge_impl.h"
+#include "src/edge/op_vertex.h"
+#include "src/tensor/workspace.h"
+#include "src/visitor.h"
+
+namespace intellgraph {
+
+// PredictVisitor forwards activations like ForwardVisitor, but reads and
+// writes them in a caller-owned |workspace| instead of the vertices, so that
+// edges and vertices are only read. With |accumulate|, the weighted input is
+// added to the activation of the outbound vertex instead of overwriting it.
+template <typename T> class PredictVisitor : public Visitor<T> {
+public:
+  explicit PredictVisitor(Workspace<T> *workspace, bool accumulate = false);
+  ~PredictVisitor() override;
+
+  void Visit(DenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) override;
+
+private:
+  Workspace<T> *workspace_ = nullptr;
+  bool accumulate_ = false;
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class PredictVisitor<float>;
+extern template class PredictVisitor<double>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_VISITOR_PREDICT_VISITOR_H_
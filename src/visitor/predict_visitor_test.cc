@@ -0,0 +1,57 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/visitor/predict_visitor.h"
+
+#include "src/edge/dense_edge_impl.h"
+#include "src/edge/vertex/op_vertex_impl.h"
+#include "src/edge/vertex/sigmoid.h"
+#include "src/eigen.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+TEST(PredictVisitorTest, VisitSuccess) {
+  OpVertexImpl<float, Sigmoid> vtx_in(0, 2, 2);
+  OpVertexImpl<float, Sigmoid> vtx_out(1, 4, 2);
+  DenseEdgeImpl<float, OpVertex<float>> edge(0, &vtx_in, &vtx_out);
+
+  vtx_out.mutable_bias().setConstant(1.0f);
+  vtx_out.mutable_act().setConstant(7.0f);
+  edge.mutable_weight().setIdentity();
+
+  MatrixX<float> act_in = MatrixX<float>::Constant(2, 2, 0.5f);
+  MatrixX<float> act_out = MatrixX<float>::Zero(4, 2);
+  Workspace<float> workspace;
+  workspace.BindConst(0, act_in.data(), 2, 2);
+  workspace.Bind(1, act_out.data(), 4, 2);
+
+  PredictVisitor<float> assign_visitor(&workspace);
+  edge.Accept(assign_visitor);
+
+  Eigen::Matrix<float, 4, 2> expected_result;
+  expected_result << 1.5f, 1.5f, 1.5f, 1.5f, 1.0f, 1.0f, 1.0f, 1.0f;
+  EXPECT_EQ(workspace.act(1), expected_result);
+  // The vertex is left untouched
+  EXPECT_EQ(vtx_out.act(), MatrixX<float>::Constant(4, 2, 7.0f));
+
+  PredictVisitor<float> accumulate_visitor(&workspace, true);
+  edge.Accept(accumulate_visitor);
+  expected_result << 2.0f, 2.0f, 2.0f, 2.0f, 1.0f, 1.0f, 1.0f, 1.0f;
+  EXPECT_EQ(workspace.act(1), expected_result);
+}
+
+} // namespace
+} // namespace intellgraph
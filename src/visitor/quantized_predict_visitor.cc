@@ -0,0 +1,88 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/visitor/quantized_predict_visitor.h"
+
+#include "src/edge/dense_edge_impl.h"
+#include "src/eigen.h"
+#include "src/kernel/quantize.h"
+#include "src/logging.h"
+
+namespace intellgraph {
+
+template <typename T>
+QuantizedPredictVisitor<T>::QuantizedPredictVisitor(
+    const QuantizedModel<T> *model, Workspace<T> *workspace, bool accumulate)
+    : model_(model), workspace_(workspace), accumulate_(accumulate) {
+  DCHECK(model_);
+  DCHECK(workspace_);
+}
+
+template <typename T>
+QuantizedPredictVisitor<T>::~QuantizedPredictVisitor() = default;
+
+template <typename T>
+void QuantizedPredictVisitor<T>::Visit(
+    DenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) {
+  IG_TRACE(1) << "DenseEdge " << edge.id() << " is predicted in int8.";
+
+  OpVertex<T> *vtx_out = edge.vertex_out();
+  const T *bias = accumulate_ ? nullptr : vtx_out->mutable_bias().data();
+  Forward({edge.id(), edge.vertex_in()->id(), vtx_out->id()}, bias);
+}
+
+template <typename T>
+void QuantizedPredictVisitor<T>::Forward(const QuantizedEdge &edge,
+                                         const T *bias) {
+  const QuantizedMatrix<T> &weight = model_->weight_by_edge.at(edge.id);
+  const ActivationRange<T> &range = model_->range_by_vertex.at(edge.vtx_in_id);
+
+  const Eigen::Map<const MatrixX<T>> act_in = workspace_->act(edge.vtx_in_id);
+  Eigen::Map<MatrixX<T>> act_out = workspace_->mutable_act(edge.vtx_out_id);
+  DCHECK_EQ(act_in.rows(), weight.depth());
+  DCHECK_EQ(act_out.rows(), weight.channels());
+  DCHECK(accumulate_ || bias);
+
+  int m = weight.channels();
+  int n = act_in.cols();
+  int k = weight.depth();
+  int ldb = RoundUp(k, kPackDepth);
+  int ldc = RoundUp(m, kPackRows);
+  act_in_.resize(static_cast<size_t>(ldb) * n);
+  product_.resize(static_cast<size_t>(ldc) * n);
+  offset_.resize(m);
+  scale_.resize(m);
+
+  T inv_scale = 1 / range.scale();
+  int zero_point = range.zero_point();
+  for (int j = 0; j < n; ++j) {
+    QuantizeU8(act_in.col(j).data(), k, inv_scale, zero_point,
+               act_in_.data() + static_cast<size_t>(j) * ldb);
+  }
+  GemmU8S8S32(m, n, k, weight.data(), act_in_.data(), ldb, product_.data(),
+              ldc);
+
+  for (int i = 0; i < m; ++i) {
+    offset_[i] = zero_point * weight.sum()[i];
+    scale_[i] = weight.scale()[i] * range.scale();
+  }
+  DequantizeS32(m, n, product_.data(), ldc, offset_.data(), scale_.data(),
+                accumulate_ ? nullptr : bias, accumulate_, act_out.data());
+}
+
+// Explicit instantiation
+template class QuantizedPredictVisitor<float>;
+template class QuantizedPredictVisitor<double>;
+
+} // namespace intellgraph
@@ -0,0 +1,97 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#ifndef INTELLGRAPH_SRC_VISITOR_QUANTIZED_PREDICT_VISITOR_H_
+#define INTELLGRAPH_SRC_VISITOR_QUANTIZED_PREDICT_VISITOR_H_
+
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "src/edge/dense_edge_impl.h"
+#include "src/edge/op_vertex.h"
+#include "src/eigen.h"
+#include "src/tensor/quantized_matrix.h"
+#include "src/tensor/workspace.h"
+#include "src/visitor.h"
+
+namespace intellgraph {
+
+// Range of the activation of a vertex observed during calibration. The
+// range always contains zero, so that zero is quantized exactly.
+template <typename T> struct ActivationRange {
+  T min = 0;
+  T max = 0;
+
+  // Scale and zero point of the uint8 activation
+  T scale() const { return max > min ? (max - min) / 255 : 1; }
+  int zero_point() const {
+    return static_cast<int>(std::lround(-min / scale()));
+  }
+};
+
+// Dense edge of a quantized model, from vertex |vtx_in_id| to |vtx_out_id|
+struct QuantizedEdge {
+  int id = 0;
+  int vtx_in_id = 0;
+  int vtx_out_id = 0;
+};
+
+// Int8 weights by edge id and calibrated activation ranges by vertex id.
+// Calibration also records the edges in the order it forwarded them, the
+// inbound edges of each vertex being consecutive, and the biases of their
+// outbound vertices, so that models predict without the float graph.
+template <typename T> struct QuantizedModel {
+  std::map<int, QuantizedMatrix<T>> weight_by_edge;
+  std::map<int, ActivationRange<T>> range_by_vertex;
+  std::vector<QuantizedEdge> edges;
+  std::map<int, MatrixX<T>> bias_by_vertex;
+};
+
+// QuantizedPredictVisitor forwards activations like PredictVisitor, but
+// multiplies the int8 weights of |model| with the inbound activation
+// quantized to uint8. The int32 products are scaled back to real values and
+// the bias is added in the same pass.
+template <typename T> class QuantizedPredictVisitor : public Visitor<T> {
+public:
+  QuantizedPredictVisitor(const QuantizedModel<T> *model,
+                          Workspace<T> *workspace, bool accumulate = false);
+  ~QuantizedPredictVisitor() override;
+
+  void Visit(DenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) override;
+  // Forwards |edge| of the model with activations in the workspace, adding
+  // |bias| unless the visitor accumulates
+  void Forward(const QuantizedEdge &edge, const T *bias);
+
+private:
+  const QuantizedModel<T> *model_ = nullptr;
+  Workspace<T> *workspace_ = nullptr;
+  bool accumulate_ = false;
+
+  // Scratch buffers reused by all edges of a pass
+  std::vector<uint8_t> act_in_;
+  std::vector<int32_t> product_;
+  std::vector<int32_t> offset_;
+  std::vector<T> scale_;
+};
+
+// Tells compiler not to instantiate the template in translation units that
+// include this header file
+extern template class QuantizedPredictVisitor<float>;
+extern template class QuantizedPredictVisitor<double>;
+
+} // namespace intellgraph
+
+#endif // INTELLGRAPH_SRC_VISITOR_QUANTIZED_PREDICT_VISITOR_H_
@@ -0,0 +1,67 @@
+/* Copyright 2020 The IntellGraph Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Contributor(s):
+        Lingbo Zhang <lingboz2015@gmail.com>
+==============================================================================*/
+#include "src/visitor/quantized_predict_visitor.h"
+
+#include "src/edge/dense_edge_impl.h"
+#include "src/edge/vertex/op_vertex_impl.h"
+#include "src/edge/vertex/sigmoid.h"
+#include "src/eigen.h"
+#include "src/visitor/calibrate_visitor.h"
+#include "gtest/gtest.h"
+
+namespace intellgraph {
+namespace {
+
+TEST(QuantizedPredictVisitorTest, VisitSuccess) {
+  OpVertexImpl<float, Sigmoid> vtx_in(0, 3, 2);
+  OpVertexImpl<float, Sigmoid> vtx_out(1, 2, 2);
+  DenseEdgeImpl<float, OpVertex<float>> edge(0, &vtx_in, &vtx_out);
+
+  vtx_out.mutable_bias() << 1.0f, -1.0f;
+  edge.mutable_weight() << 1.0f, -0.5f, 0.25f, 2.0f, -1.0f, 0.0f;
+
+  MatrixX<float> act_in(3, 2);
+  act_in << -1.0f, 0.5f, 0.0f, 2.0f, 1.5f, -0.25f;
+  MatrixX<float> act_out = MatrixX<float>::Zero(2, 2);
+  Workspace<float> workspace;
+  workspace.BindConst(0, act_in.data(), 3, 2);
+  workspace.Bind(1, act_out.data(), 2, 2);
+
+  // Calibration forwards in float
+  QuantizedModel<float> model;
+  CalibrateVisitor<float> calibrate_visitor(&model, &workspace);
+  edge.Accept(calibrate_visitor);
+  MatrixX<float> expected_result =
+      (edge.weight().transpose() * act_in).colwise() +
+      vtx_out.mutable_bias().col(0);
+  EXPECT_TRUE(workspace.act(1).isApprox(expected_result));
+  EXPECT_EQ(model.weight_by_edge.count(0), 1);
+  EXPECT_FLOAT_EQ(model.range_by_vertex.at(0).min, -1.0f);
+  EXPECT_FLOAT_EQ(model.range_by_vertex.at(0).max, 2.0f);
+
+  // Errors are within half a step of the weight and activation scales
+  act_out.setZero();
+  QuantizedPredictVisitor<float> assign_visitor(&model, &workspace);
+  edge.Accept(assign_visitor);
+  EXPECT_TRUE(workspace.act(1).isApprox(expected_result, 1e-2f));
+
+  QuantizedPredictVisitor<float> accumulate_visitor(&model, &workspace, true);
+  edge.Accept(accumulate_visitor);
+  expected_result += edge.weight().transpose() * act_in;
+  EXPECT_TRUE(workspace.act(1).isApprox(expected_result, 1e-2f));
+}
+
+} // namespace
+} // namespace intellgraph
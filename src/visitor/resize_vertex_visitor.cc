@@ -14,9 +14,10 @@ Contributor(s):
 ==============================================================================*/
 #include "src/visitor/resize_vertex_visitor.h"
 
-#include "glog/logging.h"
 #include "src/edge/dense_edge_impl.h"
+#include "src/edge/sparse_dense_edge_impl.h"
 #include "src/eigen.h"
+#include "src/logging.h"
 
 namespace intellgraph {
 
@@ -29,8 +30,17 @@ template <typename T> ResizeVertexVisitor<T>::~ResizeVertexVisitor() = default;
 template <typename T>
 void ResizeVertexVisitor<T>::Visit(
     DenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) {
-  LOG(INFO) << "OpVertex " << edge.vertex_out()->id()
-            << " is resized, batch size: " << batch_size_;
+  IG_TRACE(1) << "OpVertex " << edge.vertex_out()->id()
+              << " is resized, batch size: " << batch_size_;
+
+  edge.vertex_out()->ResizeVertex(batch_size_);
+}
+
+template <typename T>
+void ResizeVertexVisitor<T>::Visit(
+    SparseDenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) {
+  IG_TRACE(1) << "OpVertex " << edge.vertex_out()->id()
+              << " is resized, batch size: " << batch_size_;
 
   edge.vertex_out()->ResizeVertex(batch_size_);
 }
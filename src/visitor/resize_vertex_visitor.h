@@ -17,6 +17,7 @@ Contributor(s):
 
 #include "src/edge/dense_edge_impl.h"
 #include "src/edge/op_vertex.h"
+#include "src/edge/sparse_dense_edge_impl.h"
 #include "src/visitor.h"
 
 namespace intellgraph {
@@ -28,6 +29,7 @@ public:
 
   void set_batch_size(int batch_size) { batch_size_ = batch_size; }
   void Visit(DenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) override;
+  void Visit(SparseDenseEdgeImpl<T, OpVertex<T>, OpVertex<T>> &edge) override;
 
 private:
   int batch_size_;